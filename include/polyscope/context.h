@@ -11,6 +11,7 @@
 #include <glm/gtx/norm.hpp>
 
 #include <array>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
@@ -28,6 +29,7 @@ class Group;
 class SlicePlane;
 class Widget;
 class FloatingQuantityStructure;
+class ProgressiveImplicitRender;
 namespace view {
 extern const double defaultNearClipRatio;
 extern const double defaultFarClipRatio;
@@ -96,6 +98,8 @@ struct Context {
   glm::dualquat flightTargetViewR, flightInitialViewR;
   glm::vec3 flightTargetViewT, flightInitialViewT;
   float flightTargetFov, flightInitialFov;
+  bool viewChanging = false;
+  glm::mat4x4 lastRenderedViewProjMat{std::numeric_limits<float>::quiet_NaN()};
 
 
   // ======================================================
@@ -104,6 +108,9 @@ struct Context {
 
   bool pointCloudEfficiencyWarningReported = false;
   FloatingQuantityStructure* globalFloatingQuantityStructure = nullptr;
+
+  // Progressive implicit surface renders, keyed by the parent structure's unique prefix and the quantity name
+  std::map<std::string, std::unique_ptr<ProgressiveImplicitRender>> progressiveImplicitRenders;
 };
 
 
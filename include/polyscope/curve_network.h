@@ -55,9 +55,11 @@ public:
   virtual void drawPick() override;
 
   virtual void updateObjectSpaceBounds() override;
+  virtual uint64_t geometryDataVersion() override;
   virtual std::string typeName() override;
 
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
 
   // === Geometry members
 
@@ -172,6 +172,7 @@ void CurveNetwork::updateNodePositions(const V& newPositions) {
   validateSize(newPositions, nNodes(), "newPositions");
   nodePositions.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   nodePositions.markHostBufferUpdated();
+  updateObjectSpaceBounds();
   recomputeGeometryIfPopulated();
 }
 
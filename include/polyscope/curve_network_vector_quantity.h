@@ -35,6 +35,7 @@ public:
   virtual void buildCustomUI() override;
   virtual std::string niceName() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual void buildNodeInfoGUI(size_t vInd) override;
 };
 
@@ -51,6 +52,7 @@ public:
   virtual void buildCustomUI() override;
   virtual std::string niceName() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual void buildEdgeInfoGUI(size_t vInd) override;
 };
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <vector>
 
@@ -53,4 +54,24 @@ private:
   std::vector<bool> marked;
 };
 
+// A disjoint set which may be merged and queried from many threads at once (e.g. inside of parallelFor()), without
+// locks. Sets are always linked under their smallest element, so after all merges find(x) is the smallest element in
+// the set of x, regardless of the order in which merges happened.
+class ConcurrentDisjointSets {
+public:
+  // Constructor
+  ConcurrentDisjointSets(size_t n_);
+
+  // Find the representative of element x, with path halving
+  size_t find(size_t x);
+
+  // Union, linking the root with the larger index under the other
+  void merge(size_t x, size_t y);
+
+private:
+  // Member variables
+  size_t n;
+  std::vector<std::atomic<size_t>> parent;
+};
+
 } // namespace polyscope
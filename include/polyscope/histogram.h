@@ -4,6 +4,7 @@
 
 #include "polyscope/render/color_maps.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/scalar_statistics.h"
 
 #include <vector>
 
@@ -19,6 +20,9 @@ public:
   ~Histogram();
 
   void buildHistogram(const std::vector<float>& values);
+  void buildHistogram(const ScalarStatistics& stats); // stats must have getBinCount() bins
+  size_t getBinCount() const;
+  const std::vector<size_t>& getBinCounts() const; // the number of values in each bin, as last built
   void updateColormap(const std::string& newColormap);
 
   // Width = -1 means set automatically
@@ -33,6 +37,7 @@ private:
   void fillBuffers();
   size_t rawHistBinCount = 51;
 
+  std::vector<size_t> binCounts;
   std::vector<float> rawHistCurveY;
   std::vector<std::array<float, 2>> rawHistCurveX;
   std::pair<double, double> dataRange;
@@ -14,8 +14,10 @@
 #include "polyscope/scaled_value.h"
 #include "polyscope/structure.h"
 #include "polyscope/utilities.h"
+#include "polyscope/weak_handle.h"
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -75,12 +77,116 @@ struct ImplicitRenderOpts {
 
   // The maximum number of steps to take
   size_t nMaxSteps = 1024;
+
+  // The image is traced in square tiles of tileSize x tileSize pixels, and the implicit function is called on batches
+  // of rays from one tile at a time. The result does not depend on the tile size.
+  size_t tileSize = 128;
+
+  // If true, tiles are traced concurrently on several threads (see options::maxThreads). The implicit functions will
+  // then be called from multiple threads at once, so they must be thread-safe.
+  bool parallelTiles = false;
+
+  // = Options for progressive rendering
+
+  // If true, the render function only traces a preview at 1/subsampleFactor of the resolution before returning, then
+  // refines the image over the following frames, halving the subsampling each time, until every pixel has been traced
+  // (the final image is the same as a non-progressive render). When rendering from the current view, the final image
+  // is at the full view resolution rather than being reduced by subsampleFactor, and the render starts over from a new
+  // preview whenever the view changes.
+  //
+  // Only supported by renderImplicitSurface() and renderImplicitSurfaceColor() (and their batch variants). The
+  // functions are copied and called again on later frames, so anything they reference must stay alive.
+  bool progressive = false;
+
+  // For progressive rendering, roughly how much time to spend refining the image on each frame, in milliseconds. When
+  // rendering from the current view, this also covers the new preview traced after the view changes.
+  float progressiveFrameBudgetMs = 10.;
 };
 
 // Populate the custom-filled entries of opts according to the policy above.
 template <class S>
 void resolveImplicitRenderOpts(QuantityStructure<S>* parent, ImplicitRenderOpts& opts);
 
+// Refines an implicit surface render over many frames, for the render functions below with opts.progressive = true.
+// Each time the scene is rendered (with or without the UI, e.g. for screenshots) it traces more pixels within the frame
+// budget and updates the render image quantity. These are owned by the global context, and are dropped from it once
+// they are done refining a fixed camera's image, or once their quantity or structure is removed.
+class ProgressiveImplicitRender {
+public:
+  typedef std::function<void(float*, float*, size_t)> BatchFunc; // same signature as the batch functions below
+
+  // The quantity `name` is looked up with findQuantity (which calls getFloatingQuantity() on the parent); if funcColor
+  // is empty it should be a DepthRenderImageQuantity, otherwise a ColorRenderImageQuantity. If followsView is true, the
+  // camera and resolution in opts are replaced by the current view's, and are kept up to date with it.
+  ProgressiveImplicitRender(Structure& parent, std::function<FloatingQuantity*(std::string)> findQuantity,
+                            std::string name, BatchFunc func, BatchFunc funcColor, ImplicitRenderMode mode,
+                            ImplicitRenderOpts opts, bool followsView);
+
+  // Trace more pixels for this frame, within the frame budget, and publish them to the quantity. Returns false once
+  // there is nothing left to do, and the render can be dropped.
+  bool prepareFrame();
+
+  // True while there are pixels left to trace
+  bool isRefining();
+
+  // The current image, at the final resolution. Pixels which have not been traced yet are filled in from the nearest
+  // traced pixel above and to the left. Freed (empty) once refinement is done and the image has been published.
+  const ImplicitRenderOpts& getOpts();
+  const std::vector<float>& getDepths();
+  const std::vector<glm::vec3>& getNormals();
+  const std::vector<glm::vec3>& getColors();
+
+private:
+  WeakHandle<Structure> parent;
+  std::function<FloatingQuantity*(std::string)> findQuantity;
+  const std::string name;
+  BatchFunc func, funcColor;
+  const ImplicitRenderMode mode;
+  ImplicitRenderOpts opts;
+  const bool followsView;
+  bool stopped = false;            // set once the quantity is gone, never restarts after that
+  glm::mat4 viewProjMat;           // for followsView, the view which the current image is for
+  bool previewTraced = false;      // true once the coarsest level of the current image is done
+  size_t subsampleFactor = 1;      // every subsampleFactor'th pixel in each dimension is traced on the current level
+  std::vector<size_t> levelPixels; // the pixels of the current level, in the order they get traced
+  size_t nextLevelPixel = 0;
+
+  // Image data
+  std::vector<glm::vec3> rayDirs;
+  std::vector<float> depths;
+  std::vector<glm::vec3> rayPositions;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec3> colors;
+  std::vector<char> traced; // for each pixel, true once it has been traced
+
+  // Helpers
+  void restart(); // set up the image for the current opts (or view), and start on the coarsest level
+  void startLevel(size_t newSubsampleFactor);
+  void traceNextPixels(); // trace the next batch(es) of pixels on the current level
+  void publish();         // update the quantity with the current image
+  RenderImageQuantityBase* getQuantity();
+};
+
+// Start a progressive render for the quantity `name` of `parent`, replacing any which is already running for it. The
+// opts are resolved as for the render functions (see opts.progressive). The first level is traced right away, but the
+// quantity itself is not created.
+template <class S>
+ProgressiveImplicitRender* startProgressiveImplicitRender(QuantityStructure<S>* parent, std::string name,
+                                                          ProgressiveImplicitRender::BatchFunc func,
+                                                          ProgressiveImplicitRender::BatchFunc funcColor,
+                                                          ImplicitRenderMode mode, ImplicitRenderOpts opts);
+
+// Stop any progressive render of the quantity `name` of `parent`. The render functions call this, so that a new render
+// of a quantity is never overwritten by an old progressive one.
+void stopProgressiveImplicitRender(Structure& parent, std::string name);
+
+// Refine all the progressive renders for this frame, and drop those which are done. Called from
+// prepareStructuresForFrame().
+void prepareProgressiveImplicitRendersForFrame();
+
+// True if any progressive render has pixels left to trace, and so needs the scene to be drawn again
+bool progressiveImplicitRendersRefining();
+
 // === Depth/geometry/shape only render functions
 
 // Renders an implicit surface by shooting a ray for each pixel and querying the implicit function along the ray.
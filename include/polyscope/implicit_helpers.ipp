@@ -7,9 +7,14 @@
 #include "polyscope/floating_quantity_structure.h"
 #include "polyscope/implicit_helpers.h"
 #include "polyscope/messages.h"
+#include "polyscope/parallel.h"
 #include "polyscope/view.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace polyscope {
@@ -64,8 +69,10 @@ void resolveImplicitRenderOpts(QuantityStructure<S>* parent, ImplicitRenderOpts&
 }
 
 template <class Func>
-std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>>
-renderImplicitSurfaceTracer(Func&& func, ImplicitRenderMode mode, ImplicitRenderOpts opts, bool withNormals = true) {
+void traceImplicitSurfacePixels(Func&& func, ImplicitRenderMode mode, const ImplicitRenderOpts& opts,
+                                const std::vector<glm::vec3>& rayDirs, const std::vector<size_t>& pixInds,
+                                std::vector<float>& rayDepthOut, std::vector<glm::vec3>& rayPosOut,
+                                std::vector<glm::vec3>* normalOut) {
 
   // Read out option values
   const float missDist = opts.missDist.asAbsolute();
@@ -74,67 +81,50 @@ renderImplicitSurfaceTracer(Func&& func, ImplicitRenderMode mode, ImplicitRender
   const float stepSize = opts.stepSize.asAbsolute(); // used for fixed step only
   const size_t nMaxSteps = opts.nMaxSteps;
   const float normalSampleEps = opts.normalSampleEps;
-  const int subsampleFactor = opts.subsampleFactor;
-
 
-  CameraParameters& params = opts.cameraParameters;
+  const CameraParameters& params = opts.cameraParameters;
   glm::vec3 cameraLoc = params.getPosition();
-  glm::mat4x4 viewMat = params.getViewMat();
-  size_t dimX = opts.dimX;
-  size_t dimY = opts.dimY;
-  size_t nPix = dimX * dimY;
-
-  // Generate rays corresponding to each pixel
-  // (this is a working set which will be shrunk as computation proceeds)
-  std::vector<glm::vec3> rayRoots(nPix);
-  std::vector<size_t> rayInds(nPix); // index of the ray
-  for (size_t iY = 0; iY < dimY; iY++) {
-    for (size_t iX = 0; iX < dimX; iX++) {
-      size_t ind = iY * dimX + iX;
-      rayRoots[ind] = cameraLoc;
-      rayInds[ind] = ind;
-    }
+  glm::mat3x3 viewMat3(params.getViewMat());
+
+  size_t nTracePix = pixInds.size();
+  if (nTracePix == 0) return;
+  for (size_t iP : pixInds) {
+    rayDepthOut[iP] = -1.;
+    rayPosOut[iP] = glm::vec3{0.f, 0.f, 0.f};
+    if (normalOut) (*normalOut)[iP] = glm::vec3{0.f, 0.f, 0.f};
   }
-  std::vector<glm::vec3> rayDirs = params.generateCameraRays(dimX, dimY, ImageOrigin::UpperLeft);
-
-  // Sample the first value at each ray (to check for sign changes)
-  std::vector<float> currVals(nPix);
-  func(&rayRoots.front().x, &currVals.front(), rayRoots.size());
 
-  std::vector<bool> initSigns(nPix);
-  for (size_t iP = 0; iP < nPix; iP++) {
-    initSigns[iP] = std::signbit(currVals[iP]);
-  }
+  // Working set for the rays, stored as separate arrays which get compacted as rays terminate
+  std::vector<size_t> rayInds(pixInds);       // index of the ray
+  std::vector<float> rayDepth(nTracePix, 0.); // depth along the ray
+  std::vector<glm::vec3> currPos(nTracePix, cameraLoc);
+  std::vector<float> currVals(nTracePix);
 
-  // Write output data here
+  // Sample the first value (to check for sign changes). Every ray starts at the camera, so they all share this sign.
+  func(&currPos.front().x, &currVals.front(), nTracePix);
+  const bool initSign = std::signbit(currVals.front());
 
-  // March along the ray to compute depth
-  std::vector<float> rayDepth(nPix, 0.); // working data, gets shrunk and repacked
-  std::vector<glm::vec3> currPos(nPix);
-  std::vector<float> rayDepthOut(nPix, -1.);                        // output values
-  std::vector<glm::vec3> rayPosOut(nPix, glm::vec3{0.f, 0.f, 0.f}); // output values
-  size_t iFinished = 0;
-  for (size_t iStep = 0; (iStep < nMaxSteps) && (iFinished < nPix); iStep++) {
+  // March along the rays to compute depth
+  size_t nActive = nTracePix;
+  for (size_t iStep = 0; (iStep < nMaxSteps) && (nActive > 0); iStep++) {
 
     // Check for convergence & write/compact
     size_t iPack = 0;
-    for (size_t iP = 0; iP < rayDepth.size(); iP++) {
+    for (size_t iP = 0; iP < nActive; iP++) {
 
       // Check for termination
       bool missTerminated = rayDepth[iP] > missDist;
       bool terminated =
-          missTerminated || (std::abs(currVals[iP]) < hitDist) || (std::signbit(currVals[iP]) != initSigns[iP]);
+          missTerminated || (std::abs(currVals[iP]) < hitDist) || (std::signbit(currVals[iP]) != initSign);
 
       if (terminated) {
         // Write to the output buffer
         size_t outInd = rayInds[iP];
-        glm::vec3 finalPos = rayRoots[iP] + rayDepth[iP] * rayDirs[iP];
+        glm::vec3 finalPos = cameraLoc + rayDepth[iP] * rayDirs[outInd];
         float outDepth = missTerminated ? -1.f : rayDepth[iP];
         rayDepthOut[outInd] = outDepth;
         rayPosOut[outInd] = finalPos;
 
-        iFinished++;
-
       } else {
         // Take a step
         float rayStepSize = -1.;
@@ -145,41 +135,29 @@ renderImplicitSurfaceTracer(Func&& func, ImplicitRenderMode mode, ImplicitRender
         }
 
         float newDepth = rayDepth[iP] + rayStepSize;
-        glm::vec3 newPos = rayRoots[iP] + newDepth * rayDirs[iP];
+        glm::vec3 newPos = cameraLoc + newDepth * rayDirs[rayInds[iP]];
 
         // Write to the compacted array
-        rayRoots[iPack] = rayRoots[iP];
-        rayDirs[iPack] = rayDirs[iP];
         rayInds[iPack] = rayInds[iP];
         rayDepth[iPack] = newDepth;
         currPos[iPack] = newPos;
         iPack++;
       }
     }
-
-    // "Trim" the working arrays to size
-    rayRoots.resize(iPack);
-    rayDirs.resize(iPack);
-    rayInds.resize(iPack);
-    rayDepth.resize(iPack);
-    currPos.resize(iPack);
-    currVals.resize(iPack);
+    nActive = iPack;
 
     // Evaluate the remaining rays
-    if (iPack > 0) {
-      func(&currPos.front().x, &currVals.front(), currPos.size());
+    if (nActive > 0) {
+      func(&currPos.front().x, &currVals.front(), nActive);
     }
   }
 
-  // == Compute normals
+  // == Compute normals, for the rays which hit something
   // Uses finite differences on the vertices of a tetrahedron
   // (see https://iquilezles.org/articles/normalsSDF/)
 
-  std::vector<glm::vec3> normalOut;
-
-  if (withNormals) {
-
-    normalOut = std::vector<glm::vec3>(nPix, glm::vec3{0.f, 0.f, 0.f});
+  if (normalOut) {
+    std::vector<glm::vec3>& normals = *normalOut;
 
     std::array<glm::vec3, 4> tetVerts({
         glm::vec3{1.f, -1.f, -1.f},
@@ -188,42 +166,94 @@ renderImplicitSurfaceTracer(Func&& func, ImplicitRenderMode mode, ImplicitRender
         glm::vec3{1.f, 1.f, 1.f},
     });
 
-    currPos.resize(nPix);
-    currVals.resize(nPix);
-    for (size_t iV = 0; iV < 4; iV++) {
+    size_t nHit = 0;
+    for (size_t iP : pixInds) {
+      if (rayDepthOut[iP] >= 0.) rayInds[nHit++] = iP;
+    }
+
+    for (size_t iV = 0; iV < 4 && nHit > 0; iV++) {
       glm::vec3 vertVec = tetVerts[iV];
 
       // Set up the evaluation points for each pixel
-      for (size_t iP = 0; iP < nPix; iP++) {
-        float f = rayDepthOut[iP] * normalSampleEps;
-        currPos[iP] = rayPosOut[iP] + f * vertVec;
+      for (size_t iP = 0; iP < nHit; iP++) {
+        float f = rayDepthOut[rayInds[iP]] * normalSampleEps;
+        currPos[iP] = rayPosOut[rayInds[iP]] + f * vertVec;
       }
 
       // Evaluate the function at each sample point
-      func(&currPos.front().x, &currVals.front(), currPos.size());
+      func(&currPos.front().x, &currVals.front(), nHit);
 
       // Accumulate the result
-      for (size_t iP = 0; iP < nPix; iP++) {
-        normalOut[iP] += vertVec * currVals[iP];
+      for (size_t iP = 0; iP < nHit; iP++) {
+        normals[rayInds[iP]] += vertVec * currVals[iP];
       }
     }
 
     // Normalize the normal vectors and transform to view space
-    glm::mat3x3 viewMat3(viewMat);
-    for (size_t iP = 0; iP < nPix; iP++) {
-      normalOut[iP] = viewMat3 * glm::normalize(normalOut[iP]);
+    for (size_t iP = 0; iP < nHit; iP++) {
+      normals[rayInds[iP]] = viewMat3 * glm::normalize(normals[rayInds[iP]]);
     }
   }
 
-  // Handle not-converged rays
-  for (size_t iP = 0; iP < nPix; iP++) {
-    bool didConverge = rayDepthOut[iP] >= 0.;
-    if (!didConverge) {
+  // Handle not-converged rays (their normals were never touched, and stay zero)
+  for (size_t iP : pixInds) {
+    if (rayDepthOut[iP] < 0.) {
       rayDepthOut[iP] = std::numeric_limits<float>::infinity();
-      if (withNormals) {
-        normalOut[iP] = glm::vec3{0.f, 0.f, 0.f};
+    }
+  }
+}
+
+template <class Func>
+std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>>
+renderImplicitSurfaceTracer(Func&& func, ImplicitRenderMode mode, ImplicitRenderOpts opts, bool withNormals = true) {
+
+  const size_t tileSize = std::max(opts.tileSize, static_cast<size_t>(1));
+  size_t dimX = opts.dimX;
+  size_t dimY = opts.dimY;
+  size_t nPix = dimX * dimY;
+
+  // Generate rays corresponding to each pixel (they all start at the camera location)
+  std::vector<glm::vec3> rayDirs = opts.cameraParameters.generateCameraRays(dimX, dimY, ImageOrigin::UpperLeft);
+
+  // Write output data here
+  std::vector<float> rayDepthOut(nPix, -1.);                        // output values
+  std::vector<glm::vec3> rayPosOut(nPix, glm::vec3{0.f, 0.f, 0.f}); // output values
+  std::vector<glm::vec3> normalOut;
+  if (withNormals) {
+    normalOut = std::vector<glm::vec3>(nPix, glm::vec3{0.f, 0.f, 0.f});
+  }
+
+  // The image is traced in square tiles, each of which marches its rays in lockstep and makes its own batched calls to
+  // the implicit function. Every pixel belongs to exactly one tile, so tiles can write the outputs independently.
+  size_t nTilesX = (dimX + tileSize - 1) / tileSize;
+  size_t nTilesY = (dimY + tileSize - 1) / tileSize;
+  auto traceTile = [&](size_t iTile) {
+    size_t startX = (iTile % nTilesX) * tileSize;
+    size_t startY = (iTile / nTilesX) * tileSize;
+    size_t endX = std::min(startX + tileSize, dimX);
+    size_t endY = std::min(startY + tileSize, dimY);
+
+    std::vector<size_t> pixInds;
+    for (size_t iY = startY; iY < endY; iY++) {
+      for (size_t iX = startX; iX < endX; iX++) {
+        pixInds.push_back(iY * dimX + iX);
       }
     }
+
+    traceImplicitSurfacePixels(func, mode, opts, rayDirs, pixInds, rayDepthOut, rayPosOut,
+                               withNormals ? &normalOut : nullptr);
+  };
+
+  size_t nTiles = nTilesX * nTilesY;
+  if (opts.parallelTiles) {
+    parallelFor(
+        nTiles,
+        [&](size_t start, size_t end) {
+          for (size_t iTile = start; iTile < end; iTile++) traceTile(iTile);
+        },
+        1);
+  } else {
+    for (size_t iTile = 0; iTile < nTiles; iTile++) traceTile(iTile);
   }
 
 
@@ -231,6 +261,89 @@ renderImplicitSurfaceTracer(Func&& func, ImplicitRenderMode mode, ImplicitRender
                                                                                         normalOut};
 }
 
+// A progressive render keeps calling the implicit functions on later frames, after the render function has returned,
+// so it gets its own copies of them, wrapped by Adaptor to the batch signature. The non-progressive render functions
+// only refer to the caller's functions, which need not be copyable.
+template <class Func>
+struct ImplicitBatchFuncAdaptor {
+  Func func;
+  void operator()(float* pos_ptr, float* result_ptr, size_t size) { func(pos_ptr, result_ptr, size); }
+};
+
+template <class Func>
+struct ImplicitPointFuncAdaptor {
+  Func func;
+  void operator()(const float* pos_ptr, float* result_ptr, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      glm::vec3 pos{
+          pos_ptr[3 * i + 0],
+          pos_ptr[3 * i + 1],
+          pos_ptr[3 * i + 2],
+      };
+      result_ptr[i] = static_cast<float>(func(pos));
+    }
+  }
+};
+
+template <class FuncColor>
+struct ImplicitPointColorFuncAdaptor {
+  FuncColor funcColor;
+  void operator()(const float* pos_ptr, float* result_ptr, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      glm::vec3 pos{
+          pos_ptr[3 * i + 0],
+          pos_ptr[3 * i + 1],
+          pos_ptr[3 * i + 2],
+      };
+
+      glm::vec3 color = funcColor(pos);
+
+      result_ptr[3 * i + 0] = color.x;
+      result_ptr[3 * i + 1] = color.y;
+      result_ptr[3 * i + 2] = color.z;
+    }
+  }
+};
+
+template <template <class> class Adaptor, class Func>
+ProgressiveImplicitRender::BatchFunc copyImplicitFunc(Func& func, std::true_type) {
+  return Adaptor<typename std::decay<Func>::type>{func};
+}
+
+template <template <class> class Adaptor, class Func>
+ProgressiveImplicitRender::BatchFunc copyImplicitFunc(Func&, std::false_type) {
+  exception("progressive implicit surface rendering requires implicit functions which can be copied");
+  return nullptr;
+}
+
+template <template <class> class Adaptor, class Func>
+ProgressiveImplicitRender::BatchFunc copyImplicitFunc(Func& func) {
+  return copyImplicitFunc<Adaptor>(func, std::is_copy_constructible<typename std::decay<Func>::type>());
+}
+
+template <class S>
+ProgressiveImplicitRender* startProgressiveImplicitRender(QuantityStructure<S>* parent, std::string name,
+                                                          ProgressiveImplicitRender::BatchFunc func,
+                                                          ProgressiveImplicitRender::BatchFunc funcColor,
+                                                          ImplicitRenderMode mode, ImplicitRenderOpts opts) {
+
+  // When rendering from the current view, refine all the way to the view resolution; subsampleFactor only sets the
+  // resolution of the first preview
+  bool followsView = std::is_same<S, FloatingQuantityStructure>::value && !opts.cameraParameters.isValid();
+  int subsampleFactor = opts.subsampleFactor;
+  opts.subsampleFactor = 1;
+  resolveImplicitRenderOpts(parent, opts);
+  opts.subsampleFactor = subsampleFactor;
+
+  stopProgressiveImplicitRender(*parent, name);
+  auto findQuantity = [parent](std::string quantityName) { return parent->getFloatingQuantity(quantityName); };
+  ProgressiveImplicitRender* render =
+      new ProgressiveImplicitRender(*parent, findQuantity, name, func, funcColor, mode, opts, followsView);
+  state::globalContext.progressiveImplicitRenders[parent->uniquePrefix() + name] =
+      std::unique_ptr<ProgressiveImplicitRender>(render);
+  return render;
+}
+
 // =======================================================
 // === Depth/geometry/shape only render functions
 // =======================================================
@@ -253,6 +366,10 @@ DepthRenderImageQuantity* renderImplicitSurface(QuantityStructure<S>* parent, st
                                                 ImplicitRenderMode mode, ImplicitRenderOpts opts) {
 
   // Bootstrap on the batch version
+  if (opts.progressive) {
+    return renderImplicitSurfaceBatch(parent, name, copyImplicitFunc<ImplicitPointFuncAdaptor>(func), mode, opts);
+  }
+
   auto batchFunc = [&](const float* pos_ptr, float* result_ptr, size_t size) {
     for (size_t i = 0; i < size; i++) {
       glm::vec3 pos{
@@ -272,6 +389,15 @@ template <class Func, class S>
 DepthRenderImageQuantity* renderImplicitSurfaceBatch(QuantityStructure<S>* parent, std::string name, Func&& func,
                                                      ImplicitRenderMode mode, ImplicitRenderOpts opts) {
 
+  if (opts.progressive) {
+    ProgressiveImplicitRender* render = startProgressiveImplicitRender(
+        parent, name, copyImplicitFunc<ImplicitBatchFuncAdaptor>(func), nullptr, mode, opts);
+    const ImplicitRenderOpts& renderOpts = render->getOpts();
+    return parent->addDepthRenderImageQuantityImpl(name, renderOpts.dimX, renderOpts.dimY, render->getDepths(),
+                                                   render->getNormals(), ImageOrigin::UpperLeft);
+  }
+
+  stopProgressiveImplicitRender(*parent, name);
   resolveImplicitRenderOpts(parent, opts);
 
   // Call the function which does all the hard work
@@ -312,6 +438,11 @@ ColorRenderImageQuantity* renderImplicitSurfaceColor(QuantityStructure<S>* paren
                                                      ImplicitRenderOpts opts) {
 
   // Bootstrap on the batch version
+  if (opts.progressive) {
+    return renderImplicitSurfaceColorBatch(parent, name, copyImplicitFunc<ImplicitPointFuncAdaptor>(func),
+                                           copyImplicitFunc<ImplicitPointColorFuncAdaptor>(funcColor), mode, opts);
+  }
+
   auto batchFunc = [&](const float* pos_ptr, float* result_ptr, size_t size) {
     for (size_t i = 0; i < size; i++) {
       glm::vec3 pos{
@@ -348,6 +479,16 @@ ColorRenderImageQuantity* renderImplicitSurfaceColorBatch(QuantityStructure<S>*
                                                           FuncColor&& funcColor, ImplicitRenderMode mode,
                                                           ImplicitRenderOpts opts) {
 
+  if (opts.progressive) {
+    ProgressiveImplicitRender* render =
+        startProgressiveImplicitRender(parent, name, copyImplicitFunc<ImplicitBatchFuncAdaptor>(func),
+                                       copyImplicitFunc<ImplicitBatchFuncAdaptor>(funcColor), mode, opts);
+    const ImplicitRenderOpts& renderOpts = render->getOpts();
+    return parent->addColorRenderImageQuantityImpl(name, renderOpts.dimX, renderOpts.dimY, render->getDepths(),
+                                                   render->getNormals(), render->getColors(), ImageOrigin::UpperLeft);
+  }
+
+  stopProgressiveImplicitRender(*parent, name);
   resolveImplicitRenderOpts(parent, opts);
 
   // Call the function which does all the hard work
@@ -434,6 +575,10 @@ ScalarRenderImageQuantity* renderImplicitSurfaceScalarBatch(QuantityStructure<S>
                                                             FuncScalar&& funcScalar, ImplicitRenderMode mode,
                                                             ImplicitRenderOpts opts, DataType dataType) {
 
+  if (opts.progressive) {
+    exception("progressive rendering is only supported for depth and color implicit surface renders");
+  }
+  stopProgressiveImplicitRender(*parent, name);
   resolveImplicitRenderOpts(parent, opts);
 
   // Call the function which does all the hard work
@@ -524,6 +669,10 @@ RawColorRenderImageQuantity* renderImplicitSurfaceRawColorBatch(QuantityStructur
                                                                 Func&& func, FuncColor&& funcColor,
                                                                 ImplicitRenderMode mode, ImplicitRenderOpts opts) {
 
+  if (opts.progressive) {
+    exception("progressive rendering is only supported for depth and color implicit surface renders");
+  }
+  stopProgressiveImplicitRender(*parent, name);
   resolveImplicitRenderOpts(parent, opts);
 
   // Call the function which does all the hard work
@@ -0,0 +1,44 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace polyscope {
+
+// A read-only memory mapping of a whole file. Pages are loaded by the operating system as they are touched, so a
+// mapping can be much larger than the available memory.
+class MappedFile {
+public:
+  MappedFile();
+  MappedFile(std::string filename); // throws if the file cannot be opened or mapped
+  ~MappedFile();
+
+  // movable, but not copyable
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool isOpen() const;
+  void close();
+
+  const std::string& getFilename() const;
+  size_t size() const; // in bytes
+  const unsigned char* data() const;
+
+private:
+  std::string filename;
+  const unsigned char* mappedData = nullptr;
+  size_t mappedSize = 0;
+  bool opened = false;
+
+#ifdef _WIN32
+  void* fileHandle = nullptr;
+  void* mappingHandle = nullptr;
+#endif
+};
+
+} // namespace polyscope
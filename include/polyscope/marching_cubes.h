@@ -0,0 +1,49 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "polyscope/sparse_brick_grid.h"
+
+namespace polyscope {
+
+// An indexed triangle mesh, as extracted by marchingCubes() below
+struct IsosurfaceMesh {
+  std::vector<glm::vec3> vertices;
+  std::vector<uint32_t> indices; // 3 per triangle
+};
+
+// Extract the isosurface at `isoLevel` of a scalar field sampled at the nodes of a regular grid. The values are laid out
+// like VolumeGrid node data (x varies fastest, then y, then z), and node (i,j,k) sits at boundMin + (i,j,k) * spacing.
+// Vertices are shared between all the triangles which meet at them, and are output in world coordinates.
+//
+// The grid is split into slabs along z which are processed in parallel. The result matches the vendored
+// MC::marching_cube() up to the ordering of vertices, and does not depend on the number of threads.
+IsosurfaceMesh marchingCubes(const std::vector<float>& values, glm::uvec3 nodeDim, float isoLevel, glm::vec3 boundMin,
+                             glm::vec3 spacing);
+
+// Same as above, for a sparse field whose stored bricks are given by `layout`, with their values in `atlasValues`. Only
+// the stored bricks are visited, since the cells of all other bricks are constant, and they are processed in parallel.
+// The result matches marchingCubes() on the equivalent dense field, up to the ordering of vertices and triangles.
+IsosurfaceMesh marchingCubes(const SparseBrickLayout& layout, const std::vector<float>& atlasValues, float isoLevel,
+                             glm::vec3 boundMin, glm::vec3 spacing);
+
+// == Lookup tables, shared with device-side implementations
+
+// The edges of a grid cube, as the axis of the edge and the offset of its lower node from the lower corner of the cube
+struct MarchingCubesEdge {
+  int axis;
+  uint32_t dx, dy, dz;
+};
+extern const MarchingCubesEdge marchingCubesEdges[12];
+
+// The triangles for a configuration of the cube corners, where bit i of `config` is set if corner i is below the level,
+// and corner i is at offset ((i >> 2) & 1, (i >> 1) & 1, i & 1). The low 4 bits hold the number of triangles, followed
+// by 4 bits for each triangle corner giving the cube edge it lies on.
+uint64_t marchingCubesCase(int config);
+
+} // namespace polyscope
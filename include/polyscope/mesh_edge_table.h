@@ -0,0 +1,33 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace polyscope {
+
+// Edge connectivity of a polygon mesh. Halfedges are indexed like corners: halfedge i points from vertex
+// faceIndsEntries[i] to the next vertex in the same face.
+struct MeshEdgeTable {
+  size_t nEdges = 0;
+
+  // For each halfedge, the index of its edge. Edges are numbered in Polyscope's canonical ordering, which is the order
+  // in which they are first encountered when iterating over the halfedges in order.
+  std::vector<uint32_t> halfedgeEdge;
+
+  // For each halfedge, another halfedge along the same edge (INVALID_IND_32 if there is none, e.g. on the boundary).
+  // On nonmanifold edges, the first halfedge of the edge is the twin of all others, and the second is its twin.
+  std::vector<uint32_t> twinHalfedge;
+};
+
+// Build the edge table for a mesh given in the flat face-vertex format used by SurfaceMesh, where face i has the
+// vertices faceIndsEntries[faceIndsStart[i]] ... faceIndsEntries[faceIndsStart[i+1]-1].
+//
+// Halfedges are bucketed by their lower vertex, sorted by the upper vertex within each (small) bucket, and numbered
+// with a prefix sum, all in parallel. The result does not depend on the number of threads.
+MeshEdgeTable buildMeshEdgeTable(const std::vector<uint32_t>& faceIndsStart,
+                                 const std::vector<uint32_t>& faceIndsEntries, size_t nVertices);
+
+} // namespace polyscope
@@ -60,6 +60,10 @@ extern bool giveFocusOnShow;
 // If true, hide the polyscope window when a show() command finishes (default: true)
 extern bool hideWindowAfterShow;
 
+// Maximum number of threads used for CPU-side computation, like lazily computing mesh geometry and connectivity.
+// Values <= 0 use all hardware threads, and 1 disables multithreading. (default: 0)
+extern int maxThreads;
+
 // === Scene options
 
 // Behavior of the ground plane
@@ -83,6 +87,20 @@ extern int ssaaFactor;
 extern TransparencyMode transparencyMode;
 extern int transparencyRenderPasses;
 
+// Skip drawing structures whose bounds are entirely outside the view, or entirely behind a slice plane. The number of
+// skipped draws is reported by culledStructureDrawCount(). (default: true)
+extern bool cullStructures;
+
+// Point clouds with at least this many points use level-of-detail rendering when created (0 disables). While the camera
+// is moving, such point clouds draw only enough points to leave gaps of about pointCloudLODPixelSpacing pixels, and draw
+// every point once the camera comes to rest. (defaults: 0, 2.)
+extern size_t pointCloudLODThreshold;
+extern float pointCloudLODPixelSpacing;
+
+// The most GPU memory, in bytes, which each streaming point cloud may hold at once (see StreamingPointCloud). Takes
+// effect on the next draw. (default: 256 MB)
+extern size_t streamingPointCloudGPUBudget;
+
 // === Advanced ImGui configuration
 
 // If false, Polyscope will not create any ImGui UIs at all, but will still set up ImGui and invoke its render steps
@@ -0,0 +1,21 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace polyscope {
+
+// Number of threads used by parallelFor() below, including the calling thread. Set by options::maxThreads.
+size_t numParallelWorkers();
+
+// Invoke func(start, end) on disjoint contiguous chunks which cover [0, N), spread across a persistent pool of worker
+// threads. Inputs with fewer than 2 * grainSize entries, and calls made from inside another parallelFor(), run
+// directly on the calling thread.
+//
+// Each index is visited by exactly one chunk, so func may write to per-index outputs without synchronization. If any
+// invocation throws, the first exception is re-thrown on the calling thread after all chunks finish.
+void parallelFor(size_t N, const std::function<void(size_t, size_t)>& func, size_t grainSize = 4096);
+
+} // namespace polyscope
@@ -16,6 +16,8 @@
 
 namespace polyscope {
 
+void markSceneChanged(); // (see polyscope.h)
+
 // A named variable which "remembers" its previous values via a global cache.
 // On construction, the variable checks the cache for a cached value with the same; if one is found it is used instead
 // of the construction value. Whenever the value of the variable is modified (or initially created), it is written to
@@ -99,6 +101,7 @@ public:
     value = value_;
     detail::getPersistentCacheRef<T>().cache[name] = value;
     holdsDefaultValue_ = false;
+    markSceneChanged();
   }
 
   // Passive setter, will change value without marking in cache; does nothing if some value has already been directly
@@ -5,7 +5,9 @@
 #include "polyscope/structure.h"
 
 #include <cstdint>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace polyscope {
 namespace pick {
@@ -14,8 +16,13 @@ namespace pick {
 // == Set up picking
 // Called by a structure to figure out what data it should render to the pick buffer.
 // Request 'count' contiguous indices for drawing a pick buffer. The return value is the start of the range.
+// Each structure holds at most one range; requesting again releases the old one.
 size_t requestPickBufferRange(Structure* requestingStructure, size_t count);
 
+// Give back the range held by a structure (if any), so that its indices can be reused by later requests. Called
+// automatically when a structure is removed.
+void releasePickBufferRange(Structure* structure);
+
 
 // == Main query
 // Get the structure which was clicked on (nullptr if none), and the pick ID in local indices for that structure (such
@@ -24,6 +31,29 @@ std::pair<Structure*, size_t> pickAtScreenCoords(glm::vec2 screenCoords); // tak
 std::pair<Structure*, size_t> pickAtBufferCoords(int xPos, int yPos);     // takes indices into the buffer
 std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos);      // old, badly named. takes buffer coordinates.
 
+// Batched versions of the queries above, which pick many pixels at once and read them back in a single transfer.
+// Output entries correspond to the input coordinates.
+std::vector<std::pair<Structure*, size_t>> pickAtScreenCoords(const std::vector<glm::vec2>& screenCoords);
+std::vector<std::pair<Structure*, size_t>> pickAtBufferCoords(const std::vector<glm::ivec2>& bufferCoords);
+
+// The pick buffer is rendered on demand and cached. It is automatically re-rendered when the view changes or anything
+// calls markSceneChanged(). Call this to force a re-render on the next query, e.g. after custom changes to pick
+// rendering which do not mark the scene changed.
+void invalidatePickBuffer();
+
+
+// == Region queries
+// Get every element visible in a region of the screen, as a sorted list of distinct local indices for each structure
+// which was hit. The pick buffer is rendered at most once and the region is read back in a single transfer.
+
+// Axis-aligned rectangles, given by two opposite corners (inclusive)
+std::unordered_map<Structure*, std::vector<size_t>> pickInScreenRect(glm::vec2 corner1, glm::vec2 corner2);
+std::unordered_map<Structure*, std::vector<size_t>> pickInBufferRect(glm::ivec2 corner1, glm::ivec2 corner2);
+
+// Closed polygons, possibly self-intersecting (uses the even-odd rule). A pixel is included if its center is inside.
+std::unordered_map<Structure*, std::vector<size_t>> pickInScreenLasso(const std::vector<glm::vec2>& polygon);
+std::unordered_map<Structure*, std::vector<size_t>> pickInBufferLasso(const std::vector<glm::vec2>& polygon);
+
 
 // == Stateful picking: track and update a current selection
 
@@ -40,6 +70,7 @@ void resetSelectionIfStructure(Structure* s); // If something from this structur
 
 // Convert between global pick indexing for the whole program, and local per-structure pick indexing
 std::pair<Structure*, size_t> globalIndexToLocal(size_t globalInd);
+std::vector<std::pair<Structure*, size_t>> globalIndexToLocal(const std::vector<size_t>& globalInds);
 size_t localIndexToGlobal(std::pair<Structure*, size_t> localPick);
 
 // Convert indices to float3 color and back
@@ -6,10 +6,12 @@
 #include "polyscope/color_management.h"
 #include "polyscope/persistent_value.h"
 #include "polyscope/point_cloud_quantity.h"
+#include "polyscope/point_lod_octree.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
 #include "polyscope/scaled_value.h"
+#include "polyscope/spatial_clusters.h"
 #include "polyscope/standardize_data_array.h"
 #include "polyscope/structure.h"
 
@@ -56,8 +58,10 @@ public:
   virtual void drawDelayed() override;
   virtual void drawPick() override;
   virtual void updateObjectSpaceBounds() override;
+  virtual uint64_t geometryDataVersion() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
 
   // === Geometry members
   render::ManagedBuffer<glm::vec3> points;
@@ -133,6 +137,18 @@ public:
   PointCloud* setMaterial(std::string name);
   std::string getMaterial();
 
+  // Spatial chunking: sort the points into spatial clusters, and draw only the clusters which intersect the view
+  // frustum. Worthwhile for very large point clouds which are often viewed up close.
+  PointCloud* setSpatialChunking(bool newVal);
+  bool getSpatialChunking();
+
+  // Level of detail: while the camera moves, draw a subsample of the points which leaves gaps of about
+  // options::pointCloudLODPixelSpacing pixels on screen, and draw every point again once the camera comes to rest.
+  // Also culls to the view frustum like spatial chunking, and takes precedence over it. Enabled automatically for point
+  // clouds with at least options::pointCloudLODThreshold points.
+  PointCloud* setLevelOfDetail(bool newVal);
+  bool getLevelOfDetail();
+
   // Rendering helpers used by quantities
   void setPointCloudUniforms(render::ShaderProgram& p);
   void setPointProgramGeometryAttributes(render::ShaderProgram& p);
@@ -151,12 +167,52 @@ private:
   PersistentValue<glm::vec3> pointColor;
   PersistentValue<ScaledValue<float>> pointRadius;
   PersistentValue<std::string> material;
+  PersistentValue<bool> spatialChunking;
+  PersistentValue<bool> levelOfDetail;
 
   // Drawing related things
   // if nullptr, prepare() (resp. preparePick()) needs to be called
   std::shared_ptr<render::ShaderProgram> program;
   std::shared_ptr<render::ShaderProgram> pickProgram;
 
+  // Spatial chunking. The programs draw the points in cluster order, and the clusters are rebuilt whenever the points
+  // move.
+  SpatialClusters spatialClusters;
+  bool spatialClustersBuilt = false;
+  uint64_t spatialClustersDataVersion = 0;
+  std::vector<uint32_t> clusterOrderData;
+  render::ManagedBuffer<uint32_t> clusterOrder;
+  void ensureSpatialClustersBuilt();
+
+  // Level of detail. Like spatial chunking, the programs draw the points in the order of the octree.
+  PointLODOctree lodOctree;
+  bool lodOctreeBuilt = false;
+  uint64_t lodOctreeDataVersion = 0;
+  std::vector<uint32_t> lodOrderData;
+  render::ManagedBuffer<uint32_t> lodOrder;
+  void ensureLevelOfDetailBuilt();
+
+  // The ranges selected from the octree or the clusters, and what they were selected for. Every program drawn (and
+  // picked) with the same view reuses them, rather than walking the octree or clusters again.
+  struct DrawRangesKey {
+    bool levelOfDetail;
+    glm::mat4 modelViewProj;
+    float viewportHeight;
+    float pad;
+    float maxPixelSpacing;
+    bool cull;
+    uint64_t dataVersion;
+    bool operator==(const DrawRangesKey& o) const {
+      return levelOfDetail == o.levelOfDetail && modelViewProj == o.modelViewProj &&
+             viewportHeight == o.viewportHeight && pad == o.pad && maxPixelSpacing == o.maxPixelSpacing &&
+             cull == o.cull && dataVersion == o.dataVersion;
+    }
+  };
+  bool drawRangesSelected = false;
+  DrawRangesKey drawRangesKey;
+  std::vector<std::array<uint32_t, 2>> drawRanges;
+  void setPointCloudDrawRanges(render::ShaderProgram& p);
+
   // === Helpers
   // Do setup work related to drawing, including allocating openGL data
   void ensureRenderProgramPrepared();
@@ -177,6 +233,7 @@ private:
   std::string pointRadiusQuantityName = ""; // empty string means none
   bool pointRadiusQuantityAutoscale = true;
   PointCloudScalarQuantity& resolvePointRadiusQuantity(); // helper
+  float getMaxPointRadius(); // the largest radius a point can be drawn with
 };
 
 
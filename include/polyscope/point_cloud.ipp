@@ -38,6 +38,7 @@ void PointCloud::updatePointPositions(const V& newPositions) {
   validateSize(newPositions, nPoints(), "point cloud updated positions " + name);
   points.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   points.markHostBufferUpdated();
+  updateObjectSpaceBounds();
 }
 
 template <class V>
@@ -19,6 +19,7 @@ public:
   virtual void buildPickUI(size_t ind) override;
   virtual std::string niceName() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
 };
 
 } // namespace polyscope
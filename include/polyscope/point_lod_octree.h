@@ -0,0 +1,60 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+// A level-of-detail hierarchy over a set of points. It is an octree in which every node keeps a sparse set of
+// representative points spread over its cell: at most one point from each cell of a NODE_GRID^3 grid over the node.
+// The remaining points go to the children. Each point is the representative of exactly one node, so drawing the nodes
+// down to some depth draws a subsample whose density increases with depth, and drawing every node draws each point
+// exactly once.
+//
+// The points are ordered by node, with the nodes in depth-first order, so that both the representatives of a node and
+// a whole subtree are contiguous runs of the order (see render::ShaderProgram::setDrawOrder()).
+class PointLODOctree {
+public:
+  static const uint32_t NODE_GRID = 16;
+  static const uint32_t LEAF_SIZE = 4096; // nodes with at most this many points keep them all
+  static const int MAX_DEPTH = 20;
+
+  PointLODOctree();
+  PointLODOctree(const std::vector<glm::vec3>& points);
+
+  size_t nPoints() const;
+  size_t nNodes() const;
+
+  // The points, in node order
+  const std::vector<uint32_t>& getOrder() const;
+
+  // The [start, end) runs of the order to draw. Nodes whose bounds (padded by `pad`, in object space) are outside the
+  // view frustum of `modelViewProj` are skipped, if `cullFrustum` is set. Below a node, the children are drawn only if
+  // the representatives of the node are more than `maxPixelSpacing` pixels apart on a viewport of height
+  // `viewportHeight`; with a spacing of 0 every node is drawn. Adjacent runs are merged, and if nothing is drawn the
+  // result is a single empty run.
+  std::vector<std::array<uint32_t, 2>> selectRanges(const glm::mat4& modelViewProj, float viewportHeight, float pad,
+                                                    float maxPixelSpacing, bool cullFrustum = true) const;
+
+  // The nodes are public so they can be inspected in tests
+  struct Node {
+    std::array<glm::vec3, 2> bounds; // of all points in the subtree
+    float spacing;                   // width of the grid cells the representatives were picked from
+    uint32_t start;                  // the representatives are order[start, ownEnd)
+    uint32_t ownEnd;
+    uint32_t end;     // the whole subtree is order[start, end)
+    uint32_t nodeEnd; // index of the first node after the subtree
+  };
+  const std::vector<Node>& getNodes() const;
+
+private:
+  std::vector<uint32_t> order;
+  std::vector<Node> nodes; // in depth-first order, starting with the root
+};
+
+} // namespace polyscope
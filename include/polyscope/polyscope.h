@@ -157,6 +157,20 @@ void requestRedraw();
 // Has a redraw been requested for the next frame?
 bool redrawRequested();
 
+// Mark that the contents of the scene changed (data, geometry, or parameters which affect how it is drawn), as opposed
+// to just needing a redraw. Buffer updates, persistent value setters, transforms and structure refreshes call this
+// already. It does not request a redraw.
+void markSceneChanged();
+
+// A counter which is incremented by every call to markSceneChanged(). Caches of rendered data (like the pick buffer)
+// compare against it to detect that the scene may have changed since they were rendered.
+uint64_t sceneGeneration();
+
+// The number of structure draws (including pick buffer draws) which were skipped because the structure was not visible,
+// counted since startup. Each render of the scene counts a culled structure once, even if the transparency mode draws
+// the structures in several passes. Useful for profiling, see options::cullStructures.
+uint64_t culledStructureDrawCount();
+
 // Managed a stack of of contexts to draw the UI. Usually contains one entry, which causes the main GUI to be drawn, but
 // in general the top callback will be called instead. Primarily exists to manage the ImGUI context, so callbacks can
 // create other contexts and circumvent the main draw loop. This is used internally to implement messages, element
@@ -184,8 +198,10 @@ void buildUserGuiAndInvokeCallback();
 // Exposed so that some weird flow (eg, errors) can re-enter the main loop when appropriate. Be careful!
 void mainLoopIteration();
 void initializeImGUIContext();
-void drawStructures();
+void prepareStructuresForFrame();
+void drawStructures(bool countCulled = true); // (pass false for the repeated passes of a frame)
 void drawStructuresDelayed();
+void drawStructuresPick();
 
 // Called to check any options that might have been changed and perform appropriate updates. Users generally should not
 // need to call this directly.
@@ -45,6 +45,9 @@ public:
   // Re-perform any setup work for the quantity, including regenerating shader programs.
   virtual void refresh();
 
+  // How far (in world units) this quantity draws past the parent's bounds, used to pad the bounds for culling.
+  virtual float getRenderPadding();
+
   // A decorated name for the quantity that will be used in headers. For instance, for surface scalar named "value" we
   // return "value (scalar)"
   virtual std::string niceName();
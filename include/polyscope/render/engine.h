@@ -10,6 +10,7 @@
 #include "polyscope/render/color_maps.h"
 #include "polyscope/render/ground_plane.h"
 #include "polyscope/render/materials.h"
+#include "polyscope/scalar_statistics.h"
 #include "polyscope/types.h"
 #include "polyscope/view.h"
 
@@ -40,7 +41,17 @@ enum class FilterMode { Nearest = 0, Linear };
 enum class TextureFormat { RGB8 = 0, RGBA8, RG16F, RGB16F, RGBA16F, RGBA32F, RGB32F, R32F, R16F, DEPTH24 };
 enum class RenderBufferType { Color, ColorAlpha, Depth, Float4 };
 enum class DepthMode { Less, LEqual, LEqualReadOnly, Greater, Disable, PassReadOnly };
-enum class BlendMode { AlphaOver, OverNoWrite, AlphaUnder, Zero, WeightedAdd, Add, Source, Disable };
+enum class BlendMode {
+  AlphaOver,
+  OverNoWrite,
+  AlphaUnder,
+  Zero,
+  WeightedAdd,
+  WeightedAccumulate,
+  Add,
+  Source,
+  Disable
+};
 enum class RenderDataType {
   Vector2Float,
   Vector3Float,
@@ -91,6 +102,29 @@ public:
   virtual void setData(const std::vector<std::array<glm::vec3, 3>>& data) = 0;
   virtual void setData(const std::vector<std::array<glm::vec3, 4>>& data) = 0;
 
+  // Size the buffer to hold `count` entries without uploading any data. The contents are undefined until they are
+  // written, e.g. with setDataRange().
+  virtual void allocate(size_t count) = 0;
+
+  // Overwrite a sub-range of the buffer, copying `count` entries starting at data[dataStart] into the buffer starting
+  // at entry `bufferStart`. The buffer must already hold at least bufferStart + count entries from a previous
+  // setData() or allocate(), it is never resized by this call.
+  // clang-format off
+  virtual void setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<float>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<double>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart, size_t bufferStart, size_t count) = 0;
+  // clang-format on
+
   virtual uint32_t getNativeBufferID() = 0; // used to interop with external things, e.g. ImGui
 
   // == Getters
@@ -263,6 +297,8 @@ public:
 
   // Query pixel
   virtual std::array<float, 4> readFloat4(int xPos, int yPos) = 0;
+  // Query a block of pixels in one transfer, returned row by row starting from (xStart, yStart)
+  virtual std::vector<std::array<float, 4>> readFloat4Region(int xStart, int yStart, int sizeX, int sizeY) = 0;
   virtual float readDepth(int xPos, int yPos) = 0;
   virtual void blitTo(FrameBuffer* other) = 0;
   virtual std::vector<unsigned char> readBuffer() = 0;
@@ -403,6 +439,13 @@ public:
   // Indices
   virtual void setInstanceCount(uint32_t instanceCount) = 0;
 
+  // Subsets
+  // For the non-indexed draw modes, draw the vertices in the order given by a buffer of uint indices rather than in
+  // storage order. The draw ranges then select [start, end) runs of that order (or of the index buffer, for indexed
+  // modes), so a structure can submit only some of its elements in a single draw. An empty list draws everything.
+  virtual void setDrawOrder(std::shared_ptr<AttributeBuffer> orderBuffer) = 0;
+  void setDrawRanges(const std::vector<std::array<uint32_t, 2>>& ranges);
+
   // Call once to initialize GLSL code used by multiple shaders
   static void initCommonShaders(); // TODO
 
@@ -431,6 +474,10 @@ protected:
 
   std::shared_ptr<AttributeBuffer> indexBuffer;
 
+  // Drawing in a custom order (which is held in indexBuffer), and drawing subsets
+  bool useDrawOrder = false;
+  std::vector<std::array<uint32_t, 2>> drawRanges;
+
   // instancing
   uint32_t instanceCount = INVALID_IND_32;
 };
@@ -525,6 +572,23 @@ public:
   // create attribute buffers
   virtual std::shared_ptr<AttributeBuffer> generateAttributeBuffer(RenderDataType dataType_, int arrayCount_ = 1) = 0;
 
+  // Expand an attribute buffer through an index buffer directly on the device, as target[i] = source[indices[i]].
+  // `indices` must hold UInt data, and `target` must already be allocated with one entry per index.
+  // Returns false if the backend does not support this, in which case the caller should do the expansion host-side.
+  virtual bool gatherAttributeBuffer(AttributeBuffer& source, AttributeBuffer& indices, AttributeBuffer& target);
+
+  // Extract the isosurface at `isoLevel` of a scalar field held in a 3D float texture, with one texel per grid node,
+  // directly on the device (node (i,j,k) sits at boundMin + (i,j,k) * spacing, as in marchingCubes()). `positions`
+  // (Vector3Float) and `indices` (UInt) get allocated and filled with the triangles, three vertices each.
+  // Returns false if the backend does not support this, in which case the caller should extract the mesh on the host.
+  virtual bool extractIsosurface(TextureBuffer& values, float isoLevel, glm::vec3 boundMin, glm::vec3 spacing,
+                                 AttributeBuffer& positions, AttributeBuffer& indices);
+
+  // Compute the range and histogram of a Float attribute buffer directly on the device, with the same conventions as
+  // computeScalarStatistics(); only the results come back to the host.
+  // Returns false if the backend does not support this, in which case the caller should compute them on the host.
+  virtual bool reduceScalarStatistics(AttributeBuffer& values, size_t binCount, float rangeEPS,
+                                      ScalarStatistics& stats);
 
   // create textures
   virtual std::shared_ptr<TextureBuffer> generateTextureBuffer(TextureFormat format, unsigned int size1D,
@@ -561,23 +625,30 @@ public:
   std::shared_ptr<FrameBuffer> sceneBuffer, sceneBufferFinal;
   std::shared_ptr<FrameBuffer> pickFramebuffer;
   std::shared_ptr<FrameBuffer> sceneDepthMinFrame;
+  std::shared_ptr<FrameBuffer> sceneBufferWeighted; // shares the scene depth buffer
   FrameBuffer& getDisplayBuffer();
 
   // Main buffers for rendering
   // sceneDepthMin is an optional texture copy of the depth buffe used for some effects
   std::shared_ptr<TextureBuffer> sceneColor, sceneColorFinal, sceneDepth, sceneDepthMin;
+  // accumulated color/revealage and weight sum for TransparencyMode::WeightedBlended
+  std::shared_ptr<TextureBuffer> sceneColorWeighted, sceneWeightSum;
   std::shared_ptr<RenderBuffer> pickColorBuffer, pickDepthBuffer;
   TextureBuffer& getFinalSceneColorTexture();
 
   // General-use programs used by the engine
   std::shared_ptr<ShaderProgram> renderTexturePlain, renderTextureDot3, renderTextureMap3, renderTextureSphereBG;
-  std::shared_ptr<ShaderProgram> compositePeel, mapLight, copyDepth;
+  std::shared_ptr<ShaderProgram> compositePeel, compositeWeighted, mapLight, copyDepth;
 
   // Manage transparency and culling
   void setTransparencyMode(TransparencyMode newMode);
   TransparencyMode getTransparencyMode();
   bool transparencyEnabled();
   virtual void applyTransparencySettings() = 0;
+  // TransparencyMode::WeightedBlended draws the scene in two passes, one for opaque fragments and one which accumulates
+  // all the transparent fragments at once. This selects which of the two the transparency settings & rules apply to.
+  void setWeightedAccumulatePass(bool newVal);
+  bool getWeightedAccumulatePass();
   void addSlicePlane(std::string uniquePostfix);
   void removeSlicePlane(std::string uniquePostfix);
   bool slicePlanesEnabled();                     // true if there is at least one slice plane in the scene
@@ -638,6 +709,7 @@ protected:
                           // screenshot renders while minimized.
   float currPixelScale;
   TransparencyMode transparencyMode = TransparencyMode::None;
+  bool weightedAccumulatePass = false;
   int slicePlaneCount = 0;
   bool frontFaceCCW = true;
   std::vector<FrameBuffer*> renderFramebufferStack; // supports push/popBindFramebufferForRendering
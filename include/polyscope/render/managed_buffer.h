@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <unordered_map>
@@ -118,6 +119,15 @@ public:
   // reflecting updates to the render buffer.
   void markHostBufferUpdated();
 
+  // Like markHostBufferUpdated(), but only the entries `data[start] ... data[start+count-1]` have changed. Only those
+  // entries are pushed to the render buffer and to any indexed views, which is much cheaper when a small part of a big
+  // buffer changes. The host buffer must already be populated, since the untouched entries are assumed to be valid.
+  void markHostBufferUpdated(size_t start, size_t count);
+
+  // Same as above, but for a set of dirty ranges, given as {start, count} pairs. The ranges may be in any order and
+  // may overlap; they are sorted and coalesced before anything is uploaded.
+  void markHostBufferUpdated(std::vector<std::array<size_t, 2>> ranges);
+
   // Get the value at index `i`. It may be dynamically fetched from either the cpu-side `data` member or the render
   // buffer, depending on where the data currently lives.
   // If the data lives only on the device-side render buffer, this function is expensive, so don't call it in a
@@ -133,6 +143,14 @@ public:
   bool hasData(); // true if there is valid data on either the host or device
   size_t size();  // size of the data (number of entries)
 
+  // True if the current values are held only by the render buffer (e.g. after markRenderAttributeBufferUpdated()), so
+  // that reading them on the host means copying them back from the device.
+  bool dataIsOnlyOnDevice();
+
+  // Increases every time the contents are marked as updated (on the host or on the device), so that values derived
+  // from the buffer can tell whether they are stale.
+  uint64_t dataVersion() const;
+
   // Is it an attribute, texture1d, texture2d, etc?
   DeviceBufferType getDeviceBufferType();
 
@@ -188,9 +206,14 @@ public:
 
 
 protected:
+  // (buffers of other types use the device-side buffer of an index buffer for indexed views)
+  template <typename>
+  friend class ManagedBuffer;
+
   // == Internal members
 
   bool hostBufferIsPopulated; // true if the host buffer contains currently-valid data
+  uint64_t dataVersionCount = 0;
 
   std::shared_ptr<render::AttributeBuffer> renderAttributeBuffer;
   std::shared_ptr<render::TextureBuffer> renderTextureBuffer;
@@ -211,8 +234,22 @@ protected:
   std::vector<std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>>
       existingIndexedViews;
   void updateIndexedViews();
+  void updateIndexedViews(const std::vector<std::array<size_t, 2>>& dirtyRanges); // only the given [start,end) ranges
   void removeDeletedIndexedViews();
 
+  // The inverse of an index buffer used for an indexed view: for each entry `i` of `data`, the view entries which
+  // reference it are viewInds[offsets[i]] ... viewInds[offsets[i+1]-1]. Built lazily the first time a partial update
+  // needs to be pushed to the view, and cached by the index buffer's uniqueID. Rebuilt if the contents of the index
+  // buffer have changed since (according to its dataVersion()).
+  struct IndexedViewInverse {
+    uint64_t indicesID;
+    uint64_t indicesVersion;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> viewInds;
+  };
+  std::vector<IndexedViewInverse> indexedViewInverses;
+  IndexedViewInverse& getIndexedViewInverse(ManagedBuffer<uint32_t>& indices);
+
   // == Internal helper functions
 
   void invalidateHostBuffer();
@@ -223,10 +260,11 @@ protected:
   enum class CanonicalDataSource { HostData = 0, NeedsCompute, RenderBuffer };
   CanonicalDataSource currentCanonicalDataSource();
 
-  // Manage the program which copies indexed data from the renderBuffer to the indexed views
-  void ensureHaveBufferIndexCopyProgram();
-  void invokeBufferIndexCopyProgram();
-  std::shared_ptr<render::ShaderProgram> bufferIndexCopyProgram;
+  // Regenerate an indexed view from the render buffer directly on the device, without a round trip through host
+  // memory. Only used when both this buffer and the indices already have a render attribute buffer, nothing gets
+  // allocated or uploaded here. Returns false if that is not the case or if the render engine does not support it
+  // (e.g. the mock backend), in which case the caller must expand the view on the host.
+  bool invokeBufferIndexCopyProgram(ManagedBuffer<uint32_t>& indices, render::AttributeBuffer& viewBuffer);
 };
 
 
@@ -6,7 +6,9 @@
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 
+#include <map>
 #include <unordered_map>
+#include <utility>
 
 // A fake version of the opengl engine, with all of the actual gl calls stubbed out. Useful for testing.
 
@@ -21,6 +23,8 @@ public:
 
   void bind();
 
+  void allocate(size_t count) override;
+
   void setData(const std::vector<glm::vec2>& data) override;
   void setData(const std::vector<glm::vec3>& data) override;
   void setData(const std::vector<glm::vec4>& data) override;
@@ -39,6 +43,22 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  // clang-format off
+  void setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<float>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<double>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  // clang-format on
+
   // get data at a single index from the buffer
   float getData_float(size_t ind) override;
   double getData_double(size_t ind) override;
@@ -70,10 +90,16 @@ private:
   void checkType(RenderDataType targetType);
   void checkArray(int arrayCount);
 
+  // the raw bytes of the buffer, so that data which is written can be read back like on a real device
+  std::vector<unsigned char> contents;
+
   // internal implementation helpers
   template <typename T>
   void setData_helper(const std::vector<T>& data);
 
+  template <typename T>
+  void setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t bufferStart, size_t count);
+
   template <typename T>
   T getData_helper(size_t ind);
 
@@ -137,6 +163,8 @@ public:
   void bind();
 
 protected:
+  // the values of single-channel float textures, so that they can be read back like on a real device
+  std::vector<float> scalarContents;
 };
 
 class GLRenderBuffer : public RenderBuffer {
@@ -178,13 +206,20 @@ public:
   // Query pixels
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
+  std::vector<std::array<float, 4>> readFloat4Region(int xStart, int yStart, int sizeX, int sizeY) override;
   float readDepth(int xPos, int yPos) override;
   void blitTo(FrameBuffer* other) override;
 
+  // Nothing actually gets drawn by the mock backend. For testing, this stands in for drawing: it sets the pixels of a
+  // rectangle to `val` until the next clear(). Coordinates are as in readFloat4Region().
+  void fillFloat4Region(int xStart, int yStart, int sizeX, int sizeY, std::array<float, 4> val);
+
   // Getters
   uint32_t getNativeBufferID() override;
 
 protected:
+  // pixels set by fillFloat4Region(), all others read as the clear color
+  std::map<std::pair<int, int>, std::array<float, 4>> filledPixels;
 };
 
 // Classes to keep track of attributes and uniforms
@@ -283,6 +318,9 @@ public:
   // Indices
   void setInstanceCount(uint32_t instanceCount) override;
 
+  // Subsets
+  void setDrawOrder(std::shared_ptr<AttributeBuffer> orderBuffer) override;
+
   // Textures
   bool hasTexture(std::string name) override;
   bool textureIsSet(std::string name) override;
@@ -314,6 +352,7 @@ private:
 
   // Drawing related
   void activateTextures();
+  uint64_t primitivesInRange(uint32_t count); // primitives formed by `count` consecutive vertices/indices
 
   std::shared_ptr<GLCompiledProgram> compiledProgram;
 };
@@ -330,6 +369,11 @@ public:
   void swapDisplayBuffers() override;
   std::vector<unsigned char> readDisplayBuffer() override;
 
+  // The number of primitives (points, lines, triangles...) submitted by all draws since the last reset. There is no
+  // GPU to do any drawing, but this lets tests check what would have been drawn.
+  uint64_t getSubmittedPrimitiveCount() const;
+  void resetSubmittedPrimitiveCount();
+
   // Manage render state
   void setDepthMode(DepthMode newMode) override;
   void setBlendMode(BlendMode newMode) override;
@@ -364,6 +408,10 @@ public:
   // create attribute buffers
   std::shared_ptr<AttributeBuffer> generateAttributeBuffer(RenderDataType dataType_, int arrayCount_) override;
 
+  // device-side marching cubes, emulated on the host with the same output as the OpenGL backend's geometry shader
+  bool extractIsosurface(TextureBuffer& values, float isoLevel, glm::vec3 boundMin, glm::vec3 spacing,
+                         AttributeBuffer& positions, AttributeBuffer& indices) override;
+
   // create textures
   std::shared_ptr<TextureBuffer> generateTextureBuffer(TextureFormat format, unsigned int size1D,
                                                        const unsigned char* data = nullptr) override; // 1d
@@ -404,9 +452,13 @@ public:
   virtual void setFrontFaceCCW(bool newVal) override;
 
 protected:
+  friend class GLShaderProgram;
+
   // Helpers
   virtual void createSlicePlaneFliterRule(std::string name) override;
 
+  uint64_t submittedPrimitiveCount = 0;
+
   // Shader program & rule caches
   std::unordered_map<std::string, std::pair<std::vector<ShaderStageSpecification>, DrawMode>> registeredShaderPrograms;
   std::unordered_map<std::string, ShaderReplacementRule> registeredShaderRules;
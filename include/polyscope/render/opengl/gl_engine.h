@@ -49,6 +49,9 @@ public:
   void bind();
   VertexBufferHandle getHandle() const { return VBOLoc; }
 
+  // Allocate room for `count` entries without filling them, e.g. to be written on the device by transform feedback
+  void allocate(size_t count) override;
+
   void setData(const std::vector<glm::vec2>& data) override;
   void setData(const std::vector<glm::vec3>& data) override;
   void setData(const std::vector<glm::vec4>& data) override;
@@ -67,6 +70,22 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  // clang-format off
+  void setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<float>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<double>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart, size_t bufferStart, size_t count) override;
+  // clang-format on
+
   // get data at a single index from the buffer
   float getData_float(size_t ind) override;
   double getData_double(size_t ind) override;
@@ -106,6 +125,9 @@ private:
   template <typename T>
   void setData_helper(const std::vector<T>& data);
 
+  template <typename T>
+  void setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t bufferStart, size_t count);
+
   template <typename T>
   T getData_helper(size_t ind);
 
@@ -215,6 +237,7 @@ public:
   // Query pixels
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
+  std::vector<std::array<float, 4>> readFloat4Region(int xStart, int yStart, int sizeX, int sizeY) override;
   float readDepth(int xPos, int yPos) override;
   void blitTo(FrameBuffer* other) override;
 
@@ -327,6 +350,9 @@ public:
   // Instancing
   void setInstanceCount(uint32_t instanceCount) override;
 
+  // Subsets
+  void setDrawOrder(std::shared_ptr<AttributeBuffer> orderBuffer) override;
+
   // Textures
   bool hasTexture(std::string name) override;
   bool textureIsSet(std::string name) override;
@@ -358,6 +384,8 @@ private:
 
   // Drawing related
   void activateTextures();
+  void drawAll();
+  void drawSubsets(); // with a draw order or draw ranges
 
   // GL pointers for various useful things
   std::shared_ptr<GLCompiledProgram> compiledProgram;
@@ -387,6 +415,17 @@ public:
   // create attribute buffers
   std::shared_ptr<AttributeBuffer> generateAttributeBuffer(RenderDataType dataType_, int arrayCount_) override;
 
+  // device-side indexed expansion, via transform feedback
+  bool gatherAttributeBuffer(AttributeBuffer& source, AttributeBuffer& indices, AttributeBuffer& target) override;
+
+  // device-side marching cubes, via a geometry shader and transform feedback
+  bool extractIsosurface(TextureBuffer& values, float isoLevel, glm::vec3 boundMin, glm::vec3 spacing,
+                         AttributeBuffer& positions, AttributeBuffer& indices) override;
+
+  // device-side range and histogram, by drawing the values as points in to small float targets with blending
+  bool reduceScalarStatistics(AttributeBuffer& values, size_t binCount, float rangeEPS,
+                              ScalarStatistics& stats) override;
+
   // create textures
   std::shared_ptr<TextureBuffer> generateTextureBuffer(TextureFormat format, unsigned int size1D,
                                                        const unsigned char* data = nullptr) override; // 1d
@@ -436,6 +475,25 @@ protected:
   void populateDefaultShadersAndRules();
 
   std::unordered_map<std::string, std::shared_ptr<GLCompiledProgram>> compiledProgamCache;
+
+  // The `#version` line of the GLSL_VERSION rule, for internal programs which are built directly from source
+  std::string getGLSLVersionDirective();
+
+  // Transform feedback programs used by gatherAttributeBuffer(), one per (data type, array count)
+  std::unordered_map<std::string, ProgramHandle> gatherProgramCache;
+  ProgramHandle getGatherProgram(RenderDataType dataType, int arrayCount);
+
+  // Transform feedback programs used by extractIsosurface(), created on first use (0 until then)
+  ProgramHandle isosurfaceProgram = 0;
+  ProgramHandle sequenceProgram = 0;
+  ProgramHandle getIsosurfaceProgram();
+  ProgramHandle getSequenceProgram();
+
+  // Programs used by reduceScalarStatistics(), created on first use (0 until then)
+  ProgramHandle statisticsRangeProgram = 0;
+  ProgramHandle statisticsBinProgram = 0;
+  ProgramHandle getStatisticsRangeProgram();
+  ProgramHandle getStatisticsBinProgram();
   std::string programKeyFromRules(const std::string& programName, const std::vector<std::string>& rules,
                                   ShaderReplacementDefaults defaults);
   std::shared_ptr<GLCompiledProgram> getCompiledProgram(const std::string& programName,
@@ -18,6 +18,7 @@ extern const ShaderStageSpecification FLEX_GRIDCUBE_PLANE_FRAG_SHADER;
 
 // Rules
 extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE;
+extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE;
 extern const ShaderReplacementRule GRIDCUBE_PROPAGATE_CELL_VALUE;
 extern const ShaderReplacementRule GRIDCUBE_WIREFRAME;
 extern const ShaderReplacementRule GRIDCUBE_CONSTANT_PICK;
@@ -18,6 +18,7 @@ extern const ShaderStageSpecification PLAIN_RAW_RENDERIMAGE_TEXTURE_DRAW_FRAG_SH
 extern const ShaderStageSpecification DOT3_TEXTURE_DRAW_FRAG_SHADER;
 extern const ShaderStageSpecification MAP3_TEXTURE_DRAW_FRAG_SHADER;
 extern const ShaderStageSpecification COMPOSITE_PEEL;
+extern const ShaderStageSpecification COMPOSITE_WEIGHTED;
 extern const ShaderStageSpecification DEPTH_COPY;
 extern const ShaderStageSpecification DEPTH_TO_MASK;
 extern const ShaderStageSpecification BLUR_RGB;
@@ -17,6 +17,7 @@ extern const ShaderReplacementRule SLICE_TETS_MESH_WIREFRAME;
 extern const ShaderReplacementRule SLICE_TETS_PROPAGATE_VALUE;
 extern const ShaderReplacementRule SLICE_TETS_PROPAGATE_VECTOR;
 extern const ShaderReplacementRule SLICE_TETS_VECTOR_COLOR;
+extern const ShaderReplacementRule SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE;
 
 
 } // namespace backend_openGL3
@@ -30,8 +30,15 @@ public:
   // Set uniforms in rendering programs for scalars
   void setScalarUniforms(render::ShaderProgram& p);
 
+  // Update the values. The data range and histogram are only recomputed if `updateStatistics` is true (see
+  // refreshStatistics()), since that takes a pass over the data.
   template <class V>
-  void updateData(const V& newValues);
+  void updateData(const V& newValues, bool updateStatistics = false);
+
+  // Recompute the data range and histogram from the current values; the colormap range follows the new data range,
+  // unless it was set manually. Values which live only on the device (written via values.getRenderAttributeBuffer())
+  // are reduced there, if the backend supports it, rather than copied back.
+  QuantityT* refreshStatistics();
 
   // === Members
   QuantityT& quantity;
@@ -51,6 +58,7 @@ public:
   std::pair<double, double> getMapRange();
   QuantityT* resetMapRange(); // reset to full range
   std::pair<double, double> getDataRange();
+  const std::vector<size_t>& getHistogramBinCounts(); // the number of values in each histogram bin
 
   // Isolines
   QuantityT* setIsolinesEnabled(bool newEnabled);
@@ -60,6 +68,11 @@ public:
   QuantityT* setIsolineDarkness(double val);
   double getIsolineDarkness();
 
+  // Automatically refresh the statistics whenever the values change, checked each time the quantity is drawn. Useful
+  // for values which are updated every frame, e.g. by a simulation writing to the render buffer.
+  QuantityT* setAutoRefreshStatistics(bool newVal);
+  bool getAutoRefreshStatistics();
+
 protected:
   std::vector<float> valuesData;
   const DataType dataType;
@@ -67,16 +80,27 @@ protected:
   // === Visualization parameters
 
   // Affine data maps and limits
+  Histogram hist; // (before dataRange, which is initialized along with it)
+  uint64_t statisticsDataVersion = 0; // values.dataVersion() when the statistics were last computed
   std::pair<double, double> dataRange;
   PersistentValue<float> vizRangeMin;
   PersistentValue<float> vizRangeMax;
-  Histogram hist;
 
   // Parameters
   PersistentValue<std::string> cMap;
   PersistentValue<bool> isolinesEnabled;
   PersistentValue<ScaledValue<float>> isolineWidth;
   PersistentValue<float> isolineDarkness;
+  PersistentValue<bool> autoRefreshStatistics;
+
+  // Compute the histogram of the current values, and return their range
+  std::pair<double, double> computeStatistics();
+
+  // The statistics of the values which computeStatistics() reports. By default these are the entries of `values`;
+  // quantities whose buffer is not one entry per element override it. (During construction the default is used, so an
+  // override must call refreshStatistics() once it is constructed.)
+  virtual ScalarStatistics computeValueStatistics(size_t binCount, float rangeEPS);
+  void refreshStatisticsIfStale(); // if auto-refresh is enabled
 };
 
 } // namespace polyscope
@@ -7,18 +7,18 @@ namespace polyscope {
 template <typename QuantityT>
 ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vector<float>& values_, DataType dataType_)
     : quantity(quantity_), values(&quantity, quantity.uniquePrefix() + "values", valuesData), valuesData(values_),
-      dataType(dataType_), dataRange(robustMinMax(values.data, 1e-5)),
+      dataType(dataType_), dataRange(computeStatistics()),
       vizRangeMin(quantity.uniquePrefix() + "vizRangeMin", -777.), // set later,
       vizRangeMax(quantity.uniquePrefix() + "vizRangeMax", -777.), // including clearing cache
       cMap(quantity.uniquePrefix() + "cmap", defaultColorMap(dataType)),
       isolinesEnabled(quantity.uniquePrefix() + "isolinesEnabled", false),
       isolineWidth(quantity.uniquePrefix() + "isolineWidth",
                    absoluteValue((dataRange.second - dataRange.first) * 0.02)),
-      isolineDarkness(quantity.uniquePrefix() + "isolineDarkness", 0.7)
+      isolineDarkness(quantity.uniquePrefix() + "isolineDarkness", 0.7),
+      autoRefreshStatistics(quantity.uniquePrefix() + "autoRefreshStatistics", false)
 
 {
   hist.updateColormap(cMap.get());
-  hist.buildHistogram(values.data);
 
   if (vizRangeMin.holdsDefaultValue()) { // min and max should always have same cache state
     // dynamically compute a viz range from the data min/max
@@ -30,6 +30,8 @@ ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vecto
 template <typename QuantityT>
 void ScalarQuantity<QuantityT>::buildScalarUI() {
 
+  refreshStatisticsIfStale();
+
   if (render::buildColormapSelector(cMap.get())) {
     quantity.refresh();
     hist.updateColormap(cMap.get());
@@ -166,6 +168,9 @@ template <typename QuantityT>
 void ScalarQuantity<QuantityT>::buildScalarOptionsUI() {
   if (ImGui::MenuItem("Reset colormap range")) resetMapRange();
   if (ImGui::MenuItem("Enable isolines", NULL, isolinesEnabled.get())) setIsolinesEnabled(!isolinesEnabled.get());
+  if (ImGui::MenuItem("Refresh data range")) refreshStatistics();
+  if (ImGui::MenuItem("Auto-refresh data range", NULL, autoRefreshStatistics.get()))
+    setAutoRefreshStatistics(!autoRefreshStatistics.get());
 }
 
 template <typename QuantityT>
@@ -180,6 +185,8 @@ std::vector<std::string> ScalarQuantity<QuantityT>::addScalarRules(std::vector<s
 
 template <typename QuantityT>
 void ScalarQuantity<QuantityT>::setScalarUniforms(render::ShaderProgram& p) {
+  refreshStatisticsIfStale();
+
   p.setUniform("u_rangeLow", vizRangeMin.get());
   p.setUniform("u_rangeHigh", vizRangeMax.get());
 
@@ -216,10 +223,52 @@ QuantityT* ScalarQuantity<QuantityT>::resetMapRange() {
 
 template <typename QuantityT>
 template <class V>
-void ScalarQuantity<QuantityT>::updateData(const V& newValues) {
+void ScalarQuantity<QuantityT>::updateData(const V& newValues, bool updateStatistics) {
   validateSize(newValues, values.size(), "scalar quantity " + quantity.name);
   values.data = standardizeArray<float, V>(newValues);
   values.markHostBufferUpdated();
+
+  if (updateStatistics) {
+    refreshStatistics();
+  }
+}
+
+template <typename QuantityT>
+QuantityT* ScalarQuantity<QuantityT>::refreshStatistics() {
+  dataRange = computeStatistics();
+  if (vizRangeMin.holdsDefaultValue()) {
+    resetMapRange();
+  }
+  requestRedraw();
+  return &quantity;
+}
+
+template <typename QuantityT>
+void ScalarQuantity<QuantityT>::refreshStatisticsIfStale() {
+  if (autoRefreshStatistics.get() && values.dataVersion() != statisticsDataVersion) {
+    refreshStatistics();
+  }
+}
+
+template <typename QuantityT>
+std::pair<double, double> ScalarQuantity<QuantityT>::computeStatistics() {
+  const float rangeEPS = 1e-5;
+  ScalarStatistics stats = computeValueStatistics(hist.getBinCount(), rangeEPS);
+  hist.buildHistogram(stats);
+  statisticsDataVersion = values.dataVersion();
+  return stats.range;
+}
+
+template <typename QuantityT>
+ScalarStatistics ScalarQuantity<QuantityT>::computeValueStatistics(size_t binCount, float rangeEPS) {
+  ScalarStatistics stats;
+  bool onDevice =
+      values.getDeviceBufferType() == DeviceBufferType::Attribute && values.dataIsOnlyOnDevice() &&
+      render::engine->reduceScalarStatistics(*values.getRenderAttributeBuffer(), binCount, rangeEPS, stats);
+  if (!onDevice) {
+    stats = computeScalarStatistics(values.getPopulatedHostBufferRef(), binCount, rangeEPS);
+  }
+  return stats;
 }
 
 
@@ -252,6 +301,11 @@ std::pair<double, double> ScalarQuantity<QuantityT>::getDataRange() {
   return dataRange;
 }
 
+template <typename QuantityT>
+const std::vector<size_t>& ScalarQuantity<QuantityT>::getHistogramBinCounts() {
+  return hist.getBinCounts();
+}
+
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::setIsolineWidth(double size, bool isRelative) {
   isolineWidth = ScaledValue<float>(size, isRelative);
@@ -280,6 +334,18 @@ double ScalarQuantity<QuantityT>::getIsolineDarkness() {
   return isolineDarkness.get();
 }
 
+template <typename QuantityT>
+QuantityT* ScalarQuantity<QuantityT>::setAutoRefreshStatistics(bool newVal) {
+  autoRefreshStatistics = newVal;
+  requestRedraw();
+  return &quantity;
+}
+
+template <typename QuantityT>
+bool ScalarQuantity<QuantityT>::getAutoRefreshStatistics() {
+  return autoRefreshStatistics.get();
+}
+
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::setIsolinesEnabled(bool newEnabled) {
   isolinesEnabled = newEnabled;
@@ -0,0 +1,39 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace polyscope {
+
+// Summary statistics of an array of scalar values, as shown by scalar quantities and their histograms.
+struct ScalarStatistics {
+  // The range of the finite values, padded as in robustMinMax() (so it is (-1, 1) if there are no finite values)
+  std::pair<double, double> range{-1., 1.};
+
+  // The number of values in each of binCounts.size() equal-width bins spanning the range. NaN values are not counted;
+  // infinite values are counted in the first or last bin.
+  std::vector<size_t> binCounts;
+};
+
+// Compute the range and histogram of `values`. Makes one pass for the range and a second one for the bins, both
+// vectorized where SSE2 is available and spread across threads with parallelFor().
+ScalarStatistics computeScalarStatistics(const std::vector<float>& values, size_t binCount, float rangeEPS = 1e-12);
+
+// As above, counting `repeatCount` more copies of `repeatedValue` which are not stored in `values`, such as the
+// background of a sparse field.
+ScalarStatistics computeScalarStatistics(const std::vector<float>& values, size_t binCount, float rangeEPS,
+                                         float repeatedValue, uint64_t repeatCount);
+
+// The range reported for data whose finite values span [minVal, maxVal], padded as in robustMinMax(). Pass minVal >
+// maxVal if there are no finite values. For backends which find the min and max themselves.
+std::pair<double, double> padScalarRange(float minVal, float maxVal, float rangeEPS);
+
+// The factor mapping a value x to its (fractional) bin, (x - range.first) * scale. It is 0 for a degenerate range,
+// which puts everything in the first bin.
+float scalarBinScale(std::pair<double, double> range, size_t binCount);
+
+} // namespace polyscope
@@ -43,6 +43,7 @@ public:
   virtual void drawDelayed() override;
   virtual void drawPick() override;
   virtual void updateObjectSpaceBounds() override;
+  virtual uint64_t geometryDataVersion() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
 
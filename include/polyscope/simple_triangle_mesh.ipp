@@ -28,6 +28,7 @@ void SimpleTriangleMesh::updateVertices(const V& newPositions) {
   validateSize(newPositions, vertices.size(), "newPositions");
   vertices.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   vertices.markHostBufferUpdated();
+  updateObjectSpaceBounds();
 }
 
 template <class V, class F>
@@ -35,6 +36,7 @@ void SimpleTriangleMesh::update(const V& newPositions, const F& newFaces) {
 
   vertices.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   vertices.markHostBufferUpdated();
+  updateObjectSpaceBounds();
 
   faces.data = standardizeVectorArray<glm::uvec3, 3>(newFaces);
   faces.markHostBufferUpdated();
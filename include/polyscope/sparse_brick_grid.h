@@ -0,0 +1,121 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+// The arrangement of a sparse field of values at the nodes of a regular grid. The cells are grouped into bricks of
+// BRICK_CELLS^3 cells, and only some of the bricks are stored; everywhere else the field takes a constant background
+// value. A brick stores all BRICK_NODES^3 of its nodes, including the ones on its upper faces which it shares with the
+// neighboring bricks, so that every cell can be interpolated from a single brick.
+//
+// The stored bricks are packed into an atlas, which is laid out like a 3D texture (x varies fastest) that is a few
+// bricks wide along x and y and grows along z. The slot of each brick in the atlas is kept in a page table with one
+// entry for every brick of the grid.
+//
+// Each node is owned by the brick which has it on its lower faces (or by the last brick along an axis, for the final
+// layer of nodes). Bricks which are not stored must be entirely background, including on their upper faces, so that
+// cells in those bricks are constant. SparseBrickGrid below maintains this automatically.
+class SparseBrickLayout {
+public:
+  static const uint32_t BRICK_CELLS = 8;
+  static const uint32_t BRICK_NODES = BRICK_CELLS + 1;
+  static const uint32_t BRICK_SIZE = BRICK_NODES * BRICK_NODES * BRICK_NODES; // number of values in a brick
+
+  // Bricks along x and y of the atlas are capped such that it fits in a 2048^3 texture, the usual limit on desktop
+  // GPUs. The same cap applies to the number of layers.
+  static const uint32_t MAX_ATLAS_BRICKS_PER_AXIS = 2048 / BRICK_NODES;
+
+  SparseBrickLayout();
+  SparseBrickLayout(glm::uvec3 nodeDim);
+
+  // == Bricks
+  glm::uvec3 getNodeDim() const;
+  glm::uvec3 getBrickDim() const;
+  uint64_t nBricks() const;       // total number of bricks in the grid, stored or not
+  uint32_t nStoredBricks() const; // number of bricks in the atlas
+
+  uint64_t flattenBrickIndex(glm::uvec3 brickInd) const;
+  glm::uvec3 unflattenBrickIndex(uint64_t i) const;
+
+  // The atlas slot of a brick, or INVALID_IND_32 if it is not stored
+  uint32_t getBrickSlot(glm::uvec3 brickInd) const;
+  glm::uvec3 getSlotBrick(uint32_t slot) const;
+
+  // Store a brick, returning its slot. Does nothing if the brick is already stored. The atlas might need to grow
+  // afterwards, see atlasSize().
+  uint32_t addBrick(glm::uvec3 brickInd);
+
+  // The brick which owns a node. Also gives the node's index within that brick.
+  glm::uvec3 brickOfNode(glm::uvec3 nodeInd, glm::uvec3& localNodeInd) const;
+
+  // The page table, with one entry per brick (x varies fastest)
+  const std::vector<uint32_t>& getBrickSlots() const;
+
+  // == Atlas
+  glm::uvec3 getAtlasBrickDim() const; // in bricks
+  glm::uvec3 getAtlasDim() const;      // in nodes
+  size_t atlasSize() const;            // number of values in the atlas, including unused slots
+
+  // Index in the atlas of a node of the brick stored at `slot`, with local indices in [0, BRICK_NODES)
+  size_t atlasIndex(uint32_t slot, glm::uvec3 localNodeInd) const;
+
+  // Index in the atlas of a node of the grid, or INVALID_IND_64 if its value is the background
+  size_t nodeAtlasIndex(glm::uvec3 nodeInd) const;
+
+  // Bytes used by the page table
+  size_t memoryUsage() const;
+
+private:
+  glm::uvec3 nodeDim{0, 0, 0};
+  glm::uvec3 brickDim{0, 0, 0};
+  uint32_t atlasBricksXY = 1;
+  std::vector<uint32_t> brickSlots;
+  std::vector<glm::uvec3> slotBricks;
+};
+
+
+// A sparse field of node values, stored as bricks in an atlas. Unlike a dense array, memory is only used for the bricks
+// where the field differs from the background, which makes very large mostly-empty grids (such as narrow-band SDFs or
+// occupancy grids) practical.
+class SparseBrickGrid {
+public:
+  SparseBrickGrid(glm::uvec3 nodeDim, float backgroundValue);
+
+  // Evaluate a field in the bricks accepted by `brickFilter`, and treat it as background everywhere else.
+  // `brickFilter(brickInd)` is called once for each brick of the grid, and `nodeFunc(nodeInd)` for each node owned
+  // by an accepted brick (possibly more than once, for nodes shared between bricks). Bricks which turn out to hold
+  // only the background are dropped. Both functions may be called from several threads at once.
+  static SparseBrickGrid fromCallable(glm::uvec3 nodeDim, float backgroundValue,
+                                      const std::function<bool(glm::uvec3)>& brickFilter,
+                                      const std::function<float(glm::uvec3)>& nodeFunc);
+
+  // Set the value at a node. Every brick which holds the node is stored if needed, unless the value is the background.
+  void setValue(glm::uvec3 nodeInd, float value);
+  float getValue(glm::uvec3 nodeInd) const;
+
+  // Expand to a dense array of node values, laid out like VolumeGrid node data
+  std::vector<float> toDense() const;
+
+  const SparseBrickLayout& getLayout() const;
+  const std::vector<float>& getAtlasValues() const;
+  float getBackgroundValue() const;
+
+  // Bytes used by the page table and the atlas
+  size_t memoryUsage() const;
+
+private:
+  SparseBrickLayout layout;
+  float backgroundValue;
+  std::vector<float> atlasValues;
+
+  uint32_t addBrick(glm::uvec3 brickInd);
+};
+
+} // namespace polyscope
@@ -0,0 +1,57 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace polyscope {
+
+// How a box relates to the view frustum of `modelViewProj`, once padded by `pad` on all sides
+enum class FrustumTest { Outside, Intersects, Inside };
+FrustumTest testBoxAgainstFrustum(const std::array<glm::vec3, 2>& box, const glm::mat4& modelViewProj, float pad);
+
+// Make a selection of [start, end) draw ranges in which nothing is visible hold a single empty run {0, 0}. A shader
+// program given no ranges at all draws everything (see render::ShaderProgram::setDrawRanges()), so a selection must
+// never be passed on empty.
+void ensureDrawRangesNonEmpty(std::vector<std::array<uint32_t, 2>>& ranges);
+
+// A hierarchy of spatially coherent clusters over the elements of a structure (points, triangles, ...), which lets a
+// draw submit only the clusters that intersect the view frustum.
+//
+// The elements are sorted along a Morton curve through the centers of their bounding boxes, and the sorted order is
+// cut into leaf clusters of CLUSTER_SIZE consecutive elements. Each level above groups BRANCHING consecutive nodes of
+// the level below, up to a single root. Every node thus covers a contiguous run of the sorted order, which can be drawn
+// as one range of a draw order buffer (see render::ShaderProgram::setDrawOrder()).
+class SpatialClusters {
+public:
+  static const uint32_t CLUSTER_SIZE = 256;
+  static const uint32_t BRANCHING = 8;
+
+  SpatialClusters();
+
+  // Build from the bounding box of each element (the two lists may be the same, for points)
+  SpatialClusters(const std::vector<glm::vec3>& elementLow, const std::vector<glm::vec3>& elementHigh);
+
+  size_t nElements() const;
+  size_t nClusters() const; // number of leaf clusters
+
+  // The elements, in cluster order
+  const std::vector<uint32_t>& getOrder() const;
+
+  // The [start, end) runs of the cluster order which may be visible through the view frustum of `modelViewProj`,
+  // after padding the bounds of each cluster by `pad` (in the object space of the elements). Adjacent runs are merged,
+  // so a fully visible structure yields a single run, and if nothing is visible the result is a single empty run.
+  std::vector<std::array<uint32_t, 2>> visibleRanges(const glm::mat4& modelViewProj, float pad) const;
+
+private:
+  std::vector<uint32_t> order;
+
+  // Bounding boxes of the nodes, from the leaf clusters at level 0 up to the root
+  std::vector<std::vector<std::array<glm::vec3, 2>>> levelBounds;
+};
+
+} // namespace polyscope
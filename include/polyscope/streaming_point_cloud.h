@@ -0,0 +1,200 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/color_management.h"
+#include "polyscope/mapped_file.h"
+#include "polyscope/persistent_value.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/scaled_value.h"
+#include "polyscope/structure.h"
+#include "polyscope/types.h"
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace polyscope {
+
+// A point cloud whose data stays in files on disk, for point clouds too large to hold in memory.
+//
+// Positions (and any scalar quantities) are read from memory-mapped files of raw float32 values. The points are split
+// into chunks of CHUNK_SIZE consecutive points in file order, and each frame the chunks in view are streamed to the GPU,
+// subsampled according to how large they appear on screen. The GPU copies live in a pool of fixed size, bounded by
+// options::streamingPointCloudGPUBudget, from which the least recently used chunks are evicted. Files whose points are
+// spatially coherent in file order (as is usual for scans) stream best.
+//
+// Registering reads through the whole file once, to compute the bounds of each chunk.
+class StreamingPointCloud : public Structure {
+public:
+  // === Member functions ===
+
+  // Construct a new streaming point cloud from a file of float32 xyz positions. The first position starts at
+  // `byteOffset`, and consecutive positions are `recordBytes` apart (0 means tightly packed, 12 bytes apart), which
+  // allows reading interleaved records, skipping the other fields.
+  StreamingPointCloud(std::string name, std::string filename, size_t byteOffset = 0, size_t recordBytes = 0);
+
+  // === Overrides
+
+  // Build the imgui display
+  virtual void buildCustomUI() override;
+  virtual void buildCustomOptionsUI() override;
+  virtual void buildPickUI(size_t localPickID) override;
+
+  // Standard structure overrides
+  virtual void draw() override;
+  virtual void drawDelayed() override;
+  virtual void drawPick() override;
+  virtual void prepareFrame() override; // updates which chunks are resident, for the main camera
+  virtual void updateObjectSpaceBounds() override;
+  virtual std::string typeName() override;
+  virtual void refresh() override;
+  virtual float getRenderPadding() override;
+
+  size_t nPoints();
+
+  // Misc data
+  static const std::string structureTypeName;
+  static const uint32_t CHUNK_SIZE = 1 << 16; // points per chunk
+  static const uint32_t PAGE_SIZE = 256;      // points per allocation unit of the GPU pool
+  static const uint32_t MAX_STRIDE = 256;     // coarsest subsampling of a chunk (strides are powers of 4)
+  static const size_t MAX_UPLOAD_POINTS_WHILE_MOVING = 1 << 22; // per frame, to stay interactive
+
+  // === Quantities
+
+  // Add a scalar quantity from a file of float32 values, laid out like the positions (see the constructor). Only one
+  // scalar quantity is shown at a time, see setActiveScalarQuantity().
+  StreamingPointCloud* addScalarQuantityFromFile(std::string name, std::string filename, size_t byteOffset = 0,
+                                                 size_t recordBytes = 0);
+  std::vector<std::string> getScalarQuantityNames();
+
+  // The scalar quantity used to color the points, or "" to use the point color
+  StreamingPointCloud* setActiveScalarQuantity(std::string name);
+  std::string getActiveScalarQuantity();
+
+  // Colormap and range for the active scalar quantity (the range is reset to the data range when it changes)
+  StreamingPointCloud* setColorMap(std::string val);
+  std::string getColorMap();
+  StreamingPointCloud* setMapRange(std::pair<double, double> val);
+  std::pair<double, double> getMapRange();
+
+  // === Streaming statistics
+  size_t nChunks();
+  size_t getResidentPointCount(); // points currently held on the GPU
+  size_t getDrawnPointCount();    // points drawn in the last frame
+  size_t getUploadedPointCount(); // points uploaded to the GPU so far
+  size_t getGPUPoolBytes();       // size of the GPU pool, at most options::streamingPointCloudGPUBudget
+
+  // === Get/set visualization parameters
+
+  // set the base color of the points
+  StreamingPointCloud* setPointColor(glm::vec3 newVal);
+  glm::vec3 getPointColor();
+
+  // set the radius of the points
+  StreamingPointCloud* setPointRadius(double newVal, bool isRelative = true);
+  double getPointRadius();
+
+  // Point render mode (sphere, quad, etc)
+  StreamingPointCloud* setPointRenderMode(PointRenderMode newVal);
+  PointRenderMode getPointRenderMode();
+
+  // Material
+  StreamingPointCloud* setMaterial(std::string name);
+  std::string getMaterial();
+
+private:
+  // A float32 array in a mapped file
+  struct MappedArray {
+    MappedFile file;
+    size_t byteOffset;
+    size_t recordBytes;
+    size_t count;
+  };
+  MappedArray openMappedArray(std::string filename, size_t byteOffset, size_t recordBytes, size_t valueBytes);
+  glm::vec3 readPosition(size_t i) const;
+  float readValue(const MappedArray& arr, size_t i) const;
+
+  MappedArray positions;
+
+  struct ScalarQuantityFile {
+    std::string name;
+    MappedArray values;
+    std::pair<double, double> dataRange;
+  };
+  std::vector<ScalarQuantityFile> scalarQuantities;
+  std::string activeScalarQuantity;
+  std::pair<double, double> mapRange;
+  ScalarQuantityFile* resolveActiveScalarQuantity();
+
+  // === Visualization parameters
+  PersistentValue<std::string> pointRenderMode;
+  PersistentValue<glm::vec3> pointColor;
+  PersistentValue<ScaledValue<float>> pointRadius;
+  PersistentValue<std::string> material;
+  PersistentValue<std::string> cMap;
+
+  // Drawing related things
+  // if nullptr, prepare() (resp. preparePick()) needs to be called
+  std::shared_ptr<render::ShaderProgram> program;
+  std::shared_ptr<render::ShaderProgram> pickProgram;
+
+  // === Streaming state
+
+  struct Chunk {
+    std::array<glm::vec3, 2> bounds;
+    size_t start;   // first point in the file
+    uint32_t count; // points in the file
+
+    // GPU residency: the points start + k * stride live in the given pool pages, in order
+    uint32_t stride = 0; // 0 if not resident
+    uint32_t residentCount = 0;
+    std::vector<uint32_t> pages;
+    uint64_t lastUsedFrame = 0;
+  };
+  std::vector<Chunk> chunks;
+
+  // The pool: each page holds PAGE_SIZE points
+  std::shared_ptr<render::AttributeBuffer> positionPool;
+  std::shared_ptr<render::AttributeBuffer> valuePool;
+  size_t poolPages = 0;
+  size_t poolBytesPerPoint = 0;
+  size_t poolBudget = 0; // the budget the pool was sized for
+  std::vector<uint32_t> freePages;
+
+  uint64_t frameCount = 0;
+  size_t drawnPointCount = 0;
+  size_t uploadedPointCount = 0;
+  std::vector<std::array<uint32_t, 2>> drawRanges;
+
+  // === Helpers
+  void buildChunks();
+  void ensurePoolAllocated();
+  void clearResidency();
+  void updateResidency();
+  void releasePages(Chunk& c);
+  void uploadChunk(Chunk& c, uint32_t stride);
+  void ensureRenderProgramPrepared();
+  void ensurePickProgramPrepared();
+  void setStreamingPointCloudUniforms(render::ShaderProgram& p);
+  std::vector<std::string> addStreamingPointCloudRules(std::vector<std::string> initRules);
+  std::string getShaderNameForRenderMode();
+
+  // == Picking related things
+  size_t pickStart;
+  glm::vec3 pickColor;
+};
+
+
+// Shorthand to add a streaming point cloud to polyscope
+StreamingPointCloud* registerStreamingPointCloud(std::string name, std::string filename, size_t byteOffset = 0,
+                                                 size_t recordBytes = 0);
+
+// Shorthand to get a streaming point cloud from polyscope
+StreamingPointCloud* getStreamingPointCloud(std::string name = "");
+bool hasStreamingPointCloud(std::string name = "");
+void removeStreamingPointCloud(std::string name = "", bool errorIfAbsent = false);
+
+} // namespace polyscope
@@ -44,6 +44,11 @@ public:
   virtual void drawDelayed() = 0;
   virtual void drawPick() = 0;
 
+  // Called once per frame before any of the passes above, with the main camera's view and viewport. View-dependent
+  // work which should not be redone for every pass (ground plane reflection and shadow, transparency peeling, picking)
+  // goes here.
+  virtual void prepareFrame();
+
   // == Add rendering rules
   std::vector<std::string> addStructureRules(std::vector<std::string> initRules);
 
@@ -68,6 +73,14 @@ public:
   float lengthScale();                            // get characteristic length
   virtual bool hasExtents();                      // bounding box and length scale are only meaningful if true
 
+  // True if the structure's bounds lie entirely outside the view frustum, or entirely on the culled side of an active
+  // slice plane, so drawing it would produce nothing. Always false if options::cullStructures is disabled, or if the
+  // geometry has changed on the device since the bounds were last computed.
+  virtual bool isCulled();
+
+  // How far (in world units) drawn primitives may extend past the object-space bounds, e.g. point radii or vectors.
+  virtual float getRenderPadding();
+
   // = Basic state
   virtual std::string typeName() = 0;
 
@@ -132,6 +145,11 @@ protected:
   std::tuple<glm::vec3, glm::vec3> objectSpaceBoundingBox;
   float objectSpaceLengthScale;
   virtual void updateObjectSpaceBounds() = 0;
+
+  // Version of the geometry the bounds depend on. When it differs from objectSpaceBoundsDataVersion (as after a write
+  // directly to the render buffer), the bounds are stale and the structure is never culled.
+  virtual uint64_t geometryDataVersion();
+  uint64_t objectSpaceBoundsDataVersion = 0;
 };
 
 
@@ -181,6 +199,9 @@ public:
   // Re-perform any setup work, including refreshing all quantities
   virtual void refresh() override;
 
+  // Includes the padding of enabled quantities
+  virtual float getRenderPadding() override;
+
   // = Manage quantities
 
   // Note: takes ownership of pointer after it is passed in
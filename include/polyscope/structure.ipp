@@ -82,9 +82,19 @@ void QuantityStructure<S>::refresh() {
   for (auto& qp : floatingQuantities) {
     qp.second->refresh();
   }
+  markSceneChanged();
   requestRedraw();
 }
 
+template <typename S>
+float QuantityStructure<S>::getRenderPadding() {
+  float padding = Structure::getRenderPadding();
+  for (auto& qp : quantities) {
+    if (qp.second->isEnabled()) padding = std::max(padding, qp.second->getRenderPadding());
+  }
+  return padding;
+}
+
 template <typename S>
 void QuantityStructure<S>::removeQuantity(std::string name, bool errorIfAbsent) {
 
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -11,6 +12,7 @@
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
+#include "polyscope/spatial_clusters.h"
 #include "polyscope/standardize_data_array.h"
 #include "polyscope/structure.h"
 #include "polyscope/surface_mesh_quantity.h"
@@ -81,6 +83,7 @@ public:
   virtual void drawDelayed() override;
   virtual void drawPick() override;
   virtual void updateObjectSpaceBounds() override;
+  virtual uint64_t geometryDataVersion() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
 
@@ -176,6 +179,12 @@ public:
   template <class V>
   void updateVertexPositions2D(const V& newPositions2D);
 
+  // Update the positions of just the vertices in `indices`, where newPositions[i] is the new position of vertex
+  // indices[i]. Only the derived geometry (normals, areas, ...) around the moved vertices is recomputed and re-uploaded,
+  // which is much cheaper than updateVertexPositions() when a small part of a big mesh moves.
+  template <class I, class V>
+  void updateVertexPositionsPartial(const I& indices, const V& newPositions);
+
 
   // === Indexing conventions
 
@@ -234,12 +243,11 @@ public:
   void markCornersAsUsed();
 
   // = Manifold connectivity
-  // These are always defined on the triangulated mesh.
   // Not necessarily populated by default. Call ensureHaveManifoldConnectivity() to be sure they are populated.
   void ensureHaveManifoldConnectivity();
-  // Halfedges are implicitly indexed in order on the triangulated face list
+  // Halfedges are implicitly indexed in order on the face list, like corners
   // (note that this may not match the halfedge perm that the user specifies)
-  std::vector<size_t> twinHalfedge; // for halfedge i, the index of a twin halfedge
+  std::vector<size_t> twinHalfedge; // for halfedge i, the index of a twin halfedge (INVALID_IND on boundary)
 
   static const std::string structureTypeName;
 
@@ -274,6 +282,11 @@ public:
   SurfaceMesh* setShadeStyle(MeshShadeStyle newStyle);
   MeshShadeStyle getShadeStyle();
 
+  // Spatial chunking: sort the triangles into spatial clusters, and draw only the clusters which intersect the view
+  // frustum. Worthwhile for very large meshes which are often viewed up close.
+  SurfaceMesh* setSpatialChunking(bool newVal);
+  bool getSpatialChunking();
+
   // == Rendering helpers used by quantities
 
   // void fillGeometryBuffers(render::ShaderProgram& p);
@@ -334,6 +347,9 @@ private:
   bool edgesHaveBeenUsed = false;
   std::vector<uint32_t>
       halfedgeEdgeCorrespondence; // ugly hack used to save a pick buffer attr, filled out lazily w/ edge indices
+  std::vector<uint32_t> halfedgeEdgeCanonical; // for each halfedge, its edge in Polyscope's canonical ordering
+  std::vector<uint32_t> vertexFaceStart;       // CSR lists of the faces incident on each vertex, in face order
+  std::vector<uint32_t> vertexFaceEntries;     // (a face appears once per corner at the vertex)
 
 
   // Visualization settings
@@ -344,11 +360,35 @@ private:
   PersistentValue<BackFacePolicy> backFacePolicy;
   PersistentValue<glm::vec3> backFaceColor;
   PersistentValue<MeshShadeStyle> shadeStyle;
+  PersistentValue<bool> spatialChunking;
 
   // Do setup work related to drawing, including allocating openGL data
   void prepare();
   void preparePick();
 
+  // Spatial chunking. The programs draw the corners of the triangulated mesh in cluster order, and the clusters are
+  // rebuilt whenever the vertices move.
+  SpatialClusters spatialClusters;
+  bool spatialClustersBuilt = false;
+  uint64_t spatialClustersDataVersion = 0;
+  std::vector<uint32_t> clusterOrderData; // [3 * nTriFace]
+  render::ManagedBuffer<uint32_t> clusterOrder;
+  void ensureSpatialClustersBuilt();
+
+  // The visible ranges of corners selected from the clusters, and what they were selected for. Every program drawn
+  // with the same view reuses them, rather than walking the clusters again.
+  struct DrawRangesKey {
+    glm::mat4 modelViewProj;
+    uint64_t dataVersion;
+    bool operator==(const DrawRangesKey& o) const {
+      return modelViewProj == o.modelViewProj && dataVersion == o.dataVersion;
+    }
+  };
+  bool drawRangesSelected = false;
+  DrawRangesKey drawRangesKey;
+  std::vector<std::array<uint32_t, 2>> drawRanges;
+  void setSurfaceMeshDrawRanges(render::ShaderProgram& p);
+
 
   /// == Compute indices & geometry data
   void computeTriangleCornerInds();
@@ -364,6 +404,16 @@ private:
   void computeDefaultFaceTangentBasisX();
   void computeDefaultFaceTangentBasisY();
   void countEdges();
+  void ensureHaveEdgeTable(); // populates nEdgesCount, halfedgeEdgeCanonical, and twinHalfedge together
+  void ensureHaveVertexFaceAdjacency(); // populates vertexFaceStart and vertexFaceEntries
+
+  // Geometry of a single element, shared by the compute functions above and partial updates
+  glm::vec3 computeFaceNormal(size_t iF);
+  glm::vec3 computeFaceCenter(size_t iF);
+  float computeFaceArea(size_t iF);
+  glm::vec3 computeVertexNormal(size_t iV); // requires faceNormals, faceAreas, and the vertex-face adjacency
+  float computeVertexArea(size_t iV);       // requires faceAreas and the vertex-face adjacency
+  std::array<glm::vec3, 2> computeDefaultFaceTangentBasis(size_t iF); // requires faceNormals, triangular faces only
 
   // Picking-related
   // Order of indexing: vertexPositions, faces, edges, halfedges
@@ -386,6 +436,7 @@ private:
 
   void initializeMeshTriangulation();
   void recomputeGeometryIfPopulated();
+  void updateVertexPositionsPartialImpl(const std::vector<uint32_t>& inds, const std::vector<glm::vec3>& newPositions);
 
   glm::vec2 projectToScreenSpace(glm::vec3 coord);
 
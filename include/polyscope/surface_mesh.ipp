@@ -65,9 +65,15 @@ void SurfaceMesh::updateVertexPositions(const V& newPositions) {
   validateSize(newPositions, vertexDataSize, "newPositions");
   vertexPositions.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   vertexPositions.markHostBufferUpdated();
+  updateObjectSpaceBounds();
   recomputeGeometryIfPopulated();
 }
 
+template <class I, class V>
+void SurfaceMesh::updateVertexPositionsPartial(const I& indices, const V& newPositions) {
+  updateVertexPositionsPartialImpl(standardizeArray<uint32_t, I>(indices),
+                                   standardizeVectorArray<glm::vec3, 3>(newPositions));
+}
 
 template <class V>
 void SurfaceMesh::updateVertexPositions2D(const V& newPositions2D) {
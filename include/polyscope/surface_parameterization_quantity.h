@@ -61,11 +61,25 @@ public:
   SurfaceCornerParameterizationQuantity(std::string name, SurfaceMesh& mesh_, const std::vector<glm::vec2>& coords_,
                                         ParamCoordsType type_, ParamVizStyle style);
 
+  virtual void draw() override;
   virtual void buildCornerInfoGUI(size_t cInd) override;
+  virtual void buildParameterizationOptionsUI() override;
   virtual std::string niceName() override;
 
+  // Label islands from the corner coordinates, replacing any labels set with setIslandLabels(). Two faces are in the
+  // same island if they share an edge whose coordinates agree on both sides. Labels are numbered 0, 1, ... in order of
+  // the first face of each island.
+  void computeIslandLabels();
+
+  // If true, island labels are computed from the coordinates as above, and recomputed whenever they change.
+  SurfaceCornerParameterizationQuantity* setAutoIslandLabels(bool newVal);
+  bool getAutoIslandLabels();
+
 protected:
   virtual void fillCoordBuffers(render::ShaderProgram& p) override;
+
+  PersistentValue<bool> autoIslandLabels;
+  uint64_t islandLabelsCoordsVersion = 0; // the version of the coords which the computed labels describe
 };
 
 
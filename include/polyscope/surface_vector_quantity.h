@@ -40,6 +40,7 @@ public:
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
   virtual void buildVertexInfoGUI(size_t vInd) override;
 };
@@ -55,6 +56,7 @@ public:
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
   virtual void buildFaceInfoGUI(size_t fInd) override;
 };
@@ -71,6 +73,7 @@ public:
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
   void buildFaceInfoGUI(size_t fInd) override;
 };
@@ -89,6 +92,7 @@ public:
   virtual void buildCustomUI() override;
 
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
   void buildVertexInfoGUI(size_t vInd) override;
 };
@@ -105,6 +109,7 @@ public:
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
 
   std::vector<float> oneForm;
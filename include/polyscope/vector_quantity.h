@@ -59,6 +59,8 @@ public:
   QuantityT* setMaterial(std::string name);
   std::string getMaterial();
 
+  // How far the drawn vectors may extend past their roots, in world units
+  float computeVectorRenderPadding();
 
 protected:
   const VectorType vectorType;
@@ -72,6 +74,11 @@ protected:
   float vectorLengthRange = -1.;
   bool vectorLengthRangeManuallySet = false;
 
+  // The actual max length of the data (unlike vectorLengthRange, never set manually), and the data version it was
+  // computed from
+  float vectorMaxLength = 0.;
+  uint64_t vectorMaxLengthDataVersion = 0;
+
   std::shared_ptr<render::ShaderProgram> vectorProgram;
 };
 
@@ -90,6 +97,9 @@ public:
   void drawVectors();
   void refreshVectors();
 
+  // Infinite if the vectors were written on the device, since their length is then unknown
+  float getVectorRenderPadding();
+
   template <class V>
   void updateData(const V& newVectors);
   template <class V>
@@ -135,6 +145,9 @@ public:
   void drawVectors();
   void refreshVectors();
 
+  // Infinite if the vectors were written on the device, since their length is then unknown
+  float getVectorRenderPadding();
+
   template <class V>
   void updateData(const V& newVectors);
 
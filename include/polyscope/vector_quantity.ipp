@@ -81,6 +81,14 @@ double VectorQuantityBase<QuantityT>::getVectorLengthRange() {
   return vectorLengthRange;
 }
 
+template <typename QuantityT>
+float VectorQuantityBase<QuantityT>::computeVectorRenderPadding() {
+  float radius = vectorRadius.get().asAbsolute();
+  if (vectorMaxLength == 0.) return radius;
+  if (vectorType == VectorType::AMBIENT) return vectorMaxLength + radius;
+  return vectorLengthMult.get().asAbsolute() / vectorLengthRange * vectorMaxLength + radius;
+}
+
 template <typename QuantityT>
 QuantityT* VectorQuantityBase<QuantityT>::setVectorRadius(double val, bool isRelative) {
   vectorRadius = ScaledValue<double>(val, isRelative);
@@ -182,16 +190,24 @@ void VectorQuantity<QuantityT>::createProgram() {
 
 template <typename QuantityT>
 void VectorQuantity<QuantityT>::updateMaxLength() {
-  if (this->vectorLengthRangeManuallySet) return; // do nothing if it has already been set manually
-
   vectors.ensureHostBufferPopulated();
   float maxLength = 0.;
   for (const glm::vec3& vec : vectors.data) {
     maxLength = std::max(maxLength, glm::length(vec));
   }
+  this->vectorMaxLength = maxLength;
+  this->vectorMaxLengthDataVersion = vectors.dataVersion();
+
+  if (this->vectorLengthRangeManuallySet) return; // do nothing if it has already been set manually
   this->vectorLengthRange = maxLength;
 }
 
+template <typename QuantityT>
+float VectorQuantity<QuantityT>::getVectorRenderPadding() {
+  if (vectors.dataVersion() != this->vectorMaxLengthDataVersion) return std::numeric_limits<float>::infinity();
+  return this->computeVectorRenderPadding();
+}
+
 template <typename QuantityT>
 void VectorQuantity<QuantityT>::refreshVectors() {
   this->vectorProgram.reset();
@@ -300,16 +316,24 @@ void TangentVectorQuantity<QuantityT>::createProgram() {
 
 template <typename QuantityT>
 void TangentVectorQuantity<QuantityT>::updateMaxLength() {
-  if (this->vectorLengthRangeManuallySet) return; // do nothing if it has already been set manually
-
   tangentVectors.ensureHostBufferPopulated();
   float maxLength = 0.;
   for (const glm::vec2& vec : tangentVectors.data) {
     maxLength = std::max(maxLength, glm::length(vec));
   }
+  this->vectorMaxLength = maxLength;
+  this->vectorMaxLengthDataVersion = tangentVectors.dataVersion();
+
+  if (this->vectorLengthRangeManuallySet) return; // do nothing if it has already been set manually
   this->vectorLengthRange = maxLength;
 }
 
+template <typename QuantityT>
+float TangentVectorQuantity<QuantityT>::getVectorRenderPadding() {
+  if (tangentVectors.dataVersion() != this->vectorMaxLengthDataVersion) return std::numeric_limits<float>::infinity();
+  return this->computeVectorRenderPadding();
+}
+
 template <typename QuantityT>
 void TangentVectorQuantity<QuantityT>::refreshVectors() {
   this->vectorProgram.reset();
@@ -121,6 +121,11 @@ void startFlightTo(const CameraParameters& p, float flightLengthInSeconds = .4);
 void startFlightTo(const glm::mat4& T, float targetFov, float flightLengthInSeconds = .4);
 void immediatelyEndFlight();
 
+// True if the camera moved (or the viewport changed) since the previous interactive frame was rendered. Structures may
+// render at reduced detail while this is true; a full-detail frame follows once the camera comes to rest.
+// Non-interactive renders, like screenshots, never count as changing.
+bool viewIsChanging();
+
 // Get and set camera from json string
 std::string getViewAsJson();
 void setViewFromJson(std::string jsonData, bool flyTo);
@@ -137,6 +142,7 @@ std::tuple<int, int> screenCoordsToBufferInds(glm::vec2 screenCoords);
 void buildViewGui();
 void updateFlight(); // Note: uses wall-clock time, so should generally be called exactly once at the beginning of each
                      // iteration
+void updateViewChanging(bool interactive); // called once before each scene render
 
 
 // == Setters, getters, etc
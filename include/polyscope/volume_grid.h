@@ -6,6 +6,7 @@
 #include "polyscope/color_management.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/sparse_brick_grid.h"
 #include "polyscope/standardize_data_array.h"
 #include "polyscope/structure.h"
 
@@ -71,6 +72,15 @@ public:
   
   template <class Func>
   VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromBatchCallable(std::string name, Func&& func, DataType dataType_ = DataType::STANDARD);
+
+  // Sparse node scalars, stored in bricks of 8^3 cells. Only the bricks where the values differ from the background are
+  // kept, which makes it possible to show fields on grids far too large for a dense array. The callable version
+  // evaluates `func(pos)` only in the bricks for which `brickFilter(brickMin, brickMax)` returns true (given the corner
+  // positions of the brick), and both may be called from several threads at once.
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantitySparse(std::string name, const SparseBrickGrid& values, DataType dataType_ = DataType::STANDARD);
+
+  template <class Func, class BrickFunc>
+  VolumeGridNodeScalarQuantity* addNodeScalarQuantityFromCallableSparse(std::string name, Func&& func, BrickFunc&& brickFilter, float backgroundValue, DataType dataType_ = DataType::STANDARD);
   
   template <class T>
   VolumeGridCellScalarQuantity* addCellScalarQuantity(std::string name, const T& values, DataType dataType_ = DataType::STANDARD);
@@ -142,6 +142,23 @@ VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityFromBatchCallable
   return addNodeScalarQuantity(name, result, dataType_);
 }
 
+template <class Func, class BrickFunc>
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityFromCallableSparse(std::string name, Func&& func,
+                                                                                  BrickFunc&& brickFilter,
+                                                                                  float backgroundValue,
+                                                                                  DataType dataType_) {
+
+  auto gridBrickFilter = [&](glm::uvec3 brickInd) {
+    glm::uvec3 brickMin = brickInd * SparseBrickLayout::BRICK_CELLS;
+    glm::uvec3 brickMax = glm::min(brickMin + SparseBrickLayout::BRICK_CELLS, gridNodeDim - 1u);
+    return static_cast<bool>(brickFilter(positionOfNodeIndex(brickMin), positionOfNodeIndex(brickMax)));
+  };
+  auto gridNodeFunc = [&](glm::uvec3 nodeInd) { return static_cast<float>(func(positionOfNodeIndex(nodeInd))); };
+
+  return addNodeScalarQuantitySparse(
+      name, SparseBrickGrid::fromCallable(gridNodeDim, backgroundValue, gridBrickFilter, gridNodeFunc), dataType_);
+}
+
 template <class T>
 VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantity(std::string name, const T& values, DataType dataType_) {
   validateSize(values, nCells(), "grid cell scalar quantity " + name);
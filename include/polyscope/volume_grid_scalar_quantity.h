@@ -6,8 +6,10 @@
 
 #include "polyscope/affine_remapper.h"
 #include "polyscope/histogram.h"
+#include "polyscope/marching_cubes.h"
 #include "polyscope/render/color_maps.h"
 #include "polyscope/scalar_quantity.h"
+#include "polyscope/sparse_brick_grid.h"
 #include "polyscope/surface_mesh.h"
 #include "polyscope/volume_grid.h"
 
@@ -22,6 +24,8 @@ class VolumeGridNodeScalarQuantity : public VolumeGridQuantity, public ScalarQua
 public:
   VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, const std::vector<float>& values_,
                                DataType dataType_);
+  VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_, const SparseBrickGrid& sparseValues_,
+                               DataType dataType_);
 
   virtual void draw() override;
   virtual void buildCustomUI() override;
@@ -34,6 +38,20 @@ public:
 
   // == Getters and setters
 
+  // The value at a node, whether the data is stored densely or in sparse bricks
+  float getNodeValue(size_t ind);
+
+  // True if the values are stored in sparse bricks (see VolumeGrid::addNodeScalarQuantitySparse())
+  bool isSparse();
+
+  // Replace the values, one per node. Not supported for sparse quantities, whose buffer holds the brick atlas rather
+  // than one value per node; register a new sparse quantity instead.
+  template <class V>
+  void updateData(const V& newValues, bool updateStatistics = false);
+
+  // Bytes used by the values on the host. The render device holds a copy of the same size once they are drawn.
+  size_t getMemoryUsage();
+
   // Gridcube viz
 
   VolumeGridNodeScalarQuantity* setGridcubeVizEnabled(bool val);
@@ -57,6 +75,19 @@ public:
   SurfaceMesh* registerIsosurfaceAsMesh(std::string structureName = "");
 
 protected:
+  // Sparse storage. When it is used, `values` holds the atlas of the stored bricks instead of one value per node, and
+  // the page table of atlas slots is kept as a texture too (with -1 for bricks which are not stored).
+  bool sparse = false;
+  SparseBrickLayout sparseLayout;
+  float sparseBackgroundValue = 0.f;
+  std::vector<float> brickSlotsData;
+  render::ManagedBuffer<float> brickSlots;
+
+  // For sparse values, the statistics of the grid nodes rather than of the atlas (which also holds unused slots, and
+  // repeats the nodes shared between bricks): each node of a stored brick is counted once, in the brick which owns it,
+  // and the background once for each node which is not stored.
+  virtual ScalarStatistics computeValueStatistics(size_t binCount, float rangeEPS) override;
+
   // Visualize as a grid of cubes
   PersistentValue<bool> gridcubeVizEnabled;
   std::shared_ptr<render::ShaderProgram> gridcubeProgram;
@@ -71,6 +102,20 @@ protected:
   std::shared_ptr<render::ShaderProgram> isosurfaceProgram;
   void createIsosurfaceProgram();
 
+  // The buffers drawn by the isosurface program. If the render backend supports it they are filled directly on the
+  // device, which is fast enough to redo while the level slider is being dragged.
+  std::shared_ptr<render::AttributeBuffer> isosurfacePositionBuffer;
+  std::shared_ptr<render::AttributeBuffer> isosurfaceIndexBuffer;
+  bool isosurfaceExtractedOnDevice = false;
+  void fillIsosurfaceBuffers();
+
+  // The most recently extracted isosurface mesh, reused as long as the level and the values do not change
+  IsosurfaceMesh isosurfaceMeshCache;
+  bool isosurfaceMeshCacheValid = false;
+  float isosurfaceMeshCacheLevel = 0.f;
+  uint64_t isosurfaceMeshCacheDataVersion = 0;
+  const IsosurfaceMesh& getIsosurfaceMesh();
+
   // Visualize as raymarched volume
   // TODO
 };
@@ -110,4 +155,13 @@ protected:
   void createGridcubeProgram();
 };
 
+template <class V>
+void VolumeGridNodeScalarQuantity::updateData(const V& newValues, bool updateStatistics) {
+  if (sparse) {
+    exception("updateData() is not supported for sparse volume grid quantity " + name +
+              ", register a new sparse quantity instead");
+  }
+  ScalarQuantity<VolumeGridNodeScalarQuantity>::updateData(newValues, updateStatistics);
+}
+
 } // namespace polyscope
@@ -59,6 +59,7 @@ public:
   virtual void drawDelayed() override;
   virtual void drawPick() override;
   virtual void updateObjectSpaceBounds() override;
+  virtual uint64_t geometryDataVersion() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
 
@@ -74,6 +75,9 @@ public:
   render::ManagedBuffer<uint32_t> triangleFaceInds;   // on the split, triangulated mesh [3 * nTriFace]
   render::ManagedBuffer<uint32_t> triangleCellInds;   // on the split, triangulated mesh [3 * nTriFace]
 
+  // one buffer for each corner of the tets in the tet decomposition [nTets], filled along with the tets
+  std::array<render::ManagedBuffer<uint32_t>, 4> tetVertexInds;
+
   // internal triangle data for rendering
   render::ManagedBuffer<glm::vec3> baryCoord;  // on the split, triangulated mesh [3 * nTriFace]
   render::ManagedBuffer<glm::vec3> edgeIsReal; // on the split, triangulated mesh [3 * nTriFace]
@@ -133,11 +137,15 @@ public:
 
   // Manage a separate tetrahedral representation used for volumetric visualizations
   // (for a pure-tet mesh this will be the same as the cells array)
-  // TODO use a managed buffer for this
+  // Slicing only needs the per-corner tetVertexInds buffers, so once slices have been drawn the `tets` array can be
+  // freed with releaseTets() to save memory on large meshes; ensureHaveTets() gathers it back from tetVertexInds if it
+  // is needed again, without touching the slice buffers.
   std::vector<std::array<uint32_t, 4>> tets;
   size_t nTets();
-  void computeTets();    // fills tet buffer
-  void ensureHaveTets(); //  ensure the tet buffer is filled (but don't rebuild if already done)
+  void computeTets();             // fills tet buffer and tetVertexInds
+  void ensureHaveTets();          //  ensure the tet buffer is filled (but don't rebuild if already done)
+  void ensureHaveTetVertexInds(); //  same, for tetVertexInds only
+  void releaseTets();             // free the tet buffer, keeping tetVertexInds
 
   // === Member variables ===
   static const std::string structureTypeName;
@@ -171,6 +179,8 @@ public:
   // Rendering helpers used by quantities
   void setVolumeMeshUniforms(render::ShaderProgram& p);
   void fillGeometryBuffers(render::ShaderProgram& p);
+  // Set the tet corner positions of a SLICE_TETS program, which are also the sliced values (a_point_* and a_slice_*).
+  // These are indexed views of the vertex positions, shared by every program which slices this mesh.
   void fillSliceGeometryBuffers(render::ShaderProgram& p);
   static const std::vector<std::vector<std::array<size_t, 3>>>& cellStencil(VolumeCellType type);
 
@@ -193,6 +203,7 @@ private:
   std::vector<uint32_t> triangleVertexIndsData; // to the split, triangulated mesh
   std::vector<uint32_t> triangleFaceIndsData;   // to the split, triangulated mesh
   std::vector<uint32_t> triangleCellIndsData;   // to the split, triangulated mesh
+  std::array<std::vector<uint32_t>, 4> tetVertexIndsData;
 
   // internal triangle data for rendering
   std::vector<glm::vec3> baryCoordData;
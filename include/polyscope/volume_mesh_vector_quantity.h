@@ -38,6 +38,7 @@ public:
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
   virtual void buildVertexInfoGUI(size_t vInd) override;
 };
@@ -54,6 +55,7 @@ public:
   virtual void draw() override;
   virtual void buildCustomUI() override;
   virtual void refresh() override;
+  virtual float getRenderPadding() override;
   virtual std::string niceName() override;
   virtual void buildCellInfoGUI(size_t cInd) override;
 };
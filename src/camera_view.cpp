@@ -99,6 +99,9 @@ void CameraView::drawDelayed() {
   }
 }
 
+// The camera widget is drawn with a size relative to the scene, which is unrelated to the bounds of the structure
+bool CameraView::isCulled() { return false; }
+
 void CameraView::drawPick() {
   if (!isEnabled()) {
     return;
@@ -339,6 +339,15 @@ void CurveNetwork::refresh() {
   QuantityStructure<CurveNetwork>::refresh(); // call base class version, which refreshes quantities
 }
 
+float CurveNetwork::getRenderPadding() {
+  // the largest radius a node or edge can be drawn with
+  float maxRadius = getRadius();
+  if (nodeRadiusQuantityName != "" && !nodeRadiusQuantityAutoscale) {
+    maxRadius = std::max(0., resolveNodeRadiusQuantity().getDataRange().second);
+  }
+  return std::max(QuantityStructure<CurveNetwork>::getRenderPadding(), maxRadius);
+}
+
 void CurveNetwork::recomputeGeometryIfPopulated() { edgeCenters.recomputeIfPopulated(); }
 
 void CurveNetwork::buildPickUI(size_t localPickID) {
@@ -454,8 +463,11 @@ void CurveNetwork::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  objectSpaceBoundsDataVersion = geometryDataVersion();
 }
 
+uint64_t CurveNetwork::geometryDataVersion() { return nodePositions.dataVersion(); }
+
 CurveNetwork* CurveNetwork::setColor(glm::vec3 newVal) {
   color = newVal;
   polyscope::requestRedraw();
@@ -34,6 +34,8 @@ void CurveNetworkNodeVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float CurveNetworkNodeVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void CurveNetworkNodeVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -75,6 +77,8 @@ void CurveNetworkEdgeVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float CurveNetworkEdgeVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void CurveNetworkEdgeVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
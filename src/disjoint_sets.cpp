@@ -2,6 +2,8 @@
 
 #include "polyscope/disjoint_sets.h"
 
+#include <utility>
+
 using std::vector;
 
 namespace polyscope {
@@ -86,4 +88,41 @@ void MarkedDisjointSets::merge(size_t x, size_t y) {
   }
 }
 
+// Constructor
+ConcurrentDisjointSets::ConcurrentDisjointSets(size_t n_) : n(n_), parent(n + 1) {
+  // Initialize all elements to be in different sets
+  for (size_t i = 0; i <= n; i++) {
+    parent[i].store(i, std::memory_order_relaxed);
+  }
+}
+
+// Find the representative of element x
+size_t ConcurrentDisjointSets::find(size_t x) {
+  while (true) {
+    size_t p = parent[x].load(std::memory_order_relaxed);
+    if (p == x) return x;
+    size_t gp = parent[p].load(std::memory_order_relaxed);
+
+    // Point x at its grandparent. This only ever moves x closer to its root, so it is fine if another thread got there
+    // first and the exchange fails.
+    if (p != gp) parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+    x = gp;
+  }
+}
+
+// Union
+void ConcurrentDisjointSets::merge(size_t x, size_t y) {
+  while (true) {
+    x = find(x);
+    y = find(y);
+    if (x == y) return;
+    if (x < y) std::swap(x, y);
+
+    // Link the larger root x under y, unless some other thread linked x somewhere in the meantime; then retry from the
+    // new roots.
+    size_t expected = x;
+    if (parent[x].compare_exchange_strong(expected, y)) return;
+  }
+}
+
 } // namespace polyscope
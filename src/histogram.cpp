@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <string>
 
 namespace polyscope {
 
@@ -20,64 +21,40 @@ Histogram::Histogram(std::vector<float>& values) { buildHistogram(values); }
 Histogram::~Histogram() {}
 
 void Histogram::buildHistogram(const std::vector<float>& values) {
+  buildHistogram(computeScalarStatistics(values, rawHistBinCount));
+}
+
+void Histogram::buildHistogram(const ScalarStatistics& stats) {
 
-  // Build arrays of values
-  size_t N = values.size();
+  if (stats.binCounts.size() != rawHistBinCount) {
+    exception("histogram built from statistics with " + std::to_string(stats.binCounts.size()) + " bins, expected " +
+              std::to_string(rawHistBinCount));
+  }
 
-  // == Build histogram
-  dataRange = robustMinMax(values);
+  dataRange = stats.range;
   colormapRange = dataRange;
+  binCounts = stats.binCounts;
+
+  // Build histogram coords, rescaled to [0,1] in both dimensions
+  size_t binCount = rawHistBinCount;
+  double maxHeight = static_cast<double>(*std::max_element(stats.binCounts.begin(), stats.binCounts.end()));
+  rawHistCurveX = std::vector<std::array<float, 2>>(binCount);
+  rawHistCurveY = std::vector<float>(binCount);
+  for (size_t iBin = 0; iBin < binCount; iBin++) {
+    rawHistCurveX[iBin] = {{static_cast<float>(iBin) / binCount, static_cast<float>(iBin + 1) / binCount}};
+    rawHistCurveY[iBin] = maxHeight > 0. ? stats.binCounts[iBin] / maxHeight : 0.;
+  }
 
-  // Helper to build the four histogram variants
-  auto buildCurve = [&](size_t binCount, std::vector<std::array<float, 2>>& curveX, std::vector<float>& curveY) {
-    // linspace coords
-    double range = dataRange.second - dataRange.first;
-    double inc = range / binCount;
-    std::vector<double> sumBin(binCount, 0.0);
-
-    // count values in buckets
-    for (size_t iData = 0; iData < N; iData++) {
-
-      double iBinf = binCount * (values[iData] - dataRange.first) / range;
-      size_t iBin = std::floor(glm::clamp(iBinf, 0.0, (double)binCount - 1));
-
-      // NaN values and finite values near the bottom of float range lead to craziness, so only increment bins if we got
-      // something reasonable
-      if (iBin < binCount) {
-        sumBin[iBin] += 1.0;
-      }
-    }
-
-
-    // build histogram coords
-    curveX = std::vector<std::array<float, 2>>(binCount);
-    curveY = std::vector<float>(binCount);
-    double prevSumU = 0.0;
-    double prevSumW = 0.0;
-    double prevXEnd = dataRange.first;
-    for (size_t iBin = 0; iBin < binCount; iBin++) {
-      // y value
-      curveY[iBin] = sumBin[iBin];
-
-      // x value
-      double xEnd = prevXEnd + inc;
-      curveX[iBin] = {{static_cast<float>(prevXEnd), static_cast<float>(xEnd)}};
-      prevXEnd = xEnd;
-    }
-
-    { // Rescale curves to [0,1] in both dimensions
-      double maxHeight = *std::max_element(curveY.begin(), curveY.end());
-      for (size_t i = 0; i < binCount; i++) {
-        curveX[i][0] = (curveX[i][0] - dataRange.first) / range;
-        curveX[i][1] = (curveX[i][1] - dataRange.first) / range;
-        curveY[i] /= maxHeight;
-      }
-    }
-  };
-
-  buildCurve(rawHistBinCount, rawHistCurveX, rawHistCurveY);
+  // refill the buffers if they already exist (this happens each time the statistics of live data are refreshed)
+  if (program) {
+    fillBuffers();
+  }
 }
 
+size_t Histogram::getBinCount() const { return rawHistBinCount; }
+
+const std::vector<size_t>& Histogram::getBinCounts() const { return binCounts; }
+
 
 void Histogram::updateColormap(const std::string& newColormap) {
   colormap = newColormap;
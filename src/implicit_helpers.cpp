@@ -0,0 +1,261 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/implicit_helpers.h"
+
+#include "polyscope/parallel.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/view.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <memory>
+
+namespace polyscope {
+
+ProgressiveImplicitRender::ProgressiveImplicitRender(Structure& parent_,
+                                                     std::function<FloatingQuantity*(std::string)> findQuantity_,
+                                                     std::string name_, BatchFunc func_, BatchFunc funcColor_,
+                                                     ImplicitRenderMode mode_, ImplicitRenderOpts opts_,
+                                                     bool followsView_)
+    : parent(parent_.getWeakHandle<Structure>(&parent_)), findQuantity(findQuantity_), name(name_), func(func_),
+      funcColor(funcColor_), mode(mode_), opts(opts_), followsView(followsView_) {
+  restart();
+
+  // The coarsest level is traced right away, so that there is always something to show
+  while (nextLevelPixel < levelPixels.size()) {
+    traceNextPixels();
+  }
+}
+
+bool ProgressiveImplicitRender::prepareFrame() {
+  if (stopped || getQuantity() == nullptr) return false;
+
+  // A render of the current view is stale as soon as the view changes, start over with a new preview. A preview which
+  // is still being traced gets finished first, so that the image keeps up even if the view changes on every frame.
+  if (followsView && previewTraced && view::getCameraPerspectiveMatrix() * view::viewMat != viewProjMat) {
+    restart();
+    if (stopped) return false;
+  }
+
+  if (isRefining()) {
+
+    // Trace batches of pixels until the time for this frame is used up
+    auto frameStart = std::chrono::steady_clock::now();
+    double elapsedMs = 0.;
+    while (isRefining() && elapsedMs < opts.progressiveFrameBudgetMs) {
+      if (nextLevelPixel == levelPixels.size()) {
+        startLevel(subsampleFactor / 2);
+        continue;
+      }
+      traceNextPixels();
+      elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    }
+
+    // Until the preview of a new view is done, the quantity keeps showing the image of the previous one
+    if (previewTraced) publish();
+    if (stopped) return false;
+  }
+
+  if (isRefining()) return true;
+
+  // Once done with a fixed camera, there is nothing left to do
+  if (!followsView) return false;
+
+  // A render of the current view stays around to restart when the view changes, but the finished image has been
+  // published to the quantity and is not needed until then
+  depths = std::vector<float>();
+  normals = std::vector<glm::vec3>();
+  colors = std::vector<glm::vec3>();
+  return true;
+}
+
+bool ProgressiveImplicitRender::isRefining() {
+  return !stopped && (subsampleFactor > 1 || nextLevelPixel < levelPixels.size());
+}
+
+const ImplicitRenderOpts& ProgressiveImplicitRender::getOpts() { return opts; }
+const std::vector<float>& ProgressiveImplicitRender::getDepths() { return depths; }
+const std::vector<glm::vec3>& ProgressiveImplicitRender::getNormals() { return normals; }
+const std::vector<glm::vec3>& ProgressiveImplicitRender::getColors() { return colors; }
+
+void ProgressiveImplicitRender::restart() {
+
+  if (followsView) {
+    if (view::projectionMode != ProjectionMode::Perspective) {
+      // same restriction as resolveImplicitRenderOpts()
+      warning("progressive implicit render of " + name + " stopped, only perspective projection is supported");
+      stopped = true;
+      return;
+    }
+    opts.cameraParameters = view::getCameraParametersForCurrentView();
+    opts.dimX = view::bufferWidth;
+    opts.dimY = view::bufferHeight;
+    viewProjMat = view::getCameraPerspectiveMatrix() * view::viewMat;
+  }
+
+  size_t nPix = static_cast<size_t>(opts.dimX) * opts.dimY;
+  rayDirs = opts.cameraParameters.generateCameraRays(opts.dimX, opts.dimY, ImageOrigin::UpperLeft);
+  depths = std::vector<float>(nPix, std::numeric_limits<float>::infinity());
+  rayPositions = std::vector<glm::vec3>(nPix, glm::vec3{0.f, 0.f, 0.f});
+  normals = std::vector<glm::vec3>(nPix, glm::vec3{0.f, 0.f, 0.f});
+  if (funcColor) {
+    colors = std::vector<glm::vec3>(nPix, glm::vec3{0.f, 0.f, 0.f});
+  }
+  traced = std::vector<char>(nPix, false);
+
+  previewTraced = false;
+  startLevel(std::max(opts.subsampleFactor, 1));
+}
+
+void ProgressiveImplicitRender::startLevel(size_t newSubsampleFactor) {
+  subsampleFactor = std::max(newSubsampleFactor, static_cast<size_t>(1));
+  size_t dimX = opts.dimX;
+  size_t dimY = opts.dimY;
+
+  levelPixels.clear();
+  nextLevelPixel = 0;
+  for (size_t iY = 0; iY < dimY; iY += subsampleFactor) {
+    for (size_t iX = 0; iX < dimX; iX += subsampleFactor) {
+      size_t iP = iY * dimX + iX;
+      if (!traced[iP]) levelPixels.push_back(iP);
+    }
+  }
+
+  // Free the working data once the final level is done
+  if (subsampleFactor == 1 && levelPixels.empty()) {
+    rayDirs = std::vector<glm::vec3>();
+    rayPositions = std::vector<glm::vec3>();
+    traced = std::vector<char>();
+    levelPixels = std::vector<size_t>();
+  }
+}
+
+void ProgressiveImplicitRender::traceNextPixels() {
+  size_t dimX = opts.dimX;
+  size_t dimY = opts.dimY;
+
+  // Split the next pixels of the level in to batches of the same size as a tile in the non-progressive tracer, one for
+  // each thread if tracing in parallel
+  const size_t batchSize = std::max(opts.tileSize * opts.tileSize, static_cast<size_t>(1));
+  size_t nBatches = opts.parallelTiles ? numParallelWorkers() : 1;
+  size_t batchStart = nextLevelPixel;
+  size_t batchEnd = std::min(batchStart + nBatches * batchSize, levelPixels.size());
+  nBatches = (batchEnd - batchStart + batchSize - 1) / batchSize;
+  nextLevelPixel = batchEnd;
+
+  auto traceBatch = [&](size_t iBatch) {
+    size_t start = batchStart + iBatch * batchSize;
+    size_t end = std::min(start + batchSize, batchEnd);
+    std::vector<size_t> pixInds(levelPixels.begin() + start, levelPixels.begin() + end);
+    traceImplicitSurfacePixels(func, mode, opts, rayDirs, pixInds, depths, rayPositions, &normals);
+
+    if (funcColor) {
+      std::vector<glm::vec3> batchPos(pixInds.size());
+      std::vector<glm::vec3> batchColor(pixInds.size());
+      for (size_t i = 0; i < pixInds.size(); i++) batchPos[i] = rayPositions[pixInds[i]];
+      funcColor(&batchPos.front().x, &batchColor.front().x, pixInds.size());
+      for (size_t i = 0; i < pixInds.size(); i++) {
+        bool miss = depths[pixInds[i]] == std::numeric_limits<float>::infinity();
+        colors[pixInds[i]] = miss ? glm::vec3{0.f, 0.f, 0.f} : batchColor[i]; // (as in the non-progressive render)
+      }
+    }
+
+    // Fill in the untraced pixels below and to the right, up to the next pixel of this level. These blocks do not
+    // overlap within a level, so batches never write the same pixel.
+    for (size_t iP : pixInds) {
+      traced[iP] = true;
+      size_t pX = iP % dimX;
+      size_t pY = iP / dimX;
+      for (size_t iY = pY; iY < std::min(pY + subsampleFactor, dimY); iY++) {
+        for (size_t iX = pX; iX < std::min(pX + subsampleFactor, dimX); iX++) {
+          size_t iFill = iY * dimX + iX;
+          if (traced[iFill]) continue;
+          depths[iFill] = depths[iP];
+          normals[iFill] = normals[iP];
+          if (funcColor) colors[iFill] = colors[iP];
+        }
+      }
+    }
+  };
+
+  if (opts.parallelTiles) {
+    parallelFor(
+        nBatches,
+        [&](size_t start, size_t end) {
+          for (size_t iBatch = start; iBatch < end; iBatch++) traceBatch(iBatch);
+        },
+        1);
+  } else {
+    for (size_t iBatch = 0; iBatch < nBatches; iBatch++) traceBatch(iBatch);
+  }
+
+  if (nextLevelPixel == levelPixels.size()) {
+    previewTraced = true;
+    if (subsampleFactor == 1) startLevel(1); // frees the working data
+  }
+}
+
+void ProgressiveImplicitRender::publish() {
+  RenderImageQuantityBase* quantity = getQuantity();
+  if (quantity == nullptr) {
+    stopped = true;
+    return;
+  }
+
+  if (quantity->nPix() == depths.size()) {
+    if (funcColor) {
+      dynamic_cast<ColorRenderImageQuantity*>(quantity)->updateBuffers(depths, normals, colors);
+    } else {
+      dynamic_cast<DepthRenderImageQuantity*>(quantity)->updateBuffers(depths, normals);
+    }
+  } else {
+    // The view was resized, the quantity must be re-created at the new size. This only happens when following the
+    // view, which means the parent is a floating quantity structure.
+    FloatingQuantityStructure* floatingParent = dynamic_cast<FloatingQuantityStructure*>(&parent.get());
+    if (floatingParent == nullptr) {
+      stopped = true;
+      return;
+    }
+    if (funcColor) {
+      floatingParent->addColorRenderImageQuantityImpl(name, opts.dimX, opts.dimY, depths, normals, colors,
+                                                      ImageOrigin::UpperLeft);
+    } else {
+      floatingParent->addDepthRenderImageQuantityImpl(name, opts.dimX, opts.dimY, depths, normals,
+                                                      ImageOrigin::UpperLeft);
+    }
+  }
+}
+
+RenderImageQuantityBase* ProgressiveImplicitRender::getQuantity() {
+  if (!parent.isValid()) return nullptr;
+  FloatingQuantity* quantity = findQuantity(name);
+  if (funcColor) return dynamic_cast<ColorRenderImageQuantity*>(quantity);
+  return dynamic_cast<DepthRenderImageQuantity*>(quantity);
+}
+
+void stopProgressiveImplicitRender(Structure& parent, std::string name) {
+  state::globalContext.progressiveImplicitRenders.erase(parent.uniquePrefix() + name);
+}
+
+bool progressiveImplicitRendersRefining() {
+  for (const auto& entry : state::globalContext.progressiveImplicitRenders) {
+    if (entry.second->isRefining()) return true;
+  }
+  return false;
+}
+
+void prepareProgressiveImplicitRendersForFrame() {
+  std::map<std::string, std::unique_ptr<ProgressiveImplicitRender>>& renders =
+      state::globalContext.progressiveImplicitRenders;
+  for (auto it = renders.begin(); it != renders.end();) {
+    if (it->second->prepareFrame()) {
+      it++;
+    } else {
+      it = renders.erase(it);
+    }
+  }
+}
+
+} // namespace polyscope
@@ -0,0 +1,140 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/mapped_file.h"
+
+#include "polyscope/messages.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace polyscope {
+
+MappedFile::MappedFile() {}
+
+MappedFile::MappedFile(std::string filename_) : filename(filename_) {
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    exception("could not open file [" + filename + "]");
+    return;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    CloseHandle(file);
+    exception("could not get the size of file [" + filename + "]");
+    return;
+  }
+  fileHandle = file;
+  mappedSize = static_cast<size_t>(fileSize.QuadPart);
+  if (mappedSize == 0) { // (empty files cannot be mapped)
+    opened = true;
+    return;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) {
+    close();
+    exception("could not map file [" + filename + "]");
+    return;
+  }
+  mappingHandle = mapping;
+  mappedData = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (mappedData == nullptr) {
+    close();
+    exception("could not map file [" + filename + "]");
+    return;
+  }
+  opened = true;
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    exception("could not open file [" + filename + "]");
+    return;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    ::close(fd);
+    exception("could not get the size of file [" + filename + "]");
+    return;
+  }
+  mappedSize = static_cast<size_t>(fileStat.st_size);
+  if (mappedSize == 0) { // (empty files cannot be mapped)
+    ::close(fd);
+    opened = true;
+    return;
+  }
+
+  void* ptr = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping stays valid after the descriptor is closed
+  if (ptr == MAP_FAILED) {
+    mappedSize = 0;
+    exception("could not map file [" + filename + "]");
+    return;
+  }
+  mappedData = static_cast<const unsigned char*>(ptr);
+  opened = true;
+#endif
+}
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this == &other) return *this;
+  close();
+
+  filename = std::move(other.filename);
+  mappedData = other.mappedData;
+  mappedSize = other.mappedSize;
+  opened = other.opened;
+  other.mappedData = nullptr;
+  other.mappedSize = 0;
+  other.opened = false;
+#ifdef _WIN32
+  fileHandle = other.fileHandle;
+  mappingHandle = other.mappingHandle;
+  other.fileHandle = nullptr;
+  other.mappingHandle = nullptr;
+#endif
+
+  return *this;
+}
+
+bool MappedFile::isOpen() const { return opened; }
+
+void MappedFile::close() {
+#ifdef _WIN32
+  if (mappedData != nullptr) UnmapViewOfFile(mappedData);
+  if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+  if (fileHandle != nullptr) CloseHandle(fileHandle);
+  fileHandle = nullptr;
+  mappingHandle = nullptr;
+#else
+  if (mappedData != nullptr) munmap(const_cast<unsigned char*>(mappedData), mappedSize);
+#endif
+  mappedData = nullptr;
+  mappedSize = 0;
+  opened = false;
+}
+
+const std::string& MappedFile::getFilename() const { return filename; }
+
+size_t MappedFile::size() const { return mappedSize; }
+
+const unsigned char* MappedFile::data() const { return mappedData; }
+
+} // namespace polyscope
@@ -1,2 +1,459 @@
 #define MC_IMPLEM_ENABLE
 #include "MarchingCube/MC.h"
+
+#include "polyscope/marching_cubes.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+
+namespace polyscope {
+
+// The MC library indexes its field with the first coordinate varying slowest, so its (x,y,z) is our (z,y,x), both for
+// the cube corners and the edges below.
+const MarchingCubesEdge marchingCubesEdges[12] = {{2, 0, 0, 0}, {2, 0, 1, 0}, {2, 1, 0, 0}, {2, 1, 1, 0},
+                                                  {1, 0, 0, 0}, {1, 0, 0, 1}, {1, 1, 0, 0}, {1, 1, 0, 1},
+                                                  {0, 0, 0, 0}, {0, 0, 0, 1}, {0, 0, 1, 0}, {0, 0, 1, 1}};
+
+uint64_t marchingCubesCase(int config) { return MC::mc_internalMarching_cube_tris[config]; }
+
+namespace {
+
+// Vertex indices for the crossings on the grid edges which start in one layer of nodes, indexed like the nodes of the
+// layer. Entries are only meaningful for edges which actually cross the isosurface.
+struct LayerEdgeVertices {
+  std::vector<uint32_t> xEdge;
+  std::vector<uint32_t> yEdge;
+  std::vector<uint32_t> zEdge; // edges up to the next layer
+};
+
+class MarchingCubesGrid {
+public:
+  MarchingCubesGrid(const std::vector<float>& values_, glm::uvec3 nodeDim, float isoLevel_, glm::vec3 boundMin_,
+                    glm::vec3 spacing_)
+      : values(values_), nx(nodeDim.x), ny(nodeDim.y), nz(nodeDim.z), isoLevel(isoLevel_), boundMin(boundMin_),
+        spacing(spacing_) {}
+
+  const std::vector<float>& values;
+  const uint32_t nx, ny, nz;
+  const float isoLevel;
+  const glm::vec3 boundMin, spacing;
+
+  // (same arithmetic as the MC library, so the results agree exactly)
+  float value(uint32_t x, uint32_t y, uint32_t z) const {
+    return -isoLevel + values[(static_cast<size_t>(z) * ny + y) * nx + x];
+  }
+  static bool crosses(float vA, float vB) { return (vA < 0) != (vB < 0); }
+
+  glm::vec3 crossingPosition(uint32_t x, uint32_t y, uint32_t z, int axis, float vA, float vB) const {
+    glm::vec3 p{static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)};
+    p[axis] += vA / (vA - vB);
+    return p * spacing + boundMin;
+  }
+
+  // Number of crossings on the x- and y-edges within node layer z
+  size_t countLayerXY(uint32_t z) const {
+    size_t count = 0;
+    for (uint32_t y = 0; y < ny; y++) {
+      for (uint32_t x = 0; x < nx; x++) {
+        float v = value(x, y, z);
+        if (x + 1 < nx && crosses(v, value(x + 1, y, z))) count++;
+        if (y + 1 < ny && crosses(v, value(x, y + 1, z))) count++;
+      }
+    }
+    return count;
+  }
+
+  // Number of crossings on the z-edges from node layer z to z+1
+  size_t countLayerZ(uint32_t z) const {
+    size_t count = 0;
+    for (uint32_t y = 0; y < ny; y++) {
+      for (uint32_t x = 0; x < nx; x++) {
+        if (crosses(value(x, y, z), value(x, y, z + 1))) count++;
+      }
+    }
+    return count;
+  }
+
+  // Number the crossings on the x- and y-edges of layer z, consecutively from `start` in the same order they are
+  // counted above. If `vertices` is non-null, also write out their positions.
+  void fillLayerXY(uint32_t z, uint32_t start, LayerEdgeVertices& layer, std::vector<glm::vec3>* vertices) const {
+    uint32_t iNext = start;
+    for (uint32_t y = 0; y < ny; y++) {
+      for (uint32_t x = 0; x < nx; x++) {
+        size_t iNode = static_cast<size_t>(y) * nx + x;
+        float v = value(x, y, z);
+        if (x + 1 < nx) {
+          float vX = value(x + 1, y, z);
+          if (crosses(v, vX)) {
+            if (vertices) (*vertices)[iNext] = crossingPosition(x, y, z, 0, v, vX);
+            layer.xEdge[iNode] = iNext++;
+          }
+        }
+        if (y + 1 < ny) {
+          float vY = value(x, y + 1, z);
+          if (crosses(v, vY)) {
+            if (vertices) (*vertices)[iNext] = crossingPosition(x, y, z, 1, v, vY);
+            layer.yEdge[iNode] = iNext++;
+          }
+        }
+      }
+    }
+  }
+
+  void fillLayerZ(uint32_t z, uint32_t start, LayerEdgeVertices& layer, std::vector<glm::vec3>* vertices) const {
+    uint32_t iNext = start;
+    for (uint32_t y = 0; y < ny; y++) {
+      for (uint32_t x = 0; x < nx; x++) {
+        float v = value(x, y, z);
+        float vZ = value(x, y, z + 1);
+        if (crosses(v, vZ)) {
+          if (vertices) (*vertices)[iNext] = crossingPosition(x, y, z, 2, v, vZ);
+          layer.zEdge[static_cast<size_t>(y) * nx + x] = iNext++;
+        }
+      }
+    }
+  }
+
+  // Emit the triangles for the layer of cells between node layers z and z+1
+  void emitCellLayer(uint32_t z, const LayerEdgeVertices& bottom, const LayerEdgeVertices& top,
+                     std::vector<uint32_t>& indices) const {
+    for (uint32_t y = 0; y + 1 < ny; y++) {
+      for (uint32_t x = 0; x + 1 < nx; x++) {
+
+        int config = 0;
+        for (int iCorner = 0; iCorner < 8; iCorner++) {
+          uint32_t dx = (iCorner >> 2) & 1;
+          uint32_t dy = (iCorner >> 1) & 1;
+          uint32_t dz = iCorner & 1;
+          if (value(x + dx, y + dy, z + dz) < 0) config |= (1 << iCorner);
+        }
+        if (config == 0 || config == 255) continue;
+
+        uint64_t tris = marchingCubesCase(config);
+        size_t nIndices = 3 * (tris & 0xF);
+        for (size_t i = 0; i < nIndices; i++) {
+          const MarchingCubesEdge& e = marchingCubesEdges[(tris >> (4 + 4 * i)) & 0xF];
+          const LayerEdgeVertices& layer = e.dz ? top : bottom;
+          size_t iNode = static_cast<size_t>(y + e.dy) * nx + (x + e.dx);
+          switch (e.axis) {
+          case 0:
+            indices.push_back(layer.xEdge[iNode]);
+            break;
+          case 1:
+            indices.push_back(layer.yEdge[iNode]);
+            break;
+          default:
+            indices.push_back(layer.zEdge[iNode]);
+            break;
+          }
+        }
+      }
+    }
+  }
+};
+
+// Marching cubes over the stored bricks of a sparse field. Each brick finds the crossings on the edges starting at the
+// nodes it owns, then emits the triangles for its cells, looking up vertices on edges owned by the bricks above it.
+class SparseMarchingCubesBricks {
+public:
+  SparseMarchingCubesBricks(const SparseBrickLayout& layout_, const std::vector<float>& atlasValues_, float isoLevel_,
+                            glm::vec3 boundMin_, glm::vec3 spacing_)
+      : layout(layout_), atlasValues(atlasValues_), nodeDim(layout_.getNodeDim()), brickDim(layout_.getBrickDim()),
+        isoLevel(isoLevel_), boundMin(boundMin_), spacing(spacing_) {}
+
+  static const uint32_t B = SparseBrickLayout::BRICK_CELLS;
+  static const uint32_t N = SparseBrickLayout::BRICK_NODES;
+
+  const SparseBrickLayout& layout;
+  const std::vector<float>& atlasValues;
+  const glm::uvec3 nodeDim, brickDim;
+  const float isoLevel;
+  const glm::vec3 boundMin, spacing;
+
+  // Copy the values of a brick out of the atlas, shifted by the level (same arithmetic as the dense version, so the
+  // results agree exactly)
+  void loadBrick(uint32_t slot, float* brickValues) const {
+    for (uint32_t z = 0; z < N; z++) {
+      for (uint32_t y = 0; y < N; y++) {
+        const float* row = &atlasValues[layout.atlasIndex(slot, glm::uvec3{0, y, z})];
+        for (uint32_t x = 0; x < N; x++) *brickValues++ = -isoLevel + row[x];
+      }
+    }
+  }
+  static float value(const float* brickValues, glm::uvec3 localInd) {
+    return brickValues[(localInd.z * N + localInd.y) * N + localInd.x];
+  }
+
+  // Edges are identified within a brick by their lower node and axis, such that scanning the nodes with x varying
+  // fastest visits them in increasing order
+  static uint32_t edgeKey(glm::uvec3 localInd, int axis) {
+    return ((localInd.z * N + localInd.y) * N + localInd.x) * 3 + axis;
+  }
+
+  // One past the last local index of the nodes of a brick which lie in the grid
+  glm::uvec3 nodeEnd(glm::uvec3 brickInd) const {
+    glm::uvec3 end;
+    for (int i = 0; i < 3; i++) end[i] = std::min(N, nodeDim[i] - brickInd[i] * B);
+    return end;
+  }
+
+  // One past the last local index of the nodes owned by a brick. Only the last brick along an axis owns its upper face.
+  glm::uvec3 ownedEnd(glm::uvec3 brickInd) const {
+    glm::uvec3 end = nodeEnd(brickInd);
+    for (int i = 0; i < 3; i++) {
+      if (brickInd[i] + 1 < brickDim[i]) end[i] = std::min(end[i], B);
+    }
+    return end;
+  }
+
+  // The crossings on the edges starting at the nodes owned by the brick in `slot`, with their keys in increasing order
+  void findOwnedVertices(uint32_t slot, std::vector<uint32_t>& keys, std::vector<glm::vec3>& positions) const {
+    glm::uvec3 brickInd = layout.getSlotBrick(slot);
+    glm::uvec3 nEnd = nodeEnd(brickInd);
+    glm::uvec3 oEnd = ownedEnd(brickInd);
+    float brickValues[SparseBrickLayout::BRICK_SIZE];
+    loadBrick(slot, brickValues);
+    for (uint32_t z = 0; z < oEnd.z; z++) {
+      for (uint32_t y = 0; y < oEnd.y; y++) {
+        for (uint32_t x = 0; x < oEnd.x; x++) {
+          glm::uvec3 localInd{x, y, z};
+          float v = value(brickValues, localInd);
+          for (int axis = 0; axis < 3; axis++) {
+            glm::uvec3 nextInd = localInd;
+            nextInd[axis]++;
+            if (nextInd[axis] >= nEnd[axis]) continue;
+            float vNext = value(brickValues, nextInd);
+            if ((v < 0) == (vNext < 0)) continue;
+
+            glm::vec3 p = glm::vec3(brickInd * B + localInd);
+            p[axis] += v / (v - vNext);
+            keys.push_back(edgeKey(localInd, axis));
+            positions.push_back(p * spacing + boundMin);
+          }
+        }
+      }
+    }
+  }
+
+  // Emit the triangles for the cells of the brick in `slot`
+  void emitTriangles(uint32_t slot, const std::vector<std::vector<uint32_t>>& slotKeys,
+                     const std::vector<size_t>& slotVertexStart, std::vector<uint32_t>& indices) const {
+    glm::uvec3 brickInd = layout.getSlotBrick(slot);
+    glm::uvec3 cellEnd = nodeEnd(brickInd) - 1u;
+    float brickValues[SparseBrickLayout::BRICK_SIZE];
+    loadBrick(slot, brickValues);
+
+    // Vertex indices for the edges owned by this brick, indexed by key. Only the edges which cross are filled in.
+    uint32_t ownedVertices[SparseBrickLayout::BRICK_SIZE * 3];
+    const std::vector<uint32_t>& ownedKeys = slotKeys[slot];
+    for (size_t i = 0; i < ownedKeys.size(); i++) {
+      ownedVertices[ownedKeys[i]] = static_cast<uint32_t>(slotVertexStart[slot] + i);
+    }
+    for (uint32_t z = 0; z < cellEnd.z; z++) {
+      for (uint32_t y = 0; y < cellEnd.y; y++) {
+        for (uint32_t x = 0; x < cellEnd.x; x++) {
+
+          int config = 0;
+          for (int iCorner = 0; iCorner < 8; iCorner++) {
+            glm::uvec3 cornerInd{x + ((iCorner >> 2) & 1), y + ((iCorner >> 1) & 1), z + (iCorner & 1)};
+            if (value(brickValues, cornerInd) < 0) config |= (1 << iCorner);
+          }
+          if (config == 0 || config == 255) continue;
+
+          uint64_t tris = marchingCubesCase(config);
+          size_t nIndices = 3 * (tris & 0xF);
+          for (size_t i = 0; i < nIndices; i++) {
+            const MarchingCubesEdge& e = marchingCubesEdges[(tris >> (4 + 4 * i)) & 0xF];
+
+            // Find the brick which owns the lower node of the edge
+            glm::uvec3 ownerInd = brickInd;
+            glm::uvec3 ownerLocalInd{x + e.dx, y + e.dy, z + e.dz};
+            for (int iAxis = 0; iAxis < 3; iAxis++) {
+              if (ownerLocalInd[iAxis] == B && brickInd[iAxis] + 1 < brickDim[iAxis]) {
+                ownerInd[iAxis]++;
+                ownerLocalInd[iAxis] = 0;
+              }
+            }
+            if (ownerInd == brickInd) {
+              indices.push_back(ownedVertices[edgeKey(ownerLocalInd, e.axis)]);
+              continue;
+            }
+
+            // Edges owned by a neighbor are looked up in its list of keys
+            uint32_t ownerSlot = layout.getBrickSlot(ownerInd);
+            if (ownerSlot == INVALID_IND_32) {
+              exception("sparse brick grid has a crossing next to a brick which is not stored");
+            }
+
+            const std::vector<uint32_t>& keys = slotKeys[ownerSlot];
+            uint32_t key = edgeKey(ownerLocalInd, e.axis);
+            std::vector<uint32_t>::const_iterator it = std::lower_bound(keys.begin(), keys.end(), key);
+            if (it == keys.end() || *it != key) exception("sparse brick grid values disagree between bricks");
+            indices.push_back(static_cast<uint32_t>(slotVertexStart[ownerSlot] + (it - keys.begin())));
+          }
+        }
+      }
+    }
+  }
+};
+
+const uint32_t SparseMarchingCubesBricks::B;
+const uint32_t SparseMarchingCubesBricks::N;
+
+} // namespace
+
+IsosurfaceMesh marchingCubes(const std::vector<float>& values, glm::uvec3 nodeDim, float isoLevel, glm::vec3 boundMin,
+                             glm::vec3 spacing) {
+
+  IsosurfaceMesh mesh;
+  if (nodeDim.x < 2 || nodeDim.y < 2 || nodeDim.z < 2) return mesh;
+  size_t nLayer = static_cast<size_t>(nodeDim.x) * nodeDim.y;
+  if (values.size() != nLayer * nodeDim.z) {
+    exception("marching cubes values have size " + std::to_string(values.size()) + ", but the grid has " +
+              std::to_string(nLayer * nodeDim.z) + " nodes");
+  }
+
+  MarchingCubesGrid grid(values, nodeDim, isoLevel, boundMin, spacing);
+  uint32_t nz = nodeDim.z;
+
+  // == Count the crossings in each layer of nodes, and give each layer a contiguous block of vertex indices. Within a
+  // layer, the x- and y-edges come first, so that the slab below can number them without counting the z-edges.
+  std::vector<size_t> layerCountXY(nz, 0);
+  std::vector<size_t> layerCountZ(nz, 0);
+  size_t layerGrain = std::max<size_t>(1, 16384 / nLayer);
+  parallelFor(
+      nz,
+      [&](size_t start, size_t end) {
+        for (size_t z = start; z < end; z++) {
+          layerCountXY[z] = grid.countLayerXY(z);
+          if (z + 1 < nz) layerCountZ[z] = grid.countLayerZ(z);
+        }
+      },
+      layerGrain);
+
+  std::vector<size_t> layerStart(nz + 1, 0);
+  for (uint32_t z = 0; z < nz; z++) {
+    layerStart[z + 1] = layerStart[z] + layerCountXY[z] + layerCountZ[z];
+  }
+  size_t nVertices = layerStart[nz];
+  if (nVertices >= INVALID_IND_32) exception("marching cubes isosurface has too many vertices");
+  mesh.vertices.resize(nVertices);
+
+  // == Extract slabs of cell layers in parallel. Each slab writes the vertices of the node layers it owns (its bottom
+  // layers; the last slab also owns the final layer), but numbers the vertices of the layer above it too, since its
+  // top cells use them. This welds the slabs together without any further pass.
+  uint32_t nCellLayers = nz - 1;
+  size_t nSlabs = std::min<size_t>(nCellLayers, 4 * numParallelWorkers());
+  std::vector<std::vector<uint32_t>> slabIndices(nSlabs);
+  parallelFor(
+      nSlabs,
+      [&](size_t slabStart, size_t slabEnd) {
+        LayerEdgeVertices bottom, top;
+        for (LayerEdgeVertices* layer : {&bottom, &top}) {
+          layer->xEdge.resize(nLayer);
+          layer->yEdge.resize(nLayer);
+          layer->zEdge.resize(nLayer);
+        }
+
+        for (size_t iSlab = slabStart; iSlab < slabEnd; iSlab++) {
+          uint32_t zStart = static_cast<uint32_t>(iSlab * nCellLayers / nSlabs);
+          uint32_t zEnd = static_cast<uint32_t>((iSlab + 1) * nCellLayers / nSlabs);
+          std::vector<uint32_t>& indices = slabIndices[iSlab];
+
+          grid.fillLayerXY(zStart, layerStart[zStart], bottom, &mesh.vertices);
+          grid.fillLayerZ(zStart, layerStart[zStart] + layerCountXY[zStart], bottom, &mesh.vertices);
+          for (uint32_t z = zStart; z < zEnd; z++) {
+            uint32_t zNext = z + 1;
+            bool ownsNext = zNext < zEnd || zNext == nz - 1;
+            grid.fillLayerXY(zNext, layerStart[zNext], top, ownsNext ? &mesh.vertices : nullptr);
+            if (zNext < zEnd) {
+              grid.fillLayerZ(zNext, layerStart[zNext] + layerCountXY[zNext], top, &mesh.vertices);
+            }
+            grid.emitCellLayer(z, bottom, top, indices);
+            std::swap(bottom, top);
+          }
+        }
+      },
+      1);
+
+  // == Gather the triangles, in slab order
+  size_t nIndices = 0;
+  for (const std::vector<uint32_t>& indices : slabIndices) nIndices += indices.size();
+  mesh.indices.reserve(nIndices);
+  for (const std::vector<uint32_t>& indices : slabIndices) {
+    mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+  }
+
+  return mesh;
+}
+
+IsosurfaceMesh marchingCubes(const SparseBrickLayout& layout, const std::vector<float>& atlasValues, float isoLevel,
+                             glm::vec3 boundMin, glm::vec3 spacing) {
+
+  IsosurfaceMesh mesh;
+  glm::uvec3 nodeDim = layout.getNodeDim();
+  if (nodeDim.x < 2 || nodeDim.y < 2 || nodeDim.z < 2) return mesh;
+  if (atlasValues.size() != layout.atlasSize()) {
+    exception("marching cubes atlas values have size " + std::to_string(atlasValues.size()) + ", but the layout has " +
+              std::to_string(layout.atlasSize()));
+  }
+
+  SparseMarchingCubesBricks bricks(layout, atlasValues, isoLevel, boundMin, spacing);
+  uint32_t nSlots = layout.nStoredBricks();
+
+  // == Find the vertices owned by each brick, and give each brick a contiguous block of vertex indices
+  std::vector<std::vector<uint32_t>> slotKeys(nSlots);
+  std::vector<std::vector<glm::vec3>> slotPositions(nSlots);
+  parallelFor(
+      nSlots,
+      [&](size_t start, size_t end) {
+        for (size_t iSlot = start; iSlot < end; iSlot++) {
+          bricks.findOwnedVertices(static_cast<uint32_t>(iSlot), slotKeys[iSlot], slotPositions[iSlot]);
+        }
+      },
+      16);
+
+  std::vector<size_t> slotVertexStart(nSlots + 1, 0);
+  for (uint32_t iSlot = 0; iSlot < nSlots; iSlot++) {
+    slotVertexStart[iSlot + 1] = slotVertexStart[iSlot] + slotKeys[iSlot].size();
+  }
+  size_t nVertices = slotVertexStart[nSlots];
+  if (nVertices >= INVALID_IND_32) exception("marching cubes isosurface has too many vertices");
+  mesh.vertices.resize(nVertices);
+  parallelFor(
+      nSlots,
+      [&](size_t start, size_t end) {
+        for (size_t iSlot = start; iSlot < end; iSlot++) {
+          std::copy(slotPositions[iSlot].begin(), slotPositions[iSlot].end(),
+                    mesh.vertices.begin() + slotVertexStart[iSlot]);
+          std::vector<glm::vec3>().swap(slotPositions[iSlot]);
+        }
+      },
+      16);
+
+  // == Emit the triangles of each brick, now that the vertices of its neighbors are numbered too
+  std::vector<std::vector<uint32_t>> slotIndices(nSlots);
+  parallelFor(
+      nSlots,
+      [&](size_t start, size_t end) {
+        for (size_t iSlot = start; iSlot < end; iSlot++) {
+          bricks.emitTriangles(static_cast<uint32_t>(iSlot), slotKeys, slotVertexStart, slotIndices[iSlot]);
+        }
+      },
+      16);
+
+  // == Gather the triangles, in slot order
+  size_t nIndices = 0;
+  for (const std::vector<uint32_t>& indices : slotIndices) nIndices += indices.size();
+  mesh.indices.reserve(nIndices);
+  for (const std::vector<uint32_t>& indices : slotIndices) {
+    mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+  }
+
+  return mesh;
+}
+
+} // namespace polyscope
@@ -0,0 +1,145 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/mesh_edge_table.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace polyscope {
+
+MeshEdgeTable buildMeshEdgeTable(const std::vector<uint32_t>& faceIndsStart,
+                                 const std::vector<uint32_t>& faceIndsEntries, size_t nVertices) {
+
+  MeshEdgeTable table;
+  if (faceIndsStart.empty()) return table;
+  size_t nFaces = faceIndsStart.size() - 1;
+  size_t nHalfedges = faceIndsEntries.size();
+  if (nHalfedges >= INVALID_IND_32) exception("mesh has too many halfedges to build an edge table");
+
+  // Tip vertex of each halfedge
+  std::vector<uint32_t> heTip(nHalfedges);
+  parallelFor(nFaces, [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      size_t start = faceIndsStart[iF];
+      size_t D = faceIndsStart[iF + 1] - start;
+      for (size_t j = 0; j < D; j++) {
+        heTip[start + j] = faceIndsEntries[start + (j + 1) % D];
+      }
+    }
+  });
+  auto heLow = [&](uint32_t iHe) { return std::min(faceIndsEntries[iHe], heTip[iHe]); };
+  auto heHigh = [&](uint32_t iHe) { return std::max(faceIndsEntries[iHe], heTip[iHe]); };
+
+  // Bucket the halfedges by their lower vertex (a counting sort on the high half of the packed edge key)
+  std::vector<uint32_t> bucketStart(nVertices + 1, 0);
+  std::vector<uint32_t> bucketHalfedges(nHalfedges);
+  {
+    std::vector<std::atomic<uint32_t>> bucketCursor(nVertices); // value-initialized to 0
+    std::atomic<bool> outOfBounds(false);
+    parallelFor(nHalfedges, [&](size_t start, size_t end) {
+      for (size_t iHe = start; iHe < end; iHe++) {
+        uint32_t vLow = heLow(iHe);
+        if (vLow >= nVertices || heHigh(iHe) >= nVertices) {
+          outOfBounds = true;
+          return;
+        }
+        bucketCursor[vLow].fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+    if (outOfBounds) exception("mesh has face vertex index out of bounds");
+    for (size_t iV = 0; iV < nVertices; iV++) {
+      bucketStart[iV + 1] = bucketStart[iV] + bucketCursor[iV].load(std::memory_order_relaxed);
+      bucketCursor[iV].store(bucketStart[iV], std::memory_order_relaxed);
+    }
+    parallelFor(nHalfedges, [&](size_t start, size_t end) {
+      for (size_t iHe = start; iHe < end; iHe++) {
+        uint32_t pos = bucketCursor[heLow(iHe)].fetch_add(1, std::memory_order_relaxed);
+        bucketHalfedges[pos] = iHe;
+      }
+    });
+  }
+
+  // Within each bucket, sort by (upper vertex, halfedge index). Halfedges along the same edge are now contiguous, with
+  // the first-encountered one at the front. This also undoes any nondeterminism from the concurrent bucket fill.
+  // Then, walk each group of halfedges along an edge to record the first halfedge and the twins.
+  std::vector<uint32_t> groupFirst(nHalfedges);
+  std::vector<char> isFirst(nHalfedges, false);
+  table.twinHalfedge.resize(nHalfedges);
+  parallelFor(nVertices, [&](size_t vStart, size_t vEnd) {
+    for (size_t iV = vStart; iV < vEnd; iV++) {
+      uint32_t* bBegin = &bucketHalfedges[0] + bucketStart[iV];
+      uint32_t* bEnd = &bucketHalfedges[0] + bucketStart[iV + 1];
+      std::sort(bBegin, bEnd, [&](uint32_t heA, uint32_t heB) {
+        uint32_t hA = heHigh(heA);
+        uint32_t hB = heHigh(heB);
+        return hA < hB || (hA == hB && heA < heB);
+      });
+
+      uint32_t* gBegin = bBegin;
+      while (gBegin != bEnd) {
+        uint32_t vHigh = heHigh(*gBegin);
+        uint32_t* gEnd = gBegin + 1;
+        while (gEnd != bEnd && heHigh(*gEnd) == vHigh) gEnd++;
+
+        uint32_t he0 = *gBegin;
+        isFirst[he0] = true;
+        table.twinHalfedge[he0] = (gEnd - gBegin > 1) ? gBegin[1] : INVALID_IND_32;
+        groupFirst[he0] = he0;
+        for (uint32_t* it = gBegin + 1; it != gEnd; it++) {
+          table.twinHalfedge[*it] = he0;
+          groupFirst[*it] = he0;
+        }
+
+        gBegin = gEnd;
+      }
+    }
+  });
+
+  // Number the edges in the order of their first halfedge, via a chunked exclusive prefix sum over isFirst
+  table.halfedgeEdge.resize(nHalfedges);
+  size_t nChunks = std::max<size_t>(1, std::min<size_t>(4 * numParallelWorkers(), nHalfedges / 4096));
+  size_t chunkSize = (nHalfedges + nChunks - 1) / nChunks;
+  std::vector<size_t> chunkOffset(nChunks + 1, 0);
+  parallelFor(
+      nChunks,
+      [&](size_t cStart, size_t cEnd) {
+        for (size_t iC = cStart; iC < cEnd; iC++) {
+          size_t count = 0;
+          for (size_t iHe = iC * chunkSize; iHe < std::min(nHalfedges, (iC + 1) * chunkSize); iHe++) {
+            if (isFirst[iHe]) count++;
+          }
+          chunkOffset[iC + 1] = count;
+        }
+      },
+      1);
+  for (size_t iC = 0; iC < nChunks; iC++) {
+    chunkOffset[iC + 1] += chunkOffset[iC];
+  }
+  parallelFor(
+      nChunks,
+      [&](size_t cStart, size_t cEnd) {
+        for (size_t iC = cStart; iC < cEnd; iC++) {
+          uint32_t iEdge = chunkOffset[iC];
+          for (size_t iHe = iC * chunkSize; iHe < std::min(nHalfedges, (iC + 1) * chunkSize); iHe++) {
+            if (isFirst[iHe]) table.halfedgeEdge[iHe] = iEdge++;
+          }
+        }
+      },
+      1);
+  table.nEdges = chunkOffset[nChunks];
+
+  // All other halfedges take the edge of the first halfedge in their group
+  parallelFor(nHalfedges, [&](size_t start, size_t end) {
+    for (size_t iHe = start; iHe < end; iHe++) {
+      if (!isFirst[iHe]) table.halfedgeEdge[iHe] = table.halfedgeEdge[groupFirst[iHe]];
+    }
+  });
+
+  return table;
+}
+
+} // namespace polyscope
@@ -22,6 +22,7 @@ bool automaticallyComputeSceneExtents = true;
 bool invokeUserCallbackForNestedShow = false;
 bool giveFocusOnShow = false;
 bool hideWindowAfterShow = true;
+int maxThreads = 0;
 
 bool screenshotTransparency = true;
 std::string screenshotExtension = ".png";
@@ -43,6 +44,11 @@ int ssaaFactor = 1;
 TransparencyMode transparencyMode = TransparencyMode::None;
 int transparencyRenderPasses = 8;
 
+bool cullStructures = true;
+size_t pointCloudLODThreshold = 0;
+float pointCloudLODPixelSpacing = 2.;
+size_t streamingPointCloudGPUBudget = 256 << 20;
+
 // === Advanced ImGui configuration
 
 bool buildGui = true;
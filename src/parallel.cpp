@@ -0,0 +1,185 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/parallel.h"
+
+#include "polyscope/options.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace polyscope {
+
+namespace {
+
+// True on pool worker threads, and on the calling thread while it is running a parallelFor(). Nested calls run serially
+// on the current thread.
+thread_local bool insideParallelRegion = false;
+
+// A persistent pool of worker threads. The pool runs one job at a time; each job is a set of chunks which the workers
+// and the submitting thread claim from a shared counter until none are left. The pool is sized once for
+// numParallelWorkers(), and only re-created if that changes; jobs with few chunks just use fewer of the workers.
+class ThreadPool {
+public:
+  ~ThreadPool() { stopWorkers(); }
+
+  // Run chunkFunc(i) for each i in [0, nChunks) on a pool of nThreads threads (including the calling thread), at most
+  // one per chunk. Returns false without running anything if the pool is already busy with a job from another thread.
+  bool run(size_t nThreads, size_t nChunks, const std::function<void(size_t)>& chunkFunc) {
+    std::unique_lock<std::mutex> submitLock(submitMutex, std::try_to_lock);
+    if (!submitLock.owns_lock()) return false;
+
+    if (workers.size() + 1 != nThreads) {
+      stopWorkers();
+      startWorkers(nThreads - 1);
+    }
+
+    size_t nHelpers = std::min(workers.size(), nChunks - 1); // the calling thread takes part too
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      job = &chunkFunc;
+      jobChunks = nChunks;
+      jobOpenSlots = nHelpers;
+      nextChunk = 0;
+      jobGeneration++;
+    }
+    if (nHelpers == workers.size()) {
+      wakeWorkers.notify_all();
+    } else {
+      for (size_t i = 0; i < nHelpers; i++) wakeWorkers.notify_one();
+    }
+
+    processChunks(chunkFunc, nChunks);
+
+    // no new workers may pick up the job; wait for the ones which did to finish their chunks
+    std::unique_lock<std::mutex> lock(mutex);
+    job = nullptr;
+    jobDone.wait(lock, [&]() { return activeWorkers == 0; });
+    return true;
+  }
+
+private:
+  std::mutex submitMutex; // held for the duration of a job
+  std::mutex mutex;       // guards all of the job state below
+  std::condition_variable wakeWorkers;
+  std::condition_variable jobDone;
+  std::vector<std::thread> workers;
+  bool shutdown = false;
+
+  const std::function<void(size_t)>* job = nullptr;
+  size_t jobChunks = 0;
+  size_t jobOpenSlots = 0; // how many more workers may join the current job
+  size_t jobGeneration = 0;
+  size_t activeWorkers = 0;
+  std::atomic<size_t> nextChunk{0};
+
+  void processChunks(const std::function<void(size_t)>& chunkFunc, size_t nChunks) {
+    while (true) {
+      size_t iChunk = nextChunk.fetch_add(1);
+      if (iChunk >= nChunks) break;
+      chunkFunc(iChunk);
+    }
+  }
+
+  void workerLoop() {
+    insideParallelRegion = true;
+    size_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      wakeWorkers.wait(lock, [&]() { return shutdown || (job != nullptr && jobGeneration != seenGeneration); });
+      if (shutdown) return;
+
+      seenGeneration = jobGeneration;
+      if (jobOpenSlots == 0) continue; // enough workers on this job already
+      jobOpenSlots--;
+      const std::function<void(size_t)>* thisJob = job;
+      size_t thisJobChunks = jobChunks;
+      activeWorkers++;
+      lock.unlock();
+
+      processChunks(*thisJob, thisJobChunks);
+
+      lock.lock();
+      activeWorkers--;
+      if (activeWorkers == 0) jobDone.notify_all();
+    }
+  }
+
+  void startWorkers(size_t n) {
+    shutdown = false;
+    for (size_t i = 0; i < n; i++) {
+      workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+  }
+
+  void stopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      shutdown = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& t : workers) {
+      t.join();
+    }
+    workers.clear();
+  }
+};
+
+ThreadPool& getThreadPool() {
+  static ThreadPool pool;
+  return pool;
+}
+
+} // namespace
+
+size_t numParallelWorkers() {
+  if (options::maxThreads > 0) return options::maxThreads;
+  size_t n = std::thread::hardware_concurrency();
+  return std::max<size_t>(n, 1); // hardware_concurrency() may return 0 if it cannot tell
+}
+
+void parallelFor(size_t N, const std::function<void(size_t, size_t)>& func, size_t grainSize) {
+  if (N == 0) return;
+
+  // use a few chunks per thread, so uneven chunks still balance out
+  grainSize = std::max<size_t>(grainSize, 1);
+  size_t nThreads = numParallelWorkers();
+  size_t nChunks = std::min(4 * nThreads, N / grainSize);
+  if (nThreads <= 1 || nChunks <= 1 || insideParallelRegion) {
+    func(0, N);
+    return;
+  }
+
+  size_t chunkSize = (N + nChunks - 1) / nChunks;
+  std::exception_ptr firstError;
+  std::mutex errorMutex;
+  auto runChunk = [&](size_t iChunk) {
+    size_t start = iChunk * chunkSize;
+    size_t end = std::min(N, start + chunkSize);
+    if (start >= end) return;
+    try {
+      func(start, end);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!firstError) firstError = std::current_exception();
+    }
+  };
+
+  insideParallelRegion = true;
+  bool ran = getThreadPool().run(nThreads, nChunks, runChunk);
+  insideParallelRegion = false;
+
+  if (!ran) {
+    // the pool is busy with a call from another thread, just do the work here
+    func(0, N);
+    return;
+  }
+
+  if (firstError) std::rethrow_exception(firstError);
+}
+
+} // namespace polyscope
@@ -4,7 +4,11 @@
 
 #include "polyscope/polyscope.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <limits>
+#include <map>
 #include <tuple>
 #include <unordered_map>
 
@@ -15,18 +19,56 @@ size_t currLocalPickInd = 0;
 Structure* currPickStructure = nullptr;
 bool haveSelectionVal = false;
 
-// The next pick index that a structure can use to identify its elements
+// The next pick index that a structure can use to identify its elements, beyond all ranges allocated so far
 // (get it by calling request pickBufferRange())
 size_t nextPickBufferInd = 1; // 0 reserved for "none"
-                              //
-// Track which ranges have been allocated to which structures
-// std::vector<std::tuple<size_t, size_t, Structure*>> structureRanges;
-std::unordered_map<Structure*, std::tuple<size_t, size_t>> structureRanges;
 
+// Track which ranges have been allocated to which structures. Ranges are indexed by their start, so the range
+// containing an index can be found with a binary search.
+struct PickRange {
+  size_t end;
+  Structure* structure;
+};
+std::map<size_t, PickRange> rangesByStart;
+std::unordered_map<Structure*, size_t> structureRangeStart;
+
+// Ranges below nextPickBufferInd which were released, as start --> end. Adjacent free ranges are always merged.
+std::map<size_t, size_t> freeRanges;
+
+namespace {
+
+void addFreeRange(size_t start, size_t end) {
+
+  // merge with the neighbors on either side, if they touch
+  auto next = freeRanges.lower_bound(start);
+  if (next != freeRanges.end() && next->first == end) {
+    end = next->second;
+    next = freeRanges.erase(next);
+  }
+  if (next != freeRanges.begin()) {
+    auto prev = std::prev(next);
+    if (prev->second == start) {
+      start = prev->first;
+      freeRanges.erase(prev);
+    }
+  }
+
+  // a free range at the very end just gets returned to the unallocated space
+  if (end == nextPickBufferInd) {
+    nextPickBufferInd = start;
+  } else {
+    freeRanges[start] = end;
+  }
+}
+
+} // namespace
 
 // == Set up picking
 size_t requestPickBufferRange(Structure* requestingStructure, size_t count) {
 
+  // A structure only ever holds one range; requesting again replaces the old one
+  releasePickBufferRange(requestingStructure);
+
   // Check if we can satisfy the request
   size_t maxPickInd = std::numeric_limits<size_t>::max();
 #pragma GCC diagnostic push
@@ -39,17 +81,46 @@ size_t requestPickBufferRange(Structure* requestingStructure, size_t count) {
   }
 #pragma GCC diagnostic pop
 
-  if (count > maxPickInd || maxPickInd - count < nextPickBufferInd) {
-    exception("Wow, you sure do have a lot of stuff, Polyscope can't even count it all. (Ran out of indices while "
-              "enumerating structure elements for pick buffer.)");
+  // First fit among the released ranges, otherwise take fresh indices from the end
+  size_t ret = INVALID_IND;
+  for (auto it = freeRanges.begin(); it != freeRanges.end(); it++) {
+    size_t freeStart = it->first;
+    size_t freeEnd = it->second;
+    if (freeEnd - freeStart >= count) {
+      ret = freeStart;
+      freeRanges.erase(it);
+      if (freeEnd - freeStart > count) freeRanges[freeStart + count] = freeEnd;
+      break;
+    }
+  }
+
+  if (ret == INVALID_IND) {
+    if (count > maxPickInd || maxPickInd - count < nextPickBufferInd) {
+      exception("Wow, you sure do have a lot of stuff, Polyscope can't even count it all. (Ran out of indices while "
+                "enumerating structure elements for pick buffer.)");
+    }
+    ret = nextPickBufferInd;
+    nextPickBufferInd += count;
   }
 
-  size_t ret = nextPickBufferInd;
-  nextPickBufferInd += count;
-  structureRanges[requestingStructure] = std::make_tuple(ret, nextPickBufferInd);
+  if (count > 0) {
+    rangesByStart[ret] = PickRange{ret + count, requestingStructure};
+    structureRangeStart[requestingStructure] = ret;
+  }
   return ret;
 }
 
+void releasePickBufferRange(Structure* structure) {
+  auto it = structureRangeStart.find(structure);
+  if (it == structureRangeStart.end()) return;
+
+  size_t start = it->second;
+  size_t end = rangesByStart[start].end;
+  rangesByStart.erase(start);
+  structureRangeStart.erase(it);
+  addFreeRange(start, end);
+}
+
 // == Manage stateful picking
 
 void resetSelection() {
@@ -88,51 +159,71 @@ void setSelection(std::pair<Structure*, size_t> newPick) {
 
 std::pair<Structure*, size_t> globalIndexToLocal(size_t globalInd) {
 
-  // ONEDAY: this could be asymptotically better if we cared
-
-  // Loop through the ranges that we have allocated to find the one correpsonding to this structure.
-  for (const auto& x : structureRanges) {
+  // Find the last range starting at or before this index, and check if it contains the index
+  auto it = rangesByStart.upper_bound(globalInd);
+  if (it == rangesByStart.begin()) return {nullptr, 0};
+  it--;
 
-    Structure* structure = x.first;
-    size_t rangeStart = std::get<0>(x.second);
-    size_t rangeEnd = std::get<1>(x.second);
+  size_t rangeStart = it->first;
+  const PickRange& range = it->second;
+  if (globalInd >= range.end) return {nullptr, 0};
+  return {range.structure, globalInd - rangeStart};
+}
 
-    if (globalInd >= rangeStart && globalInd < rangeEnd) {
-      return {structure, globalInd - rangeStart};
+std::vector<std::pair<Structure*, size_t>> globalIndexToLocal(const std::vector<size_t>& globalInds) {
+  std::vector<std::pair<Structure*, size_t>> results(globalInds.size());
+
+  // Neighboring pixels usually hit the same structure, so check the last range found before searching again
+  size_t lastStart = 0;
+  size_t lastEnd = 0;
+  Structure* lastStructure = nullptr;
+  for (size_t i = 0; i < globalInds.size(); i++) {
+    size_t globalInd = globalInds[i];
+    if (lastStructure == nullptr || globalInd < lastStart || globalInd >= lastEnd) {
+      results[i] = globalIndexToLocal(globalInd);
+      if (results[i].first == nullptr) continue;
+      lastStructure = results[i].first;
+      lastStart = globalInd - results[i].second;
+      lastEnd = rangesByStart[lastStart].end;
+    } else {
+      results[i] = {lastStructure, globalInd - lastStart};
     }
   }
 
-  return {nullptr, 0};
+  return results;
 }
 
 size_t localIndexToGlobal(std::pair<Structure*, size_t> localPick) {
   if (localPick.first == nullptr) return 0;
 
-  if (structureRanges.find(localPick.first) == structureRanges.end()) {
+  auto it = structureRangeStart.find(localPick.first);
+  if (it == structureRangeStart.end()) {
     exception("structure does not match any allocated pick range");
   }
 
-  std::tuple<size_t, size_t> range = structureRanges[localPick.first];
-  size_t rangeStart = std::get<0>(range);
-  size_t rangeEnd = std::get<1>(range);
-  return rangeStart + localPick.second;
+  return it->second + localPick.second;
 }
 
-std::pair<Structure*, size_t> pickAtScreenCoords(glm::vec2 screenCoords) {
-  int xInd, yInd;
-  std::tie(xInd, yInd) = view::screenCoordsToBufferInds(screenCoords);
-  return pickAtBufferCoords(xInd, yInd);
-}
+// == Pick buffer rendering
 
-std::pair<Structure*, size_t> pickAtBufferCoords(int xPos, int yPos) { return evaluatePickQuery(xPos, yPos); }
+namespace {
 
-std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos) {
+// The pick buffer is cached, and only re-rendered when the scene or the view might have changed since the last time.
+bool pickBufferValid = false;
+uint64_t pickBufferSceneGeneration = 0;
+glm::mat4 pickBufferViewMat;
+glm::mat4 pickBufferProjMat;
+int pickBufferWidth = -1;
+int pickBufferHeight = -1;
 
-  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
+// Returns false if the pick buffer could not be rendered
+bool ensurePickBufferRendered() {
 
-  // Be sure not to pick outside of buffer
-  if (xPos < -1 || xPos >= view::bufferWidth || yPos < -1 || yPos >= view::bufferHeight) {
-    return {nullptr, 0};
+  glm::mat4 viewMat = view::getCameraViewMatrix();
+  glm::mat4 projMat = view::getCameraPerspectiveMatrix();
+  if (pickBufferValid && pickBufferSceneGeneration == sceneGeneration() && pickBufferViewMat == viewMat &&
+      pickBufferProjMat == projMat && pickBufferWidth == view::bufferWidth && pickBufferHeight == view::bufferHeight) {
+    return true;
   }
 
   render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
@@ -143,27 +234,257 @@ std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos) {
   pickFramebuffer->resize(view::bufferWidth, view::bufferHeight);
   pickFramebuffer->setViewport(0, 0, view::bufferWidth, view::bufferHeight);
   pickFramebuffer->clearColor = glm::vec3{0., 0., 0.};
-  if (!pickFramebuffer->bindForRendering()) return {nullptr, 0};
+  if (!pickFramebuffer->bindForRendering()) {
+    pickBufferValid = false;
+    return false;
+  }
   pickFramebuffer->clear();
 
   // Render pick buffer
-  for (auto& cat : state::structures) {
-    for (auto& x : cat.second) {
-      x.second->drawPick();
-    }
+  drawStructuresPick();
+
+  // NOTE: read the generation after drawing, preparing pick data for the first time may mark the scene changed
+  pickBufferValid = true;
+  pickBufferSceneGeneration = sceneGeneration();
+  pickBufferViewMat = viewMat;
+  pickBufferProjMat = projMat;
+  pickBufferWidth = view::bufferWidth;
+  pickBufferHeight = view::bufferHeight;
+  return true;
+}
+
+bool inBufferBounds(int xPos, int yPos) {
+  return xPos >= 0 && xPos < view::bufferWidth && yPos >= 0 && yPos < view::bufferHeight;
+}
+
+// Buffer coordinates count rows from the top, the framebuffer counts from the bottom
+int bufferRowToFramebufferRow(int yPos) { return view::bufferHeight - 1 - yPos; }
+
+} // namespace
+
+void invalidatePickBuffer() { pickBufferValid = false; }
+
+std::pair<Structure*, size_t> pickAtScreenCoords(glm::vec2 screenCoords) {
+  int xInd, yInd;
+  std::tie(xInd, yInd) = view::screenCoordsToBufferInds(screenCoords);
+  return pickAtBufferCoords(xInd, yInd);
+}
+
+std::pair<Structure*, size_t> pickAtBufferCoords(int xPos, int yPos) { return evaluatePickQuery(xPos, yPos); }
+
+std::pair<Structure*, size_t> evaluatePickQuery(int xPos, int yPos) {
+
+  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
+  if (xPos == -1 && yPos == -1) {
+    ensurePickBufferRendered();
+    return {nullptr, 0};
   }
 
-  if (xPos == -1 || yPos == -1) {
+  // Be sure not to pick outside of buffer
+  if (!inBufferBounds(xPos, yPos)) {
     return {nullptr, 0};
   }
 
+  if (!ensurePickBufferRendered()) return {nullptr, 0};
+
   // Read from the pick buffer
-  std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, view::bufferHeight - yPos);
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, bufferRowToFramebufferRow(yPos));
   size_t globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
 
   return pick::globalIndexToLocal(globalInd);
 }
 
+std::vector<std::pair<Structure*, size_t>> pickAtScreenCoords(const std::vector<glm::vec2>& screenCoords) {
+  std::vector<glm::ivec2> bufferCoords;
+  bufferCoords.reserve(screenCoords.size());
+  for (const glm::vec2& c : screenCoords) {
+    int xInd, yInd;
+    std::tie(xInd, yInd) = view::screenCoordsToBufferInds(c);
+    bufferCoords.emplace_back(xInd, yInd);
+  }
+  return pickAtBufferCoords(bufferCoords);
+}
+
+std::vector<std::pair<Structure*, size_t>> pickAtBufferCoords(const std::vector<glm::ivec2>& bufferCoords) {
+
+  std::vector<std::pair<Structure*, size_t>> results(bufferCoords.size(), {nullptr, 0});
+
+  // Find the bounding rectangle of the queries
+  int xMin = view::bufferWidth;
+  int xMax = -1;
+  int yMin = view::bufferHeight;
+  int yMax = -1;
+  size_t nInBounds = 0;
+  for (const glm::ivec2& c : bufferCoords) {
+    if (!inBufferBounds(c.x, c.y)) continue;
+    xMin = std::min(xMin, c.x);
+    xMax = std::max(xMax, c.x);
+    yMin = std::min(yMin, c.y);
+    yMax = std::max(yMax, c.y);
+    nInBounds++;
+  }
+  if (nInBounds == 0) return results;
+
+  if (!ensurePickBufferRendered()) return results;
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+
+  std::vector<size_t> globalInds(bufferCoords.size(), 0);
+  auto decode = [&](const std::array<float, 4>& val) { return pick::vecToInd(glm::vec3{val[0], val[1], val[2]}); };
+
+  // Read the whole rectangle in one transfer, unless the queries are so scattered that this would read far more pixels
+  // than it needs to
+  size_t sizeX = xMax - xMin + 1;
+  size_t sizeY = yMax - yMin + 1;
+  if (sizeX * sizeY > 16 * nInBounds + 4096) {
+    for (size_t i = 0; i < bufferCoords.size(); i++) {
+      const glm::ivec2& c = bufferCoords[i];
+      if (!inBufferBounds(c.x, c.y)) continue;
+      globalInds[i] = decode(pickFramebuffer->readFloat4(c.x, bufferRowToFramebufferRow(c.y)));
+    }
+  } else {
+    int rowStart = bufferRowToFramebufferRow(yMax);
+    std::vector<std::array<float, 4>> region = pickFramebuffer->readFloat4Region(xMin, rowStart, sizeX, sizeY);
+    for (size_t i = 0; i < bufferCoords.size(); i++) {
+      const glm::ivec2& c = bufferCoords[i];
+      if (!inBufferBounds(c.x, c.y)) continue;
+      size_t row = bufferRowToFramebufferRow(c.y) - rowStart;
+      size_t col = c.x - xMin;
+      globalInds[i] = decode(region[row * sizeX + col]);
+    }
+  }
+
+  // (index 0 is "nothing", which resolves to no structure, as do the out-of-bounds entries)
+  return pick::globalIndexToLocal(globalInds);
+}
+
+namespace {
+
+// Read back the rectangle [xMin,xMax]x[yMin,yMax] of the pick buffer (in buffer coordinates, inclusive, and within the
+// buffer) in a single transfer, and gather the global index of every pixel for which includePixel(x,y) is true.
+template <typename F>
+std::vector<size_t> readRegionGlobalInds(int xMin, int xMax, int yMin, int yMax, F&& includePixel) {
+  std::vector<size_t> globalInds;
+  if (!ensurePickBufferRendered()) return globalInds;
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+
+  int sizeX = xMax - xMin + 1;
+  int sizeY = yMax - yMin + 1;
+  int rowStart = bufferRowToFramebufferRow(yMax);
+  std::vector<std::array<float, 4>> region = pickFramebuffer->readFloat4Region(xMin, rowStart, sizeX, sizeY);
+
+  size_t lastInd = 0;
+  for (int iRow = 0; iRow < sizeY; iRow++) {
+    int y = yMax - iRow;
+    for (int iCol = 0; iCol < sizeX; iCol++) {
+      int x = xMin + iCol;
+      if (!includePixel(x, y)) continue;
+      const std::array<float, 4>& val = region[static_cast<size_t>(iRow) * sizeX + iCol];
+      size_t globalInd = pick::vecToInd(glm::vec3{val[0], val[1], val[2]});
+
+      // skip the background, and runs of the same element along a row, which are very common
+      if (globalInd == 0 || globalInd == lastInd) continue;
+      globalInds.push_back(globalInd);
+      lastInd = globalInd;
+    }
+  }
+
+  return globalInds;
+}
+
+// Deduplicate global indices and sort them out by the structure they belong to
+std::unordered_map<Structure*, std::vector<size_t>> groupByStructure(std::vector<size_t>& globalInds) {
+  std::sort(globalInds.begin(), globalInds.end());
+  globalInds.erase(std::unique(globalInds.begin(), globalInds.end()), globalInds.end());
+
+  std::unordered_map<Structure*, std::vector<size_t>> result;
+  for (const std::pair<Structure*, size_t>& localPick : globalIndexToLocal(globalInds)) {
+    if (localPick.first == nullptr) continue;
+    result[localPick.first].push_back(localPick.second);
+  }
+  return result;
+}
+
+} // namespace
+
+std::unordered_map<Structure*, std::vector<size_t>> pickInScreenRect(glm::vec2 corner1, glm::vec2 corner2) {
+  int x1, y1, x2, y2;
+  std::tie(x1, y1) = view::screenCoordsToBufferInds(corner1);
+  std::tie(x2, y2) = view::screenCoordsToBufferInds(corner2);
+  return pickInBufferRect(glm::ivec2{x1, y1}, glm::ivec2{x2, y2});
+}
+
+std::unordered_map<Structure*, std::vector<size_t>> pickInBufferRect(glm::ivec2 corner1, glm::ivec2 corner2) {
+
+  // Clamp the rectangle to the buffer
+  int xMin = std::max(std::min(corner1.x, corner2.x), 0);
+  int xMax = std::min(std::max(corner1.x, corner2.x), view::bufferWidth - 1);
+  int yMin = std::max(std::min(corner1.y, corner2.y), 0);
+  int yMax = std::min(std::max(corner1.y, corner2.y), view::bufferHeight - 1);
+  if (xMin > xMax || yMin > yMax) return {};
+
+  std::vector<size_t> globalInds = readRegionGlobalInds(xMin, xMax, yMin, yMax, [](int, int) { return true; });
+  return groupByStructure(globalInds);
+}
+
+std::unordered_map<Structure*, std::vector<size_t>> pickInScreenLasso(const std::vector<glm::vec2>& polygon) {
+  glm::vec2 screenToBuffer{static_cast<float>(view::bufferWidth) / view::windowWidth,
+                           static_cast<float>(view::bufferHeight) / view::windowHeight};
+  std::vector<glm::vec2> bufferPolygon;
+  bufferPolygon.reserve(polygon.size());
+  for (const glm::vec2& p : polygon) {
+    bufferPolygon.push_back(p * screenToBuffer);
+  }
+  return pickInBufferLasso(bufferPolygon);
+}
+
+std::unordered_map<Structure*, std::vector<size_t>> pickInBufferLasso(const std::vector<glm::vec2>& polygon) {
+  if (polygon.size() < 3) return {};
+
+  // Bounding box of the polygon, clamped to the buffer
+  glm::vec2 lower = polygon[0];
+  glm::vec2 upper = polygon[0];
+  for (const glm::vec2& p : polygon) {
+    lower = glm::min(lower, p);
+    upper = glm::max(upper, p);
+  }
+  int xMin = std::max(static_cast<int>(std::floor(lower.x)), 0);
+  int xMax = std::min(static_cast<int>(std::ceil(upper.x)), view::bufferWidth - 1);
+  int yMin = std::max(static_cast<int>(std::floor(lower.y)), 0);
+  int yMax = std::min(static_cast<int>(std::ceil(upper.y)), view::bufferHeight - 1);
+  if (xMin > xMax || yMin > yMax) return {};
+
+  // Scanline fill: for each row, find where the polygon boundary crosses the line through the pixel centers. Pixels
+  // whose centers lie between alternating crossings are inside (even-odd rule).
+  std::vector<std::vector<float>> rowCrossings(yMax - yMin + 1);
+  for (size_t i = 0; i < polygon.size(); i++) {
+    glm::vec2 pA = polygon[i];
+    glm::vec2 pB = polygon[(i + 1) % polygon.size()];
+    if (pA.y == pB.y) continue;
+    if (pA.y > pB.y) std::swap(pA, pB);
+
+    // rows whose centers are in [pA.y, pB.y), so that shared vertices are counted exactly once
+    int rowLow = std::max(static_cast<int>(std::ceil(pA.y - 0.5f)), yMin);
+    int rowHigh = std::min(static_cast<int>(std::ceil(pB.y - 0.5f)) - 1, yMax);
+    for (int y = rowLow; y <= rowHigh; y++) {
+      float t = (y + 0.5f - pA.y) / (pB.y - pA.y);
+      rowCrossings[y - yMin].push_back(pA.x + t * (pB.x - pA.x));
+    }
+  }
+  for (std::vector<float>& crossings : rowCrossings) {
+    std::sort(crossings.begin(), crossings.end());
+  }
+
+  auto insideLasso = [&](int x, int y) {
+    const std::vector<float>& crossings = rowCrossings[y - yMin];
+    size_t nLeft = std::upper_bound(crossings.begin(), crossings.end(), x + 0.5f) - crossings.begin();
+    return nLeft % 2 == 1;
+  };
+
+  std::vector<size_t> globalInds = readRegionGlobalInds(xMin, xMax, yMin, yMax, insideLasso);
+  return groupByStructure(globalInds);
+}
+
 } // namespace pick
 
 
@@ -30,11 +30,19 @@ PointCloud::PointCloud(std::string name, std::vector<glm::vec3> points_)
       pointRenderMode(uniquePrefix() + "pointRenderMode", "sphere"),
       pointColor(uniquePrefix() + "pointColor", getNextUniqueColor()),
       pointRadius(uniquePrefix() + "pointRadius", relativeValue(0.005)),
-      material(uniquePrefix() + "material", "clay")
+      material(uniquePrefix() + "material", "clay"),
+      spatialChunking(uniquePrefix() + "spatialChunking", false),
+      levelOfDetail(uniquePrefix() + "levelOfDetail", false),
+      clusterOrder(this, uniquePrefix() + "clusterOrder", clusterOrderData),
+      lodOrder(this, uniquePrefix() + "lodOrder", lodOrderData)
 // clang-format on
 {
   cullWholeElements.setPassive(true);
   updateObjectSpaceBounds();
+
+  if (options::pointCloudLODThreshold > 0 && nPoints() >= options::pointCloudLODThreshold) {
+    levelOfDetail.setPassive(true);
+  }
 }
 
 // Helper to set uniforms
@@ -61,6 +69,40 @@ void PointCloud::setPointCloudUniforms(render::ShaderProgram& p) {
 
     p.setUniform("u_pointRadius", pointRadius.get().asAbsolute() / scalarQScale);
   }
+
+  setPointCloudDrawRanges(p);
+}
+
+void PointCloud::setPointCloudDrawRanges(render::ShaderProgram& p) {
+  if (!getLevelOfDetail() && !getSpatialChunking()) return;
+
+  DrawRangesKey key;
+  key.levelOfDetail = getLevelOfDetail();
+  key.maxPixelSpacing =
+      (key.levelOfDetail && view::viewIsChanging()) ? std::max(options::pointCloudLODPixelSpacing, 0.f) : 0.f;
+  key.cull = options::cullStructures;
+  if (key.maxPixelSpacing == 0.f && !key.cull) {
+    p.setDrawRanges({});
+    return;
+  }
+  key.modelViewProj = view::getCameraPerspectiveMatrix() * getModelView();
+  key.viewportHeight = static_cast<float>(render::engine->getCurrentViewport()[3]);
+  key.pad = getMaxPointRadius(); // pad the bounds by the largest radius a point can be drawn with
+  key.dataVersion = points.dataVersion();
+
+  if (!drawRangesSelected || !(key == drawRangesKey)) {
+    if (key.levelOfDetail) {
+      ensureLevelOfDetailBuilt();
+      drawRanges =
+          lodOctree.selectRanges(key.modelViewProj, key.viewportHeight, key.pad, key.maxPixelSpacing, key.cull);
+    } else {
+      ensureSpatialClustersBuilt();
+      drawRanges = spatialClusters.visibleRanges(key.modelViewProj, key.pad);
+    }
+    drawRangesKey = key;
+    drawRangesSelected = true;
+  }
+  p.setDrawRanges(drawRanges);
 }
 
 void PointCloud::draw() {
@@ -72,8 +114,9 @@ void PointCloud::draw() {
   // (this warning is only printed once, and only if verbosity is high enough)
   if (nPoints() > 500000 && getPointRenderMode() == PointRenderMode::Sphere &&
       !internal::pointCloudEfficiencyWarningReported && options::verbosity > 1) {
-    info("To render large point clouds efficiently, set their render mode to 'quad' instead of 'sphere'. (disable "
-         "these warnings by setting Polyscope's verbosity < 2)");
+    info("To render large point clouds efficiently, set their render mode to 'quad' instead of 'sphere', and consider "
+         "enabling level of detail with setLevelOfDetail(true). (disable these warnings by setting Polyscope's "
+         "verbosity < 2)");
     internal::pointCloudEfficiencyWarningReported = true;
   }
 
@@ -126,7 +169,7 @@ void PointCloud::drawPick() {
 
   // Set uniforms
   setStructureUniforms(*pickProgram);
-  setPointCloudUniforms(*pickProgram);
+  setPointCloudUniforms(*pickProgram); // (picks against the same points that were drawn for this view)
 
   pickProgram->draw();
 }
@@ -185,6 +228,37 @@ void PointCloud::setPointProgramGeometryAttributes(render::ShaderProgram& p) {
     PointCloudScalarQuantity& radQ = resolvePointRadiusQuantity();
     p.setAttribute("a_pointRadius", radQ.values.getRenderAttributeBuffer());
   }
+  if (getLevelOfDetail()) {
+    ensureLevelOfDetailBuilt();
+    p.setDrawOrder(lodOrder.getRenderAttributeBuffer());
+  } else if (getSpatialChunking()) {
+    ensureSpatialClustersBuilt();
+    p.setDrawOrder(clusterOrder.getRenderAttributeBuffer());
+  }
+}
+
+void PointCloud::ensureSpatialClustersBuilt() {
+  if (spatialClustersBuilt && spatialClustersDataVersion == points.dataVersion()) return;
+
+  points.ensureHostBufferPopulated();
+  spatialClusters = SpatialClusters(points.data, points.data);
+  clusterOrder.data = spatialClusters.getOrder();
+  clusterOrder.markHostBufferUpdated();
+
+  spatialClustersBuilt = true;
+  spatialClustersDataVersion = points.dataVersion();
+}
+
+void PointCloud::ensureLevelOfDetailBuilt() {
+  if (lodOctreeBuilt && lodOctreeDataVersion == points.dataVersion()) return;
+
+  points.ensureHostBufferPopulated();
+  lodOctree = PointLODOctree(points.data);
+  lodOrder.data = lodOctree.getOrder();
+  lodOrder.markHostBufferUpdated();
+
+  lodOctreeBuilt = true;
+  lodOctreeDataVersion = points.dataVersion();
 }
 
 std::string PointCloud::getShaderNameForRenderMode() {
@@ -309,6 +383,9 @@ void PointCloud::buildCustomOptionsUI() {
     material.manuallyChanged();
     setMaterial(material.get()); // trigger the other updates that happen on set()
   }
+
+  if (ImGui::MenuItem("Spatial Chunking", NULL, getSpatialChunking())) setSpatialChunking(!getSpatialChunking());
+  if (ImGui::MenuItem("Level of Detail", NULL, getLevelOfDetail())) setLevelOfDetail(!getLevelOfDetail());
 }
 
 void PointCloud::updateObjectSpaceBounds() {
@@ -330,6 +407,20 @@ void PointCloud::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  objectSpaceBoundsDataVersion = geometryDataVersion();
+}
+
+uint64_t PointCloud::geometryDataVersion() { return points.dataVersion(); }
+
+float PointCloud::getMaxPointRadius() {
+  if (pointRadiusQuantityName != "" && !pointRadiusQuantityAutoscale) {
+    return std::max(0., resolvePointRadiusQuantity().getDataRange().second);
+  }
+  return pointRadius.get().asAbsolute();
+}
+
+float PointCloud::getRenderPadding() {
+  return std::max(QuantityStructure<PointCloud>::getRenderPadding(), getMaxPointRadius());
 }
 
 
@@ -454,6 +545,22 @@ PointCloud* PointCloud::setMaterial(std::string m) {
 }
 std::string PointCloud::getMaterial() { return material.get(); }
 
+PointCloud* PointCloud::setSpatialChunking(bool newVal) {
+  spatialChunking = newVal;
+  refresh();
+  requestRedraw();
+  return this;
+}
+bool PointCloud::getSpatialChunking() { return spatialChunking.get(); }
+
+PointCloud* PointCloud::setLevelOfDetail(bool newVal) {
+  levelOfDetail = newVal;
+  refresh();
+  requestRedraw();
+  return this;
+}
+bool PointCloud::getLevelOfDetail() { return levelOfDetail.get(); }
+
 PointCloud* PointCloud::setPointRadius(double newVal, bool isRelative) {
   pointRadius = ScaledValue<float>(newVal, isRelative);
   polyscope::requestRedraw();
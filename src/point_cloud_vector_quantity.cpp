@@ -28,6 +28,8 @@ void PointCloudVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float PointCloudVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void PointCloudVectorQuantity::buildCustomUI() { buildVectorUI(); }
 
 void PointCloudVectorQuantity::buildPickUI(size_t ind) {
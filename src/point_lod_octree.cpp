@@ -0,0 +1,220 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/point_lod_octree.h"
+
+#include "polyscope/parallel.h"
+#include "polyscope/spatial_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace polyscope {
+
+namespace {
+
+typedef PointLODOctree::Node Node;
+
+// Build the subtree for the points order[start, end) in the cube with corner `cellLow` and width `cellSize`. The
+// points get reordered in place, and the nodes of the subtree are returned in depth-first order.
+std::vector<Node> buildSubtree(const std::vector<glm::vec3>& points, std::vector<uint32_t>& order, uint32_t start,
+                               uint32_t end, glm::vec3 cellLow, float cellSize, int depth) {
+  const uint32_t G = PointLODOctree::NODE_GRID;
+
+  Node node;
+  node.start = start;
+  node.end = end;
+  node.spacing = cellSize / G;
+
+  if (end - start <= PointLODOctree::LEAF_SIZE || depth >= PointLODOctree::MAX_DEPTH) {
+    node.ownEnd = end;
+  } else {
+    // The first point in each grid cell is a representative, move those to the front
+    float gridScale = cellSize > 0.f ? G / cellSize : 0.f;
+    std::vector<char> cellTaken(G * G * G, false);
+    uint32_t ownEnd = start;
+    for (uint32_t i = start; i < end; i++) {
+      glm::vec3 p = points[order[i]];
+      uint32_t cellInd = 0;
+      for (int j = 2; j >= 0; j--) {
+        float t = (p[j] - cellLow[j]) * gridScale;
+        if (!(t >= 0.f)) t = 0.f; // also catches nan
+        cellInd = cellInd * G + std::min(static_cast<uint32_t>(t), G - 1);
+      }
+      if (!cellTaken[cellInd]) {
+        cellTaken[cellInd] = true;
+        std::swap(order[ownEnd], order[i]);
+        ownEnd++;
+      }
+    }
+    node.ownEnd = ownEnd;
+  }
+
+  std::vector<Node> nodes{node};
+  if (node.ownEnd == end) {
+    nodes[0].nodeEnd = 1;
+  } else {
+
+    // Sort the rest into the octants of the cell
+    float halfSize = 0.5f * cellSize;
+    glm::vec3 cellCenter = cellLow + halfSize;
+    auto octantOf = [&](uint32_t iP) {
+      glm::vec3 p = points[iP];
+      return (p.x >= cellCenter.x ? 1 : 0) + (p.y >= cellCenter.y ? 2 : 0) + (p.z >= cellCenter.z ? 4 : 0);
+    };
+    std::array<uint32_t, 9> octantStart{};
+    for (uint32_t i = node.ownEnd; i < end; i++) {
+      octantStart[octantOf(order[i]) + 1]++;
+    }
+    octantStart[0] = node.ownEnd;
+    for (int c = 0; c < 8; c++) octantStart[c + 1] += octantStart[c];
+    std::vector<uint32_t> sorted(end - node.ownEnd);
+    std::array<uint32_t, 8> fill;
+    std::copy(octantStart.begin(), octantStart.begin() + 8, fill.begin());
+    for (uint32_t i = node.ownEnd; i < end; i++) {
+      int c = octantOf(order[i]);
+      sorted[fill[c] - node.ownEnd] = order[i];
+      fill[c]++;
+    }
+    std::copy(sorted.begin(), sorted.end(), order.begin() + node.ownEnd);
+    sorted = std::vector<uint32_t>();
+
+    // Children are independent, build them in parallel (nested calls run serially, so this only kicks in near the root)
+    std::array<std::vector<Node>, 8> childNodes;
+    parallelFor(
+        8,
+        [&](size_t cStart, size_t cEnd) {
+          for (size_t c = cStart; c < cEnd; c++) {
+            if (octantStart[c] == octantStart[c + 1]) continue;
+            glm::vec3 childLow{(c & 1) ? cellCenter.x : cellLow.x, (c & 2) ? cellCenter.y : cellLow.y,
+                               (c & 4) ? cellCenter.z : cellLow.z};
+            childNodes[c] =
+                buildSubtree(points, order, octantStart[c], octantStart[c + 1], childLow, halfSize, depth + 1);
+          }
+        },
+        1);
+
+    for (std::vector<Node>& child : childNodes) {
+      uint32_t offset = static_cast<uint32_t>(nodes.size());
+      for (Node& n : child) {
+        n.nodeEnd += offset;
+        nodes.push_back(n);
+      }
+    }
+    nodes[0].nodeEnd = static_cast<uint32_t>(nodes.size());
+  }
+
+  // Bounds of the subtree, from its own points and the children
+  glm::vec3 low{std::numeric_limits<float>::infinity()};
+  glm::vec3 high{-std::numeric_limits<float>::infinity()};
+  for (uint32_t i = start; i < nodes[0].ownEnd; i++) {
+    low = glm::min(low, points[order[i]]);
+    high = glm::max(high, points[order[i]]);
+  }
+  for (uint32_t iChild = 1; iChild < nodes.size(); iChild = nodes[iChild].nodeEnd) {
+    low = glm::min(low, nodes[iChild].bounds[0]);
+    high = glm::max(high, nodes[iChild].bounds[1]);
+  }
+  nodes[0].bounds = {low, high};
+
+  return nodes;
+}
+
+} // namespace
+
+PointLODOctree::PointLODOctree() {}
+
+PointLODOctree::PointLODOctree(const std::vector<glm::vec3>& points) {
+  if (points.empty()) return;
+
+  order.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    order[i] = static_cast<uint32_t>(i);
+  }
+
+  // The root is the bounding cube of the points
+  glm::vec3 low{std::numeric_limits<float>::infinity()};
+  glm::vec3 high{-std::numeric_limits<float>::infinity()};
+  for (const glm::vec3& p : points) {
+    low = glm::min(low, p);
+    high = glm::max(high, p);
+  }
+  float size = std::max(high.x - low.x, std::max(high.y - low.y, high.z - low.z));
+  if (!std::isfinite(size)) size = 0.f;
+
+  nodes = buildSubtree(points, order, 0, static_cast<uint32_t>(points.size()), low, size, 0);
+}
+
+size_t PointLODOctree::nPoints() const { return order.size(); }
+
+size_t PointLODOctree::nNodes() const { return nodes.size(); }
+
+const std::vector<uint32_t>& PointLODOctree::getOrder() const { return order; }
+
+const std::vector<PointLODOctree::Node>& PointLODOctree::getNodes() const { return nodes; }
+
+std::vector<std::array<uint32_t, 2>> PointLODOctree::selectRanges(const glm::mat4& modelViewProj, float viewportHeight,
+                                                                  float pad, float maxPixelSpacing,
+                                                                  bool cullFrustum) const {
+  std::vector<std::array<uint32_t, 2>> ranges;
+  auto addRange = [&](uint32_t start, uint32_t end) {
+    if (start == end) return;
+    if (!ranges.empty() && ranges.back()[1] == start) {
+      ranges.back()[1] = end;
+    } else {
+      ranges.push_back({start, end});
+    }
+  };
+
+  // Pixels per unit length at a clip-space w of 1 (lengths shrink by 1/w in perspective)
+  glm::vec3 clipY{modelViewProj[0][1], modelViewProj[1][1], modelViewProj[2][1]};
+  float pixelsPerLength = glm::length(clipY) * 0.5f * viewportHeight;
+
+  // Depth first, so the runs come out in order
+  std::vector<uint32_t> toVisit;
+  if (!nodes.empty()) toVisit.push_back(0);
+  while (!toVisit.empty()) {
+    uint32_t iNode = toVisit.back();
+    toVisit.pop_back();
+    const Node& node = nodes[iNode];
+
+    FrustumTest frustum = FrustumTest::Inside;
+    if (cullFrustum) {
+      frustum = testBoxAgainstFrustum(node.bounds, modelViewProj, pad);
+      if (frustum == FrustumTest::Outside) continue;
+    }
+
+    bool refine = true;
+    if (maxPixelSpacing > 0.f) {
+      // project the spacing at the nearest corner of the node
+      float minW = std::numeric_limits<float>::infinity();
+      for (int i = 0; i < 8; i++) {
+        glm::vec3 c{(i & 1) ? node.bounds[1].x : node.bounds[0].x, (i & 2) ? node.bounds[1].y : node.bounds[0].y,
+                    (i & 4) ? node.bounds[1].z : node.bounds[0].z};
+        minW = std::min(minW, (modelViewProj * glm::vec4(c, 1.)).w);
+      }
+      if (minW > 0.f) { // (otherwise the node reaches behind the camera, refine it)
+        refine = node.spacing * pixelsPerLength / minW > maxPixelSpacing;
+      }
+    }
+
+    if (!refine) {
+      addRange(node.start, node.ownEnd);
+    } else if (frustum == FrustumTest::Inside && maxPixelSpacing <= 0.f) {
+      addRange(node.start, node.end);
+    } else {
+      addRange(node.start, node.ownEnd);
+      std::vector<uint32_t> children;
+      for (uint32_t iChild = iNode + 1; iChild < node.nodeEnd; iChild = nodes[iChild].nodeEnd) {
+        children.push_back(iChild);
+      }
+      toVisit.insert(toVisit.end(), children.rbegin(), children.rend());
+    }
+  }
+
+  ensureDrawRangesNonEmpty(ranges);
+
+  return ranges;
+}
+
+} // namespace polyscope
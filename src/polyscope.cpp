@@ -9,6 +9,7 @@
 
 #include "imgui.h"
 
+#include "polyscope/implicit_helpers.h"
 #include "polyscope/options.h"
 #include "polyscope/pick.h"
 #include "polyscope/render/engine.h"
@@ -41,6 +42,8 @@ std::vector<ContextEntry> contextStack;
 int frameTickStack = 0;
 
 bool redrawNextFrame = true;
+uint64_t sceneGenerationCount = 0;
+uint64_t culledStructureDraws = 0;
 bool unshowRequested = false;
 
 // Some state about imgui windows to stack them
@@ -279,13 +282,30 @@ void frameTick() {
 
 void requestRedraw() { redrawNextFrame = true; }
 bool redrawRequested() { return redrawNextFrame; }
+void markSceneChanged() { sceneGenerationCount++; }
+uint64_t sceneGeneration() { return sceneGenerationCount; }
+uint64_t culledStructureDrawCount() { return culledStructureDraws; }
 
-void drawStructures() {
+void prepareStructuresForFrame() {
+  for (auto& catMap : state::structures) {
+    for (auto& s : catMap.second) {
+      if (s.second->isEnabled()) s.second->prepareFrame();
+    }
+  }
+
+  prepareProgressiveImplicitRendersForFrame();
+}
+
+void drawStructures(bool countCulled) {
 
   // Draw all off the structures registered with polyscope
 
   for (auto& catMap : state::structures) {
     for (auto& s : catMap.second) {
+      if (s.second->isEnabled() && s.second->isCulled()) {
+        if (countCulled) culledStructureDraws++;
+        continue;
+      }
       s.second->draw();
     }
   }
@@ -296,6 +316,18 @@ void drawStructures() {
   }
 }
 
+void drawStructuresPick() {
+  for (auto& catMap : state::structures) {
+    for (auto& s : catMap.second) {
+      if (s.second->isEnabled() && s.second->isCulled()) {
+        culledStructureDraws++;
+        continue;
+      }
+      s.second->drawPick();
+    }
+  }
+}
+
 void drawStructuresDelayed() {
   // "delayed" drawing allows structures to render things which should be rendered after most of the scene has been
   // drawn
@@ -444,6 +476,8 @@ void renderScene() {
 
   if (!options::renderScene) return;
 
+  prepareStructuresForFrame();
+
   if (render::engine->getTransparencyMode() == TransparencyMode::Pretty) {
     // Special depth peeling case: multiple render passes
     // We will perform several "peeled" rounds of rendering in to the usual scene buffer. After each, we will manually
@@ -466,7 +500,7 @@ void renderScene() {
       render::engine->clearSceneBuffer();
 
       render::engine->applyTransparencySettings();
-      drawStructures();
+      drawStructures(iPass == 0);
 
       // Draw ground plane, slicers, etc
       bool isRedraw = iPass > 0;
@@ -489,6 +523,41 @@ void renderScene() {
     }
 
 
+  } else if (render::engine->getTransparencyMode() == TransparencyMode::WeightedBlended) {
+    // Weighted blended transparency: two render passes, independent of the number of transparent layers
+    // The first pass draws all opaque fragments as usual. The second accumulates the transparent fragments in to a
+    // separate buffer with order-independent blending, which is then composited over the opaque result.
+
+    // Clear the accumulation buffers now, since clearing later would also clear the shared depth buffer
+    render::engine->setDepthMode(DepthMode::Less); // we need depth to be enabled for the clear to do anything
+    render::engine->sceneBufferWeighted->clear();
+
+    render::engine->bindSceneBuffer();
+    render::engine->setWeightedAccumulatePass(false);
+    render::engine->applyTransparencySettings();
+    drawStructures();
+
+    render::engine->groundPlane.draw();
+    renderSlicePlanes();
+
+    render::engine->applyTransparencySettings();
+    drawStructuresDelayed();
+
+    // Accumulate transparent fragments, depth tested against the opaque ones
+    render::engine->sceneBufferWeighted->bindForRendering();
+    render::engine->setWeightedAccumulatePass(true);
+    render::engine->applyTransparencySettings();
+    drawStructures(false);
+    render::engine->setWeightedAccumulatePass(false);
+
+    // Composite the transparent fragments over the opaque scene
+    render::engine->bindSceneBuffer();
+    render::engine->setDepthMode(DepthMode::Disable);
+    render::engine->setBlendMode(BlendMode::AlphaOver);
+    render::engine->compositeWeighted->draw();
+
+    render::engine->sceneBuffer->blitTo(render::engine->sceneBufferFinal.get());
+
   } else {
     // Normal case: single render pass
 
@@ -848,8 +917,15 @@ void draw(bool withUI, bool withContextCallback) {
 
   // Draw structures in the scene
   if (redrawNextFrame || options::alwaysRedraw) {
+    view::updateViewChanging(withUI);
+    redrawNextFrame = false; // (before rendering, so that redraws requested while preparing the frame are kept)
     renderScene();
-    redrawNextFrame = false;
+
+    // The scene may have been drawn at reduced detail while the camera moves, draw it again once the camera settles
+    if (view::viewIsChanging()) requestRedraw();
+
+    // Progressive implicit renders keep refining on the following frames
+    if (progressiveImplicitRendersRefining()) requestRedraw();
   }
   renderSceneToScreen();
 
@@ -1054,6 +1130,7 @@ void removeStructure(std::string type, std::string name, bool errorIfAbsent) {
     g.second->removeChildStructure(*s);
   }
   pick::resetSelectionIfStructure(s);
+  pick::releasePickBufferRange(s);
   sMap.erase(s->name);
   updateStructureExtents();
   return;
@@ -1248,6 +1325,9 @@ void processLazyProperties() {
 
 void updateStructureExtents() {
 
+  // (called whenever structures are added, removed or moved)
+  markSceneChanged();
+
   if (!options::automaticallyComputeSceneExtents) {
     return;
   }
@@ -33,6 +33,8 @@ bool Quantity::isEnabled() { return enabled.get(); }
 
 void Quantity::refresh() { requestRedraw(); }
 
+float Quantity::getRenderPadding() { return 0.; }
+
 std::string Quantity::niceName() { return name; }
 
 std::string Quantity::uniquePrefix() { return parent.uniquePrefix() + name + "#"; }
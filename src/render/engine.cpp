@@ -126,6 +126,8 @@ std::string modeName(const TransparencyMode& m) {
     return "Simple";
   case TransparencyMode::Pretty:
     return "Pretty";
+  case TransparencyMode::WeightedBlended:
+    return "Weighted Blended";
   }
   return "";
 }
@@ -270,6 +272,13 @@ ShaderProgram::ShaderProgram(DrawMode dm) : drawMode(dm), uniqueID(render::engin
   }
 }
 
+void ShaderProgram::setDrawRanges(const std::vector<std::array<uint32_t, 2>>& ranges) {
+  if (!ranges.empty() && (drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced)) {
+    exception("setDrawRanges() called, but instanced draw modes do not support draw ranges.");
+  }
+  drawRanges = ranges;
+}
+
 
 Engine::Engine() {}
 Engine::~Engine() {}
@@ -300,7 +309,8 @@ void Engine::buildEngineGui() {
     if (ImGui::TreeNode("Transparency")) {
 
       if (ImGui::BeginCombo("Mode", modeName(transparencyMode).c_str())) {
-        for (TransparencyMode m : {TransparencyMode::None, TransparencyMode::Simple, TransparencyMode::Pretty}) {
+        for (TransparencyMode m : {TransparencyMode::None, TransparencyMode::Simple, TransparencyMode::Pretty,
+                                   TransparencyMode::WeightedBlended}) {
           std::string mName = modeName(m);
           if (ImGui::Selectable(mName.c_str(), transparencyMode == m)) {
             options::transparencyMode = m;
@@ -328,6 +338,11 @@ void Engine::buildEngineGui() {
         }
         break;
       }
+      case TransparencyMode::WeightedBlended: {
+        ImGui::TextWrapped("Approximate transparent rendering which draws all transparent objects in one pass. Much "
+                           "cheaper than Pretty for layered scenes, but surfaces at similar depths blend together.");
+        break;
+      }
       }
 
       ImGui::TreePop();
@@ -461,6 +476,7 @@ void Engine::resizeScreenBuffers() {
   sceneBuffer->resize(ssaaFactor * width, ssaaFactor * height);
   sceneBufferFinal->resize(ssaaFactor * width, ssaaFactor * height);
   sceneDepthMinFrame->resize(ssaaFactor * width, ssaaFactor * height);
+  sceneBufferWeighted->resize(ssaaFactor * width, ssaaFactor * height);
 }
 
 void Engine::setScreenBufferViewports() {
@@ -474,6 +490,7 @@ void Engine::setScreenBufferViewports() {
   sceneBuffer->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
   sceneBufferFinal->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
   sceneDepthMinFrame->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
+  sceneBufferWeighted->setViewport(ssaaFactor * xStart, ssaaFactor * yStart, ssaaFactor * sizeX, ssaaFactor * sizeY);
 }
 
 bool Engine::bindSceneBuffer() {
@@ -522,6 +539,8 @@ void Engine::applyLightingTransform(std::shared_ptr<TextureBuffer>& texture) {
       break;
     case TransparencyMode::Pretty:
       break;
+    case TransparencyMode::WeightedBlended:
+      break;
     }
 
     mapLight = render::engine->requestShader("MAP_LIGHT", resolveRules, render::ShaderReplacementDefaults::Process);
@@ -602,6 +621,12 @@ void Engine::setTransparencyMode(TransparencyMode newMode) {
         defaultRules_sceneObject.end());
     break;
   }
+  case TransparencyMode::WeightedBlended: {
+    defaultRules_sceneObject.erase(std::remove(defaultRules_sceneObject.begin(), defaultRules_sceneObject.end(),
+                                               "TRANSPARENCY_WEIGHTED_STRUCTURE"),
+                                   defaultRules_sceneObject.end());
+    break;
+  }
   }
 
   transparencyMode = newMode;
@@ -619,6 +644,10 @@ void Engine::setTransparencyMode(TransparencyMode newMode) {
     defaultRules_sceneObject.push_back("TRANSPARENCY_PEEL_STRUCTURE");
     break;
   }
+  case TransparencyMode::WeightedBlended: {
+    defaultRules_sceneObject.push_back("TRANSPARENCY_WEIGHTED_STRUCTURE");
+    break;
+  }
   }
 
   // Regenerate _all_ the things
@@ -635,10 +664,16 @@ bool Engine::transparencyEnabled() {
     return true;
   case TransparencyMode::Pretty:
     return true;
+  case TransparencyMode::WeightedBlended:
+    return true;
   }
   return false;
 }
 
+void Engine::setWeightedAccumulatePass(bool newVal) { weightedAccumulatePass = newVal; }
+
+bool Engine::getWeightedAccumulatePass() { return weightedAccumulatePass; }
+
 void Engine::setSSAAFactor(int newVal) {
   if (newVal < 1 || newVal > 4) exception("ssaaFactor must be one of 1,2,3,4");
   ssaaFactor = newVal;
@@ -688,6 +723,23 @@ void Engine::allocateGlobalBuffersAndPrograms() {
     sceneBufferFinal->clearAlpha = 0.0;
   }
 
+  { // Accumulation buffer for weighted blended transparency
+    // The color buffer holds the weighted sum of premultiplied colors in rgb and the product of (1 - alpha) in a, the
+    // second buffer holds the sum of weights. The depth buffer is shared with the scene buffer, so transparent
+    // fragments are tested against the opaque ones.
+    sceneColorWeighted = generateTextureBuffer(TextureFormat::RGBA16F, view::bufferWidth, view::bufferHeight);
+    sceneWeightSum = generateTextureBuffer(TextureFormat::R16F, view::bufferWidth, view::bufferHeight);
+
+    sceneBufferWeighted = generateFrameBuffer(view::bufferWidth, view::bufferHeight);
+    sceneBufferWeighted->addColorBuffer(sceneColorWeighted);
+    sceneBufferWeighted->addColorBuffer(sceneWeightSum);
+    sceneBufferWeighted->addDepthBuffer(sceneDepth);
+    sceneBufferWeighted->setDrawBuffers();
+
+    sceneBufferWeighted->clearColor = glm::vec3{0., 0., 0.};
+    sceneBufferWeighted->clearAlpha = 1.0;
+  }
+
   { // Alternate display buffer
     std::shared_ptr<RenderBuffer> sceneColorAlt =
         generateRenderBuffer(RenderBufferType::ColorAlpha, view::bufferWidth, view::bufferHeight);
@@ -734,6 +786,11 @@ void Engine::allocateGlobalBuffersAndPrograms() {
     compositePeel->setAttribute("a_position", screenTrianglesCoords());
     compositePeel->setTextureFromBuffer("t_image", sceneColor.get());
 
+    compositeWeighted = render::engine->requestShader("COMPOSITE_WEIGHTED", {}, render::ShaderReplacementDefaults::Process);
+    compositeWeighted->setAttribute("a_position", screenTrianglesCoords());
+    compositeWeighted->setTextureFromBuffer("t_accum", sceneColorWeighted.get());
+    compositeWeighted->setTextureFromBuffer("t_weightSum", sceneWeightSum.get());
+
     copyDepth = render::engine->requestShader("DEPTH_COPY", {}, render::ShaderReplacementDefaults::Process);
     copyDepth->setAttribute("a_position", screenTrianglesCoords());
     copyDepth->setTextureFromBuffer("t_depth", sceneDepth.get());
@@ -1152,6 +1209,22 @@ void Engine::loadDefaultColorMaps() {
 }
 
 
+bool Engine::gatherAttributeBuffer(AttributeBuffer& source, AttributeBuffer& indices, AttributeBuffer& target) {
+  // default: not supported by this backend, callers fall back on a host-side expansion
+  return false;
+}
+
+bool Engine::extractIsosurface(TextureBuffer& values, float isoLevel, glm::vec3 boundMin, glm::vec3 spacing,
+                               AttributeBuffer& positions, AttributeBuffer& indices) {
+  // default: not supported by this backend, callers fall back on host-side extraction
+  return false;
+}
+
+bool Engine::reduceScalarStatistics(AttributeBuffer& values, size_t binCount, float rangeEPS, ScalarStatistics& stats) {
+  // default: not supported by this backend, callers read the values back and compute the statistics on the host
+  return false;
+}
+
 void Engine::showTextureInImGuiWindow(std::string windowName, TextureBuffer* buffer) {
   ImGui::Begin(windowName.c_str());
 
@@ -1,6 +1,7 @@
 // Copyright 2018-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
 
 
+#include <algorithm>
 #include <vector>
 
 #include "polyscope/render/managed_buffer.h"
@@ -14,6 +15,38 @@
 namespace polyscope {
 namespace render {
 
+namespace {
+
+// When coalescing dirty ranges, ranges separated by at most this many clean entries get merged. Re-uploading a few
+// clean (but still valid) entries is cheaper than issuing another transfer.
+const size_t DIRTY_RANGE_MERGE_GAP = 64;
+
+// Convert a list of {start, count} dirty ranges to a sorted list of disjoint [start, end) ranges, clamped to `size`.
+std::vector<std::array<size_t, 2>> coalesceDirtyRanges(const std::vector<std::array<size_t, 2>>& ranges,
+                                                       size_t size) {
+
+  std::vector<std::array<size_t, 2>> sorted;
+  sorted.reserve(ranges.size());
+  for (const std::array<size_t, 2>& r : ranges) {
+    if (r[0] >= size || r[1] == 0) continue;
+    sorted.push_back({r[0], std::min(r[0] + r[1], size)});
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  std::vector<std::array<size_t, 2>> merged;
+  for (const std::array<size_t, 2>& r : sorted) {
+    if (!merged.empty() && r[0] <= merged.back()[1] + DIRTY_RANGE_MERGE_GAP) {
+      merged.back()[1] = std::max(merged.back()[1], r[1]);
+    } else {
+      merged.push_back(r);
+    }
+  }
+
+  return merged;
+}
+
+} // namespace
+
 template <typename T>
 ManagedBuffer<T>::ManagedBuffer(ManagedBufferRegistry* registry_, const std::string& name_, std::vector<T>& data_)
     : name(name_), uniqueID(internal::getNextUniqueID()), registry(registry_), data(data_), dataGetsComputed(false),
@@ -121,6 +154,8 @@ std::vector<T>& ManagedBuffer<T>::getPopulatedHostBufferRef() {
 template <typename T>
 void ManagedBuffer<T>::markHostBufferUpdated() {
   hostBufferIsPopulated = true;
+  dataVersionCount++;
+  markSceneChanged();
 
   // If the data is stored in the device-side buffers, update it as needed
   if (renderAttributeBuffer) {
@@ -139,6 +174,49 @@ void ManagedBuffer<T>::markHostBufferUpdated() {
   }
 }
 
+template <typename T>
+void ManagedBuffer<T>::markHostBufferUpdated(size_t start, size_t count) {
+  markHostBufferUpdated(std::vector<std::array<size_t, 2>>{{start, count}});
+}
+
+template <typename T>
+void ManagedBuffer<T>::markHostBufferUpdated(std::vector<std::array<size_t, 2>> ranges) {
+
+  if (!hostBufferIsPopulated) {
+    exception("ManagedBuffer " + name +
+              " partial update requires a populated host buffer. Call ensureHostBufferPopulated() before writing.");
+  }
+
+  std::vector<std::array<size_t, 2>> dirtyRanges = coalesceDirtyRanges(ranges, data.size());
+  if (dirtyRanges.empty()) return;
+  dataVersionCount++;
+  markSceneChanged();
+
+  // If the device-side buffer does not match the host buffer, there is nothing to patch; upload everything instead.
+  if (renderAttributeBuffer && renderAttributeBuffer->getDataSize() != static_cast<int64_t>(data.size())) {
+    markHostBufferUpdated();
+    return;
+  }
+
+  if (renderAttributeBuffer) {
+    for (const std::array<size_t, 2>& r : dirtyRanges) {
+      renderAttributeBuffer->setDataRange(data, r[0], r[0], r[1] - r[0]);
+    }
+    requestRedraw();
+  }
+
+  if (renderTextureBuffer) {
+    // textures do not support sub-range updates, re-fill the whole thing
+    renderTextureBuffer->setData(data);
+    requestRedraw();
+  }
+
+  if (deviceBufferType == DeviceBufferType::Attribute) {
+    updateIndexedViews(dirtyRanges);
+    requestRedraw();
+  }
+}
+
 template <typename T>
 T ManagedBuffer<T>::getValue(size_t ind) {
 
@@ -233,6 +311,16 @@ bool ManagedBuffer<T>::hasData() {
   return false;
 }
 
+template <typename T>
+bool ManagedBuffer<T>::dataIsOnlyOnDevice() {
+  return currentCanonicalDataSource() == CanonicalDataSource::RenderBuffer;
+}
+
+template <typename T>
+uint64_t ManagedBuffer<T>::dataVersion() const {
+  return dataVersionCount;
+}
+
 template <typename T>
 DeviceBufferType ManagedBuffer<T>::getDeviceBufferType() {
   return deviceBufferType;
@@ -340,6 +428,8 @@ void ManagedBuffer<T>::markRenderAttributeBufferUpdated() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
 
   invalidateHostBuffer();
+  dataVersionCount++;
+  markSceneChanged();
   updateIndexedViews();
   requestRedraw();
 }
@@ -349,6 +439,8 @@ void ManagedBuffer<T>::markRenderTextureBufferUpdated() {
   checkDeviceBufferTypeIsTexture();
 
   invalidateHostBuffer();
+  dataVersionCount++;
+  markSceneChanged();
   requestRedraw();
 }
 
@@ -403,18 +495,122 @@ void ManagedBuffer<T>::updateIndexedViews() {
     render::ManagedBuffer<uint32_t>& indices = *std::get<0>(existingViewTup);
     render::AttributeBuffer& viewBuffer = *viewBufferPtr;
 
-    // apply the indexing and set the data
+    // prefer expanding the view directly on the device
+    if (invokeBufferIndexCopyProgram(indices, viewBuffer)) continue;
+
+    // otherwise, apply the indexing on the host and set the data
+    ensureHostBufferPopulated();
     indices.ensureHostBufferPopulated();
     std::vector<T> expandData = gather(data, indices.data);
     viewBuffer.setData(expandData);
+  }
 
-    // TODO fornow, only CPU-side updating is supported. Add direct GPU-side support using the bufferIndexCopyProgram
-    // below.
+  requestRedraw();
+}
+
+template <typename T>
+void ManagedBuffer<T>::updateIndexedViews(const std::vector<std::array<size_t, 2>>& dirtyRanges) {
+  checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
+
+  removeDeletedIndexedViews(); // periodic filtering
+
+  std::vector<uint32_t> dirtyViewInds;
+  std::vector<std::array<size_t, 2>> viewRanges;
+  std::vector<T> expandData;
+
+  for (std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>& existingViewTup :
+       existingIndexedViews) {
+
+    std::shared_ptr<render::AttributeBuffer> viewBufferPtr = std::get<1>(existingViewTup).lock();
+    if (!viewBufferPtr) continue; // skip if it has been deleted (will be removed eventually)
+
+    // note: index buffer must still be alive here. we can't check it, you will just get memory errors
+    // if it has been deleted
+    render::ManagedBuffer<uint32_t>& indices = *std::get<0>(existingViewTup);
+    render::AttributeBuffer& viewBuffer = *viewBufferPtr;
+    indices.ensureHostBufferPopulated();
+
+    if (viewBuffer.getDataSize() != static_cast<int64_t>(indices.data.size())) {
+      // sizes are out of sync, fall back on re-expanding everything
+      viewBuffer.setData(gather(data, indices.data));
+      continue;
+    }
+
+    // Find all view entries which reference a dirty entry
+    IndexedViewInverse& inverse = getIndexedViewInverse(indices);
+    dirtyViewInds.clear();
+    for (const std::array<size_t, 2>& r : dirtyRanges) {
+      dirtyViewInds.insert(dirtyViewInds.end(), inverse.viewInds.begin() + inverse.offsets[r[0]],
+                           inverse.viewInds.begin() + inverse.offsets[r[1]]);
+    }
+    if (dirtyViewInds.empty()) continue;
+
+    // If most of the view is dirty anyway, just re-expand the whole thing
+    if (2 * dirtyViewInds.size() > indices.data.size()) {
+      if (!invokeBufferIndexCopyProgram(indices, viewBuffer)) {
+        viewBuffer.setData(gather(data, indices.data));
+      }
+      continue;
+    }
+
+    // Apply the indexing for each dirty range of the view and push just those entries
+    viewRanges.clear();
+    for (uint32_t i : dirtyViewInds) {
+      viewRanges.push_back({i, 1});
+    }
+    viewRanges = coalesceDirtyRanges(viewRanges, indices.data.size());
+    for (const std::array<size_t, 2>& r : viewRanges) {
+      expandData.resize(r[1] - r[0]);
+      for (size_t i = r[0]; i < r[1]; i++) {
+        expandData[i - r[0]] = data[indices.data[i]];
+      }
+      viewBuffer.setDataRange(expandData, 0, r[0], expandData.size());
+    }
   }
 
   requestRedraw();
 }
 
+template <typename T>
+typename ManagedBuffer<T>::IndexedViewInverse& ManagedBuffer<T>::getIndexedViewInverse(ManagedBuffer<uint32_t>& indices) {
+
+  IndexedViewInverse* cached = nullptr;
+  for (IndexedViewInverse& inverse : indexedViewInverses) {
+    if (inverse.indicesID == indices.uniqueID) cached = &inverse;
+  }
+  if (cached != nullptr && cached->indicesVersion == indices.dataVersion() &&
+      cached->offsets.size() == data.size() + 1) {
+    return *cached;
+  }
+
+  // Build it as a counting sort of the view entries by the data entry they reference
+  indices.ensureHostBufferPopulated();
+  const std::vector<uint32_t>& inds = indices.data;
+  IndexedViewInverse inverse;
+  inverse.indicesID = indices.uniqueID;
+  inverse.indicesVersion = indices.dataVersion();
+  inverse.offsets.assign(data.size() + 1, 0);
+  for (uint32_t ind : inds) {
+    if (ind >= data.size()) exception("ManagedBuffer " + name + " index buffer " + indices.name + " out of bounds");
+    inverse.offsets[ind + 1]++;
+  }
+  for (size_t i = 0; i < data.size(); i++) {
+    inverse.offsets[i + 1] += inverse.offsets[i];
+  }
+  inverse.viewInds.resize(inds.size());
+  std::vector<uint32_t> fillPos(inverse.offsets.begin(), inverse.offsets.end() - 1);
+  for (size_t i = 0; i < inds.size(); i++) {
+    inverse.viewInds[fillPos[inds[i]]++] = static_cast<uint32_t>(i);
+  }
+
+  if (cached != nullptr) { // stale, the indices or the size of the data changed
+    *cached = std::move(inverse);
+    return *cached;
+  }
+  indexedViewInverses.push_back(std::move(inverse));
+  return indexedViewInverses.back();
+}
+
 template <typename T>
 void ManagedBuffer<T>::removeDeletedIndexedViews() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
@@ -427,6 +623,19 @@ void ManagedBuffer<T>::removeDeletedIndexedViews() {
           [](const std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>& entry)
               -> bool { return std::get<1>(entry).expired(); }),
       existingIndexedViews.end());
+
+  // also drop any cached inverses which no longer correspond to a view
+  // (all remaining views are alive, so it is safe to dereference their index buffers)
+  indexedViewInverses.erase(
+      std::remove_if(indexedViewInverses.begin(), indexedViewInverses.end(),
+                     [&](const IndexedViewInverse& inverse) -> bool {
+                       for (std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>&
+                                entry : existingIndexedViews) {
+                         if (std::get<0>(entry)->uniqueID == inverse.indicesID) return false;
+                       }
+                       return true;
+                     }),
+      indexedViewInverses.end());
 }
 
 template <typename T>
@@ -482,19 +691,14 @@ typename ManagedBuffer<T>::CanonicalDataSource ManagedBuffer<T>::currentCanonica
 
 
 template <typename T>
-void ManagedBuffer<T>::ensureHaveBufferIndexCopyProgram() {
-  if (bufferIndexCopyProgram) return;
+bool ManagedBuffer<T>::invokeBufferIndexCopyProgram(ManagedBuffer<uint32_t>& indices,
+                                                     render::AttributeBuffer& viewBuffer) {
 
-  // sanity check
-  if (!renderAttributeBuffer) exception("ManagedBuffer " + name + " asked to copy indices, but has no buffers");
+  // Both the canonical data and the indices must already live on the device
+  if (!renderAttributeBuffer || !indices.renderAttributeBuffer) return false;
+  if (viewBuffer.getDataSize() != indices.renderAttributeBuffer->getDataSize()) return false;
 
-  // TODO allocate the transform feedback program
-}
-
-template <typename T>
-void ManagedBuffer<T>::invokeBufferIndexCopyProgram() {
-  ensureHaveBufferIndexCopyProgram();
-  bufferIndexCopyProgram->draw();
+  return render::engine->gatherAttributeBuffer(*renderAttributeBuffer, *indices.renderAttributeBuffer, viewBuffer);
 }
 
 // === Interact with the buffer registry
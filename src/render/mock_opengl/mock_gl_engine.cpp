@@ -3,6 +3,7 @@
 #ifdef POLYSCOPE_BACKEND_OPENGL_MOCK_ENABLED
 #include "polyscope/render/mock_opengl/mock_gl_engine.h"
 
+#include "polyscope/marching_cubes.h"
 #include "polyscope/messages.h"
 #include "polyscope/options.h"
 #include "polyscope/polyscope.h"
@@ -29,6 +30,9 @@
 
 #include "stb_image.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace polyscope {
 namespace render {
 namespace backend_openGL_mock {
@@ -72,6 +76,18 @@ void GLAttributeBuffer::checkArray(int testArrayCount) {
   }
 }
 
+void GLAttributeBuffer::allocate(size_t count) {
+  bind();
+  if (!isSet() || count > bufferSize) {
+    setFlag = true;
+    uint64_t newSize = count;
+    newSize = std::max(newSize, 2 * bufferSize); // if we're expanding, at-least double
+    bufferSize = newSize;
+  }
+  dataSize = count;
+  contents.resize(bufferSize * sizeInBytes(dataType) * arrayCount);
+  checkGLError();
+}
 
 template <typename T>
 void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
@@ -87,6 +103,8 @@ void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
 
   // do the actual copy
   dataSize = data.size();
+  contents.resize(bufferSize * sizeof(T));
+  if (!data.empty()) std::memcpy(&contents.front(), &data.front(), data.size() * sizeof(T));
 
   checkGLError();
 }
@@ -165,6 +183,111 @@ void GLAttributeBuffer::setData(const std::vector<glm::uvec4>& data) {
   setData_helper(data);
 }
 
+// === set ranges of values
+
+template <typename T>
+void GLAttributeBuffer::setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t bufferStart,
+                                            size_t count) {
+  if (count == 0) return;
+  if (!isSet() || bufferStart + count > static_cast<size_t>(getDataSize()) || dataStart + count > data.size()) {
+    exception("bad setDataRange");
+  }
+  bind();
+
+  std::memcpy(&contents[bufferStart * sizeof(T)], &data[dataStart], count * sizeof(T));
+
+  checkGLError();
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector2Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart,
+                                     size_t bufferStart, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart,
+                                     size_t bufferStart, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart,
+                                     size_t bufferStart, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector4Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<float>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<double>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Float);
+  if (dataStart + count > data.size()) exception("bad setDataRange");
+
+  // Convert the input range to floats
+  std::vector<float> floatData(count);
+  for (size_t i = 0; i < count; i++) {
+    floatData[i] = static_cast<float>(data[dataStart + i]);
+  }
+
+  setDataRange_helper(floatData, 0, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Int);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector2UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector3UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector4UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
 
 // === get single data values
 
@@ -173,6 +296,7 @@ T GLAttributeBuffer::getData_helper(size_t ind) {
   if (!isSet() || ind >= static_cast<size_t>(getDataSize() * getArrayCount())) exception("bad getData");
   bind();
   T readValue{};
+  if ((ind + 1) * sizeof(T) <= contents.size()) std::memcpy(&readValue, &contents[ind * sizeof(T)], sizeof(T));
   return readValue;
 }
 
@@ -223,6 +347,9 @@ std::vector<T> GLAttributeBuffer::getDataRange_helper(size_t start, size_t count
   if (!isSet() || start + count > static_cast<size_t>(getDataSize() * getArrayCount())) exception("bad getData");
   bind();
   std::vector<T> readValues(count);
+  if (count > 0 && (start + count) * sizeof(T) <= contents.size()) {
+    std::memcpy(&readValues.front(), &contents[start * sizeof(T)], count * sizeof(T));
+  }
   return readValues;
 }
 
@@ -292,6 +419,8 @@ GLTextureBuffer::GLTextureBuffer(TextureFormat format_, unsigned int size1D, con
 GLTextureBuffer::GLTextureBuffer(TextureFormat format_, unsigned int size1D, const float* data)
     : TextureBuffer(1, format_, size1D) {
 
+  if (data != nullptr && dimension(format) == 1) scalarContents.assign(data, data + getTotalSize());
+
   checkGLError();
 
   setFilterMode(FilterMode::Nearest);
@@ -310,6 +439,8 @@ GLTextureBuffer::GLTextureBuffer(TextureFormat format_, unsigned int sizeX_, uns
 GLTextureBuffer::GLTextureBuffer(TextureFormat format_, unsigned int sizeX_, unsigned int sizeY_, const float* data)
     : TextureBuffer(2, format_, sizeX_, sizeY_) {
 
+  if (data != nullptr && dimension(format) == 1) scalarContents.assign(data, data + getTotalSize());
+
   checkGLError();
 
   setFilterMode(FilterMode::Nearest);
@@ -329,6 +460,8 @@ GLTextureBuffer::GLTextureBuffer(TextureFormat format_, unsigned int sizeX_, uns
                                  const float* data)
     : TextureBuffer(3, format_, sizeX_, sizeY_, sizeZ_) {
 
+  if (data != nullptr && dimension(format) == 1) scalarContents.assign(data, data + getTotalSize());
+
   checkGLError();
 
   setFilterMode(FilterMode::Nearest);
@@ -339,6 +472,7 @@ GLTextureBuffer::~GLTextureBuffer() {}
 void GLTextureBuffer::resize(unsigned int newLen) {
 
   TextureBuffer::resize(newLen);
+  scalarContents.clear();
 
   bind();
   if (dim == 1) {
@@ -351,6 +485,7 @@ void GLTextureBuffer::resize(unsigned int newLen) {
 void GLTextureBuffer::resize(unsigned int newX, unsigned int newY) {
 
   TextureBuffer::resize(newX, newY);
+  scalarContents.clear();
 
   bind();
   if (dim == 2) {
@@ -363,6 +498,7 @@ void GLTextureBuffer::resize(unsigned int newX, unsigned int newY) {
 void GLTextureBuffer::resize(unsigned int newX, unsigned int newY, unsigned int newZ) {
 
   TextureBuffer::resize(newX, newY, newZ);
+  scalarContents.clear();
 
   bind();
   if (dim == 3) {
@@ -421,6 +557,7 @@ void GLTextureBuffer::setData(const std::vector<float>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  if (dimension(format) == 1) scalarContents = data;
 
   switch (dim) {
   case 1:
@@ -440,6 +577,7 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
   if (data.size() != getTotalSize()) {
     exception("OpenGL error: texture buffer data is not the right size.");
   }
+  if (dimension(format) == 1) scalarContents.assign(data.begin(), data.end());
 
   switch (dim) {
   case 1:
@@ -490,6 +628,7 @@ uint32_t GLTextureBuffer::getNativeBufferID() { return 77; };
 
 std::vector<float> GLTextureBuffer::getDataScalar() {
   if (dimension(format) != 1) exception("called getDataScalar on texture which does not have a 1 dimensional format");
+  if (scalarContents.size() == getTotalSize()) return scalarContents;
   std::vector<float> outData;
   outData.resize(getSizeX() * getSizeY());
 
@@ -643,15 +782,38 @@ bool GLFrameBuffer::bindForRendering() {
 
 void GLFrameBuffer::clear() {
   if (!bindForRendering()) return;
+  filledPixels.clear();
 }
 
 std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
   // Read from the buffer
-  std::array<float, 4> result = {1., 2., 3., 4.};
+  auto it = filledPixels.find(std::make_pair(xPos, yPos));
+  if (it != filledPixels.end()) return it->second;
+  std::array<float, 4> result = {clearColor.x, clearColor.y, clearColor.z, clearAlpha};
+
+  return result;
+}
 
+std::vector<std::array<float, 4>> GLFrameBuffer::readFloat4Region(int xStart, int yStart, int sizeX, int sizeY) {
+  // Read from the buffer
+  std::vector<std::array<float, 4>> result;
+  result.reserve(static_cast<size_t>(sizeX) * sizeY);
+  for (int iY = 0; iY < sizeY; iY++) {
+    for (int iX = 0; iX < sizeX; iX++) {
+      result.push_back(readFloat4(xStart + iX, yStart + iY));
+    }
+  }
   return result;
 }
 
+void GLFrameBuffer::fillFloat4Region(int xStart, int yStart, int sizeX, int sizeY, std::array<float, 4> val) {
+  for (int iY = 0; iY < sizeY; iY++) {
+    for (int iX = 0; iX < sizeX; iX++) {
+      filledPixels[std::make_pair(xStart + iX, yStart + iY)] = val;
+    }
+  }
+}
+
 float GLFrameBuffer::readDepth(int xPos, int yPos) {
   // Read from the buffer
   float result = 0.5;
@@ -1427,6 +1589,24 @@ void GLShaderProgram::setIndex(std::shared_ptr<AttributeBuffer> externalBuffer)
   checkGLError();
 }
 
+void GLShaderProgram::setDrawOrder(std::shared_ptr<AttributeBuffer> orderBuffer) {
+  if (useIndex || drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced) {
+    throw std::invalid_argument("Tried to setDrawOrder() when program drawMode is indexed or instanced");
+  }
+
+  std::shared_ptr<GLAttributeBuffer> engineOrderBuff = std::dynamic_pointer_cast<GLAttributeBuffer>(orderBuffer);
+  if (!engineOrderBuff) throw std::invalid_argument("draw order buffer engine type cast failed");
+  if (engineOrderBuff->getType() != RenderDataType::UInt) {
+    throw std::invalid_argument("draw order buffer should be of type uint");
+  }
+
+  indexBuffer = engineOrderBuff;
+  indexSizeMult = 1;
+  useDrawOrder = true;
+
+  checkGLError();
+}
+
 // Check that uniforms and attributes are all set and of consistent size
 void GLShaderProgram::validateData() {
   // Check uniforms
@@ -1473,7 +1653,7 @@ void GLShaderProgram::validateData() {
   }
 
   // Set the size
-  if (useIndex) {
+  if (useIndex || useDrawOrder) {
     drawDataLength = static_cast<unsigned int>(indexSizeMult * indexBuffer->getDataSize());
   } else {
     drawDataLength = static_cast<unsigned int>(attributeSize);
@@ -1548,14 +1728,56 @@ void GLShaderProgram::draw() {
     break;
   }
 
+  // Tally up what would have been submitted
+  uint64_t primitiveCount = 0;
+  if (drawRanges.empty()) {
+    primitiveCount = primitivesInRange(drawDataLength);
+  } else {
+    for (const std::array<uint32_t, 2>& r : drawRanges) {
+      uint32_t end = std::min(r[1], drawDataLength);
+      if (r[0] < end) primitiveCount += primitivesInRange(end - r[0]);
+    }
+  }
+  glEngine->submittedPrimitiveCount += primitiveCount;
+
   if (usePrimitiveRestart) {
   }
 
   checkGLError();
 }
 
+uint64_t GLShaderProgram::primitivesInRange(uint32_t count) {
+  switch (drawMode) {
+  case DrawMode::Points:
+    return count;
+  case DrawMode::Lines:
+  case DrawMode::IndexedLines:
+    return count / 2;
+  case DrawMode::LinesAdjacency:
+  case DrawMode::IndexedLinesAdjacency:
+    return count / 4;
+  case DrawMode::Triangles:
+  case DrawMode::IndexedTriangles:
+    return count / 3;
+  case DrawMode::TrianglesAdjacency:
+    return count / 6;
+  case DrawMode::IndexedLineStrip: // (ignoring primitive restarts)
+    return count < 2 ? 0 : count - 1;
+  case DrawMode::IndexedLineStripAdjacency:
+    return count < 4 ? 0 : count - 3;
+  case DrawMode::TrianglesInstanced:
+    return static_cast<uint64_t>(count / 3) * instanceCount;
+  case DrawMode::TriangleStripInstanced:
+    return static_cast<uint64_t>(count < 3 ? 0 : count - 2) * instanceCount;
+  }
+  return 0;
+}
+
 MockGLEngine::MockGLEngine() {}
 
+uint64_t MockGLEngine::getSubmittedPrimitiveCount() const { return submittedPrimitiveCount; }
+void MockGLEngine::resetSubmittedPrimitiveCount() { submittedPrimitiveCount = 0; }
+
 void MockGLEngine::initialize() {
 
   if (options::verbosity > 0) {
@@ -1683,6 +1905,64 @@ void MockGLEngine::setFrontFaceCCW(bool newVal) {
   frontFaceCCW = newVal;
 }
 
+bool MockGLEngine::extractIsosurface(TextureBuffer& valuesBuff, float isoLevel, glm::vec3 boundMin, glm::vec3 spacing,
+                                     AttributeBuffer& positions, AttributeBuffer& indices) {
+
+  GLTextureBuffer* values = dynamic_cast<GLTextureBuffer*>(&valuesBuff);
+  if (!values || values->getDimension() != 3 || values->getFormat() != TextureFormat::R32F) return false;
+
+  // sanity checks
+  if (positions.getType() != RenderDataType::Vector3Float || positions.getArrayCount() != 1) {
+    exception("isosurface position buffer must have Vector3Float type");
+  }
+  if (indices.getType() != RenderDataType::UInt) exception("isosurface index buffer must have UInt type");
+
+  // Visit the cells in the same order as the OpenGL geometry shader, and emit the same unshared vertices
+  std::vector<float> nodeValues = values->getDataScalar();
+  if (nodeValues.size() != values->getTotalSize()) return false; // contents unknown, extract on the host
+  glm::ivec3 nodeDim{values->getSizeX(), values->getSizeY(), values->getSizeZ()};
+  auto value = [&](glm::ivec3 node) {
+    return -isoLevel + nodeValues[(static_cast<size_t>(node.z) * nodeDim.y + node.y) * nodeDim.x + node.x];
+  };
+
+  std::vector<glm::vec3> outPositions;
+  for (int iZ = 0; iZ + 1 < nodeDim.z; iZ++) {
+    for (int iY = 0; iY + 1 < nodeDim.y; iY++) {
+      for (int iX = 0; iX + 1 < nodeDim.x; iX++) {
+        glm::ivec3 cell{iX, iY, iZ};
+
+        int config = 0;
+        for (int iCorner = 0; iCorner < 8; iCorner++) {
+          glm::ivec3 offset{(iCorner >> 2) & 1, (iCorner >> 1) & 1, iCorner & 1};
+          if (value(cell + offset) < 0.f) config |= (1 << iCorner);
+        }
+        if (config == 0 || config == 255) continue;
+
+        uint64_t c = marchingCubesCase(config);
+        int nTris = static_cast<int>(c & 15u);
+        for (int slot = 1; slot <= 3 * nTris; slot++) {
+          const MarchingCubesEdge& edge = marchingCubesEdges[(c >> (4 * slot)) & 15u];
+          glm::ivec3 nodeA = cell + glm::ivec3(edge.dx, edge.dy, edge.dz);
+          glm::ivec3 nodeB = nodeA;
+          nodeB[edge.axis] += 1;
+          float vA = value(nodeA);
+          float vB = value(nodeB);
+          glm::vec3 p{nodeA};
+          p[edge.axis] += vA / (vA - vB);
+          outPositions.push_back(p * spacing + boundMin);
+        }
+      }
+    }
+  }
+
+  std::vector<uint32_t> outIndices(outPositions.size());
+  for (size_t i = 0; i < outIndices.size(); i++) outIndices[i] = static_cast<uint32_t>(i);
+
+  positions.setData(outPositions);
+  indices.setData(outIndices);
+  return true;
+}
+
 // == Factories
 
 
@@ -1916,6 +2196,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("TEXTURE_DRAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("TEXTURE_DRAW_RAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RAW_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("COMPOSITE_PEEL", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_PEEL}, DrawMode::Triangles);
+  registerShaderProgram("COMPOSITE_WEIGHTED", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_WEIGHTED}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_COPY", {TEXTURE_DRAW_VERT_SHADER, DEPTH_COPY}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_TO_MASK", {TEXTURE_DRAW_VERT_SHADER, DEPTH_TO_MASK}, DrawMode::Triangles);
   registerShaderProgram("SCALAR_TEXTURE_COLORMAP", {TEXTURE_DRAW_VERT_SHADER, SCALAR_TEXTURE_COLORMAP}, DrawMode::Triangles);
@@ -1936,6 +2217,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("TRANSPARENCY_RESOLVE_SIMPLE", TRANSPARENCY_RESOLVE_SIMPLE);
   registerShaderRule("TRANSPARENCY_PEEL_STRUCTURE", TRANSPARENCY_PEEL_STRUCTURE);
   registerShaderRule("TRANSPARENCY_PEEL_GROUND", TRANSPARENCY_PEEL_GROUND);
+  registerShaderRule("TRANSPARENCY_WEIGHTED_STRUCTURE", TRANSPARENCY_WEIGHTED_STRUCTURE);
   
   registerShaderRule("GENERATE_VIEW_POS", GENERATE_VIEW_POS);
   registerShaderRule("COMPUTE_SHADE_NORMAL_FROM_POSITION", COMPUTE_SHADE_NORMAL_FROM_POSITION);
@@ -1993,6 +2275,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   
   // volume gridcube things
   registerShaderRule("GRIDCUBE_PROPAGATE_NODE_VALUE", GRIDCUBE_PROPAGATE_NODE_VALUE);
+  registerShaderRule("GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE", GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE);
   registerShaderRule("GRIDCUBE_PROPAGATE_CELL_VALUE", GRIDCUBE_PROPAGATE_CELL_VALUE);
   registerShaderRule("GRIDCUBE_WIREFRAME", GRIDCUBE_WIREFRAME);
   registerShaderRule("GRIDCUBE_CONSTANT_PICK", GRIDCUBE_CONSTANT_PICK);
@@ -2026,6 +2309,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("SLICE_TETS_PROPAGATE_VECTOR", SLICE_TETS_PROPAGATE_VECTOR);
   registerShaderRule("SLICE_TETS_VECTOR_COLOR", SLICE_TETS_VECTOR_COLOR);
   registerShaderRule("SLICE_TETS_MESH_WIREFRAME", SLICE_TETS_MESH_WIREFRAME);
+  registerShaderRule("SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE", SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE);
 
   // clang-format on
 };
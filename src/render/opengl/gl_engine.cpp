@@ -5,6 +5,7 @@
 #ifdef POLYSCOPE_BACKEND_OPENGL3_ENABLED
 #include "polyscope/render/opengl/gl_engine.h"
 
+#include "polyscope/marching_cubes.h"
 #include "polyscope/messages.h"
 #include "polyscope/options.h"
 #include "polyscope/polyscope.h"
@@ -31,6 +32,8 @@
 #include "stb_image.h"
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <set>
 
 namespace polyscope {
@@ -134,6 +137,25 @@ inline GLenum colorAttachNum(const unsigned int i) {
   return GL_COLOR_ATTACHMENT0;
 }
 
+inline GLenum native(const DrawMode& x) {
+  switch (x) {
+    case DrawMode::Points:                    return GL_POINTS;
+    case DrawMode::LinesAdjacency:            return GL_LINES_ADJACENCY;
+    case DrawMode::Triangles:                 return GL_TRIANGLES;
+    case DrawMode::TrianglesAdjacency:        return GL_TRIANGLES_ADJACENCY;
+    case DrawMode::IndexedTriangles:          return GL_TRIANGLES;
+    case DrawMode::Lines:                     return GL_LINES;
+    case DrawMode::IndexedLines:              return GL_LINES;
+    case DrawMode::IndexedLineStrip:          return GL_LINE_STRIP;
+    case DrawMode::IndexedLinesAdjacency:     return GL_LINES_ADJACENCY;
+    case DrawMode::IndexedLineStripAdjacency: return GL_LINE_STRIP_ADJACENCY;
+    case DrawMode::TrianglesInstanced:        return GL_TRIANGLES;
+    case DrawMode::TriangleStripInstanced:    return GL_TRIANGLE_STRIP;
+  }
+  exception("bad enum");
+  return GL_POINTS;
+}
+
 // clang-format on
 
 
@@ -232,6 +254,19 @@ GLAttributeBuffer::~GLAttributeBuffer() {
 
 void GLAttributeBuffer::bind() { glBindBuffer(getTarget(), VBOLoc); }
 
+void GLAttributeBuffer::allocate(size_t count) {
+  bind();
+  if (!isSet() || count > bufferSize) {
+    setFlag = true;
+    uint64_t newSize = count;
+    newSize = std::max(newSize, 2 * bufferSize); // if we're expanding, at-least double
+    glBufferData(getTarget(), newSize * sizeInBytes(dataType) * arrayCount, NULL, GL_STATIC_DRAW);
+    bufferSize = newSize;
+  }
+  dataSize = count;
+  checkGLError();
+}
+
 void GLAttributeBuffer::checkType(RenderDataType targetType) {
   if (dataType != targetType) {
     throw std::invalid_argument("Tried to set GLAttributeBuffer with wrong type. Actual type: " +
@@ -343,6 +378,110 @@ void GLAttributeBuffer::setData(const std::vector<glm::uvec4>& data) {
   setData_helper(data);
 }
 
+// === set ranges of values
+
+template <typename T>
+void GLAttributeBuffer::setDataRange_helper(const std::vector<T>& data, size_t dataStart, size_t bufferStart,
+                                            size_t count) {
+  if (count == 0) return;
+  if (!isSet() || bufferStart + count > static_cast<size_t>(getDataSize()) || dataStart + count > data.size()) {
+    exception("bad setDataRange");
+  }
+  bind();
+  glBufferSubData(getTarget(), bufferStart * sizeof(T), count * sizeof(T), &data[dataStart]);
+
+  checkGLError();
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec2>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector2Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec3>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t dataStart,
+                                     size_t bufferStart, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t dataStart,
+                                     size_t bufferStart, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t dataStart,
+                                     size_t bufferStart, size_t count) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec4>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector4Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<float>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<double>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Float);
+  if (dataStart + count > data.size()) exception("bad setDataRange");
+
+  // Convert the input range to floats
+  std::vector<float> floatData(count);
+  for (size_t i = 0; i < count; i++) {
+    floatData[i] = static_cast<float>(data[dataStart + i]);
+  }
+
+  setDataRange_helper(floatData, 0, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<int32_t>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Int);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<uint32_t>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec2>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector2UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec3>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector3UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec4>& data, size_t dataStart, size_t bufferStart,
+                                     size_t count) {
+  checkType(RenderDataType::Vector4UInt);
+  setDataRange_helper(data, dataStart, bufferStart, count);
+}
+
 // === get single data values
 
 template <typename T>
@@ -970,6 +1109,20 @@ std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
   return result;
 }
 
+std::vector<std::array<float, 4>> GLFrameBuffer::readFloat4Region(int xStart, int yStart, int sizeX, int sizeY) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::vector<std::array<float, 4>> result(static_cast<size_t>(sizeX) * sizeY);
+  if (result.empty()) return result;
+  glReadPixels(xStart, yStart, sizeX, sizeY, GL_RGBA, GL_FLOAT, &result.front());
+
+  return result;
+}
+
 float GLFrameBuffer::readDepth(int xPos, int yPos) {
 
   // TODO does no error checking for the case where no depth buffer is attached
@@ -1959,6 +2112,28 @@ void GLShaderProgram::setIndex(std::shared_ptr<AttributeBuffer> externalBuffer)
   checkGLError();
 }
 
+void GLShaderProgram::setDrawOrder(std::shared_ptr<AttributeBuffer> orderBuffer) {
+  if (useIndex || drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced) {
+    throw std::invalid_argument("Tried to setDrawOrder() when program drawMode is indexed or instanced");
+  }
+
+  std::shared_ptr<GLAttributeBuffer> engineOrderBuff = std::dynamic_pointer_cast<GLAttributeBuffer>(orderBuffer);
+  if (!engineOrderBuff) throw std::invalid_argument("draw order buffer engine type cast failed");
+  if (engineOrderBuff->getType() != RenderDataType::UInt) {
+    throw std::invalid_argument("draw order buffer should be of type uint");
+  }
+
+  indexBuffer = engineOrderBuff;
+  indexSizeMult = 1;
+  useDrawOrder = true;
+
+  // the order is drawn as an element buffer, like an index
+  bindVAO();
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, engineOrderBuff->getHandle());
+
+  checkGLError();
+}
+
 // Check that uniforms and attributes are all set and of consistent size
 void GLShaderProgram::validateData() {
 
@@ -2010,7 +2185,7 @@ void GLShaderProgram::validateData() {
   }
 
   // Set the size
-  if (useIndex) {
+  if (useIndex || useDrawOrder) {
     drawDataLength = static_cast<unsigned int>(indexSizeMult * indexBuffer->getDataSize());
   } else {
     drawDataLength = static_cast<unsigned int>(attributeSize);
@@ -2057,6 +2232,50 @@ void GLShaderProgram::draw() {
 
   activateTextures();
 
+  if (useDrawOrder || !drawRanges.empty()) {
+    drawSubsets();
+  } else {
+    drawAll();
+  }
+
+  if (usePrimitiveRestart) {
+    glDisable(GL_PRIMITIVE_RESTART);
+  }
+
+  checkGLError();
+}
+
+void GLShaderProgram::drawSubsets() {
+
+  // Gather the ranges, clamped to the data which is actually there. No ranges means everything (in the draw order).
+  std::vector<GLint> starts;
+  std::vector<GLsizei> counts;
+  std::vector<const void*> offsets;
+  auto addRange = [&](uint32_t start, uint32_t end) {
+    end = std::min(end, drawDataLength);
+    if (start >= end) return;
+    starts.push_back(static_cast<GLint>(start));
+    counts.push_back(static_cast<GLsizei>(end - start));
+    offsets.push_back(reinterpret_cast<const void*>(static_cast<size_t>(start) * sizeof(uint32_t)));
+  };
+  if (drawRanges.empty()) {
+    addRange(0, drawDataLength);
+  } else {
+    for (const std::array<uint32_t, 2>& r : drawRanges) {
+      addRange(r[0], r[1]);
+    }
+  }
+  if (counts.empty()) return;
+
+  if (useIndex || useDrawOrder) {
+    glMultiDrawElements(native(drawMode), &counts.front(), GL_UNSIGNED_INT, &offsets.front(),
+                        static_cast<GLsizei>(counts.size()));
+  } else {
+    glMultiDrawArrays(native(drawMode), &starts.front(), &counts.front(), static_cast<GLsizei>(counts.size()));
+  }
+}
+
+void GLShaderProgram::drawAll() {
   switch (drawMode) {
   case DrawMode::Points:
     glDrawArrays(GL_POINTS, 0, drawDataLength);
@@ -2100,16 +2319,16 @@ void GLShaderProgram::draw() {
     glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, drawDataLength, instanceCount);
     break;
   }
-
-  if (usePrimitiveRestart) {
-    glDisable(GL_PRIMITIVE_RESTART);
-  }
-
-  checkGLError();
 }
 
 GLEngine::GLEngine() {}
-GLEngine::~GLEngine() {}
+GLEngine::~GLEngine() {
+  for (std::pair<const std::string, ProgramHandle>& entry : gatherProgramCache) {
+    glDeleteProgram(entry.second);
+  }
+  if (isosurfaceProgram != 0) glDeleteProgram(isosurfaceProgram);
+  if (sequenceProgram != 0) glDeleteProgram(sequenceProgram);
+}
 
 void GLEngine::checkError(bool fatal) { checkGLError(fatal); }
 
@@ -2190,6 +2409,10 @@ void GLEngine::setBlendMode(BlendMode newMode) {
     glEnable(GL_BLEND);
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
     break;
+  case BlendMode::WeightedAccumulate:
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA); // sum colors, multiply (1 - alpha) in to a
+    break;
   case BlendMode::Add:
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE);
@@ -2234,6 +2457,16 @@ void GLEngine::applyTransparencySettings() {
     setDepthMode(DepthMode::Less);
     break;
   }
+  case TransparencyMode::WeightedBlended: {
+    if (weightedAccumulatePass) {
+      setBlendMode(BlendMode::WeightedAccumulate);
+      setDepthMode(DepthMode::LEqualReadOnly);
+    } else {
+      setBlendMode(BlendMode::AlphaOver);
+      setDepthMode(DepthMode::Less);
+    }
+    break;
+  }
   }
 }
 
@@ -2247,6 +2480,603 @@ void GLEngine::setFrontFaceCCW(bool newVal) {
   }
 }
 
+// == Device-side buffer operations
+
+std::string GLEngine::getGLSLVersionDirective() {
+  if (registeredShaderRules.find("GLSL_VERSION") != registeredShaderRules.end()) {
+    for (const std::pair<std::string, std::string>& replacement : registeredShaderRules["GLSL_VERSION"].replacements) {
+      if (replacement.first == "GLSL_VERSION") return replacement.second + "\n";
+    }
+  }
+  exception("No shader replacement rule with name [GLSL_VERSION] registered.");
+  return "";
+}
+
+ProgramHandle GLEngine::getGatherProgram(RenderDataType dataType, int arrayCount) {
+
+  std::string key = renderDataTypeName(dataType) + "#" + std::to_string(arrayCount);
+  if (gatherProgramCache.find(key) != gatherProgramCache.end()) {
+    return gatherProgramCache[key];
+  }
+
+  // clang-format off
+  std::string glslType;
+  bool isInteger = false;
+  switch (dataType) {
+    case RenderDataType::Float:          glslType = "float"; break;
+    case RenderDataType::Vector2Float:   glslType = "vec2"; break;
+    case RenderDataType::Vector3Float:   glslType = "vec3"; break;
+    case RenderDataType::Vector4Float:   glslType = "vec4"; break;
+    case RenderDataType::Int:            glslType = "int"; isInteger = true; break;
+    case RenderDataType::UInt:           glslType = "uint"; isInteger = true; break;
+    case RenderDataType::Vector2UInt:    glslType = "uvec2"; isInteger = true; break;
+    case RenderDataType::Vector3UInt:    glslType = "uvec3"; isInteger = true; break;
+    case RenderDataType::Vector4UInt:    glslType = "uvec4"; isInteger = true; break;
+    case RenderDataType::Matrix44Float:  exception("cannot gather matrix-valued attribute buffers"); break;
+  }
+  // clang-format on
+
+  // A vertex shader which just passes each attribute through to a transform feedback output.
+  // Array-valued attributes get one input/output per array entry, interleaved into the output buffer.
+  std::string src = getGLSLVersionDirective();
+  std::vector<std::string> outNames;
+  for (int i = 0; i < arrayCount; i++) {
+    std::string iStr = std::to_string(i);
+    src += "in " + glslType + " a_val" + iStr + ";\n";
+    src += std::string(isInteger ? "flat " : "") + "out " + glslType + " v_val" + iStr + ";\n";
+    outNames.push_back("v_val" + iStr);
+  }
+  src += "void main() {\n";
+  for (int i = 0; i < arrayCount; i++) {
+    std::string iStr = std::to_string(i);
+    src += "  v_val" + iStr + " = a_val" + iStr + ";\n";
+  }
+  src += "}\n";
+
+  ShaderHandle shader = glCreateShader(GL_VERTEX_SHADER);
+  const char* srcPtr = src.c_str();
+  glShaderSource(shader, 1, &srcPtr, nullptr);
+  glCompileShader(shader);
+  GLint status;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (!status) {
+    printShaderInfoLog(shader);
+    exception("[polyscope] GL gather shader compile failed");
+  }
+
+  ProgramHandle program = glCreateProgram();
+  glAttachShader(program, shader);
+  for (int i = 0; i < arrayCount; i++) {
+    glBindAttribLocation(program, i, ("a_val" + std::to_string(i)).c_str());
+  }
+  std::vector<const char*> outNamePtrs;
+  for (const std::string& n : outNames) {
+    outNamePtrs.push_back(n.c_str());
+  }
+  glTransformFeedbackVaryings(program, outNamePtrs.size(), &outNamePtrs.front(), GL_INTERLEAVED_ATTRIBS);
+  glLinkProgram(program);
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (!status) {
+    printProgramInfoLog(program);
+    exception("[polyscope] GL gather program link failed");
+  }
+  glDeleteShader(shader);
+  checkGLError();
+
+  gatherProgramCache[key] = program;
+  return program;
+}
+
+bool GLEngine::gatherAttributeBuffer(AttributeBuffer& sourceBuff, AttributeBuffer& indicesBuff,
+                                     AttributeBuffer& targetBuff) {
+
+  GLAttributeBuffer* source = dynamic_cast<GLAttributeBuffer*>(&sourceBuff);
+  GLAttributeBuffer* indices = dynamic_cast<GLAttributeBuffer*>(&indicesBuff);
+  GLAttributeBuffer* target = dynamic_cast<GLAttributeBuffer*>(&targetBuff);
+  if (!source || !indices || !target) return false;
+
+  // sanity checks
+  if (indices->getType() != RenderDataType::UInt) exception("gather index buffer must have UInt type");
+  if (source->getType() != target->getType() || source->getArrayCount() != target->getArrayCount()) {
+    exception("gather source and target buffers must have the same type");
+  }
+  if (!source->isSet() || !indices->isSet() || !target->isSet() ||
+      target->getDataSize() != indices->getDataSize()) {
+    exception("gather buffers must be allocated, with one target entry per index");
+  }
+  if (indices->getDataSize() == 0) return true;
+
+  ProgramHandle program = getGatherProgram(source->getType(), source->getArrayCount());
+
+  // Save the state we are about to change
+  GLint prevProgram, prevVertexArray, prevArrayBuffer, prevFeedbackBuffer;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &prevVertexArray);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &prevArrayBuffer);
+  glGetIntegerv(GL_TRANSFORM_FEEDBACK_BUFFER_BINDING, &prevFeedbackBuffer);
+
+  glUseProgram(program);
+
+  // Set up the source buffer as vertex attributes, and the index buffer as the element array
+  AttributeHandle vao;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+
+  RenderDataType dataType = source->getType();
+  int arrayCount = source->getArrayCount();
+  GLsizei elemBytes = sizeInBytes(dataType);
+  GLint nComp = elemBytes / 4;
+  source->bind();
+  for (int i = 0; i < arrayCount; i++) {
+    glEnableVertexAttribArray(i);
+    void* offset = reinterpret_cast<void*>(static_cast<size_t>(i * elemBytes));
+    switch (dataType) {
+    case RenderDataType::Int:
+      glVertexAttribIPointer(i, nComp, GL_INT, elemBytes * arrayCount, offset);
+      break;
+    case RenderDataType::UInt:
+    case RenderDataType::Vector2UInt:
+    case RenderDataType::Vector3UInt:
+    case RenderDataType::Vector4UInt:
+      glVertexAttribIPointer(i, nComp, GL_UNSIGNED_INT, elemBytes * arrayCount, offset);
+      break;
+    default:
+      glVertexAttribPointer(i, nComp, GL_FLOAT, GL_FALSE, elemBytes * arrayCount, offset);
+      break;
+    }
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->getHandle());
+
+  // Draw each index as a point, capturing the outputs in index order
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, target->getHandle());
+  glEnable(GL_RASTERIZER_DISCARD);
+  glBeginTransformFeedback(GL_POINTS);
+  glDrawElements(GL_POINTS, static_cast<GLsizei>(indices->getDataSize()), GL_UNSIGNED_INT, 0);
+  glEndTransformFeedback();
+  glDisable(GL_RASTERIZER_DISCARD);
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+  // Clean up, and restore the state
+  glBindVertexArray(prevVertexArray);
+  glDeleteVertexArrays(1, &vao);
+  glBindBuffer(GL_ARRAY_BUFFER, prevArrayBuffer);
+  glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, prevFeedbackBuffer);
+  glUseProgram(prevProgram);
+  checkGLError();
+
+  return true;
+}
+
+namespace {
+
+ShaderHandle compileShaderStage(GLenum stage, const std::string& src) {
+  ShaderHandle shader = glCreateShader(stage);
+  const char* srcPtr = src.c_str();
+  glShaderSource(shader, 1, &srcPtr, nullptr);
+  glCompileShader(shader);
+  GLint status;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (!status) {
+    printShaderInfoLog(shader);
+    exception("[polyscope] GL utility shader compile failed");
+  }
+  return shader;
+}
+
+// Link the given stages in to a program, after `beforeLink(program)`, and release the stages
+ProgramHandle linkUtilityProgram(const std::vector<ShaderHandle>& shaders,
+                                 const std::function<void(ProgramHandle)>& beforeLink) {
+  ProgramHandle program = glCreateProgram();
+  for (ShaderHandle shader : shaders) {
+    glAttachShader(program, shader);
+  }
+  beforeLink(program);
+  glLinkProgram(program);
+  GLint status;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (!status) {
+    printProgramInfoLog(program);
+    exception("[polyscope] GL utility program link failed");
+  }
+  for (ShaderHandle shader : shaders) {
+    glDeleteShader(shader);
+  }
+  checkGLError();
+
+  return program;
+}
+
+// Compile and link a program whose outputs are captured by transform feedback. Pass an empty geometry shader source to
+// use only a vertex shader.
+ProgramHandle compileTransformFeedbackProgram(const std::string& vertSrc, const std::string& geomSrc,
+                                              const std::string& outName) {
+  std::vector<ShaderHandle> shaders{compileShaderStage(GL_VERTEX_SHADER, vertSrc)};
+  if (!geomSrc.empty()) shaders.push_back(compileShaderStage(GL_GEOMETRY_SHADER, geomSrc));
+  return linkUtilityProgram(shaders, [&](ProgramHandle program) {
+    const char* outNamePtr = outName.c_str();
+    glTransformFeedbackVaryings(program, 1, &outNamePtr, GL_INTERLEAVED_ATTRIBS);
+  });
+}
+
+// Compile and link a plain vertex + fragment program
+ProgramHandle compileDrawProgram(const std::string& vertSrc, const std::string& fragSrc) {
+  std::vector<ShaderHandle> shaders{compileShaderStage(GL_VERTEX_SHADER, vertSrc),
+                                    compileShaderStage(GL_FRAGMENT_SHADER, fragSrc)};
+  return linkUtilityProgram(shaders, [](ProgramHandle) {});
+}
+
+} // namespace
+
+ProgramHandle GLEngine::getIsosurfaceProgram() {
+  if (isosurfaceProgram != 0) return isosurfaceProgram;
+
+  // One point per grid cell; the geometry shader emits the cell's triangles, which are captured by transform feedback.
+  // The lookup tables are baked in as constants, with each 64-bit case split into two words.
+  std::string caseTable;
+  for (int config = 0; config < 256; config++) {
+    uint64_t c = marchingCubesCase(config);
+    caseTable += (config == 0 ? "" : ", ") + std::to_string(static_cast<uint32_t>(c & 0xFFFFFFFFu)) + "u, " +
+                 std::to_string(static_cast<uint32_t>(c >> 32)) + "u";
+  }
+  std::string edgeTable;
+  for (int iE = 0; iE < 12; iE++) {
+    const MarchingCubesEdge& e = marchingCubesEdges[iE];
+    edgeTable += (iE == 0 ? "" : ", ") + std::string("ivec4(") + std::to_string(e.axis) + ", " + std::to_string(e.dx) +
+                 ", " + std::to_string(e.dy) + ", " + std::to_string(e.dz) + ")";
+  }
+
+  std::string vertSrc = getGLSLVersionDirective() + R"(
+    flat out int v_cellInd;
+    void main() { v_cellInd = gl_VertexID; }
+  )";
+
+  std::string geomSrc = getGLSLVersionDirective() + R"(
+    layout(points) in;
+    layout(triangle_strip, max_vertices = 15) out;
+    flat in int v_cellInd[];
+    out vec3 v_position;
+    uniform sampler3D t_value;
+    uniform ivec3 u_nodeDim;
+    uniform float u_isoLevel;
+    uniform vec3 u_boundMin;
+    uniform vec3 u_spacing;
+    const uint caseTable[512] = uint[512]()" +
+                        caseTable + R"();
+    const ivec4 edgeTable[12] = ivec4[12]()" +
+                        edgeTable + R"();
+
+    float value(ivec3 node) { return -u_isoLevel + texelFetch(t_value, node, 0).r; }
+
+    void main() {
+      ivec3 cellDim = u_nodeDim - 1;
+      int iCell = v_cellInd[0];
+      ivec3 cell = ivec3(iCell % cellDim.x, (iCell / cellDim.x) % cellDim.y, iCell / (cellDim.x * cellDim.y));
+
+      int config = 0;
+      for (int iCorner = 0; iCorner < 8; iCorner++) {
+        ivec3 offset = ivec3((iCorner >> 2) & 1, (iCorner >> 1) & 1, iCorner & 1);
+        if (value(cell + offset) < 0.) config |= (1 << iCorner);
+      }
+      if (config == 0 || config == 255) return;
+
+      uint caseLow = caseTable[2 * config];
+      uint caseHigh = caseTable[2 * config + 1];
+      int nTris = int(caseLow & 15u);
+      for (int iTri = 0; iTri < nTris; iTri++) {
+        for (int j = 0; j < 3; j++) {
+          int slot = 1 + 3 * iTri + j;
+          uint iEdge = slot < 8 ? (caseLow >> uint(4 * slot)) & 15u : (caseHigh >> uint(4 * (slot - 8))) & 15u;
+          ivec4 edge = edgeTable[int(iEdge)];
+          ivec3 nodeA = cell + edge.yzw;
+          ivec3 nodeB = nodeA;
+          nodeB[edge.x] += 1;
+          float vA = value(nodeA);
+          float vB = value(nodeB);
+          vec3 p = vec3(nodeA);
+          p[edge.x] += vA / (vA - vB);
+          v_position = p * u_spacing + u_boundMin;
+          EmitVertex();
+        }
+        EndPrimitive();
+      }
+    }
+  )";
+
+  isosurfaceProgram = compileTransformFeedbackProgram(vertSrc, geomSrc, "v_position");
+  return isosurfaceProgram;
+}
+
+ProgramHandle GLEngine::getSequenceProgram() {
+  if (sequenceProgram != 0) return sequenceProgram;
+
+  std::string vertSrc = getGLSLVersionDirective() + R"(
+    flat out uint v_index;
+    void main() { v_index = uint(gl_VertexID); }
+  )";
+
+  sequenceProgram = compileTransformFeedbackProgram(vertSrc, "", "v_index");
+  return sequenceProgram;
+}
+
+bool GLEngine::extractIsosurface(TextureBuffer& valuesBuff, float isoLevel, glm::vec3 boundMin, glm::vec3 spacing,
+                                 AttributeBuffer& positionsBuff, AttributeBuffer& indicesBuff) {
+
+  GLTextureBuffer* values = dynamic_cast<GLTextureBuffer*>(&valuesBuff);
+  GLAttributeBuffer* positions = dynamic_cast<GLAttributeBuffer*>(&positionsBuff);
+  GLAttributeBuffer* indices = dynamic_cast<GLAttributeBuffer*>(&indicesBuff);
+  if (!values || !positions || !indices) return false;
+  if (values->getDimension() != 3 || values->getFormat() != TextureFormat::R32F) return false;
+
+  // sanity checks
+  if (positions->getType() != RenderDataType::Vector3Float || positions->getArrayCount() != 1) {
+    exception("isosurface position buffer must have Vector3Float type");
+  }
+  if (indices->getType() != RenderDataType::UInt) exception("isosurface index buffer must have UInt type");
+
+  glm::ivec3 nodeDim{values->getSizeX(), values->getSizeY(), values->getSizeZ()};
+  if (nodeDim.x < 2 || nodeDim.y < 2 || nodeDim.z < 2) {
+    positions->allocate(0);
+    indices->allocate(0);
+    return true;
+  }
+  int64_t nCells = static_cast<int64_t>(nodeDim.x - 1) * (nodeDim.y - 1) * (nodeDim.z - 1);
+
+  // Save the state we touch, so the caller's bindings survive
+  GLint prevProgram, prevVAO, prevActiveTexture, prevTexture3D, prevTFBuffer;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &prevVAO);
+  glGetIntegerv(GL_ACTIVE_TEXTURE, &prevActiveTexture);
+  glGetIntegerv(GL_TRANSFORM_FEEDBACK_BUFFER_BINDING, &prevTFBuffer);
+  GLboolean prevRasterizerDiscard = glIsEnabled(GL_RASTERIZER_DISCARD);
+  glActiveTexture(GL_TEXTURE0);
+  glGetIntegerv(GL_TEXTURE_BINDING_3D, &prevTexture3D);
+
+  ProgramHandle program = getIsosurfaceProgram();
+  glUseProgram(program);
+  glActiveTexture(GL_TEXTURE0);
+  values->bind();
+  glUniform1i(glGetUniformLocation(program, "t_value"), 0);
+  glUniform3i(glGetUniformLocation(program, "u_nodeDim"), nodeDim.x, nodeDim.y, nodeDim.z);
+  glUniform1f(glGetUniformLocation(program, "u_isoLevel"), isoLevel);
+  glUniform3f(glGetUniformLocation(program, "u_boundMin"), boundMin.x, boundMin.y, boundMin.z);
+  glUniform3f(glGetUniformLocation(program, "u_spacing"), spacing.x, spacing.y, spacing.z);
+
+  // no attributes, the shaders work from gl_VertexID, but core profiles still need a vertex array bound
+  AttributeHandle vao;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glEnable(GL_RASTERIZER_DISCARD);
+
+  // Draw the cells in batches, to keep each individual draw reasonably short
+  const int64_t batchSize = 1 << 24;
+  auto drawCells = [&]() {
+    for (int64_t start = 0; start < nCells; start += batchSize) {
+      GLsizei count = static_cast<GLsizei>(std::min(batchSize, nCells - start));
+      glDrawArrays(GL_POINTS, static_cast<GLint>(start), count);
+    }
+  };
+
+  // First pass: count the triangles, so the output can be allocated. Only this count comes back to the host.
+  GLuint query;
+  glGenQueries(1, &query);
+  glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+  drawCells();
+  glEndQuery(GL_PRIMITIVES_GENERATED);
+  GLuint nTris = 0;
+  glGetQueryObjectuiv(query, GL_QUERY_RESULT, &nTris);
+  glDeleteQueries(1, &query);
+
+  // Second pass: capture the triangles
+  size_t nVerts = 3 * static_cast<size_t>(nTris);
+  positions->allocate(nVerts);
+  indices->allocate(nVerts);
+  if (nVerts > 0) {
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, positions->getHandle());
+    glBeginTransformFeedback(GL_TRIANGLES);
+    drawCells();
+    glEndTransformFeedback();
+
+    // The vertices are not shared, so the indices are just 0, 1, 2, ...
+    glUseProgram(getSequenceProgram());
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, indices->getHandle());
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(nVerts));
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+  }
+
+  // Restore the previous state
+  if (!prevRasterizerDiscard) glDisable(GL_RASTERIZER_DISCARD);
+  glBindVertexArray(prevVAO);
+  glDeleteVertexArrays(1, &vao);
+  glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, prevTFBuffer);
+  glBindTexture(GL_TEXTURE_3D, prevTexture3D);
+  glActiveTexture(prevActiveTexture);
+  glUseProgram(prevProgram);
+  checkGLError();
+
+  return true;
+}
+
+ProgramHandle GLEngine::getStatisticsRangeProgram() {
+  if (statisticsRangeProgram != 0) return statisticsRangeProgram;
+
+  // Every finite value lands on the single pixel, which keeps the max of (x, -x) by blending
+  std::string vertSrc = getGLSLVersionDirective() + R"(
+    layout(location = 0) in float a_value;
+    flat out vec2 v_valueAndNegValue;
+    void main() {
+      v_valueAndNegValue = vec2(a_value, -a_value);
+      bool finite = !(isnan(a_value) || isinf(a_value));
+      gl_Position = finite ? vec4(0., 0., 0., 1.) : vec4(0., 0., 2., 1.); // (z > w is clipped)
+    }
+  )";
+
+  std::string fragSrc = getGLSLVersionDirective() + R"(
+    flat in vec2 v_valueAndNegValue;
+    layout(location = 0) out vec4 outValue;
+    void main() { outValue = vec4(v_valueAndNegValue, 0., 0.); }
+  )";
+
+  statisticsRangeProgram = compileDrawProgram(vertSrc, fragSrc);
+  return statisticsRangeProgram;
+}
+
+ProgramHandle GLEngine::getStatisticsBinProgram() {
+  if (statisticsBinProgram != 0) return statisticsBinProgram;
+
+  // Every non-NaN value adds 1 to the pixel of its bin. Values are spread over several rows, so that no pixel counts
+  // past 2^24, where float32 stops being exact.
+  std::string vertSrc = getGLSLVersionDirective() + R"(
+    layout(location = 0) in float a_value;
+    uniform float u_low;
+    uniform float u_scale;
+    uniform int u_binCount;
+    uniform int u_rowCount;
+    void main() {
+      float bin = floor(clamp((a_value - u_low) * u_scale, 0., float(u_binCount - 1)));
+      float row = float(gl_VertexID % u_rowCount);
+      vec2 pos = (vec2(bin, row) + 0.5) / vec2(u_binCount, u_rowCount) * 2. - 1.;
+      gl_Position = isnan(a_value) ? vec4(0., 0., 2., 1.) : vec4(pos, 0., 1.); // (z > w is clipped)
+    }
+  )";
+
+  std::string fragSrc = getGLSLVersionDirective() + R"(
+    layout(location = 0) out vec4 outValue;
+    void main() { outValue = vec4(1.); }
+  )";
+
+  statisticsBinProgram = compileDrawProgram(vertSrc, fragSrc);
+  return statisticsBinProgram;
+}
+
+bool GLEngine::reduceScalarStatistics(AttributeBuffer& valuesBuff, size_t binCount, float rangeEPS,
+                                      ScalarStatistics& stats) {
+
+  GLAttributeBuffer* values = dynamic_cast<GLAttributeBuffer*>(&valuesBuff);
+  if (!values) return false;
+  if (values->getType() != RenderDataType::Float || values->getArrayCount() != 1) {
+    exception("scalar statistics buffer must have Float type");
+  }
+
+  stats = ScalarStatistics();
+  stats.binCounts = std::vector<size_t>(binCount, 0);
+  int64_t N = values->isSet() ? values->getDataSize() : 0;
+  if (N == 0) return true;
+
+  // Save the state we are about to change
+  GLint prevDrawFramebuffer, prevReadFramebuffer, prevProgram, prevVAO, prevArrayBuffer, prevTexture2D;
+  GLint prevViewport[4];
+  GLboolean prevColorMask[4];
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevDrawFramebuffer);
+  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevReadFramebuffer);
+  glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &prevVAO);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &prevArrayBuffer);
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTexture2D);
+  glGetIntegerv(GL_VIEWPORT, prevViewport);
+  glGetBooleanv(GL_COLOR_WRITEMASK, prevColorMask);
+  GLboolean prevBlend = glIsEnabled(GL_BLEND);
+  GLboolean prevDepthTest = glIsEnabled(GL_DEPTH_TEST);
+  GLint prevBlendSrcRGB, prevBlendDstRGB, prevBlendSrcAlpha, prevBlendDstAlpha;
+  glGetIntegerv(GL_BLEND_SRC_RGB, &prevBlendSrcRGB);
+  glGetIntegerv(GL_BLEND_DST_RGB, &prevBlendDstRGB);
+  glGetIntegerv(GL_BLEND_SRC_ALPHA, &prevBlendSrcAlpha);
+  glGetIntegerv(GL_BLEND_DST_ALPHA, &prevBlendDstAlpha);
+  GLint prevBlendEquationRGB, prevBlendEquationAlpha;
+  glGetIntegerv(GL_BLEND_EQUATION_RGB, &prevBlendEquationRGB);
+  glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &prevBlendEquationAlpha);
+
+  glDisable(GL_DEPTH_TEST);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE);
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+  // The values are drawn as points, one per value
+  AttributeHandle vao;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  values->bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), 0);
+  const int64_t batchSize = 1 << 24;
+  auto drawValues = [&]() {
+    for (int64_t start = 0; start < N; start += batchSize) {
+      glDrawArrays(GL_POINTS, static_cast<GLint>(start), static_cast<GLsizei>(std::min(batchSize, N - start)));
+    }
+  };
+
+  // Render into a small float texture, of which only the result comes back to the host
+  FrameBufferHandle framebuffer;
+  TextureBufferHandle target;
+  glGenFramebuffers(1, &framebuffer);
+  glGenTextures(1, &target);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  auto setTarget = [&](GLint internalFormat, GLenum format, GLsizei sizeX, GLsizei sizeY) {
+    glBindTexture(GL_TEXTURE_2D, target);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, sizeX, sizeY, 0, format, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+    glViewport(0, 0, sizeX, sizeY);
+  };
+
+  // First pass: min and max of the finite values
+  setTarget(GL_RGBA32F, GL_RGBA, 1, 1);
+  const float inf = std::numeric_limits<float>::infinity();
+  const GLfloat rangeClear[4] = {-inf, -inf, 0., 0.};
+  glClearBufferfv(GL_COLOR, 0, rangeClear);
+  glBlendEquation(GL_MAX);
+  glUseProgram(getStatisticsRangeProgram());
+  drawValues();
+  glBlendEquation(GL_FUNC_ADD);
+  std::array<float, 4> maxAndNegMin;
+  glReadPixels(0, 0, 1, 1, GL_RGBA, GL_FLOAT, &maxAndNegMin.front());
+  float minVal = -maxAndNegMin[1];
+  float maxVal = maxAndNegMin[0];
+  stats.range = padScalarRange(minVal, maxVal, rangeEPS);
+
+  // Second pass: count the values in each bin
+  if (minVal <= maxVal && binCount > 0) {
+    GLsizei rowCount = static_cast<GLsizei>(std::min<int64_t>(N / (1 << 22) + 1, 1024));
+    setTarget(GL_R32F, GL_RED, static_cast<GLsizei>(binCount), rowCount);
+    const GLfloat binClear[4] = {0., 0., 0., 0.};
+    glClearBufferfv(GL_COLOR, 0, binClear);
+    ProgramHandle program = getStatisticsBinProgram();
+    glUseProgram(program);
+    glUniform1f(glGetUniformLocation(program, "u_low"), static_cast<float>(stats.range.first));
+    glUniform1f(glGetUniformLocation(program, "u_scale"), scalarBinScale(stats.range, binCount));
+    glUniform1i(glGetUniformLocation(program, "u_binCount"), static_cast<GLint>(binCount));
+    glUniform1i(glGetUniformLocation(program, "u_rowCount"), rowCount);
+    drawValues();
+    std::vector<float> rowBins(binCount * rowCount);
+    glReadPixels(0, 0, static_cast<GLsizei>(binCount), rowCount, GL_RED, GL_FLOAT, &rowBins.front());
+    for (size_t i = 0; i < rowBins.size(); i++) {
+      stats.binCounts[i % binCount] += static_cast<size_t>(rowBins[i]);
+    }
+  }
+
+  // Clean up, and restore the state
+  glDeleteTextures(1, &target);
+  glDeleteFramebuffers(1, &framebuffer);
+  glBindVertexArray(prevVAO);
+  glDeleteVertexArrays(1, &vao);
+  glBindBuffer(GL_ARRAY_BUFFER, prevArrayBuffer);
+  glBindTexture(GL_TEXTURE_2D, prevTexture2D);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, prevDrawFramebuffer);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, prevReadFramebuffer);
+  glUseProgram(prevProgram);
+  glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+  glColorMask(prevColorMask[0], prevColorMask[1], prevColorMask[2], prevColorMask[3]);
+  glBlendFuncSeparate(prevBlendSrcRGB, prevBlendDstRGB, prevBlendSrcAlpha, prevBlendDstAlpha);
+  glBlendEquationSeparate(prevBlendEquationRGB, prevBlendEquationAlpha);
+  if (!prevBlend) glDisable(GL_BLEND);
+  if (prevDepthTest) glEnable(GL_DEPTH_TEST);
+  checkGLError();
+
+  return true;
+}
+
 // == Factories
 
 
@@ -2475,6 +3305,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderProgram("TEXTURE_DRAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("TEXTURE_DRAW_RAW_RENDERIMAGE_PLAIN", {TEXTURE_DRAW_VERT_SHADER, PLAIN_RAW_RENDERIMAGE_TEXTURE_DRAW_FRAG_SHADER}, DrawMode::Triangles);
   registerShaderProgram("COMPOSITE_PEEL", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_PEEL}, DrawMode::Triangles);
+  registerShaderProgram("COMPOSITE_WEIGHTED", {TEXTURE_DRAW_VERT_SHADER, COMPOSITE_WEIGHTED}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_COPY", {TEXTURE_DRAW_VERT_SHADER, DEPTH_COPY}, DrawMode::Triangles);
   registerShaderProgram("DEPTH_TO_MASK", {TEXTURE_DRAW_VERT_SHADER, DEPTH_TO_MASK}, DrawMode::Triangles);
   registerShaderProgram("SCALAR_TEXTURE_COLORMAP", {TEXTURE_DRAW_VERT_SHADER, SCALAR_TEXTURE_COLORMAP}, DrawMode::Triangles);
@@ -2495,6 +3326,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("TRANSPARENCY_RESOLVE_SIMPLE", TRANSPARENCY_RESOLVE_SIMPLE);
   registerShaderRule("TRANSPARENCY_PEEL_STRUCTURE", TRANSPARENCY_PEEL_STRUCTURE);
   registerShaderRule("TRANSPARENCY_PEEL_GROUND", TRANSPARENCY_PEEL_GROUND);
+  registerShaderRule("TRANSPARENCY_WEIGHTED_STRUCTURE", TRANSPARENCY_WEIGHTED_STRUCTURE);
 
   registerShaderRule("GENERATE_VIEW_POS", GENERATE_VIEW_POS);
   registerShaderRule("COMPUTE_SHADE_NORMAL_FROM_POSITION", COMPUTE_SHADE_NORMAL_FROM_POSITION);
@@ -2552,6 +3384,7 @@ void GLEngine::populateDefaultShadersAndRules() {
 
   // volume gridcube things
   registerShaderRule("GRIDCUBE_PROPAGATE_NODE_VALUE", GRIDCUBE_PROPAGATE_NODE_VALUE);
+  registerShaderRule("GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE", GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE);
   registerShaderRule("GRIDCUBE_PROPAGATE_CELL_VALUE", GRIDCUBE_PROPAGATE_CELL_VALUE);
   registerShaderRule("GRIDCUBE_WIREFRAME", GRIDCUBE_WIREFRAME);
   registerShaderRule("GRIDCUBE_CONSTANT_PICK", GRIDCUBE_CONSTANT_PICK);
@@ -2585,6 +3418,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("SLICE_TETS_PROPAGATE_VECTOR", SLICE_TETS_PROPAGATE_VECTOR);
   registerShaderRule("SLICE_TETS_VECTOR_COLOR", SLICE_TETS_VECTOR_COLOR);
   registerShaderRule("SLICE_TETS_MESH_WIREFRAME", SLICE_TETS_MESH_WIREFRAME);
+  registerShaderRule("SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE", SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE);
 
   // clang-format on
 };
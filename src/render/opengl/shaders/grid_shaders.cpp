@@ -379,6 +379,50 @@ const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE (
     }
 );
 
+const ShaderReplacementRule GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE (
+    /* rule name */ "GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform sampler3D t_value; // atlas of bricks
+          uniform sampler3D t_brickSlots; // atlas slot of each brick, negative if not stored
+          uniform float u_sparseBackgroundValue;
+
+          // Sample a bricked field of node values, at the same point as GRIDCUBE_PROPAGATE_NODE_VALUE would
+          float sampleSparseNodeValue(vec3 coord) {
+            const int BRICK_CELLS = 8;
+            const int BRICK_NODES = BRICK_CELLS + 1;
+
+            vec3 nodeDim = round(1.f / u_gridSpacingReference) + 1.f;
+            vec3 nodeCoord = clamp(coord * nodeDim - 0.5f, vec3(0.f), nodeDim - 1.f);
+            ivec3 brickInd = min(ivec3(nodeCoord) / BRICK_CELLS, textureSize(t_brickSlots, 0) - 1);
+            float slot = texelFetch(t_brickSlots, brickInd, 0).r;
+            if(slot < 0.f) {
+              return u_sparseBackgroundValue;
+            }
+
+            // bricks hold the nodes on their upper faces, so the interpolation never reaches into the next brick
+            ivec3 atlasDim = textureSize(t_value, 0);
+            int bricksXY = atlasDim.x / BRICK_NODES;
+            int iSlot = int(slot);
+            ivec3 atlasBrickInd = ivec3(iSlot % bricksXY, (iSlot / bricksXY) % bricksXY, iSlot / (bricksXY * bricksXY));
+            vec3 atlasCoord = vec3(atlasBrickInd * BRICK_NODES) + (nodeCoord - vec3(brickInd * BRICK_CELLS)) + 0.5f;
+            return texture(t_value, atlasCoord / vec3(atlasDim)).r;
+          }
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          float shadeValue = sampleSparseNodeValue(a_coordToFrag);
+        )"},
+    },
+    /* uniforms */ {
+      {"u_sparseBackgroundValue", RenderDataType::Float},
+    },
+    /* attributes */ { },
+    /* textures */ {
+      {"t_value", 3},
+      {"t_brickSlots", 3},
+    }
+);
+
 const ShaderReplacementRule GRIDCUBE_PROPAGATE_CELL_VALUE (
     /* rule name */ "GRIDCUBE_PROPAGATE_CELL_VALUE",
     { /* replacement sources */
@@ -302,6 +302,40 @@ const ShaderReplacementRule TRANSPARENCY_PEEL_GROUND (
     }
 );
 
+const ShaderReplacementRule TRANSPARENCY_WEIGHTED_STRUCTURE (
+    /* rule name */ "TRANSPARENCY_WEIGHTED_STRUCTURE",
+    { /* replacement sources */
+      {"FRAG_DECLARATIONS", R"(
+          uniform float u_transparency;
+          uniform int u_weightedAccumulatePass;
+          layout(location = 1) out vec4 outputWeight;
+        )"},
+      {"GENERATE_ALPHA", R"(
+          alphaOut = u_transparency;
+
+          // opaque fragments are drawn as usual in the first pass, transparent ones are accumulated in the second
+          if((alphaOut < 1.) != (u_weightedAccumulatePass != 0)) {
+            discard;
+          }
+
+          if(u_weightedAccumulatePass != 0) {
+            // assumption: "float depth" must be already set 
+            // (use float depth = gl_FragCoord.z; if not doing anything special)
+            // depth weight from McGuire & Bavoil 2013, favoring the fragments closest to the camera
+            float oitWeight = clamp(3e3 * pow(1. - depth, 3.), 1e-2, 3e3);
+            litColor *= oitWeight; // gets premultiplied by alpha below
+            outputWeight = vec4(alphaOut * oitWeight);
+          }
+        )"},
+    },
+    /* uniforms */ {
+        {"u_transparency", RenderDataType::Float},
+        {"u_weightedAccumulatePass", RenderDataType::Int},
+    },
+    /* attributes */ {},
+    /* textures */ {}
+);
+
 // clang-format on
 
 } // namespace backend_openGL3
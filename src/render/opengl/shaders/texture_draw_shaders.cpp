@@ -422,6 +422,46 @@ R"(
 )"
 };
 
+const ShaderStageSpecification COMPOSITE_WEIGHTED = {
+    
+    // stage
+    ShaderStageType::Fragment,
+    
+    // uniforms
+    { }, 
+
+    // attributes
+    { },
+    
+    // textures 
+    { {"t_accum", 2}, {"t_weightSum", 2} },
+    
+    // source 
+R"(
+      ${ GLSL_VERSION }$
+
+      in vec2 tCoord;
+      uniform sampler2D t_accum;
+      uniform sampler2D t_weightSum;
+      layout(location = 0) out vec4 outputF;
+
+      void main()
+      {
+        // rgb is the weighted sum of premultiplied colors, a is the product of (1 - alpha)
+        vec4 accum = texture(t_accum, tCoord);
+        float weightSum = texture(t_weightSum, tCoord).r;
+        float coverage = 1. - accum.a;
+        if(coverage <= 0.) {
+          discard;
+        }
+
+        // premultiplied, to be composited over the opaque scene
+        vec3 avgColor = accum.rgb / max(weightSum, 1e-5);
+        outputF = vec4(avgColor * coverage, coverage);
+      }
+)"
+};
+
 const ShaderStageSpecification DEPTH_COPY = {
     
     // stage
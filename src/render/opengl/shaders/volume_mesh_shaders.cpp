@@ -391,6 +391,33 @@ const ShaderReplacementRule SLICE_TETS_PROPAGATE_VALUE(
     },
     /* textures */ {});
 
+const ShaderReplacementRule SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE(
+    /* rule name */ "SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE",
+    {
+        /* replacement sources */
+        {"VERT_DECLARATIONS", R"(
+          in float a_levelSetValue_1;
+          in float a_levelSetValue_2;
+          in float a_levelSetValue_3;
+          in float a_levelSetValue_4;
+        )"},
+        {"VERT_ASSIGNMENTS", R"(
+          slice_1 = vec3(a_levelSetValue_1, 0., 0.);
+          slice_2 = vec3(a_levelSetValue_2, 0., 0.);
+          slice_3 = vec3(a_levelSetValue_3, 0., 0.);
+          slice_4 = vec3(a_levelSetValue_4, 0., 0.);
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */
+    {
+        {"a_levelSetValue_1", RenderDataType::Float},
+        {"a_levelSetValue_2", RenderDataType::Float},
+        {"a_levelSetValue_3", RenderDataType::Float},
+        {"a_levelSetValue_4", RenderDataType::Float},
+    },
+    /* textures */ {});
+
 } // namespace backend_openGL3
 } // namespace render
 }; // namespace polyscope
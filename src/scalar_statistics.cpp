@@ -0,0 +1,212 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/scalar_statistics.h"
+
+#include "polyscope/parallel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POLYSCOPE_SCALAR_STATISTICS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace polyscope {
+
+namespace {
+
+// Values are processed in blocks of this many entries; each block is handled by one thread and produces its own
+// partial result, which are combined afterwards in block order.
+const size_t STATISTICS_BLOCK_SIZE = 1 << 16;
+
+// Min and max over the finite values in [v, v+n). Leaves minVal = inf and maxVal = -inf if there are none.
+void blockMinMax(const float* v, size_t n, float& minVal, float& maxVal) {
+  const float inf = std::numeric_limits<float>::infinity();
+  minVal = inf;
+  maxVal = -inf;
+  size_t i = 0;
+
+#ifdef POLYSCOPE_SCALAR_STATISTICS_SSE2
+  // A value is finite iff its magnitude is <= FLT_MAX (the comparison is false for NaN). Non-finite lanes are replaced
+  // by +-inf, so they never win the min/max. Two sets of accumulators hide the latency of min/max.
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 maxFinite = _mm_set1_ps(FLT_MAX);
+  const __m128 posInf = _mm_set1_ps(inf);
+  const __m128 negInf = _mm_set1_ps(-inf);
+  __m128 min0 = posInf, min1 = posInf;
+  __m128 max0 = negInf, max1 = negInf;
+  for (; i + 8 <= n; i += 8) {
+    __m128 x0 = _mm_loadu_ps(v + i);
+    __m128 x1 = _mm_loadu_ps(v + i + 4);
+    __m128 finite0 = _mm_cmple_ps(_mm_and_ps(x0, absMask), maxFinite);
+    __m128 finite1 = _mm_cmple_ps(_mm_and_ps(x1, absMask), maxFinite);
+    min0 = _mm_min_ps(min0, _mm_or_ps(_mm_and_ps(finite0, x0), _mm_andnot_ps(finite0, posInf)));
+    min1 = _mm_min_ps(min1, _mm_or_ps(_mm_and_ps(finite1, x1), _mm_andnot_ps(finite1, posInf)));
+    max0 = _mm_max_ps(max0, _mm_or_ps(_mm_and_ps(finite0, x0), _mm_andnot_ps(finite0, negInf)));
+    max1 = _mm_max_ps(max1, _mm_or_ps(_mm_and_ps(finite1, x1), _mm_andnot_ps(finite1, negInf)));
+  }
+  float minLanes[4];
+  float maxLanes[4];
+  _mm_storeu_ps(minLanes, _mm_min_ps(min0, min1));
+  _mm_storeu_ps(maxLanes, _mm_max_ps(max0, max1));
+  for (int k = 0; k < 4; k++) {
+    minVal = std::min(minVal, minLanes[k]);
+    maxVal = std::max(maxVal, maxLanes[k]);
+  }
+#endif
+
+  for (; i < n; i++) {
+    bool finite = std::isfinite(v[i]);
+    minVal = std::min(minVal, finite ? v[i] : inf);
+    maxVal = std::max(maxVal, finite ? v[i] : -inf);
+  }
+}
+
+// Add the values in [v, v+n) to the bins. The bin of x is (x - low) * scale, clamped to [0, binCount-1]; NaN values are
+// skipped.
+void blockBin(const float* v, size_t n, float low, float scale, size_t binCount, uint32_t* bins) {
+  const float lastBin = static_cast<float>(binCount - 1);
+  size_t i = 0;
+
+#ifdef POLYSCOPE_SCALAR_STATISTICS_SSE2
+  // Each lane counts into its own copy of the bins, so that runs of values landing in the same bin (common, e.g. for
+  // clamped data) do not serialize on a single counter.
+  std::vector<uint32_t> laneBins(4 * binCount, 0);
+  uint32_t* lane0 = &laneBins[0];
+  uint32_t* lane1 = &laneBins[binCount];
+  uint32_t* lane2 = &laneBins[2 * binCount];
+  uint32_t* lane3 = &laneBins[3 * binCount];
+  const __m128 lowV = _mm_set1_ps(low);
+  const __m128 scaleV = _mm_set1_ps(scale);
+  const __m128 zeroV = _mm_setzero_ps();
+  const __m128 lastBinV = _mm_set1_ps(lastBin);
+  for (; i + 4 <= n; i += 4) {
+    __m128 x = _mm_loadu_ps(v + i);
+    int notNaN = _mm_movemask_ps(_mm_cmpord_ps(x, x));
+    __m128 t = _mm_mul_ps(_mm_sub_ps(x, lowV), scaleV);
+    t = _mm_min_ps(_mm_max_ps(t, zeroV), lastBinV); // (NaN lanes become 0, and are masked below)
+    __m128i ind = _mm_cvttps_epi32(t);
+    lane0[_mm_cvtsi128_si32(ind)] += notNaN & 1;
+    lane1[_mm_cvtsi128_si32(_mm_shuffle_epi32(ind, 1))] += (notNaN >> 1) & 1;
+    lane2[_mm_cvtsi128_si32(_mm_shuffle_epi32(ind, 2))] += (notNaN >> 2) & 1;
+    lane3[_mm_cvtsi128_si32(_mm_shuffle_epi32(ind, 3))] += (notNaN >> 3) & 1;
+  }
+  for (size_t iBin = 0; iBin < binCount; iBin++) {
+    bins[iBin] += lane0[iBin] + lane1[iBin] + lane2[iBin] + lane3[iBin];
+  }
+#endif
+
+  for (; i < n; i++) {
+    float t = (v[i] - low) * scale;
+    if (std::isnan(t)) continue;
+    t = std::min(std::max(t, 0.f), lastBin);
+    bins[static_cast<size_t>(t)]++;
+  }
+}
+
+} // namespace
+
+ScalarStatistics computeScalarStatistics(const std::vector<float>& values, size_t binCount, float rangeEPS) {
+  return computeScalarStatistics(values, binCount, rangeEPS, 0.f, 0);
+}
+
+ScalarStatistics computeScalarStatistics(const std::vector<float>& values, size_t binCount, float rangeEPS,
+                                         float repeatedValue, uint64_t repeatCount) {
+
+  ScalarStatistics stats;
+  stats.binCounts = std::vector<size_t>(binCount, 0);
+  size_t N = values.size();
+  if (N == 0 && repeatCount == 0) {
+    return stats;
+  }
+  size_t nBlocks = (N + STATISTICS_BLOCK_SIZE - 1) / STATISTICS_BLOCK_SIZE;
+  auto blockStart = [&](size_t iB) { return iB * STATISTICS_BLOCK_SIZE; };
+  auto blockSize = [&](size_t iB) { return std::min(STATISTICS_BLOCK_SIZE, N - blockStart(iB)); };
+
+  // == Range
+
+  std::vector<float> blockMin(nBlocks);
+  std::vector<float> blockMax(nBlocks);
+  parallelFor(
+      nBlocks,
+      [&](size_t start, size_t end) {
+        for (size_t iB = start; iB < end; iB++) {
+          blockMinMax(&values[blockStart(iB)], blockSize(iB), blockMin[iB], blockMax[iB]);
+        }
+      },
+      1);
+
+  float minVal = std::numeric_limits<float>::infinity();
+  float maxVal = -std::numeric_limits<float>::infinity();
+  for (size_t iB = 0; iB < nBlocks; iB++) {
+    minVal = std::min(minVal, blockMin[iB]);
+    maxVal = std::max(maxVal, blockMax[iB]);
+  }
+  if (repeatCount > 0 && std::isfinite(repeatedValue)) {
+    minVal = std::min(minVal, repeatedValue);
+    maxVal = std::max(maxVal, repeatedValue);
+  }
+  stats.range = padScalarRange(minVal, maxVal, rangeEPS);
+  if (!(minVal <= maxVal) || binCount == 0) { // no finite values, or no bins
+    return stats;
+  }
+
+  // == Histogram
+
+  float low = static_cast<float>(stats.range.first);
+  float scale = scalarBinScale(stats.range, binCount);
+  std::vector<uint32_t> blockBins(nBlocks * binCount, 0); // (a block has at most 2^16 values, so these cannot overflow)
+  parallelFor(
+      nBlocks,
+      [&](size_t start, size_t end) {
+        for (size_t iB = start; iB < end; iB++) {
+          blockBin(&values[blockStart(iB)], blockSize(iB), low, scale, binCount, &blockBins[iB * binCount]);
+        }
+      },
+      1);
+
+  for (size_t iB = 0; iB < nBlocks; iB++) {
+    for (size_t iBin = 0; iBin < binCount; iBin++) {
+      stats.binCounts[iBin] += blockBins[iB * binCount + iBin];
+    }
+  }
+
+  // (binned like the values, see blockBin())
+  float tRepeated = (repeatedValue - low) * scale;
+  if (repeatCount > 0 && !std::isnan(tRepeated)) {
+    tRepeated = std::min(std::max(tRepeated, 0.f), static_cast<float>(binCount - 1));
+    stats.binCounts[static_cast<size_t>(tRepeated)] += repeatCount;
+  }
+
+  return stats;
+}
+
+std::pair<double, double> padScalarRange(float minVal, float maxVal, float rangeEPS) {
+  if (!(minVal <= maxVal)) {
+    return std::make_pair(-1.0, 1.0);
+  }
+
+  // Hack to do less ugly things when constants (or near-constant) are passed in (same as robustMinMax())
+  float maxMag = std::max(std::abs(minVal), std::abs(maxVal));
+  if (maxMag < rangeEPS) {
+    maxVal = rangeEPS;
+    minVal = -rangeEPS;
+  } else if ((maxVal - minVal) / maxMag < rangeEPS) {
+    float mid = (minVal + maxVal) / 2.0;
+    maxVal = mid + maxMag * rangeEPS;
+    minVal = mid - maxMag * rangeEPS;
+  }
+  return std::make_pair(minVal, maxVal);
+}
+
+float scalarBinScale(std::pair<double, double> range, size_t binCount) {
+  float scale = static_cast<float>(binCount / (range.second - range.first));
+  if (!std::isfinite(scale)) scale = 0.;
+  return scale;
+}
+
+} // namespace polyscope
@@ -270,8 +270,11 @@ void SimpleTriangleMesh::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  objectSpaceBoundsDataVersion = geometryDataVersion();
 }
 
+uint64_t SimpleTriangleMesh::geometryDataVersion() { return vertices.dataVersion(); }
+
 std::string SimpleTriangleMesh::typeName() { return structureTypeName; }
 
 // === Option getters and setters
@@ -134,7 +134,7 @@ void SlicePlane::setVolumeMeshToInspect(std::string meshname) {
   drawPlane = false;
   meshToInspect->addSlicePlaneListener(this);
   meshToInspect->setCullWholeElements(false);
-  meshToInspect->ensureHaveTets(); // do this as early as possible because it is expensive
+  meshToInspect->ensureHaveTetVertexInds(); // do this as early as possible because it is expensive
   shouldInspectMesh = true;
   volumeInspectProgram.reset();
 }
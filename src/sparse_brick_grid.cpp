@@ -0,0 +1,297 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/sparse_brick_grid.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace polyscope {
+
+// ========================================================
+// ==========             Layout                 ==========
+// ========================================================
+
+const uint32_t SparseBrickLayout::BRICK_CELLS;
+const uint32_t SparseBrickLayout::BRICK_NODES;
+const uint32_t SparseBrickLayout::BRICK_SIZE;
+const uint32_t SparseBrickLayout::MAX_ATLAS_BRICKS_PER_AXIS;
+
+SparseBrickLayout::SparseBrickLayout() {}
+
+SparseBrickLayout::SparseBrickLayout(glm::uvec3 nodeDim_) : nodeDim(nodeDim_) {
+  for (int i = 0; i < 3; i++) {
+    uint32_t cellDim = nodeDim[i] > 0 ? nodeDim[i] - 1 : 0;
+    brickDim[i] = std::max<uint32_t>(1, (cellDim + BRICK_CELLS - 1) / BRICK_CELLS);
+  }
+  brickSlots.resize(nBricks(), INVALID_IND_32);
+
+  // Make the atlas just wide enough that every brick of the grid would fit without exceeding the cap on its depth
+  double minBricksXY = std::ceil(std::sqrt(static_cast<double>(nBricks()) / MAX_ATLAS_BRICKS_PER_AXIS));
+  atlasBricksXY = static_cast<uint32_t>(std::min<double>(std::max(minBricksXY, 1.), MAX_ATLAS_BRICKS_PER_AXIS));
+}
+
+glm::uvec3 SparseBrickLayout::getNodeDim() const { return nodeDim; }
+glm::uvec3 SparseBrickLayout::getBrickDim() const { return brickDim; }
+
+uint64_t SparseBrickLayout::nBricks() const { return static_cast<uint64_t>(brickDim.x) * brickDim.y * brickDim.z; }
+uint32_t SparseBrickLayout::nStoredBricks() const { return static_cast<uint32_t>(slotBricks.size()); }
+
+uint64_t SparseBrickLayout::flattenBrickIndex(glm::uvec3 brickInd) const {
+  return (static_cast<uint64_t>(brickInd.z) * brickDim.y + brickInd.y) * brickDim.x + brickInd.x;
+}
+
+glm::uvec3 SparseBrickLayout::unflattenBrickIndex(uint64_t i) const {
+  uint64_t nXY = static_cast<uint64_t>(brickDim.x) * brickDim.y;
+  uint64_t iZ = i / nXY;
+  i -= iZ * nXY;
+  uint64_t iY = i / brickDim.x;
+  uint64_t iX = i - iY * brickDim.x;
+  return glm::uvec3{static_cast<uint32_t>(iX), static_cast<uint32_t>(iY), static_cast<uint32_t>(iZ)};
+}
+
+uint32_t SparseBrickLayout::getBrickSlot(glm::uvec3 brickInd) const { return brickSlots[flattenBrickIndex(brickInd)]; }
+glm::uvec3 SparseBrickLayout::getSlotBrick(uint32_t slot) const { return slotBricks[slot]; }
+
+uint32_t SparseBrickLayout::addBrick(glm::uvec3 brickInd) {
+  uint32_t& slot = brickSlots[flattenBrickIndex(brickInd)];
+  if (slot != INVALID_IND_32) return slot;
+
+  uint64_t capacity = static_cast<uint64_t>(atlasBricksXY) * atlasBricksXY * MAX_ATLAS_BRICKS_PER_AXIS;
+  if (slotBricks.size() >= capacity) {
+    exception("sparse brick grid cannot store more than " + std::to_string(capacity) + " bricks");
+  }
+
+  slot = static_cast<uint32_t>(slotBricks.size());
+  slotBricks.push_back(brickInd);
+  return slot;
+}
+
+glm::uvec3 SparseBrickLayout::brickOfNode(glm::uvec3 nodeInd, glm::uvec3& localNodeInd) const {
+  glm::uvec3 brickInd;
+  for (int i = 0; i < 3; i++) {
+    brickInd[i] = std::min(nodeInd[i] / BRICK_CELLS, brickDim[i] - 1);
+    localNodeInd[i] = nodeInd[i] - brickInd[i] * BRICK_CELLS;
+  }
+  return brickInd;
+}
+
+const std::vector<uint32_t>& SparseBrickLayout::getBrickSlots() const { return brickSlots; }
+
+glm::uvec3 SparseBrickLayout::getAtlasBrickDim() const {
+  // always keep at least one layer, so the atlas is never an empty texture
+  uint32_t nPerLayer = atlasBricksXY * atlasBricksXY;
+  uint32_t nLayers = std::max<uint32_t>(1, (nStoredBricks() + nPerLayer - 1) / nPerLayer);
+  return glm::uvec3{atlasBricksXY, atlasBricksXY, nLayers};
+}
+
+glm::uvec3 SparseBrickLayout::getAtlasDim() const { return getAtlasBrickDim() * BRICK_NODES; }
+
+size_t SparseBrickLayout::atlasSize() const {
+  glm::uvec3 atlasDim = getAtlasDim();
+  return static_cast<size_t>(atlasDim.x) * atlasDim.y * atlasDim.z;
+}
+
+size_t SparseBrickLayout::atlasIndex(uint32_t slot, glm::uvec3 localNodeInd) const {
+  glm::uvec3 atlasBrickInd{slot % atlasBricksXY, (slot / atlasBricksXY) % atlasBricksXY,
+                           slot / (atlasBricksXY * atlasBricksXY)};
+  glm::uvec3 atlasNodeInd = atlasBrickInd * BRICK_NODES + localNodeInd;
+  size_t atlasWidth = static_cast<size_t>(atlasBricksXY) * BRICK_NODES;
+  return (atlasNodeInd.z * atlasWidth + atlasNodeInd.y) * atlasWidth + atlasNodeInd.x;
+}
+
+size_t SparseBrickLayout::nodeAtlasIndex(glm::uvec3 nodeInd) const {
+  glm::uvec3 localNodeInd;
+  glm::uvec3 brickInd = brickOfNode(nodeInd, localNodeInd);
+  uint32_t slot = getBrickSlot(brickInd);
+  if (slot == INVALID_IND_32) return INVALID_IND_64;
+  return atlasIndex(slot, localNodeInd);
+}
+
+size_t SparseBrickLayout::memoryUsage() const {
+  return brickSlots.size() * sizeof(uint32_t) + slotBricks.size() * sizeof(glm::uvec3);
+}
+
+// ========================================================
+// ==========              Grid                  ==========
+// ========================================================
+
+SparseBrickGrid::SparseBrickGrid(glm::uvec3 nodeDim, float backgroundValue_)
+    : layout(nodeDim), backgroundValue(backgroundValue_) {
+  atlasValues.resize(layout.atlasSize(), backgroundValue);
+}
+
+SparseBrickGrid SparseBrickGrid::fromCallable(glm::uvec3 nodeDim, float backgroundValue,
+                                              const std::function<bool(glm::uvec3)>& brickFilter,
+                                              const std::function<float(glm::uvec3)>& nodeFunc) {
+
+  SparseBrickGrid grid(nodeDim, backgroundValue);
+  const SparseBrickLayout& layout = grid.layout;
+  const uint32_t B = SparseBrickLayout::BRICK_CELLS;
+  const uint32_t N = SparseBrickLayout::BRICK_NODES;
+  glm::uvec3 brickDim = layout.getBrickDim();
+  size_t nBricks = layout.nBricks();
+
+  std::vector<char> accepted(nBricks);
+  parallelFor(
+      nBricks,
+      [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; i++) accepted[i] = brickFilter(layout.unflattenBrickIndex(i));
+      },
+      64);
+
+  // == Evaluate the accepted bricks, and the ones below them along each axis. Those share nodes with an accepted brick,
+  // so they are only constant if the shared nodes are background.
+  std::vector<char> evaluated(nBricks);
+  parallelFor(nBricks, [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      glm::uvec3 brickInd = layout.unflattenBrickIndex(i);
+      bool any = false;
+      for (uint32_t iNeigh = 0; iNeigh < 8 && !any; iNeigh++) {
+        glm::uvec3 neighInd = brickInd + glm::uvec3{(iNeigh >> 2) & 1, (iNeigh >> 1) & 1, iNeigh & 1};
+        if (neighInd.x < brickDim.x && neighInd.y < brickDim.y && neighInd.z < brickDim.z) {
+          any = accepted[layout.flattenBrickIndex(neighInd)];
+        }
+      }
+      evaluated[i] = any;
+    }
+  });
+
+  std::vector<uint64_t> evaluatedBricks;
+  for (size_t i = 0; i < nBricks; i++) {
+    if (evaluated[i]) evaluatedBricks.push_back(i);
+  }
+
+  // Nodes owned by a brick which was not accepted are background, so that every brick agrees on the nodes it shares
+  std::vector<float> evaluatedValues(evaluatedBricks.size() * SparseBrickLayout::BRICK_SIZE);
+  std::vector<char> keep(evaluatedBricks.size());
+  parallelFor(
+      evaluatedBricks.size(),
+      [&](size_t start, size_t end) {
+        for (size_t iBrick = start; iBrick < end; iBrick++) {
+          glm::uvec3 brickInd = layout.unflattenBrickIndex(evaluatedBricks[iBrick]);
+          float* brickValues = &evaluatedValues[iBrick * SparseBrickLayout::BRICK_SIZE];
+          bool anyNonBackground = false;
+          for (uint32_t z = 0; z < N; z++) {
+            for (uint32_t y = 0; y < N; y++) {
+              for (uint32_t x = 0; x < N; x++) {
+                glm::uvec3 nodeInd = brickInd * B + glm::uvec3{x, y, z};
+                float val = backgroundValue;
+                if (nodeInd.x < nodeDim.x && nodeInd.y < nodeDim.y && nodeInd.z < nodeDim.z) {
+                  glm::uvec3 ownerLocalInd;
+                  glm::uvec3 ownerInd = layout.brickOfNode(nodeInd, ownerLocalInd);
+                  if (accepted[layout.flattenBrickIndex(ownerInd)]) val = nodeFunc(nodeInd);
+                }
+                *brickValues++ = val;
+                anyNonBackground = anyNonBackground || val != backgroundValue;
+              }
+            }
+          }
+          keep[iBrick] = anyNonBackground;
+        }
+      },
+      1);
+
+  // == Pack the bricks which hold anything but background into the atlas
+  for (size_t iBrick = 0; iBrick < evaluatedBricks.size(); iBrick++) {
+    if (!keep[iBrick]) continue;
+    uint32_t slot = grid.addBrick(layout.unflattenBrickIndex(evaluatedBricks[iBrick]));
+    const float* brickValues = &evaluatedValues[iBrick * SparseBrickLayout::BRICK_SIZE];
+    for (uint32_t z = 0; z < N; z++) {
+      for (uint32_t y = 0; y < N; y++) {
+        std::copy(brickValues, brickValues + N, grid.atlasValues.begin() + layout.atlasIndex(slot, {0, y, z}));
+        brickValues += N;
+      }
+    }
+  }
+
+  return grid;
+}
+
+uint32_t SparseBrickGrid::addBrick(glm::uvec3 brickInd) {
+  uint32_t slot = layout.addBrick(brickInd);
+  if (atlasValues.size() < layout.atlasSize()) {
+    atlasValues.resize(layout.atlasSize(), backgroundValue);
+  }
+  return slot;
+}
+
+void SparseBrickGrid::setValue(glm::uvec3 nodeInd, float value) {
+
+  glm::uvec3 nodeDim = layout.getNodeDim();
+  if (nodeInd.x >= nodeDim.x || nodeInd.y >= nodeDim.y || nodeInd.z >= nodeDim.z) {
+    exception("sparse brick grid node index out of bounds");
+  }
+
+  // Along each axis, a node is held by the brick it falls in, and also by the brick below if it lies on a boundary
+  const uint32_t B = SparseBrickLayout::BRICK_CELLS;
+  glm::uvec3 brickDim = layout.getBrickDim();
+  uint32_t nAxisBricks[3];
+  uint32_t axisBricks[3][2];
+  uint32_t axisLocal[3][2];
+  for (int i = 0; i < 3; i++) {
+    nAxisBricks[i] = 0;
+    uint32_t brick = nodeInd[i] / B;
+    if (brick < brickDim[i]) {
+      axisBricks[i][nAxisBricks[i]] = brick;
+      axisLocal[i][nAxisBricks[i]] = nodeInd[i] - brick * B;
+      nAxisBricks[i]++;
+    }
+    if (nodeInd[i] % B == 0 && brick > 0) {
+      axisBricks[i][nAxisBricks[i]] = brick - 1;
+      axisLocal[i][nAxisBricks[i]] = B;
+      nAxisBricks[i]++;
+    }
+  }
+
+  for (uint32_t iX = 0; iX < nAxisBricks[0]; iX++) {
+    for (uint32_t iY = 0; iY < nAxisBricks[1]; iY++) {
+      for (uint32_t iZ = 0; iZ < nAxisBricks[2]; iZ++) {
+        glm::uvec3 brickInd{axisBricks[0][iX], axisBricks[1][iY], axisBricks[2][iZ]};
+        uint32_t slot = layout.getBrickSlot(brickInd);
+        if (slot == INVALID_IND_32) {
+          if (value == backgroundValue) continue;
+          slot = addBrick(brickInd);
+        }
+        atlasValues[layout.atlasIndex(slot, {axisLocal[0][iX], axisLocal[1][iY], axisLocal[2][iZ]})] = value;
+      }
+    }
+  }
+}
+
+float SparseBrickGrid::getValue(glm::uvec3 nodeInd) const {
+  size_t iAtlas = layout.nodeAtlasIndex(nodeInd);
+  if (iAtlas == INVALID_IND_64) return backgroundValue;
+  return atlasValues[iAtlas];
+}
+
+std::vector<float> SparseBrickGrid::toDense() const {
+  glm::uvec3 nodeDim = layout.getNodeDim();
+  size_t nLayer = static_cast<size_t>(nodeDim.x) * nodeDim.y;
+  std::vector<float> values(nLayer * nodeDim.z);
+  parallelFor(
+      nodeDim.z,
+      [&](size_t start, size_t end) {
+        for (size_t z = start; z < end; z++) {
+          for (uint32_t y = 0; y < nodeDim.y; y++) {
+            for (uint32_t x = 0; x < nodeDim.x; x++) {
+              values[z * nLayer + static_cast<size_t>(y) * nodeDim.x + x] =
+                  getValue(glm::uvec3{x, y, static_cast<uint32_t>(z)});
+            }
+          }
+        }
+      },
+      1);
+  return values;
+}
+
+const SparseBrickLayout& SparseBrickGrid::getLayout() const { return layout; }
+const std::vector<float>& SparseBrickGrid::getAtlasValues() const { return atlasValues; }
+float SparseBrickGrid::getBackgroundValue() const { return backgroundValue; }
+
+size_t SparseBrickGrid::memoryUsage() const { return layout.memoryUsage() + atlasValues.size() * sizeof(float); }
+
+} // namespace polyscope
@@ -0,0 +1,190 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/spatial_clusters.h"
+
+#include "polyscope/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace polyscope {
+
+namespace {
+
+// Spread the low 10 bits of x out to every third bit
+uint32_t expandBits10(uint32_t x) {
+  x &= 0x3ff;
+  x = (x | (x << 16)) & 0x30000ff;
+  x = (x | (x << 8)) & 0x300f00f;
+  x = (x | (x << 4)) & 0x30c30c3;
+  x = (x | (x << 2)) & 0x9249249;
+  return x;
+}
+
+uint32_t mortonCode(glm::vec3 p, glm::vec3 low, glm::vec3 scale) {
+  uint32_t code = 0;
+  for (int i = 0; i < 3; i++) {
+    float t = (p[i] - low[i]) * scale[i];
+    if (!(t >= 0.f)) t = 0.f; // also catches nan
+    uint32_t q = static_cast<uint32_t>(std::min(t, 1023.f));
+    code |= expandBits10(q) << i;
+  }
+  return code;
+}
+
+} // namespace
+
+FrustumTest testBoxAgainstFrustum(const std::array<glm::vec3, 2>& box, const glm::mat4& modelViewProj, float pad) {
+  glm::vec3 low = box[0] - pad;
+  glm::vec3 high = box[1] + pad;
+
+  // (in homogeneous clip coordinates, which is exact for corners behind the camera too)
+  std::array<glm::vec4, 8> clipCorners;
+  for (int i = 0; i < 8; i++) {
+    glm::vec3 c{(i & 1) ? high.x : low.x, (i & 2) ? high.y : low.y, (i & 4) ? high.z : low.z};
+    clipCorners[i] = modelViewProj * glm::vec4(c, 1.);
+  }
+
+  bool allInside = true;
+  for (int iAxis = 0; iAxis < 3; iAxis++) {
+    bool allBelow = true;
+    bool allAbove = true;
+    for (const glm::vec4& c : clipCorners) {
+      bool below = c[iAxis] < -c.w;
+      bool above = c[iAxis] > c.w;
+      allBelow = allBelow && below;
+      allAbove = allAbove && above;
+      allInside = allInside && !below && !above;
+    }
+    if (allBelow || allAbove) return FrustumTest::Outside;
+  }
+  return allInside ? FrustumTest::Inside : FrustumTest::Intersects;
+}
+
+void ensureDrawRangesNonEmpty(std::vector<std::array<uint32_t, 2>>& ranges) {
+  if (ranges.empty()) {
+    ranges.push_back({0, 0});
+  }
+}
+
+SpatialClusters::SpatialClusters() {}
+
+SpatialClusters::SpatialClusters(const std::vector<glm::vec3>& elementLow, const std::vector<glm::vec3>& elementHigh) {
+  size_t N = std::min(elementLow.size(), elementHigh.size());
+  if (N == 0) return;
+
+  // Bounds of the element centers, to quantize them for the Morton codes
+  std::vector<glm::vec3> centers(N);
+  parallelFor(N, [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      centers[i] = 0.5f * (elementLow[i] + elementHigh[i]);
+    }
+  });
+  glm::vec3 low{std::numeric_limits<float>::infinity()};
+  glm::vec3 high{-std::numeric_limits<float>::infinity()};
+  for (const glm::vec3& c : centers) {
+    low = glm::min(low, c);
+    high = glm::max(high, c);
+  }
+  glm::vec3 scale;
+  for (int i = 0; i < 3; i++) {
+    float width = high[i] - low[i];
+    scale[i] = (width > 0.f && std::isfinite(width)) ? 1023.f / width : 0.f;
+  }
+
+  // Sort along the curve, breaking ties by index so the order is deterministic
+  std::vector<std::pair<uint32_t, uint32_t>> keys(N);
+  parallelFor(N, [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      keys[i] = std::make_pair(mortonCode(centers[i], low, scale), static_cast<uint32_t>(i));
+    }
+  });
+  std::sort(keys.begin(), keys.end());
+  order.resize(N);
+  for (size_t i = 0; i < N; i++) {
+    order[i] = keys[i].second;
+  }
+
+  // Leaf clusters
+  size_t nLeaves = (N + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+  levelBounds.emplace_back(nLeaves);
+  parallelFor(
+      nLeaves,
+      [&](size_t start, size_t end) {
+        for (size_t iC = start; iC < end; iC++) {
+          glm::vec3 cLow{std::numeric_limits<float>::infinity()};
+          glm::vec3 cHigh{-std::numeric_limits<float>::infinity()};
+          for (size_t i = iC * CLUSTER_SIZE; i < std::min(N, (iC + 1) * CLUSTER_SIZE); i++) {
+            cLow = glm::min(cLow, elementLow[order[i]]);
+            cHigh = glm::max(cHigh, elementHigh[order[i]]);
+          }
+          levelBounds[0][iC] = {cLow, cHigh};
+        }
+      },
+      64);
+
+  // Levels above, up to the root
+  while (levelBounds.back().size() > 1) {
+    const std::vector<std::array<glm::vec3, 2>>& below = levelBounds.back();
+    std::vector<std::array<glm::vec3, 2>> level((below.size() + BRANCHING - 1) / BRANCHING);
+    for (size_t i = 0; i < below.size(); i++) {
+      std::array<glm::vec3, 2>& node = level[i / BRANCHING];
+      if (i % BRANCHING == 0) {
+        node = below[i];
+      } else {
+        node[0] = glm::min(node[0], below[i][0]);
+        node[1] = glm::max(node[1], below[i][1]);
+      }
+    }
+    levelBounds.push_back(std::move(level));
+  }
+}
+
+size_t SpatialClusters::nElements() const { return order.size(); }
+
+size_t SpatialClusters::nClusters() const { return levelBounds.empty() ? 0 : levelBounds[0].size(); }
+
+const std::vector<uint32_t>& SpatialClusters::getOrder() const { return order; }
+
+std::vector<std::array<uint32_t, 2>> SpatialClusters::visibleRanges(const glm::mat4& modelViewProj, float pad) const {
+  std::vector<std::array<uint32_t, 2>> ranges;
+
+  auto addRange = [&](uint64_t start, uint64_t end) {
+    if (!ranges.empty() && ranges.back()[1] == start) {
+      ranges.back()[1] = static_cast<uint32_t>(end);
+    } else {
+      ranges.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end)});
+    }
+  };
+
+  // Walk down from the root, skipping nodes outside the frustum and taking nodes inside it whole
+  std::function<void(size_t, size_t, uint64_t)> visit = [&](size_t iLevel, size_t iNode, uint64_t leavesPerNode) {
+    FrustumTest result = testBoxAgainstFrustum(levelBounds[iLevel][iNode], modelViewProj, pad);
+    if (result == FrustumTest::Outside) return;
+    if (result == FrustumTest::Inside || iLevel == 0) {
+      uint64_t leafStart = iNode * leavesPerNode;
+      uint64_t leafEnd = std::min<uint64_t>((iNode + 1) * leavesPerNode, nClusters());
+      addRange(leafStart * CLUSTER_SIZE, std::min<uint64_t>(leafEnd * CLUSTER_SIZE, order.size()));
+      return;
+    }
+    size_t childEnd = std::min((iNode + 1) * BRANCHING, levelBounds[iLevel - 1].size());
+    for (size_t iChild = iNode * BRANCHING; iChild < childEnd; iChild++) {
+      visit(iLevel - 1, iChild, leavesPerNode / BRANCHING);
+    }
+  };
+
+  if (!levelBounds.empty()) {
+    uint64_t rootLeaves = 1;
+    for (size_t i = 1; i < levelBounds.size(); i++) rootLeaves *= BRANCHING;
+    visit(levelBounds.size() - 1, 0, rootLeaves);
+  }
+
+  ensureDrawRangesNonEmpty(ranges);
+
+  return ranges;
+}
+
+} // namespace polyscope
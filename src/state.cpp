@@ -2,6 +2,8 @@
 
 #include "polyscope/polyscope.h"
 
+#include "polyscope/implicit_helpers.h"
+
 namespace polyscope {
 
 namespace state {
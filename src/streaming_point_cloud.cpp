@@ -0,0 +1,721 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/streaming_point_cloud.h"
+
+#include "polyscope/parallel.h"
+#include "polyscope/pick.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/spatial_clusters.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace polyscope {
+
+// Initialize statics
+const std::string StreamingPointCloud::structureTypeName = "Streaming Point Cloud";
+const uint32_t StreamingPointCloud::CHUNK_SIZE;
+const uint32_t StreamingPointCloud::PAGE_SIZE;
+const uint32_t StreamingPointCloud::MAX_STRIDE;
+const size_t StreamingPointCloud::MAX_UPLOAD_POINTS_WHILE_MOVING;
+
+// Constructor
+StreamingPointCloud::StreamingPointCloud(std::string name, std::string filename, size_t byteOffset,
+                                         size_t recordBytes)
+    : // clang-format off
+      Structure(name, structureTypeName),
+      pointRenderMode(uniquePrefix() + "pointRenderMode", "quad"),
+      pointColor(uniquePrefix() + "pointColor", getNextUniqueColor()),
+      pointRadius(uniquePrefix() + "pointRadius", relativeValue(0.002)),
+      material(uniquePrefix() + "material", "clay"),
+      cMap(uniquePrefix() + "cmap", "viridis")
+// clang-format on
+{
+  positions = openMappedArray(filename, byteOffset, recordBytes, 3 * sizeof(float));
+  buildChunks();
+  updateObjectSpaceBounds();
+}
+
+StreamingPointCloud::MappedArray StreamingPointCloud::openMappedArray(std::string filename, size_t byteOffset,
+                                                                      size_t recordBytes, size_t valueBytes) {
+  MappedArray arr;
+  arr.file = MappedFile(filename);
+  arr.byteOffset = byteOffset;
+  arr.recordBytes = recordBytes == 0 ? valueBytes : recordBytes;
+  if (arr.recordBytes < valueBytes) {
+    exception("record size for file [" + filename + "] is smaller than the " + std::to_string(valueBytes) +
+              " bytes of a value");
+  }
+
+  // (the last record only needs to hold the value, not a whole record)
+  size_t fileSize = arr.file.size();
+  arr.count = fileSize < byteOffset + valueBytes ? 0 : (fileSize - byteOffset - valueBytes) / arr.recordBytes + 1;
+  return arr;
+}
+
+glm::vec3 StreamingPointCloud::readPosition(size_t i) const {
+  glm::vec3 p;
+  std::memcpy(&p[0], positions.file.data() + positions.byteOffset + i * positions.recordBytes, 3 * sizeof(float));
+  return p;
+}
+
+float StreamingPointCloud::readValue(const MappedArray& arr, size_t i) const {
+  float v;
+  std::memcpy(&v, arr.file.data() + arr.byteOffset + i * arr.recordBytes, sizeof(float));
+  return v;
+}
+
+void StreamingPointCloud::buildChunks() {
+  size_t nChunks = (positions.count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  chunks.resize(nChunks);
+
+  // One pass through the file, each chunk independently
+  parallelFor(
+      nChunks,
+      [&](size_t start, size_t end) {
+        for (size_t iC = start; iC < end; iC++) {
+          Chunk& c = chunks[iC];
+          c.start = iC * CHUNK_SIZE;
+          c.count = static_cast<uint32_t>(std::min<size_t>(CHUNK_SIZE, positions.count - c.start));
+          glm::vec3 low{std::numeric_limits<float>::infinity()};
+          glm::vec3 high{-std::numeric_limits<float>::infinity()};
+          for (size_t i = c.start; i < c.start + c.count; i++) {
+            glm::vec3 p = readPosition(i);
+            if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) continue;
+            low = glm::min(low, p);
+            high = glm::max(high, p);
+          }
+          c.bounds = {low, high};
+        }
+      },
+      1);
+}
+
+size_t StreamingPointCloud::nPoints() { return positions.count; }
+
+size_t StreamingPointCloud::nChunks() { return chunks.size(); }
+
+void StreamingPointCloud::updateObjectSpaceBounds() {
+  glm::vec3 low{std::numeric_limits<float>::infinity()};
+  glm::vec3 high{-std::numeric_limits<float>::infinity()};
+  for (const Chunk& c : chunks) {
+    low = glm::min(low, c.bounds[0]);
+    high = glm::max(high, c.bounds[1]);
+  }
+  objectSpaceBoundingBox = std::make_tuple(low, high);
+
+  // length scale, from the diagonal of the bounding box (the points are not all in memory to measure a radius)
+  objectSpaceLengthScale = (low.x <= high.x) ? glm::length(high - low) : 0.;
+}
+
+std::string StreamingPointCloud::typeName() { return structureTypeName; }
+
+// === Scalar quantities
+
+StreamingPointCloud* StreamingPointCloud::addScalarQuantityFromFile(std::string name, std::string filename,
+                                                                    size_t byteOffset, size_t recordBytes) {
+  ScalarQuantityFile q;
+  q.name = name;
+  q.values = openMappedArray(filename, byteOffset, recordBytes, sizeof(float));
+  if (q.values.count < nPoints()) {
+    exception("scalar quantity [" + name + "] file [" + filename + "] holds " + std::to_string(q.values.count) +
+              " values, but point cloud [" + this->name + "] has " + std::to_string(nPoints()) + " points");
+    return this;
+  }
+
+  // Data range, skipping non-finite values
+  size_t nBlocks = (nPoints() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  std::vector<std::pair<double, double>> blockRanges(nBlocks);
+  parallelFor(
+      nBlocks,
+      [&](size_t start, size_t end) {
+        for (size_t iB = start; iB < end; iB++) {
+          double low = std::numeric_limits<double>::infinity();
+          double high = -std::numeric_limits<double>::infinity();
+          for (size_t i = iB * CHUNK_SIZE; i < std::min<size_t>((iB + 1) * CHUNK_SIZE, nPoints()); i++) {
+            float v = readValue(q.values, i);
+            if (!std::isfinite(v)) continue;
+            low = std::min(low, static_cast<double>(v));
+            high = std::max(high, static_cast<double>(v));
+          }
+          blockRanges[iB] = {low, high};
+        }
+      },
+      1);
+  q.dataRange = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+  for (const std::pair<double, double>& r : blockRanges) {
+    q.dataRange.first = std::min(q.dataRange.first, r.first);
+    q.dataRange.second = std::max(q.dataRange.second, r.second);
+  }
+  if (q.dataRange.first > q.dataRange.second) q.dataRange = {0., 1.}; // no finite values
+
+  // Replace any existing quantity of the same name
+  for (size_t i = 0; i < scalarQuantities.size(); i++) {
+    if (scalarQuantities[i].name == name) {
+      scalarQuantities.erase(scalarQuantities.begin() + i);
+      break;
+    }
+  }
+  scalarQuantities.push_back(std::move(q));
+
+  // the active quantity may have been replaced, re-upload it
+  if (activeScalarQuantity == name) {
+    setActiveScalarQuantity(name);
+  }
+
+  return this;
+}
+
+std::vector<std::string> StreamingPointCloud::getScalarQuantityNames() {
+  std::vector<std::string> names;
+  for (const ScalarQuantityFile& q : scalarQuantities) {
+    names.push_back(q.name);
+  }
+  return names;
+}
+
+StreamingPointCloud::ScalarQuantityFile* StreamingPointCloud::resolveActiveScalarQuantity() {
+  for (ScalarQuantityFile& q : scalarQuantities) {
+    if (q.name == activeScalarQuantity) return &q;
+  }
+  return nullptr;
+}
+
+StreamingPointCloud* StreamingPointCloud::setActiveScalarQuantity(std::string name) {
+  activeScalarQuantity = name;
+  ScalarQuantityFile* q = resolveActiveScalarQuantity();
+  if (name != "" && q == nullptr) {
+    activeScalarQuantity = "";
+    exception("point cloud [" + this->name + "] has no scalar quantity [" + name + "]");
+  }
+  if (q != nullptr) {
+    mapRange = q->dataRange;
+  }
+
+  // the pool holds the values of the active quantity, it needs to be reloaded
+  clearResidency();
+  positionPool.reset();
+  valuePool.reset();
+  refresh();
+  return this;
+}
+std::string StreamingPointCloud::getActiveScalarQuantity() { return activeScalarQuantity; }
+
+StreamingPointCloud* StreamingPointCloud::setColorMap(std::string val) {
+  cMap = val;
+  refresh();
+  return this;
+}
+std::string StreamingPointCloud::getColorMap() { return cMap.get(); }
+
+StreamingPointCloud* StreamingPointCloud::setMapRange(std::pair<double, double> val) {
+  mapRange = val;
+  requestRedraw();
+  return this;
+}
+std::pair<double, double> StreamingPointCloud::getMapRange() { return mapRange; }
+
+// === Streaming
+
+void StreamingPointCloud::clearResidency() {
+  for (Chunk& c : chunks) {
+    c.stride = 0;
+    c.residentCount = 0;
+    c.pages.clear();
+  }
+  freePages.clear();
+  drawRanges.clear();
+}
+
+void StreamingPointCloud::ensurePoolAllocated() {
+  size_t bytesPerPoint = 3 * sizeof(float) + (resolveActiveScalarQuantity() ? sizeof(float) : 0);
+  if (positionPool && poolBytesPerPoint == bytesPerPoint && poolBudget == options::streamingPointCloudGPUBudget) {
+    return;
+  }
+
+  clearResidency();
+  program.reset();
+  pickProgram.reset();
+
+  // As many pages as the budget allows, but no more than it takes to hold every point
+  size_t pagesForAll = 0;
+  for (const Chunk& c : chunks) {
+    pagesForAll += (c.count + PAGE_SIZE - 1) / PAGE_SIZE;
+  }
+  poolPages = std::min(pagesForAll, options::streamingPointCloudGPUBudget / (PAGE_SIZE * bytesPerPoint));
+  poolPages = std::min<size_t>(poolPages, std::numeric_limits<uint32_t>::max() / PAGE_SIZE);
+  poolBytesPerPoint = bytesPerPoint;
+  poolBudget = options::streamingPointCloudGPUBudget;
+
+  // (hand out low pages first, so pages of a chunk tend to be adjacent and draw as a single range)
+  for (size_t i = 0; i < poolPages; i++) {
+    freePages.push_back(static_cast<uint32_t>(poolPages - 1 - i));
+  }
+
+  positionPool = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+  // (sized without a host copy, pages are only drawn once uploadChunk() has filled them)
+  positionPool->allocate(std::max<size_t>(poolPages, 1) * PAGE_SIZE);
+  if (resolveActiveScalarQuantity()) {
+    valuePool = render::engine->generateAttributeBuffer(RenderDataType::Float);
+    valuePool->allocate(std::max<size_t>(poolPages, 1) * PAGE_SIZE);
+  } else {
+    valuePool.reset();
+  }
+}
+
+void StreamingPointCloud::releasePages(Chunk& c) {
+  freePages.insert(freePages.end(), c.pages.rbegin(), c.pages.rend());
+  c.pages.clear();
+  c.stride = 0;
+  c.residentCount = 0;
+}
+
+void StreamingPointCloud::uploadChunk(Chunk& c, uint32_t stride) {
+  uint32_t n = (c.count + stride - 1) / stride;
+
+  std::vector<glm::vec3> positionData(n);
+  std::vector<float> valueData;
+  ScalarQuantityFile* q = resolveActiveScalarQuantity();
+  if (q) valueData.resize(n);
+  for (uint32_t k = 0; k < n; k++) {
+    size_t i = c.start + static_cast<size_t>(k) * stride;
+    positionData[k] = readPosition(i);
+    if (q) valueData[k] = readValue(q->values, i);
+  }
+
+  for (size_t iPage = 0; iPage < c.pages.size(); iPage++) {
+    size_t dataStart = iPage * PAGE_SIZE;
+    size_t count = std::min<size_t>(PAGE_SIZE, n - dataStart);
+    size_t bufferStart = static_cast<size_t>(c.pages[iPage]) * PAGE_SIZE;
+    positionPool->setDataRange(positionData, dataStart, bufferStart, count);
+    if (q) valuePool->setDataRange(valueData, dataStart, bufferStart, count);
+  }
+
+  c.stride = stride;
+  c.residentCount = n;
+  uploadedPointCount += n;
+}
+
+void StreamingPointCloud::updateResidency() {
+  ensurePoolAllocated();
+  frameCount++;
+
+  glm::mat4 modelViewProj = view::getCameraPerspectiveMatrix() * getModelView();
+  glm::vec4 viewport = render::engine->getCurrentViewport();
+  float pad = pointRadius.get().asAbsolute();
+
+  // While the camera moves, draw coarser and cap the uploads per frame; once it rests, aim for a point per pixel
+  bool moving = view::viewIsChanging();
+  float pixelSpacing = moving ? std::max(options::pointCloudLODPixelSpacing, 1.f) : 1.f;
+  size_t uploadBudget = moving ? MAX_UPLOAD_POINTS_WHILE_MOVING : std::numeric_limits<size_t>::max();
+
+  // The chunks in view, each with the stride which gives the desired density on screen
+  struct Request {
+    uint32_t iChunk;
+    float nearW;
+    uint32_t stride;
+  };
+  std::vector<Request> requests;
+  for (size_t iC = 0; iC < chunks.size(); iC++) {
+    const Chunk& c = chunks[iC];
+    if (c.count == 0 || !(c.bounds[0].x <= c.bounds[1].x)) continue;
+    if (options::cullStructures && testBoxAgainstFrustum(c.bounds, modelViewProj, pad) == FrustumTest::Outside) {
+      continue;
+    }
+
+    // screen-space extent of the bounds
+    float nearW = std::numeric_limits<float>::infinity();
+    glm::vec2 ndcLow{std::numeric_limits<float>::infinity()};
+    glm::vec2 ndcHigh{-std::numeric_limits<float>::infinity()};
+    for (int i = 0; i < 8; i++) {
+      glm::vec3 corner{(i & 1) ? c.bounds[1].x : c.bounds[0].x, (i & 2) ? c.bounds[1].y : c.bounds[0].y,
+                       (i & 4) ? c.bounds[1].z : c.bounds[0].z};
+      glm::vec4 clip = modelViewProj * glm::vec4(corner, 1.);
+      nearW = std::min(nearW, clip.w);
+      if (clip.w > 0.f) {
+        glm::vec2 ndc{clip.x / clip.w, clip.y / clip.w};
+        ndcLow = glm::min(ndcLow, ndc);
+        ndcHigh = glm::max(ndcHigh, ndc);
+      }
+    }
+
+    uint32_t stride = 1;
+    if (nearW > 0.f) { // (otherwise the chunk reaches behind the camera, draw it at full density)
+      ndcLow = glm::clamp(ndcLow, glm::vec2{-1.f}, glm::vec2{1.f});
+      ndcHigh = glm::clamp(ndcHigh, glm::vec2{-1.f}, glm::vec2{1.f});
+      glm::vec2 extentPixels = 0.5f * (ndcHigh - ndcLow) * glm::vec2{viewport[2], viewport[3]};
+      float wantedPoints = extentPixels.x * extentPixels.y / (pixelSpacing * pixelSpacing);
+      while (stride < MAX_STRIDE && c.count / (4 * stride) >= wantedPoints) stride *= 4;
+    }
+    requests.push_back(Request{static_cast<uint32_t>(iC), nearW, stride});
+  }
+
+  // Nearest chunks get served first
+  std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) { return a.nearW < b.nearW; });
+
+  // Chunks which have not been used yet this frame can be evicted, least recently used first
+  std::vector<uint32_t> lru;
+  size_t evictablePages = 0;
+  for (size_t iC = 0; iC < chunks.size(); iC++) {
+    if (chunks[iC].stride == 0) continue;
+    lru.push_back(static_cast<uint32_t>(iC));
+    evictablePages += chunks[iC].pages.size();
+  }
+  std::sort(lru.begin(), lru.end(),
+            [&](uint32_t a, uint32_t b) { return chunks[a].lastUsedFrame < chunks[b].lastUsedFrame; });
+  size_t lruPos = 0;
+
+  auto markUsed = [&](Chunk& c) {
+    if (c.lastUsedFrame < frameCount) evictablePages -= c.pages.size();
+    c.lastUsedFrame = frameCount;
+  };
+
+  size_t uploaded = 0;
+  bool incomplete = false;
+  for (const Request& r : requests) {
+    Chunk& c = chunks[r.iChunk];
+
+    // Take the desired stride, or coarser ones if the pool is full
+    for (uint32_t stride = r.stride; stride <= MAX_STRIDE && c.stride != stride; stride *= 4) {
+      size_t n = (c.count + stride - 1) / stride;
+      size_t pagesNeeded = (n + PAGE_SIZE - 1) / PAGE_SIZE;
+      if (uploaded + n > uploadBudget) {
+        incomplete = true;
+        break;
+      }
+      if (pagesNeeded > freePages.size() + evictablePages) continue;
+
+      evictablePages -= c.pages.size();
+      releasePages(c);
+      while (freePages.size() < pagesNeeded) {
+        Chunk& victim = chunks[lru[lruPos++]];
+        if (victim.stride == 0 || victim.lastUsedFrame == frameCount) continue;
+        evictablePages -= victim.pages.size();
+        releasePages(victim);
+      }
+      c.pages.assign(freePages.rbegin(), freePages.rbegin() + pagesNeeded);
+      freePages.resize(freePages.size() - pagesNeeded);
+      uploadChunk(c, stride);
+      c.lastUsedFrame = frameCount;
+      uploaded += n;
+    }
+
+    if (c.stride != 0) markUsed(c);
+  }
+
+  // Draw the pages of every chunk used this frame
+  std::vector<std::array<uint32_t, 2>> previousDrawRanges;
+  previousDrawRanges.swap(drawRanges);
+  drawnPointCount = 0;
+  for (const Chunk& c : chunks) {
+    if (c.stride == 0 || c.lastUsedFrame != frameCount) continue;
+    for (size_t iPage = 0; iPage < c.pages.size(); iPage++) {
+      uint32_t start = c.pages[iPage] * PAGE_SIZE;
+      uint32_t count = static_cast<uint32_t>(std::min<size_t>(PAGE_SIZE, c.residentCount - iPage * PAGE_SIZE));
+      drawRanges.push_back({start, start + count});
+    }
+    drawnPointCount += c.residentCount;
+  }
+  std::sort(drawRanges.begin(), drawRanges.end());
+  std::vector<std::array<uint32_t, 2>> merged;
+  for (const std::array<uint32_t, 2>& range : drawRanges) {
+    if (!merged.empty() && merged.back()[1] == range[0]) {
+      merged.back()[1] = range[1];
+    } else {
+      merged.push_back(range);
+    }
+  }
+  drawRanges = std::move(merged);
+
+  // What the pick pass draws has changed
+  if (uploaded > 0 || drawRanges != previousDrawRanges) markSceneChanged();
+
+  // Come back for the rest next frame
+  if (incomplete) requestRedraw();
+}
+
+size_t StreamingPointCloud::getResidentPointCount() {
+  size_t count = 0;
+  for (const Chunk& c : chunks) {
+    count += c.residentCount;
+  }
+  return count;
+}
+
+size_t StreamingPointCloud::getDrawnPointCount() { return drawnPointCount; }
+
+size_t StreamingPointCloud::getUploadedPointCount() { return uploadedPointCount; }
+
+size_t StreamingPointCloud::getGPUPoolBytes() { return positionPool ? poolPages * PAGE_SIZE * poolBytesPerPoint : 0; }
+
+// === Drawing
+
+void StreamingPointCloud::prepareFrame() {
+  // Once per frame rather than in draw(), the other passes (ground plane reflection and shadow, picking) draw the
+  // chunks selected for the main camera rather than streaming in chunks for their own views
+  updateResidency();
+}
+
+void StreamingPointCloud::draw() {
+  if (!isEnabled()) {
+    return;
+  }
+
+  if (drawRanges.empty()) return; // (an empty list of ranges would draw the whole pool)
+
+  ensureRenderProgramPrepared();
+
+  // Set program uniforms
+  setStructureUniforms(*program);
+  setStreamingPointCloudUniforms(*program);
+  render::engine->setMaterialUniforms(*program, material.get());
+  if (resolveActiveScalarQuantity()) {
+    program->setUniform("u_rangeLow", mapRange.first);
+    program->setUniform("u_rangeHigh", mapRange.second);
+  } else {
+    program->setUniform("u_baseColor", pointColor.get());
+  }
+  program->setDrawRanges(drawRanges);
+
+  program->draw();
+}
+
+void StreamingPointCloud::drawDelayed() {}
+
+void StreamingPointCloud::drawPick() {
+  if (!isEnabled() || drawRanges.empty()) {
+    return;
+  }
+
+  // Ensure we have prepared buffers
+  ensurePickProgramPrepared();
+
+  // Set uniforms
+  setStructureUniforms(*pickProgram);
+  setStreamingPointCloudUniforms(*pickProgram);
+  pickProgram->setUniform("u_color", pickColor);
+  pickProgram->setDrawRanges(drawRanges);
+
+  pickProgram->draw();
+}
+
+void StreamingPointCloud::setStreamingPointCloudUniforms(render::ShaderProgram& p) {
+  glm::mat4 P = view::getCameraPerspectiveMatrix();
+  glm::mat4 Pinv = glm::inverse(P);
+
+  if (getPointRenderMode() == PointRenderMode::Sphere) {
+    p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
+    p.setUniform("u_viewport", render::engine->getCurrentViewport());
+  }
+  p.setUniform("u_pointRadius", pointRadius.get().asAbsolute());
+}
+
+void StreamingPointCloud::ensureRenderProgramPrepared() {
+  // If already prepared, do nothing
+  if (program) return;
+
+  bool withScalar = resolveActiveScalarQuantity() != nullptr;
+
+  // clang-format off
+  program = render::engine->requestShader(getShaderNameForRenderMode(),
+    render::engine->addMaterialRules(getMaterial(),
+      addStreamingPointCloudRules(
+        withScalar ? std::vector<std::string>{"SPHERE_PROPAGATE_VALUE", "SHADE_COLORMAP_VALUE"} :
+                     std::vector<std::string>{"SHADE_BASECOLOR"}
+      )
+    )
+  );
+  // clang-format on
+
+  program->setAttribute("a_position", positionPool);
+  if (withScalar) {
+    program->setAttribute("a_value", valuePool);
+    program->setTextureFromColormap("t_colormap", cMap.get());
+  }
+
+  render::engine->setMaterial(*program, getMaterial());
+}
+
+void StreamingPointCloud::ensurePickProgramPrepared() {
+
+  // If already prepared, do nothing
+  if (pickProgram) return;
+
+  // clang-format off
+  pickProgram = render::engine->requestShader(getShaderNameForRenderMode(),
+    addStreamingPointCloudRules({"SHADECOLOR_FROM_UNIFORM"}),
+    render::ShaderReplacementDefaults::Pick
+  );
+  // clang-format on
+
+  pickProgram->setAttribute("a_position", positionPool);
+
+  // The whole point cloud is a single pick target, the points are not all in memory to tell them apart
+  pickStart = pick::requestPickBufferRange(this, 1);
+  pickColor = pick::indToVec(pickStart);
+}
+
+std::vector<std::string> StreamingPointCloud::addStreamingPointCloudRules(std::vector<std::string> initRules) {
+  initRules = addStructureRules(initRules);
+  if (wantsCullPosition()) {
+    if (getPointRenderMode() == PointRenderMode::Sphere)
+      initRules.push_back("SPHERE_CULLPOS_FROM_CENTER");
+    else if (getPointRenderMode() == PointRenderMode::Quad)
+      initRules.push_back("SPHERE_CULLPOS_FROM_CENTER_QUAD");
+  }
+  return initRules;
+}
+
+std::string StreamingPointCloud::getShaderNameForRenderMode() {
+  if (getPointRenderMode() == PointRenderMode::Sphere)
+    return "RAYCAST_SPHERE";
+  else if (getPointRenderMode() == PointRenderMode::Quad)
+    return "POINT_QUAD";
+  return "ERROR";
+}
+
+void StreamingPointCloud::refresh() {
+  program.reset();
+  pickProgram.reset();
+  requestRedraw();
+  Structure::refresh();
+}
+
+float StreamingPointCloud::getRenderPadding() { return pointRadius.get().asAbsolute(); }
+
+// === UI
+
+void StreamingPointCloud::buildCustomUI() {
+  ImGui::Text("# points: %lld  (%lld on the GPU)", static_cast<long long int>(nPoints()),
+              static_cast<long long int>(getResidentPointCount()));
+  if (ImGui::ColorEdit3("Point color", &pointColor.get()[0], ImGuiColorEditFlags_NoInputs)) {
+    setPointColor(getPointColor());
+  }
+  ImGui::SameLine();
+  ImGui::PushItemWidth(70);
+  if (ImGui::SliderFloat("Radius", pointRadius.get().getValuePtr(), 0.0, .1, "%.5f",
+                         ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat)) {
+    pointRadius.manuallyChanged();
+    requestRedraw();
+  }
+  ImGui::PopItemWidth();
+
+  if (!scalarQuantities.empty()) {
+    std::string label = activeScalarQuantity == "" ? "none" : activeScalarQuantity;
+    if (ImGui::BeginCombo("Scalar", label.c_str())) {
+      if (ImGui::Selectable("none", activeScalarQuantity == "")) setActiveScalarQuantity("");
+      for (const ScalarQuantityFile& q : scalarQuantities) {
+        if (ImGui::Selectable(q.name.c_str(), activeScalarQuantity == q.name)) setActiveScalarQuantity(q.name);
+      }
+      ImGui::EndCombo();
+    }
+
+    if (resolveActiveScalarQuantity()) {
+      if (render::buildColormapSelector(cMap.get())) {
+        cMap.manuallyChanged();
+        setColorMap(cMap.get());
+      }
+      float range[2] = {static_cast<float>(mapRange.first), static_cast<float>(mapRange.second)};
+      if (ImGui::DragFloat2("Range", range)) {
+        setMapRange({range[0], range[1]});
+      }
+    }
+  }
+}
+
+void StreamingPointCloud::buildCustomOptionsUI() {
+  if (ImGui::BeginMenu("Point Render Mode")) {
+    if (ImGui::MenuItem("sphere (pretty)", NULL, getPointRenderMode() == PointRenderMode::Sphere))
+      setPointRenderMode(PointRenderMode::Sphere);
+    if (ImGui::MenuItem("quad (fast)", NULL, getPointRenderMode() == PointRenderMode::Quad))
+      setPointRenderMode(PointRenderMode::Quad);
+    ImGui::EndMenu();
+  }
+
+  if (render::buildMaterialOptionsGui(material.get())) {
+    material.manuallyChanged();
+    setMaterial(material.get()); // trigger the other updates that happen on set()
+  }
+}
+
+void StreamingPointCloud::buildPickUI(size_t localPickID) {
+  ImGui::Text("%lld points, streamed from %s", static_cast<long long int>(nPoints()),
+              positions.file.getFilename().c_str());
+}
+
+// === Option getters and setters
+
+StreamingPointCloud* StreamingPointCloud::setPointRenderMode(PointRenderMode newVal) {
+  switch (newVal) {
+  case PointRenderMode::Sphere:
+    pointRenderMode = "sphere";
+    break;
+  case PointRenderMode::Quad:
+    pointRenderMode = "quad";
+    break;
+  }
+  refresh();
+  requestRedraw();
+  return this;
+}
+PointRenderMode StreamingPointCloud::getPointRenderMode() {
+  // The point render mode is stored as string internally to simplify persistent value handling
+  if (pointRenderMode.get() == "sphere")
+    return PointRenderMode::Sphere;
+  else if (pointRenderMode.get() == "quad")
+    return PointRenderMode::Quad;
+  return PointRenderMode::Quad; // should never happen
+}
+
+StreamingPointCloud* StreamingPointCloud::setPointColor(glm::vec3 newVal) {
+  pointColor = newVal;
+  polyscope::requestRedraw();
+  return this;
+}
+glm::vec3 StreamingPointCloud::getPointColor() { return pointColor.get(); }
+
+StreamingPointCloud* StreamingPointCloud::setPointRadius(double newVal, bool isRelative) {
+  pointRadius = ScaledValue<float>(newVal, isRelative);
+  polyscope::requestRedraw();
+  return this;
+}
+double StreamingPointCloud::getPointRadius() { return pointRadius.get().asAbsolute(); }
+
+StreamingPointCloud* StreamingPointCloud::setMaterial(std::string m) {
+  material = m;
+  refresh();
+  requestRedraw();
+  return this;
+}
+std::string StreamingPointCloud::getMaterial() { return material.get(); }
+
+// === Registration
+
+StreamingPointCloud* registerStreamingPointCloud(std::string name, std::string filename, size_t byteOffset,
+                                                 size_t recordBytes) {
+  checkInitialized();
+
+  StreamingPointCloud* s = new StreamingPointCloud(name, filename, byteOffset, recordBytes);
+
+  bool success = registerStructure(s);
+  if (!success) {
+    safeDelete(s);
+  }
+
+  return s;
+}
+
+StreamingPointCloud* getStreamingPointCloud(std::string name) {
+  return dynamic_cast<StreamingPointCloud*>(getStructure(StreamingPointCloud::structureTypeName, name));
+}
+bool hasStreamingPointCloud(std::string name) { return hasStructure(StreamingPointCloud::structureTypeName, name); }
+void removeStreamingPointCloud(std::string name, bool errorIfAbsent) {
+  removeStructure(StreamingPointCloud::structureTypeName, name, errorIfAbsent);
+}
+
+} // namespace polyscope
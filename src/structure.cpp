@@ -6,6 +6,10 @@
 
 #include "imgui.h"
 
+#include <array>
+#include <cmath>
+#include <limits>
+
 namespace polyscope {
 
 Structure::Structure(std::string name_, std::string subtypeName)
@@ -49,6 +53,8 @@ void Structure::addToGroup(std::string groupName) { addToGroup(*getGroup(groupNa
 
 void Structure::addToGroup(Group& group) { group.addChildStructure(*this); }
 
+void Structure::prepareFrame() {}
+
 void Structure::buildUI() {
   ImGui::PushID(name.c_str()); // ensure there are no conflicts with
                                // identically-named labels
@@ -158,6 +164,7 @@ void Structure::buildCustomOptionsUI() {}
 
 void Structure::refresh() {
   updateObjectSpaceBounds();
+  markSceneChanged();
   requestRedraw();
 }
 
@@ -223,6 +230,74 @@ void Structure::rescaleToUnit() {
 
 bool Structure::hasExtents() { return true; }
 
+float Structure::getRenderPadding() { return 0.; }
+
+uint64_t Structure::geometryDataVersion() { return 0; }
+
+bool Structure::isCulled() {
+  if (!options::cullStructures || !hasExtents()) return false;
+  if (geometryDataVersion() != objectSpaceBoundsDataVersion) return false;
+
+  // World-space bounds of the (possibly rotated) object-space box, padded by the size that points, vectors, etc are
+  // drawn with past the geometry itself
+  glm::vec3 objLow = std::get<0>(objectSpaceBoundingBox);
+  glm::vec3 objHigh = std::get<1>(objectSpaceBoundingBox);
+  const glm::mat4x4& T = objectTransform.get();
+  glm::vec3 low{std::numeric_limits<float>::infinity()};
+  glm::vec3 high{-std::numeric_limits<float>::infinity()};
+  for (int i = 0; i < 8; i++) {
+    glm::vec3 c{(i & 1) ? objHigh.x : objLow.x, (i & 2) ? objHigh.y : objLow.y, (i & 4) ? objHigh.z : objLow.z};
+    glm::vec4 ch = T * glm::vec4(c, 1.);
+    low = glm::min(low, glm::vec3(ch) / ch.w);
+    high = glm::max(high, glm::vec3(ch) / ch.w);
+  }
+  if (glm::any(glm::isnan(low)) || glm::any(glm::isnan(high)) || glm::any(glm::isinf(low)) ||
+      glm::any(glm::isinf(high))) {
+    return false;
+  }
+  float margin = getRenderPadding();
+  if (!std::isfinite(margin)) return false;
+  low -= margin;
+  high += margin;
+
+  std::array<glm::vec3, 8> corners;
+  for (int i = 0; i < 8; i++) {
+    corners[i] = glm::vec3{(i & 1) ? high.x : low.x, (i & 2) ? high.y : low.y, (i & 4) ? high.z : low.z};
+  }
+
+  // Entirely outside one of the clip planes of the view frustum
+  // (testing in homogeneous clip coordinates is exact for corners behind the camera, too). Uses the view of the current
+  // pass, which the ground plane mirrors or projects when drawing reflections and shadows.
+  glm::mat4 viewProj = view::getCameraPerspectiveMatrix() * view::viewMat;
+  std::array<glm::vec4, 8> clipCorners;
+  for (int i = 0; i < 8; i++) {
+    clipCorners[i] = viewProj * glm::vec4(corners[i], 1.);
+  }
+  for (int iAxis = 0; iAxis < 3; iAxis++) {
+    bool allBelow = true;
+    bool allAbove = true;
+    for (const glm::vec4& c : clipCorners) {
+      allBelow = allBelow && c[iAxis] < -c.w;
+      allAbove = allAbove && c[iAxis] > c.w;
+    }
+    if (allBelow || allAbove) return true;
+  }
+
+  // Entirely on the culled side of a slice plane
+  for (std::unique_ptr<SlicePlane>& s : state::slicePlanes) {
+    if (!s->getActive() || getIgnoreSlicePlane(s->name)) continue;
+    glm::vec3 center = s->getCenter();
+    glm::vec3 normal = s->getNormal();
+    bool allCulled = true;
+    for (const glm::vec3& c : corners) {
+      allCulled = allCulled && glm::dot(c - center, normal) < 0.;
+    }
+    if (allCulled) return true;
+  }
+
+  return false;
+}
+
 glm::mat4 Structure::getModelView() { return view::getCameraViewMatrix() * objectTransform.get(); }
 
 std::vector<std::string> Structure::addStructureRules(std::vector<std::string> initRules) {
@@ -250,6 +325,10 @@ void Structure::setStructureUniforms(render::ShaderProgram& p) {
       p.setUniform("u_transparency", transparency.get());
     }
 
+    if (p.hasUniform("u_weightedAccumulatePass")) {
+      p.setUniform("u_weightedAccumulatePass", render::engine->getWeightedAccumulatePass() ? 1 : 0);
+    }
+
     if (p.hasUniform("u_viewportDim")) {
       glm::vec4 viewport = render::engine->getCurrentViewport();
       glm::vec2 viewportDim{viewport[2], viewport[3]};
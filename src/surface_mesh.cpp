@@ -4,6 +4,8 @@
 
 #include "glm/fwd.hpp"
 #include "polyscope/combining_hash_functions.h"
+#include "polyscope/mesh_edge_table.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
@@ -12,6 +14,7 @@
 #include "polyscope/types.h"
 #include "polyscope/utilities.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <utility>
 
@@ -60,7 +63,11 @@ edgeColor(              uniquePrefix() + "edgeColor",       glm::vec3{0., 0., 0.
 edgeWidth(              uniquePrefix() + "edgeWidth",       0.),
 backFacePolicy(         uniquePrefix() + "backFacePolicy",  BackFacePolicy::Different),
 backFaceColor(          uniquePrefix() + "backFaceColor",   glm::vec3(1.f - surfaceColor.get().r, 1.f - surfaceColor.get().g, 1.f - surfaceColor.get().b)),
-shadeStyle(             uniquePrefix() + "shadeStyle",      MeshShadeStyle::Flat)
+shadeStyle(             uniquePrefix() + "shadeStyle",      MeshShadeStyle::Flat),
+spatialChunking(        uniquePrefix() + "spatialChunking", false),
+
+// == spatial chunking
+clusterOrder(           this, uniquePrefix() + "clusterOrder",        clusterOrderData)
 
 // clang-format on
 {}
@@ -182,115 +189,81 @@ void SurfaceMesh::computeConnectivityData() {
 // =====    Lazily-Populated Connectivity   ========
 // =================================================
 
-void SurfaceMesh::computeTriangleAllEdgeInds() {
+void SurfaceMesh::ensureHaveEdgeTable() {
+  if (!halfedgeEdgeCanonical.empty() || nHalfedges() == 0) return; // already populated
+
+  // Edges, halfedge-edge indices, and twins all come out of a single pass of the shared edge table builder
+  MeshEdgeTable table = buildMeshEdgeTable(faceIndsStart, faceIndsEntries, nVertices());
+
+  nEdgesCount = table.nEdges;
+  halfedgeEdgeCanonical = std::move(table.halfedgeEdge);
+
+  twinHalfedge.resize(nHalfedges());
+  for (size_t iHe = 0; iHe < nHalfedges(); iHe++) {
+    uint32_t t = table.twinHalfedge[iHe];
+    twinHalfedge[iHe] = (t == INVALID_IND_32) ? INVALID_IND : t;
+  }
+}
 
-  // WARNING: logic duplicated in countEdges()
+void SurfaceMesh::computeTriangleAllEdgeInds() {
 
   if (edgePerm.empty())
     exception("SurfaceMesh " + name +
               " performed an operation which requires edge indices to be specified, but none have been set. "
               "Call setEdgePermutation().");
 
-  triangleVertexInds.ensureHostBufferPopulated();
+  ensureHaveEdgeTable();
+  if (nEdgesCount > edgePerm.size()) {
+    exception("SurfaceMesh " + name + " edge indexing out of bounds. Did you pass an edge ordering that is too short?");
+  }
+
   triangleAllEdgeInds.data.resize(3 * 3 * nFacesTriangulation());
   halfedgeEdgeCorrespondence.resize(nHalfedges());
 
-  // used to loop over edges
-  std::unordered_map<std::pair<size_t, size_t>, size_t, polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
-      seenEdgeInds;
+  parallelFor(nFaces(), [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      size_t iStart = faceIndsStart[iF];
+      size_t D = faceIndsStart[iF + 1] - iStart;
+      size_t iTriFace = iStart - 2 * iF; // a face of degree D is triangulated in to D-2 triangles
 
-  auto createEdgeKey = [&](size_t a, size_t b) -> std::pair<size_t, size_t> {
-    return std::make_pair(std::min(a, b), std::max(a, b));
-  };
+      for (size_t j = 0; j < D; j++) {
+        halfedgeEdgeCorrespondence[iStart + j] = edgePerm[halfedgeEdgeCanonical[iStart + j]];
+      }
 
-  size_t psEdgeInd = 0; // polyscope's edge index, iterated according to Polyscope's canonical ordering
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
+      // emit the data for triangles triangulating this face
+      for (size_t j = 1; (j + 1) < D; j++) {
 
-    // TODO why can't we use edges on non triangular meshes? Implement it.
+        // FORNOW: for polygonal faces, substitute the opposite-edge value for all internal edges of the triangulation
+        // (these are masked out by edgeIsReal)
 
-    if (D != 3) {
-      exception("SurfaceMesh " + name +
-                " attempted to access triangle-edge indices, but it has non-triangular faces. These indices are "
-                "only well-defined on a pure-triangular mesh.");
-    }
+        uint32_t he0 = iStart + j; // this is a dummy value due to triangulation of polygons
+        uint32_t he1 = iStart + j; // this is the actual right value for the opposite edge
+        uint32_t he2 = iStart + j; // this is a dummy value due to triangulation of polygons
 
-    glm::uvec3 thisTriInds{0, 0, 0};
-    for (size_t j = 0; j < 3; j++) {
-      size_t vA = triangleVertexInds.data[3 * iF + j];
-      size_t vB = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
+        // substitute non-dummy values for first and last edge if this is not an internal tri
+        if (j == 1) he0 = iStart;
+        if (j + 2 == D) he2 = iStart + D - 1;
 
-      std::pair<size_t, size_t> key = createEdgeKey(vA, vB);
+        glm::uvec3 thisTriInds{halfedgeEdgeCorrespondence[he0], halfedgeEdgeCorrespondence[he1],
+                               halfedgeEdgeCorrespondence[he2]};
 
-      size_t thisEdgeInd;
-      if (seenEdgeInds.find(key) == seenEdgeInds.end()) {
-        // process a new edge in the canonical ordering
-        if (psEdgeInd >= edgePerm.size()) {
-          exception("SurfaceMesh " + name +
-                    " edge indexing out of bounds. Did you pass an edge ordering that is too short?");
+        for (size_t k = 0; k < 3; k++) {
+          for (size_t m = 0; m < 3; m++) {
+            triangleAllEdgeInds.data[9 * iTriFace + 3 * k + m] = thisTriInds[m];
+          }
         }
-        thisEdgeInd = edgePerm[psEdgeInd];
-        seenEdgeInds[key] = thisEdgeInd;
-        psEdgeInd++;
-      } else {
-        // we've processed this edge before, retrieve its assigned index
-        thisEdgeInd = seenEdgeInds[key];
-      }
-
-      halfedgeEdgeCorrespondence[start + j] = thisEdgeInd;
-      thisTriInds[j] = thisEdgeInd;
-    }
 
-    for (size_t j = 0; j < 3; j++) {
-      for (size_t k = 0; k < 3; k++) {
-        triangleAllEdgeInds.data[9 * iF + 3 * j + k] = thisTriInds[k];
+        iTriFace++;
       }
     }
-  }
+  });
 
-  nEdgesCount = psEdgeInd;
   triangleAllEdgeInds.markHostBufferUpdated();
 }
 
 void SurfaceMesh::countEdges() {
-
-  // WARNING: logic duplicated in computeTriangleAllEdgeInds()
-
-  // used to loop over edges
-  std::unordered_map<std::pair<size_t, size_t>, size_t, polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
-      seenEdgeInds;
-
-  auto createEdgeKey = [&](size_t a, size_t b) -> std::pair<size_t, size_t> {
-    return std::make_pair(std::min(a, b), std::max(a, b));
-  };
-
-  size_t psEdgeInd = 0; // polyscope's edge index, iterated according to Polyscope's canonical ordering
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
-
-    if (D != 3) {
-      exception("SurfaceMesh " + name +
-                " attempted to count edges, but mesh has non-triangular faces. Edge functions are only implemented on "
-                "a pure-triangular mesh.");
-    }
-
-    for (size_t j = 0; j < 3; j++) {
-      size_t vA = triangleVertexInds.data[3 * iF + j];
-      size_t vB = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-
-      std::pair<size_t, size_t> key = createEdgeKey(vA, vB);
-
-      if (seenEdgeInds.find(key) == seenEdgeInds.end()) {
-        size_t thisEdgeInd = psEdgeInd;
-        seenEdgeInds[key] = thisEdgeInd;
-        psEdgeInd++;
-      }
-    }
-  }
-
-  nEdgesCount = psEdgeInd;
+  ensureHaveEdgeTable();
+  if (nHalfedges() == 0) nEdgesCount = 0;
 }
 
 size_t SurfaceMesh::nEdges() {
@@ -405,33 +378,132 @@ void SurfaceMesh::computeTriangleAllCornerInds() {
 
 size_t SurfaceMesh::nVertices() { return vertexPositions.size(); }
 
+void SurfaceMesh::ensureHaveVertexFaceAdjacency() {
+  if (!vertexFaceStart.empty()) return; // already populated
+
+  // Bucket the corners by vertex with a (stable) counting sort, so each vertex lists its faces in the same order a
+  // serial loop over the faces would visit them. Gathering over this list makes vertex accumulations deterministic.
+  vertexFaceStart.assign(nVertices() + 1, 0);
+  for (uint32_t iV : faceIndsEntries) {
+    vertexFaceStart[iV + 1]++;
+  }
+  for (size_t iV = 0; iV < nVertices(); iV++) {
+    vertexFaceStart[iV + 1] += vertexFaceStart[iV];
+  }
+
+  vertexFaceEntries.resize(nCorners());
+  std::vector<uint32_t> fillPos(vertexFaceStart.begin(), vertexFaceStart.end() - 1);
+  for (size_t iF = 0; iF < nFaces(); iF++) {
+    for (size_t iC = faceIndsStart[iF]; iC < faceIndsStart[iF + 1]; iC++) {
+      vertexFaceEntries[fillPos[faceIndsEntries[iC]]++] = iF;
+    }
+  }
+}
+
+glm::vec3 SurfaceMesh::computeFaceNormal(size_t iF) {
+  size_t iStart = faceIndsStart[iF];
+  size_t D = faceIndsStart[iF + 1] - iStart;
+
+  glm::vec3 fN{0., 0., 0.};
+  if (D == 3) {
+    glm::vec3 pA = vertexPositions.data[faceIndsEntries[iStart + 0]];
+    glm::vec3 pB = vertexPositions.data[faceIndsEntries[iStart + 1]];
+    glm::vec3 pC = vertexPositions.data[faceIndsEntries[iStart + 2]];
+    fN = glm::cross(pB - pA, pC - pA);
+  } else {
+    for (size_t j = 0; j < D; j++) {
+      glm::vec3 pA = vertexPositions.data[faceIndsEntries[iStart + j]];
+      glm::vec3 pB = vertexPositions.data[faceIndsEntries[iStart + (j + 1) % D]];
+      glm::vec3 pC = vertexPositions.data[faceIndsEntries[iStart + (j + 2) % D]];
+      fN += glm::cross(pC - pB, pA - pB);
+    }
+  }
+  return glm::normalize(fN);
+}
+
+glm::vec3 SurfaceMesh::computeFaceCenter(size_t iF) {
+  size_t start = faceIndsStart[iF];
+  size_t D = faceIndsStart[iF + 1] - start;
+  glm::vec3 faceCenter{0., 0., 0.};
+  for (size_t j = 0; j < D; j++) {
+    glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + j]];
+    faceCenter += pA;
+  }
+  faceCenter /= D;
+  return faceCenter;
+}
+
+float SurfaceMesh::computeFaceArea(size_t iF) {
+  size_t start = faceIndsStart[iF];
+  size_t D = faceIndsStart[iF + 1] - start;
+
+  // Compute a face normal
+  double fA;
+  if (D == 3) {
+    glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
+    glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + 1]];
+    glm::vec3 pC = vertexPositions.data[faceIndsEntries[start + 2]];
+    glm::vec3 fN = glm::cross(pB - pA, pC - pA);
+    fA = 0.5 * glm::length(fN);
+  } else {
+    fA = 0;
+    glm::vec3 pRoot = vertexPositions.data[faceIndsEntries[start]];
+    for (size_t j = 1; j + 1 < D; j++) {
+      glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + j]];
+      glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + j + 1]];
+      fA += 0.5 * glm::length(glm::cross(pA - pRoot, pB - pRoot));
+    }
+  }
+  return fA;
+}
+
+glm::vec3 SurfaceMesh::computeVertexNormal(size_t iV) {
+  // Accumulate quantities from each incident face, then normalize
+  glm::vec3 vN{0., 0., 0.};
+  for (size_t i = vertexFaceStart[iV]; i < vertexFaceStart[iV + 1]; i++) {
+    size_t iF = vertexFaceEntries[i];
+    vN += faceNormals.data[iF] * static_cast<float>(faceAreas.data[iF]);
+  }
+  return glm::normalize(vN);
+}
+
+float SurfaceMesh::computeVertexArea(size_t iV) {
+  // Accumulate quantities from each incident face
+  float vA = 0.;
+  for (size_t i = vertexFaceStart[iV]; i < vertexFaceStart[iV + 1]; i++) {
+    size_t iF = vertexFaceEntries[i];
+    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
+    vA += faceAreas.data[iF] / D;
+  }
+  return vA;
+}
+
+std::array<glm::vec3, 2> SurfaceMesh::computeDefaultFaceTangentBasis(size_t iF) {
+  size_t start = faceIndsStart[iF];
+
+  glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
+  glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + 1]];
+  glm::vec3 N = faceNormals.data[iF];
+
+  glm::vec3 basisX = pB - pA;
+  basisX = glm::normalize(basisX - N * glm::dot(N, basisX));
+
+  glm::vec3 basisY = glm::normalize(-glm::cross(basisX, N));
+
+  return {basisX, basisY};
+}
+
 void SurfaceMesh::computeFaceNormals() {
 
   vertexPositions.ensureHostBufferPopulated();
 
   faceNormals.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t iStart = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - iStart;
-
-    glm::vec3 fN{0., 0., 0.};
-    if (D == 3) {
-      glm::vec3 pA = vertexPositions.data[faceIndsEntries[iStart + 0]];
-      glm::vec3 pB = vertexPositions.data[faceIndsEntries[iStart + 1]];
-      glm::vec3 pC = vertexPositions.data[faceIndsEntries[iStart + 2]];
-      fN = glm::cross(pB - pA, pC - pA);
-    } else {
-      for (size_t j = 0; j < D; j++) {
-        glm::vec3 pA = vertexPositions.data[faceIndsEntries[iStart + j]];
-        glm::vec3 pB = vertexPositions.data[faceIndsEntries[iStart + (j + 1) % D]];
-        glm::vec3 pC = vertexPositions.data[faceIndsEntries[iStart + (j + 2) % D]];
-        fN += glm::cross(pC - pB, pA - pB);
-      }
+  parallelFor(nFaces(), [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      faceNormals.data[iF] = computeFaceNormal(iF);
     }
-    fN = glm::normalize(fN);
-    faceNormals.data[iF] = fN;
-  }
+  });
 
   faceNormals.markHostBufferUpdated();
 }
@@ -442,17 +514,11 @@ void SurfaceMesh::computeFaceCenters() {
 
   faceCenters.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
-    glm::vec3 faceCenter{0., 0., 0.};
-    for (size_t j = 0; j < D; j++) {
-      glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + j]];
-      faceCenter += pA;
+  parallelFor(nFaces(), [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      faceCenters.data[iF] = computeFaceCenter(iF);
     }
-    faceCenter /= D;
-    faceCenters.data[iF] = faceCenter;
-  }
+  });
 
   faceCenters.markHostBufferUpdated();
 }
@@ -463,31 +529,11 @@ void SurfaceMesh::computeFaceAreas() {
 
   faceAreas.data.resize(nFaces());
 
-  // Loop over faces to compute face-valued quantities
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
-
-    // Compute a face normal
-    double fA;
-    if (D == 3) {
-      glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
-      glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + 1]];
-      glm::vec3 pC = vertexPositions.data[faceIndsEntries[start + 2]];
-      glm::vec3 fN = glm::cross(pB - pA, pC - pA);
-      fA = 0.5 * glm::length(fN);
-    } else {
-      fA = 0;
-      glm::vec3 pRoot = vertexPositions.data[faceIndsEntries[start]];
-      for (size_t j = 1; j + 1 < D; j++) {
-        glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + j]];
-        glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + j + 1]];
-        fA += 0.5 * glm::length(glm::cross(pA - pRoot, pB - pRoot));
-      }
+  parallelFor(nFaces(), [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      faceAreas.data[iF] = computeFaceArea(iF);
     }
-
-    faceAreas.data[iF] = fA;
-  }
+  });
 
   faceAreas.markHostBufferUpdated();
 }
@@ -497,27 +543,15 @@ void SurfaceMesh::computeVertexNormals() {
 
   faceNormals.ensureHostBufferPopulated();
   faceAreas.ensureHostBufferPopulated();
+  ensureHaveVertexFaceAdjacency();
 
   vertexNormals.data.resize(nVertices());
 
-  const glm::vec3 zero{0., 0., 0.};
-
-  std::fill(vertexNormals.data.begin(), vertexNormals.data.end(), zero);
-
-  // Accumulate quantities from each face
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t start = faceIndsStart[iF];
-    size_t D = faceIndsStart[iF + 1] - start;
-    for (size_t j = 0; j < D; j++) {
-      size_t iV = faceIndsEntries[start + j];
-      vertexNormals.data[iV] += faceNormals.data[iF] * static_cast<float>(faceAreas.data[iF]);
+  parallelFor(nVertices(), [&](size_t vStart, size_t vEnd) {
+    for (size_t iV = vStart; iV < vEnd; iV++) {
+      vertexNormals.data[iV] = computeVertexNormal(iV);
     }
-  }
-
-  // Normalize
-  for (size_t iV = 0; iV < nVertices(); iV++) {
-    vertexNormals.data[iV] = glm::normalize(vertexNormals.data[iV]);
-  }
+  });
 
   vertexNormals.markHostBufferUpdated();
 }
@@ -525,19 +559,15 @@ void SurfaceMesh::computeVertexNormals() {
 void SurfaceMesh::computeVertexAreas() {
 
   faceAreas.ensureHostBufferPopulated();
+  ensureHaveVertexFaceAdjacency();
 
   vertexAreas.data.resize(nVertices());
-  std::fill(vertexAreas.data.begin(), vertexAreas.data.end(), 0.);
 
-  // Accumulate quantities from each face
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-    size_t start = faceIndsStart[iF];
-    for (size_t j = 0; j < D; j++) {
-      size_t iV = faceIndsEntries[start + j];
-      vertexAreas.data[iV] += faceAreas.data[iF] / D;
+  parallelFor(nVertices(), [&](size_t vStart, size_t vEnd) {
+    for (size_t iV = vStart; iV < vEnd; iV++) {
+      vertexAreas.data[iV] = computeVertexArea(iV);
     }
-  }
+  });
 
   vertexAreas.markHostBufferUpdated();
 }
@@ -549,26 +579,17 @@ void SurfaceMesh::computeDefaultFaceTangentBasisX() {
 
   vertexPositions.ensureHostBufferPopulated();
   faceNormals.ensureHostBufferPopulated();
+  if (nFacesTriangulation() != nFaces()) {
+    exception("Default face tangent spaces only available for pure-triangular meshes");
+  }
 
   defaultFaceTangentBasisX.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-    if (D != 3) exception("Default face tangent spaces only available for pure-triangular meshes");
-
-    size_t start = faceIndsStart[iF];
-
-    glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
-    glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + 1]];
-    glm::vec3 N = faceNormals.data[iF];
-
-    glm::vec3 basisX = pB - pA;
-    basisX = glm::normalize(basisX - N * glm::dot(N, basisX));
-
-    glm::vec3 basisY = glm::normalize(-glm::cross(basisX, N));
-
-    defaultFaceTangentBasisX.data[iF] = basisX;
-  }
+  parallelFor(nFaces(), [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      defaultFaceTangentBasisX.data[iF] = computeDefaultFaceTangentBasis(iF)[0];
+    }
+  });
 
   defaultFaceTangentBasisX.markHostBufferUpdated();
 }
@@ -580,26 +601,17 @@ void SurfaceMesh::computeDefaultFaceTangentBasisY() {
 
   vertexPositions.ensureHostBufferPopulated();
   faceNormals.ensureHostBufferPopulated();
+  if (nFacesTriangulation() != nFaces()) {
+    exception("Default face tangent spaces only available for pure-triangular meshes");
+  }
 
   defaultFaceTangentBasisY.data.resize(nFaces());
 
-  for (size_t iF = 0; iF < nFaces(); iF++) {
-    size_t D = faceIndsStart[iF + 1] - faceIndsStart[iF];
-    if (D != 3) exception("Default face tangent spaces only available for pure-triangular meshes");
-
-    size_t start = faceIndsStart[iF];
-
-    glm::vec3 pA = vertexPositions.data[faceIndsEntries[start + 0]];
-    glm::vec3 pB = vertexPositions.data[faceIndsEntries[start + 1]];
-    glm::vec3 N = faceNormals.data[iF];
-
-    glm::vec3 basisX = pB - pA;
-    basisX = glm::normalize(basisX - N * glm::dot(N, basisX));
-
-    glm::vec3 basisY = glm::normalize(-glm::cross(basisX, N));
-
-    defaultFaceTangentBasisY.data[iF] = basisY;
-  }
+  parallelFor(nFaces(), [&](size_t fStart, size_t fEnd) {
+    for (size_t iF = fStart; iF < fEnd; iF++) {
+      defaultFaceTangentBasisY.data[iF] = computeDefaultFaceTangentBasis(iF)[1];
+    }
+  });
 
   defaultFaceTangentBasisY.markHostBufferUpdated();
 }
@@ -636,59 +648,7 @@ void SurfaceMesh::checkTriangular() {
 
 void SurfaceMesh::ensureHaveManifoldConnectivity() {
   if (!twinHalfedge.empty()) return; // already populated
-
-  triangleVertexInds.ensureHostBufferPopulated();
-
-  twinHalfedge.resize(nHalfedges());
-
-  // Maps from edge (sorted) to all halfedges incident on that edge
-  std::unordered_map<std::pair<size_t, size_t>, std::vector<size_t>,
-                     polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
-      edgeInds;
-
-  // Fill out faceForHalfedge and populate edge lookup map
-  for (size_t iF = 0; iF < nFacesTriangulation(); iF++) {
-    for (size_t j = 0; j < 3; j++) {
-      size_t iV = triangleVertexInds.data[3 * iF + j];
-      size_t iVNext = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-      size_t iHe = 3 * iF + j;
-
-
-      std::pair<size_t, size_t> edgeKey(std::min(iV, iVNext), std::max(iV, iVNext));
-
-      // Make sure the key is populated
-      auto it = edgeInds.find(edgeKey);
-      if (it == edgeInds.end()) {
-        it = edgeInds.insert(it, {edgeKey, std::vector<size_t>()});
-      }
-
-      // Add this halfedge to the entry
-      it->second.push_back(iHe);
-    }
-  }
-
-  // Second walk through, setting twins
-  for (size_t iF = 0; iF < nFacesTriangulation(); iF++) {
-    for (size_t j = 0; j < 3; j++) {
-      size_t iV = triangleVertexInds.data[3 * iF + j];
-      size_t iVNext = triangleVertexInds.data[3 * iF + ((j + 1) % 3)];
-      size_t iHe = 3 * iF + j;
-
-      std::pair<size_t, size_t> edgeKey(std::min(iV, iVNext), std::max(iV, iVNext));
-      std::vector<size_t>& edgeHalfedges = edgeInds.find(edgeKey)->second;
-
-      // Pick the first halfedge we find which is not this one
-      size_t myTwin = INVALID_IND;
-      for (size_t t : edgeHalfedges) {
-        if (t != iHe) {
-          myTwin = t;
-          break;
-        }
-      }
-
-      twinHalfedge[iHe] = myTwin;
-    }
-  }
+  ensureHaveEdgeTable();
 }
 
 void SurfaceMesh::draw() {
@@ -826,6 +786,42 @@ void SurfaceMesh::setMeshGeometryAttributes(render::ShaderProgram& p) {
   if (wantsCullPosition()) {
     p.setAttribute("a_cullPos", faceCenters.getIndexedRenderAttributeBuffer(triangleFaceInds));
   }
+  if (getSpatialChunking()) {
+    ensureSpatialClustersBuilt();
+    p.setDrawOrder(clusterOrder.getRenderAttributeBuffer());
+  }
+}
+
+void SurfaceMesh::ensureSpatialClustersBuilt() {
+  if (spatialClustersBuilt && spatialClustersDataVersion == vertexPositions.dataVersion()) return;
+
+  vertexPositions.ensureHostBufferPopulated();
+  triangleVertexInds.ensureHostBufferPopulated();
+
+  size_t nTri = nFacesTriangulation();
+  std::vector<glm::vec3> triLow(nTri);
+  std::vector<glm::vec3> triHigh(nTri);
+  for (size_t iT = 0; iT < nTri; iT++) {
+    glm::vec3 pA = vertexPositions.data[triangleVertexInds.data[3 * iT + 0]];
+    glm::vec3 pB = vertexPositions.data[triangleVertexInds.data[3 * iT + 1]];
+    glm::vec3 pC = vertexPositions.data[triangleVertexInds.data[3 * iT + 2]];
+    triLow[iT] = glm::min(pA, glm::min(pB, pC));
+    triHigh[iT] = glm::max(pA, glm::max(pB, pC));
+  }
+  spatialClusters = SpatialClusters(triLow, triHigh);
+
+  // the draw order lists corners, three per triangle
+  const std::vector<uint32_t>& triOrder = spatialClusters.getOrder();
+  clusterOrder.data.resize(3 * nTri);
+  for (size_t i = 0; i < nTri; i++) {
+    for (uint32_t j = 0; j < 3; j++) {
+      clusterOrder.data[3 * i + j] = 3 * triOrder[i] + j;
+    }
+  }
+  clusterOrder.markHostBufferUpdated();
+
+  spatialClustersBuilt = true;
+  spatialClustersDataVersion = vertexPositions.dataVersion();
 }
 
 void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
@@ -842,8 +838,8 @@ void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
   if (halfedgesHaveBeenUsed) triangleAllHalfedgeInds.ensureHostBufferPopulated();
   if (cornersHaveBeenUsed) triangleCornerInds.ensureHostBufferPopulated();
 
-  // nEdges() requires computing number of edges, which is expensive and might not even be implemented for polygonal
-  // meshes. This way we only call it if actually needed, and use 0 otherwise.
+  // nEdges() requires computing number of edges, which is expensive. This way we only call it if actually needed, and
+  // use 0 otherwise.
   size_t nEdgesSafe = edgesHaveBeenUsed ? nEdges() : 0;
 
   // Get element indices
@@ -1041,6 +1037,31 @@ void SurfaceMesh::setSurfaceMeshUniforms(render::ShaderProgram& p) {
     p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
     p.setUniform("u_viewport", render::engine->getCurrentViewport());
   }
+  setSurfaceMeshDrawRanges(p);
+}
+
+void SurfaceMesh::setSurfaceMeshDrawRanges(render::ShaderProgram& p) {
+  if (!getSpatialChunking()) return;
+  if (!options::cullStructures) {
+    p.setDrawRanges({});
+    return;
+  }
+
+  ensureSpatialClustersBuilt();
+  DrawRangesKey key;
+  key.modelViewProj = view::getCameraPerspectiveMatrix() * getModelView();
+  key.dataVersion = vertexPositions.dataVersion();
+
+  if (!drawRangesSelected || !(key == drawRangesKey)) {
+    drawRanges = spatialClusters.visibleRanges(key.modelViewProj, 0.f);
+    for (std::array<uint32_t, 2>& r : drawRanges) { // (triangles to corners)
+      r[0] *= 3;
+      r[1] *= 3;
+    }
+    drawRangesKey = key;
+    drawRangesSelected = true;
+  }
+  p.setDrawRanges(drawRanges);
 }
 
 
@@ -1300,6 +1321,8 @@ void SurfaceMesh::buildCustomOptionsUI() {
       setBackFacePolicy(BackFacePolicy::Cull);
     ImGui::EndMenu();
   }
+
+  if (ImGui::MenuItem("Spatial Chunking", NULL, getSpatialChunking())) setSpatialChunking(!getSpatialChunking());
 }
 
 void SurfaceMesh::recomputeGeometryIfPopulated() {
@@ -1308,9 +1331,128 @@ void SurfaceMesh::recomputeGeometryIfPopulated() {
   faceAreas.recomputeIfPopulated();
   vertexNormals.recomputeIfPopulated();
   vertexAreas.recomputeIfPopulated();
+  defaultFaceTangentBasisX.recomputeIfPopulated();
+  defaultFaceTangentBasisY.recomputeIfPopulated();
   // edgeLengths.recomputeIfPopulated();
 }
 
+namespace {
+
+// Convert a sorted list of unique indices to {start, count} runs of consecutive indices
+std::vector<std::array<size_t, 2>> indicesToRanges(const std::vector<uint32_t>& sortedInds) {
+  std::vector<std::array<size_t, 2>> ranges;
+  for (uint32_t i : sortedInds) {
+    if (!ranges.empty() && ranges.back()[0] + ranges.back()[1] == i) {
+      ranges.back()[1]++;
+    } else {
+      ranges.push_back({i, 1});
+    }
+  }
+  return ranges;
+}
+
+void sortUnique(std::vector<uint32_t>& inds) {
+  std::sort(inds.begin(), inds.end());
+  inds.erase(std::unique(inds.begin(), inds.end()), inds.end());
+}
+
+} // namespace
+
+void SurfaceMesh::updateVertexPositionsPartialImpl(const std::vector<uint32_t>& inds,
+                                                   const std::vector<glm::vec3>& newPositions) {
+
+  if (inds.size() != newPositions.size()) {
+    exception("SurfaceMesh " + name + " partial position update has " + std::to_string(inds.size()) +
+              " indices but " + std::to_string(newPositions.size()) + " positions");
+  }
+  for (uint32_t iV : inds) {
+    if (iV >= nVertices()) {
+      exception("SurfaceMesh " + name + " partial position update has vertex index " + std::to_string(iV) +
+                " out of bounds for number of vertices " + std::to_string(nVertices()));
+    }
+  }
+
+  // If much of the mesh moves, a full update is just as fast and far simpler
+  if (inds.size() > nVertices() / 4) {
+    vertexPositions.ensureHostBufferPopulated();
+    for (size_t i = 0; i < inds.size(); i++) {
+      vertexPositions.data[inds[i]] = newPositions[i];
+    }
+    vertexPositions.markHostBufferUpdated();
+    updateObjectSpaceBounds();
+    recomputeGeometryIfPopulated();
+    return;
+  }
+
+  // == Write the new positions
+  vertexPositions.ensureHostBufferPopulated();
+  for (size_t i = 0; i < inds.size(); i++) {
+    vertexPositions.data[inds[i]] = newPositions[i];
+  }
+  std::vector<uint32_t> movedVerts = inds;
+  sortUnique(movedVerts);
+  vertexPositions.markHostBufferUpdated(indicesToRanges(movedVerts));
+  updateObjectSpaceBounds();
+
+  // == Find the affected elements
+  // faces incident on a moved vertex, and vertices whose accumulated values read from one of those faces
+  ensureHaveVertexFaceAdjacency();
+  std::vector<uint32_t> dirtyFaces;
+  for (uint32_t iV : movedVerts) {
+    for (size_t i = vertexFaceStart[iV]; i < vertexFaceStart[iV + 1]; i++) {
+      dirtyFaces.push_back(vertexFaceEntries[i]);
+    }
+  }
+  sortUnique(dirtyFaces);
+  std::vector<uint32_t> dirtyVerts;
+  for (uint32_t iF : dirtyFaces) {
+    for (size_t iC = faceIndsStart[iF]; iC < faceIndsStart[iF + 1]; iC++) {
+      dirtyVerts.push_back(faceIndsEntries[iC]);
+    }
+  }
+  sortUnique(dirtyVerts);
+  std::vector<std::array<size_t, 2>> dirtyFaceRanges = indicesToRanges(dirtyFaces);
+  std::vector<std::array<size_t, 2>> dirtyVertRanges = indicesToRanges(dirtyVerts);
+
+  // == Recompute the affected entries of each populated buffer
+  // (in dependency order, so e.g. vertex normals see the updated face normals)
+
+  auto updateFaceBuffer = [&](render::ManagedBuffer<glm::vec3>& buff, std::function<glm::vec3(size_t)> func) {
+    if (!buff.hasData()) return;
+    buff.ensureHostBufferPopulated();
+    for (uint32_t iF : dirtyFaces) buff.data[iF] = func(iF);
+    buff.markHostBufferUpdated(dirtyFaceRanges);
+  };
+
+  updateFaceBuffer(faceNormals, [&](size_t iF) { return computeFaceNormal(iF); });
+  updateFaceBuffer(faceCenters, [&](size_t iF) { return computeFaceCenter(iF); });
+  if (faceAreas.hasData()) {
+    faceAreas.ensureHostBufferPopulated();
+    for (uint32_t iF : dirtyFaces) faceAreas.data[iF] = computeFaceArea(iF);
+    faceAreas.markHostBufferUpdated(dirtyFaceRanges);
+  }
+
+  if (vertexNormals.hasData()) {
+    faceNormals.ensureHostBufferPopulated();
+    faceAreas.ensureHostBufferPopulated();
+    vertexNormals.ensureHostBufferPopulated();
+    for (uint32_t iV : dirtyVerts) vertexNormals.data[iV] = computeVertexNormal(iV);
+    vertexNormals.markHostBufferUpdated(dirtyVertRanges);
+  }
+  if (vertexAreas.hasData()) {
+    faceAreas.ensureHostBufferPopulated();
+    vertexAreas.ensureHostBufferPopulated();
+    for (uint32_t iV : dirtyVerts) vertexAreas.data[iV] = computeVertexArea(iV);
+    vertexAreas.markHostBufferUpdated(dirtyVertRanges);
+  }
+
+  if (defaultFaceTangentBasisX.hasData() || defaultFaceTangentBasisY.hasData()) {
+    faceNormals.ensureHostBufferPopulated();
+  }
+  updateFaceBuffer(defaultFaceTangentBasisX, [&](size_t iF) { return computeDefaultFaceTangentBasis(iF)[0]; });
+  updateFaceBuffer(defaultFaceTangentBasisY, [&](size_t iF) { return computeDefaultFaceTangentBasis(iF)[1]; });
+}
+
 void SurfaceMesh::refresh() {
   recomputeGeometryIfPopulated();
 
@@ -1340,8 +1482,11 @@ void SurfaceMesh::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  objectSpaceBoundsDataVersion = geometryDataVersion();
 }
 
+uint64_t SurfaceMesh::geometryDataVersion() { return vertexPositions.dataVersion(); }
+
 std::string SurfaceMesh::typeName() { return structureTypeName; }
 
 long long int SurfaceMesh::selectVertex() {
@@ -1419,6 +1564,7 @@ void SurfaceMesh::markEdgesAsUsed() {
   // immediately compute edge-related connectivity info, and also repopulate the pick buffer so edges can be picked
   computeTriangleAllEdgeInds();
   pickProgram.reset();
+  markSceneChanged();
 }
 
 void SurfaceMesh::markHalfedgesAsUsed() {
@@ -1426,6 +1572,7 @@ void SurfaceMesh::markHalfedgesAsUsed() {
   halfedgesHaveBeenUsed = true;
   // repopulate the pick buffer so halfedges can be picked
   pickProgram.reset();
+  markSceneChanged();
 }
 
 void SurfaceMesh::markCornersAsUsed() {
@@ -1433,6 +1580,7 @@ void SurfaceMesh::markCornersAsUsed() {
   cornersHaveBeenUsed = true;
   // repopulate the pick buffer so corners can be picked
   pickProgram.reset();
+  markSceneChanged();
 }
 
 // === Option getters and setters
@@ -1502,6 +1650,14 @@ SurfaceMesh* SurfaceMesh::setShadeStyle(MeshShadeStyle newStyle) {
 }
 MeshShadeStyle SurfaceMesh::getShadeStyle() { return shadeStyle.get(); }
 
+SurfaceMesh* SurfaceMesh::setSpatialChunking(bool newVal) {
+  spatialChunking = newVal;
+  refresh();
+  requestRedraw();
+  return this;
+}
+bool SurfaceMesh::getSpatialChunking() { return spatialChunking.get(); }
+
 // === Quantity adders
 
 
@@ -6,7 +6,9 @@
 #include <set>
 
 #include "polyscope/curve_network.h"
+#include "polyscope/disjoint_sets.h"
 #include "polyscope/file_helpers.h"
+#include "polyscope/parallel.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 
@@ -218,10 +220,95 @@ SurfaceCornerParameterizationQuantity::SurfaceCornerParameterizationQuantity(std
                                                                              const std::vector<glm::vec2>& coords_,
                                                                              ParamCoordsType type_,
                                                                              ParamVizStyle style_)
-    : SurfaceParameterizationQuantity(name, mesh_, coords_, MeshElement::CORNER, type_, style_) {}
+    : SurfaceParameterizationQuantity(name, mesh_, coords_, MeshElement::CORNER, type_, style_),
+      autoIslandLabels(uniquePrefix() + "autoIslandLabels", false) {}
 
 std::string SurfaceCornerParameterizationQuantity::niceName() { return name + " (corner parameterization)"; }
 
+void SurfaceCornerParameterizationQuantity::draw() {
+  if (isEnabled() && getAutoIslandLabels() &&
+      (!haveIslandLabels() || islandLabelsCoordsVersion != coords.dataVersion())) {
+    computeIslandLabels();
+  }
+  SurfaceParameterizationQuantity::draw();
+}
+
+void SurfaceCornerParameterizationQuantity::buildParameterizationOptionsUI() {
+  if (ImGui::MenuItem("Islands from seams", NULL, getAutoIslandLabels())) {
+    setAutoIslandLabels(!getAutoIslandLabels());
+  }
+  ParameterizationQuantity::buildParameterizationOptionsUI();
+}
+
+void SurfaceCornerParameterizationQuantity::computeIslandLabels() {
+
+  coords.ensureHostBufferPopulated();
+  parent.ensureHaveManifoldConnectivity();
+  const std::vector<uint32_t>& faceStart = parent.faceIndsStart;
+  const std::vector<uint32_t>& faceEntries = parent.faceIndsEntries;
+  const std::vector<glm::vec2>& faceCoords = coords.data;
+  size_t nF = parent.nFaces();
+
+  // Halfedges (like corners) are indexed along the face list; record the face of each
+  std::vector<uint32_t> halfedgeFace(faceEntries.size());
+  parallelFor(nF, [&](size_t start, size_t end) {
+    for (size_t iF = start; iF < end; iF++) {
+      for (size_t iHe = faceStart[iF]; iHe < faceStart[iF + 1]; iHe++) halfedgeFace[iHe] = iF;
+    }
+  });
+  auto nextHalfedge = [&](size_t iHe) {
+    uint32_t iF = halfedgeFace[iHe];
+    return (iHe + 1 == faceStart[iF + 1]) ? faceStart[iF] : iHe + 1;
+  };
+
+  // Join the faces on either side of each edge which is not a seam. Each halfedge checks its twin, so every edge is
+  // visited from both sides, but that costs nothing extra to merge.
+  ConcurrentDisjointSets islands(nF);
+  parallelFor(nF, [&](size_t start, size_t end) {
+    for (size_t iF = start; iF < end; iF++) {
+      for (size_t iHe = faceStart[iF]; iHe < faceStart[iF + 1]; iHe++) {
+        size_t iTwin = parent.twinHalfedge[iHe];
+        if (iTwin == INVALID_IND) continue; // boundary
+        size_t iHeNext = nextHalfedge(iHe);
+        size_t iTwinNext = nextHalfedge(iTwin);
+
+        // match up the corners at either end of the edge (the twin usually runs the other way, but need not)
+        bool sameWay = faceEntries[iTwin] == faceEntries[iHe];
+        size_t iTwinTail = sameWay ? iTwin : iTwinNext;
+        size_t iTwinTip = sameWay ? iTwinNext : iTwin;
+        if (faceCoords[iHe] == faceCoords[iTwinTail] && faceCoords[iHeNext] == faceCoords[iTwinTip]) {
+          islands.merge(iF, halfedgeFace[iTwin]);
+        }
+      }
+    }
+  });
+
+  // Each island is represented by its first face, so numbering the representatives in order gives dense labels
+  std::vector<uint32_t> faceIsland(nF);
+  parallelFor(nF, [&](size_t start, size_t end) {
+    for (size_t iF = start; iF < end; iF++) faceIsland[iF] = islands.find(iF);
+  });
+  std::vector<float> labels(nF);
+  size_t nIslands = 0;
+  for (size_t iF = 0; iF < nF; iF++) {
+    labels[iF] = (faceIsland[iF] == iF) ? static_cast<float>(nIslands++) : labels[faceIsland[iF]];
+  }
+
+  setIslandLabels(labels);
+  islandLabelsCoordsVersion = coords.dataVersion();
+}
+
+SurfaceCornerParameterizationQuantity* SurfaceCornerParameterizationQuantity::setAutoIslandLabels(bool newVal) {
+  autoIslandLabels = newVal;
+  if (newVal) {
+    computeIslandLabels();
+  }
+  requestRedraw();
+  return this;
+}
+
+bool SurfaceCornerParameterizationQuantity::getAutoIslandLabels() { return autoIslandLabels.get(); }
+
 
 void SurfaceCornerParameterizationQuantity::fillCoordBuffers(render::ShaderProgram& p) {
   p.setAttribute("a_value2", coords.getIndexedRenderAttributeBuffer(parent.triangleCornerInds));
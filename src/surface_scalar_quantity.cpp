@@ -65,7 +65,6 @@ SurfaceVertexScalarQuantity::SurfaceVertexScalarQuantity(std::string name, const
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
 }
 
 void SurfaceVertexScalarQuantity::createProgram() {
@@ -108,7 +107,6 @@ SurfaceFaceScalarQuantity::SurfaceFaceScalarQuantity(std::string name, const std
 {
   values.ensureHostBufferPopulated();
   parent.faceAreas.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
 }
 
 void SurfaceFaceScalarQuantity::createProgram() {
@@ -153,7 +151,6 @@ SurfaceEdgeScalarQuantity::SurfaceEdgeScalarQuantity(std::string name, const std
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
 }
 
 void SurfaceEdgeScalarQuantity::createProgram() {
@@ -195,7 +192,6 @@ SurfaceHalfedgeScalarQuantity::SurfaceHalfedgeScalarQuantity(std::string name, c
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
 }
 
 void SurfaceHalfedgeScalarQuantity::createProgram() {
@@ -236,7 +232,6 @@ SurfaceCornerScalarQuantity::SurfaceCornerScalarQuantity(std::string name, const
 
 {
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
 }
 
 void SurfaceCornerScalarQuantity::createProgram() {
@@ -279,7 +274,6 @@ SurfaceTextureScalarQuantity::SurfaceTextureScalarQuantity(std::string name, Sur
       imageOrigin(origin_) {
   values.setTextureSize(dimX, dimY);
   values.ensureHostBufferPopulated();
-  hist.buildHistogram(values.data);
 }
 
 void SurfaceTextureScalarQuantity::createProgram() {
@@ -32,6 +32,8 @@ void SurfaceVertexVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float SurfaceVertexVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void SurfaceVertexVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -72,6 +74,8 @@ void SurfaceFaceVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float SurfaceFaceVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void SurfaceFaceVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -116,6 +120,8 @@ void SurfaceFaceTangentVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float SurfaceFaceTangentVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void SurfaceFaceTangentVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -164,6 +170,8 @@ void SurfaceVertexTangentVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float SurfaceVertexTangentVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void SurfaceVertexTangentVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -265,6 +273,8 @@ void SurfaceOneFormTangentVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float SurfaceOneFormTangentVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void SurfaceOneFormTangentVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -533,7 +533,7 @@ glm::vec3 screenCoordsToWorldPosition(glm::vec2 screenCoords) {
 
   // query the depth buffer to get depth
   render::FrameBuffer* sceneFramebuffer = render::engine->sceneBuffer.get();
-  float depth = sceneFramebuffer->readDepth(xInd, view::bufferHeight - yInd);
+  float depth = sceneFramebuffer->readDepth(xInd, view::bufferHeight - 1 - yInd);
   if (depth == 1.) {
     // if we didn't hit anything in the depth buffer, just return infinity
     float inf = std::numeric_limits<float>::infinity();
@@ -583,6 +583,16 @@ void startFlightTo(const glm::mat4& T, float targetFov, float flightLengthInSeco
 
 void immediatelyEndFlight() { midflight = false; }
 
+bool viewIsChanging() { return state::globalContext.viewChanging; }
+
+void updateViewChanging(bool interactive) {
+  ensureViewValid();
+  glm::mat4 viewProjMat = getCameraPerspectiveMatrix() * viewMat;
+  state::globalContext.viewChanging =
+      interactive && (midflight || viewProjMat != state::globalContext.lastRenderedViewProjMat);
+  state::globalContext.lastRenderedViewProjMat = viewProjMat;
+}
+
 void updateFlight() {
   if (midflight) {
     if (ImGui::GetTime() > flightEndTime) {
@@ -413,6 +413,24 @@ VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantityImpl(std::string
   return q;
 }
 
+VolumeGridNodeScalarQuantity* VolumeGrid::addNodeScalarQuantitySparse(std::string name, const SparseBrickGrid& values,
+                                                                      DataType dataType_) {
+
+  glm::uvec3 valuesNodeDim = values.getLayout().getNodeDim();
+  if (valuesNodeDim != gridNodeDim) {
+    exception("sparse grid node scalar quantity " + name + " has node dimensions " + std::to_string(valuesNodeDim.x) +
+              "x" + std::to_string(valuesNodeDim.y) + "x" + std::to_string(valuesNodeDim.z) + ", but the grid has " +
+              std::to_string(gridNodeDim.x) + "x" + std::to_string(gridNodeDim.y) + "x" +
+              std::to_string(gridNodeDim.z));
+  }
+
+  checkForQuantityWithNameAndDeleteOrError(name);
+  VolumeGridNodeScalarQuantity* q = new VolumeGridNodeScalarQuantity(name, *this, values, dataType_);
+  addQuantity(q);
+  markNodesAsUsed();
+  return q;
+}
+
 VolumeGridCellScalarQuantity* VolumeGrid::addCellScalarQuantityImpl(std::string name, const std::vector<float>& data,
                                                                     DataType dataType_) {
 
@@ -2,7 +2,7 @@
 
 #include "polyscope/volume_grid_scalar_quantity.h"
 
-#include "MarchingCube/MC.h"
+#include "polyscope/parallel.h"
 
 namespace polyscope {
 
@@ -13,6 +13,7 @@ namespace polyscope {
 VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
                                                            const std::vector<float>& values_, DataType dataType_)
     : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, values_, dataType_),
+      brickSlots(nullptr, uniquePrefix() + "brickSlots", brickSlotsData), // (unused, so not registered)
       gridcubeVizEnabled(uniquePrefix() + "gridcubeVizEnabled", true),
       isosurfaceVizEnabled(uniquePrefix() + "isosurfaceVizEnabled", false),
       isosurfaceLevel(uniquePrefix() + "isosurfaceLevel", 0.f),
@@ -22,6 +23,84 @@ VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, Vol
   values.setTextureSize(parent.getGridNodeDim().x, parent.getGridNodeDim().y, parent.getGridNodeDim().z);
 }
 
+VolumeGridNodeScalarQuantity::VolumeGridNodeScalarQuantity(std::string name, VolumeGrid& grid_,
+                                                           const SparseBrickGrid& sparseValues_, DataType dataType_)
+    : VolumeGridQuantity(name, grid_, true), ScalarQuantity(*this, sparseValues_.getAtlasValues(), dataType_),
+      sparse(true), sparseLayout(sparseValues_.getLayout()),
+      sparseBackgroundValue(sparseValues_.getBackgroundValue()),
+      brickSlots(this, uniquePrefix() + "brickSlots", brickSlotsData),
+      gridcubeVizEnabled(uniquePrefix() + "gridcubeVizEnabled", true),
+      isosurfaceVizEnabled(uniquePrefix() + "isosurfaceVizEnabled", false),
+      isosurfaceLevel(uniquePrefix() + "isosurfaceLevel", 0.f),
+      isosurfaceColor(uniquePrefix() + "isosurfaceColor", getNextUniqueColor()),
+      slicePlanesAffectIsosurface(uniquePrefix() + "slicePlanesAffectIsosurface", false) {
+
+  glm::uvec3 atlasDim = sparseLayout.getAtlasDim();
+  values.setTextureSize(atlasDim.x, atlasDim.y, atlasDim.z);
+
+  // The page table, as floats for the texture. Slots are exactly representable, since the atlas holds far fewer than
+  // 2^24 bricks.
+  const std::vector<uint32_t>& slots = sparseLayout.getBrickSlots();
+  brickSlotsData.resize(slots.size());
+  for (size_t i = 0; i < slots.size(); i++) {
+    brickSlotsData[i] = slots[i] == INVALID_IND_32 ? -1.f : static_cast<float>(slots[i]);
+  }
+  glm::uvec3 brickDim = sparseLayout.getBrickDim();
+  brickSlots.setTextureSize(brickDim.x, brickDim.y, brickDim.z);
+
+  // The statistics computed while constructing ScalarQuantity covered the whole atlas, redo them over the grid nodes
+  refreshStatistics();
+  isolineWidth.setPassive(absoluteValue((dataRange.second - dataRange.first) * 0.02));
+}
+
+ScalarStatistics VolumeGridNodeScalarQuantity::computeValueStatistics(size_t binCount, float rangeEPS) {
+  if (!sparse) return ScalarQuantity::computeValueStatistics(binCount, rangeEPS);
+
+  // Along each axis a brick owns its first BRICK_CELLS nodes, and the last brick also owns the remaining ones (see
+  // SparseBrickLayout::brickOfNode())
+  const uint32_t B = SparseBrickLayout::BRICK_CELLS;
+  glm::uvec3 nodeDim = sparseLayout.getNodeDim();
+  glm::uvec3 brickDim = sparseLayout.getBrickDim();
+  auto ownedNodes = [&](glm::uvec3 brickInd) {
+    glm::uvec3 owned;
+    for (int i = 0; i < 3; i++) {
+      owned[i] = brickInd[i] + 1 == brickDim[i] ? nodeDim[i] - brickInd[i] * B : B;
+    }
+    return owned;
+  };
+
+  // Gather the owned nodes of each stored brick
+  uint32_t nStored = sparseLayout.nStoredBricks();
+  std::vector<size_t> slotStart(nStored + 1, 0);
+  for (uint32_t slot = 0; slot < nStored; slot++) {
+    glm::uvec3 owned = ownedNodes(sparseLayout.getSlotBrick(slot));
+    slotStart[slot + 1] = slotStart[slot] + static_cast<size_t>(owned.x) * owned.y * owned.z;
+  }
+  const std::vector<float>& atlas = values.getPopulatedHostBufferRef();
+  std::vector<float> nodeValues(slotStart[nStored]);
+  parallelFor(
+      nStored,
+      [&](size_t start, size_t end) {
+        for (size_t slot = start; slot < end; slot++) {
+          uint32_t s = static_cast<uint32_t>(slot);
+          glm::uvec3 owned = ownedNodes(sparseLayout.getSlotBrick(s));
+          size_t iOut = slotStart[slot];
+          for (uint32_t z = 0; z < owned.z; z++) {
+            for (uint32_t y = 0; y < owned.y; y++) {
+              for (uint32_t x = 0; x < owned.x; x++) {
+                nodeValues[iOut++] = atlas[sparseLayout.atlasIndex(s, glm::uvec3{x, y, z})];
+              }
+            }
+          }
+        }
+      },
+      1);
+
+  uint64_t nNodes = static_cast<uint64_t>(nodeDim.x) * nodeDim.y * nodeDim.z;
+  uint64_t nBackground = nNodes - nodeValues.size();
+  return computeScalarStatistics(nodeValues, binCount, rangeEPS, sparseBackgroundValue, nBackground);
+}
+
 
 void VolumeGridNodeScalarQuantity::buildCustomUI() {
 
@@ -61,6 +140,12 @@ void VolumeGridNodeScalarQuantity::buildCustomUI() {
     buildScalarUI();
   }
 
+  if (sparse) {
+    double storedFrac = static_cast<double>(sparseLayout.nStoredBricks()) / sparseLayout.nBricks();
+    ImGui::Text("Sparse: %u bricks (%.1f%%), %.1f MB", sparseLayout.nStoredBricks(), 100. * storedFrac,
+                getMemoryUsage() / 1e6);
+  }
+
   if (isosurfaceVizEnabled.get()) {
     ImGui::TextUnformatted("Isosurface:");
     // Color picker
@@ -73,8 +158,13 @@ void VolumeGridNodeScalarQuantity::buildCustomUI() {
     ImGui::PushItemWidth(120);
     if (ImGui::SliderFloat("##Radius", &isosurfaceLevel.get(), vizRangeMin.get(), vizRangeMax.get(), "%.4e")) {
       // Note: we intentionally do this rather than calling setIsosurfaceLevel(), because that function immediately
-      // recomputes the levelset mesh, which is too expensive during user interaction
+      // recomputes the levelset mesh, which is too expensive during user interaction. The exception is when the mesh
+      // is extracted on the device, which is fast enough to follow the slider.
       isosurfaceLevel.manuallyChanged();
+      if (isosurfaceProgram && isosurfaceExtractedOnDevice) {
+        fillIsosurfaceBuffers();
+        requestRedraw();
+      }
     }
     ImGui::PopItemWidth();
     ImGui::SameLine();
@@ -106,6 +196,9 @@ void VolumeGridNodeScalarQuantity::draw() {
     parent.setStructureUniforms(*gridcubeProgram);
     parent.setGridCubeUniforms(*gridcubeProgram);
     setScalarUniforms(*gridcubeProgram);
+    if (sparse) {
+      gridcubeProgram->setUniform("u_sparseBackgroundValue", sparseBackgroundValue);
+    }
     render::engine->setMaterialUniforms(*gridcubeProgram, parent.getMaterial());
 
     // Draw the actual grid
@@ -141,7 +234,7 @@ void VolumeGridNodeScalarQuantity::createGridcubeProgram() {
       render::engine->addMaterialRules(parent.getMaterial(),
         parent.addGridCubeRules(
           addScalarRules(
-            {"GRIDCUBE_PROPAGATE_NODE_VALUE"}
+            {sparse ? "GRIDCUBE_PROPAGATE_NODE_VALUE_SPARSE" : "GRIDCUBE_PROPAGATE_NODE_VALUE"}
           ), 
         true)
       )
@@ -157,23 +250,53 @@ void VolumeGridNodeScalarQuantity::createGridcubeProgram() {
 
   gridcubeProgram->setTextureFromBuffer("t_value", values.getRenderTextureBuffer().get());
   values.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Linear);
+
+  if (sparse) {
+    gridcubeProgram->setTextureFromBuffer("t_brickSlots", brickSlots.getRenderTextureBuffer().get());
+    brickSlots.getRenderTextureBuffer().get()->setFilterMode(FilterMode::Nearest);
+  }
 }
 
-void VolumeGridNodeScalarQuantity::createIsosurfaceProgram() {
+const IsosurfaceMesh& VolumeGridNodeScalarQuantity::getIsosurfaceMesh() {
 
   values.ensureHostBufferPopulated();
+  if (isosurfaceMeshCacheValid && isosurfaceMeshCacheLevel == getIsosurfaceLevel() &&
+      isosurfaceMeshCacheDataVersion == values.dataVersion()) {
+    return isosurfaceMeshCache;
+  }
+
+  // Extract the isosurface from the level set of the scalar field, directly in world coordinates
+  if (sparse) {
+    isosurfaceMeshCache =
+        marchingCubes(sparseLayout, values.data, getIsosurfaceLevel(), parent.getBoundMin(), parent.gridSpacing());
+  } else {
+    isosurfaceMeshCache = marchingCubes(values.data, parent.getGridNodeDim(), getIsosurfaceLevel(),
+                                        parent.getBoundMin(), parent.gridSpacing());
+  }
+  isosurfaceMeshCacheValid = true;
+  isosurfaceMeshCacheLevel = getIsosurfaceLevel();
+  isosurfaceMeshCacheDataVersion = values.dataVersion();
+  return isosurfaceMeshCache;
+}
+
+void VolumeGridNodeScalarQuantity::fillIsosurfaceBuffers() {
 
-  // Extract the isosurface from the level set of the scalar field
-  MC::mcMesh isosurfaceMesh;
-  MC::marching_cube(&values.data.front(), isosurfaceLevel.get(), parent.getGridNodeDim().x, parent.getGridNodeDim().y,
-                    parent.getGridNodeDim().z, isosurfaceMesh);
+  // Extract directly from the values texture if the render backend supports it, so nothing round-trips through the
+  // host. Otherwise, extract on the host and upload. (Sparse values are always extracted on the host, which only
+  // visits the stored bricks.)
+  isosurfaceExtractedOnDevice =
+      !sparse && render::engine->extractIsosurface(*values.getRenderTextureBuffer(), getIsosurfaceLevel(),
+                                                   parent.getBoundMin(), parent.gridSpacing(),
+                                                   *isosurfacePositionBuffer, *isosurfaceIndexBuffer);
 
-  // Transform the result to be aligned with our volume's spatial layout
-  glm::vec3 scale = parent.gridSpacing();
-  for (auto& p : isosurfaceMesh.vertices) {
-    // swizzle to account for change of coordinate/buffer ordering in the MC lib
-    p = glm::vec3{p.z, p.y, p.x} * scale + parent.getBoundMin();
+  if (!isosurfaceExtractedOnDevice) {
+    const IsosurfaceMesh& isosurfaceMesh = getIsosurfaceMesh();
+    isosurfacePositionBuffer->setData(isosurfaceMesh.vertices);
+    isosurfaceIndexBuffer->setData(isosurfaceMesh.indices);
   }
+}
+
+void VolumeGridNodeScalarQuantity::createIsosurfaceProgram() {
 
   std::vector<std::string> isoProgramRules{"SHADE_BASECOLOR", "PROJ_AND_INV_PROJ_MAT",
                                            "COMPUTE_SHADE_NORMAL_FROM_POSITION"};
@@ -197,10 +320,11 @@ void VolumeGridNodeScalarQuantity::createIsosurfaceProgram() {
   // clang-format on
 
   // Populate the program buffers with the extracted mesh
-  isosurfaceProgram->setAttribute("a_vertexPositions", isosurfaceMesh.vertices);
-  std::shared_ptr<render::AttributeBuffer> indexBuff = render::engine->generateAttributeBuffer(RenderDataType::UInt);
-  indexBuff->setData(isosurfaceMesh.indices);
-  isosurfaceProgram->setIndex(indexBuff);
+  isosurfacePositionBuffer = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+  isosurfaceIndexBuffer = render::engine->generateAttributeBuffer(RenderDataType::UInt);
+  fillIsosurfaceBuffers();
+  isosurfaceProgram->setAttribute("a_vertexPositions", isosurfacePositionBuffer);
+  isosurfaceProgram->setIndex(isosurfaceIndexBuffer);
 
 
   render::engine->setMaterial(*isosurfaceProgram, parent.getMaterial());
@@ -213,15 +337,7 @@ SurfaceMesh* VolumeGridNodeScalarQuantity::registerIsosurfaceAsMesh(std::string
     structureName = parent.name + " - " + name + " - isosurface";
   }
 
-  // extract the mesh
-  MC::mcMesh isosurfaceMesh;
-  MC::marching_cube(&values.data.front(), isosurfaceLevel.get(), parent.getGridNodeDim().x, parent.getGridNodeDim().y,
-                    parent.getGridNodeDim().z, isosurfaceMesh);
-  glm::vec3 scale = parent.gridSpacing();
-  for (auto& p : isosurfaceMesh.vertices) {
-    // swizzle to account for change of coordinate/buffer ordering in the MC lib
-    p = glm::vec3{p.z, p.y, p.x} * scale + parent.getBoundMin();
-  }
+  const IsosurfaceMesh& isosurfaceMesh = getIsosurfaceMesh();
 
   return registerSurfaceMesh(structureName, isosurfaceMesh.vertices,
                              std::make_tuple(isosurfaceMesh.indices.data(), isosurfaceMesh.indices.size() / 3, 3));
@@ -230,12 +346,28 @@ SurfaceMesh* VolumeGridNodeScalarQuantity::registerIsosurfaceAsMesh(std::string
 void VolumeGridNodeScalarQuantity::buildNodeInfoGUI(size_t ind) {
   ImGui::TextUnformatted(name.c_str());
   ImGui::NextColumn();
-  ImGui::Text("%g", values.getValue(ind));
+  ImGui::Text("%g", getNodeValue(ind));
   ImGui::NextColumn();
 }
 
 // === Getters and setters
 
+float VolumeGridNodeScalarQuantity::getNodeValue(size_t ind) {
+  if (!sparse) return values.getValue(ind);
+
+  size_t atlasInd = sparseLayout.nodeAtlasIndex(parent.unflattenNodeIndex(ind));
+  if (atlasInd == INVALID_IND_64) return sparseBackgroundValue;
+  return values.getValue(atlasInd);
+}
+
+bool VolumeGridNodeScalarQuantity::isSparse() { return sparse; }
+
+size_t VolumeGridNodeScalarQuantity::getMemoryUsage() {
+  size_t total = values.size() * sizeof(float);
+  if (sparse) total += brickSlots.size() * sizeof(float) + sparseLayout.memoryUsage();
+  return total;
+}
+
 VolumeGridNodeScalarQuantity* VolumeGridNodeScalarQuantity::setGridcubeVizEnabled(bool val) {
   gridcubeVizEnabled = val;
   requestRedraw();
@@ -3,7 +3,7 @@
 #include "polyscope/volume_mesh.h"
 
 #include "polyscope/color_management.h"
-#include "polyscope/combining_hash_functions.h"
+#include "polyscope/parallel.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
@@ -13,8 +13,8 @@
 #include "imgui.h"
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
-#include <unordered_map>
 #include <utility>
 
 namespace polyscope {
@@ -109,6 +109,11 @@ vertexPositions(        this, uniquePrefix() + "vertexPositions",     vertexPosi
 triangleVertexInds(     this, uniquePrefix() + "triangleVertexInds",  triangleVertexIndsData),
 triangleFaceInds(       this, uniquePrefix() + "triangleFaceInds",    triangleFaceIndsData),
 triangleCellInds(       this, uniquePrefix() + "triangleCellInds",    triangleCellIndsData),
+tetVertexInds{{
+                        {this, uniquePrefix() + "tetVertexInds1",     tetVertexIndsData[0]},
+                        {this, uniquePrefix() + "tetVertexInds2",     tetVertexIndsData[1]},
+                        {this, uniquePrefix() + "tetVertexInds3",     tetVertexIndsData[2]},
+                        {this, uniquePrefix() + "tetVertexInds4",     tetVertexIndsData[3]}}},
 
 // internal triangle data for rendering
 baryCoord(              this, uniquePrefix() + "baryCoord",           baryCoordData),
@@ -148,75 +153,161 @@ activeLevelSetQuantity(nullptr)
   updateObjectSpaceBounds();
 }
 
-void VolumeMesh::computeCounts() {
-
-  // == Populate counts
-  nFacesCount = 0;
-  nFacesTriangulationCount = 0;
+namespace {
 
-  // == Populate interior/exterior faces
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
-    // Iterate over faces
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-      nFacesCount++;
-      nFacesTriangulationCount += face.size();
+// The distinct vertices of each face of a cell stencil, as indices into the cell
+std::vector<std::vector<size_t>> stencilFaceVertices(const std::vector<std::vector<std::array<size_t, 3>>>& stencil) {
+  std::vector<std::vector<size_t>> faceVerts;
+  for (const std::vector<std::array<size_t, 3>>& face : stencil) {
+    std::vector<size_t> verts;
+    for (const std::array<size_t, 3>& tri : face) {
+      for (size_t j : tri) {
+        if (std::find(verts.begin(), verts.end(), j) == verts.end()) verts.push_back(j);
+      }
     }
+    faceVerts.push_back(verts);
   }
+  return faceVerts;
+}
 
-  // == Step 1: count occurences of each face
-  std::unordered_map<std::array<uint32_t, 4>, int, polyscope::hash_combine::hash<std::array<uint32_t, 4>>> faceCounts;
-
-  std::set<size_t> faceInds; // Scratch map
+} // namespace
 
-  // Build a sorted list of the indices of this face
+void VolumeMesh::computeCounts() {
 
-  // Helper to build a sorted-index array for a face
-  auto generateSortedFace = [&](const std::array<uint32_t, 8>& cell, const std::vector<std::array<size_t, 3>>& face) {
-    faceInds.clear();
-    for (const std::array<size_t, 3>& tri : face) {
-      for (int j = 0; j < 3; j++) {
-        faceInds.insert(cell[tri[j]]);
-      }
-    }
-    std::array<uint32_t, 4> sortedFace{7777, 7777, 7777, 7777};
-    int j = 0;
-    for (size_t ind : faceInds) {
-      sortedFace[j] = ind;
-      j++;
+  // Faces of cells are identified by their sorted vertex indices (padded with INVALID_IND_32). A face which is shared
+  // by more than one cell is interior.
+  //
+  // Faces are bucketed by their lowest vertex, and sorted within each (small) bucket to find the groups of matching
+  // faces, all in parallel. Interior flags are gathered as a bitmask per cell, then expanded into faceIsInterior in the
+  // iteration order of the mesh.
+
+  const std::vector<std::vector<size_t>> tetFaceVerts = stencilFaceVertices(stencilTet);
+  const std::vector<std::vector<size_t>> hexFaceVerts = stencilFaceVertices(stencilHex);
+  auto cellFaceVerts = [&](VolumeCellType cellT) -> const std::vector<std::vector<size_t>>& {
+    return cellT == VolumeCellType::HEX ? hexFaceVerts : tetFaceVerts;
+  };
+  auto faceKey = [&](size_t iC, const std::vector<size_t>& verts) {
+    std::array<uint32_t, 4> key{INVALID_IND_32, INVALID_IND_32, INVALID_IND_32, INVALID_IND_32};
+    for (size_t j = 0; j < verts.size(); j++) {
+      key[j] = cells[iC][verts[j]];
     }
-    return sortedFace;
+    std::sort(key.begin(), key.end());
+    std::fill(std::unique(key.begin(), key.end()), key.end(), INVALID_IND_32);
+    return key;
   };
 
-  // Iterate over cells
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
+  size_t nC = nCells();
 
-    // Iterate over faces
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-      std::array<uint32_t, 4> sortedFace = generateSortedFace(cell, face);
-      // Add to the count
-      if (faceCounts.find(sortedFace) == faceCounts.end()) {
-        faceCounts[sortedFace] = 0;
-      }
-      faceCounts[sortedFace]++;
-    }
+  // == Populate counts
+
+  // Cells are processed in contiguous chunks, so that each chunk knows where its faces start
+  size_t nChunks = std::max<size_t>(1, std::min<size_t>(4 * numParallelWorkers(), nC / 4096));
+  size_t chunkSize = (nC + nChunks - 1) / nChunks;
+  std::vector<size_t> chunkFaceStart(nChunks + 1, 0);
+  std::vector<size_t> chunkTriStart(nChunks + 1, 0);
+  parallelFor(
+      nChunks,
+      [&](size_t cStart, size_t cEnd) {
+        for (size_t iChunk = cStart; iChunk < cEnd; iChunk++) {
+          size_t faceCount = 0;
+          size_t triCount = 0;
+          for (size_t iC = iChunk * chunkSize; iC < std::min(nC, (iChunk + 1) * chunkSize); iC++) {
+            for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellType(iC))) {
+              faceCount++;
+              triCount += face.size();
+            }
+          }
+          chunkFaceStart[iChunk + 1] = faceCount;
+          chunkTriStart[iChunk + 1] = triCount;
+        }
+      },
+      1);
+  for (size_t iChunk = 0; iChunk < nChunks; iChunk++) {
+    chunkFaceStart[iChunk + 1] += chunkFaceStart[iChunk];
+    chunkTriStart[iChunk + 1] += chunkTriStart[iChunk];
   }
+  nFacesCount = chunkFaceStart[nChunks];
+  nFacesTriangulationCount = chunkTriStart[nChunks];
+  if (nFacesCount >= INVALID_IND_32) exception("volume mesh has too many faces to find the interior ones");
 
-  // Iterate a second time; all faces which were seen more than once are inteior
-  faceIsInterior.clear();
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    const std::array<uint32_t, 8>& cell = cells[iC];
-    VolumeCellType cellT = cellType(iC);
+  // == Populate interior/exterior faces
 
-    // Iterate over faces
-    for (const std::vector<std::array<size_t, 3>>& face : cellStencil(cellT)) {
-      std::array<uint32_t, 4> sortedFace = generateSortedFace(cell, face);
-      faceIsInterior.push_back(faceCounts[sortedFace] > 1);
+  // Bucket the faces by their lowest vertex. Entries hold the cell index and the face within the cell. (Indices are
+  // wrapped to the bucket count, which only matters for meshes with out-of-bounds vertex indices.)
+  size_t nBuckets = std::max<size_t>(nVertices(), 1);
+  auto faceBucket = [&](size_t iC, const std::vector<size_t>& verts) { return faceKey(iC, verts)[0] % nBuckets; };
+  std::vector<uint32_t> bucketStart(nBuckets + 1, 0);
+  std::vector<uint64_t> bucketFaces(nFacesCount);
+  {
+    std::vector<std::atomic<uint32_t>> bucketCursor(nBuckets); // value-initialized to 0
+    parallelFor(nC, [&](size_t start, size_t end) {
+      for (size_t iC = start; iC < end; iC++) {
+        for (const std::vector<size_t>& verts : cellFaceVerts(cellType(iC))) {
+          bucketCursor[faceBucket(iC, verts)].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+    for (size_t iV = 0; iV < nBuckets; iV++) {
+      bucketStart[iV + 1] = bucketStart[iV] + bucketCursor[iV].load(std::memory_order_relaxed);
+      bucketCursor[iV].store(bucketStart[iV], std::memory_order_relaxed);
     }
+    parallelFor(nC, [&](size_t start, size_t end) {
+      for (size_t iC = start; iC < end; iC++) {
+        const std::vector<std::vector<size_t>>& faceVerts = cellFaceVerts(cellType(iC));
+        for (size_t iF = 0; iF < faceVerts.size(); iF++) {
+          uint32_t pos = bucketCursor[faceBucket(iC, faceVerts[iF])].fetch_add(1, std::memory_order_relaxed);
+          bucketFaces[pos] = (static_cast<uint64_t>(iC) << 3) | iF;
+        }
+      }
+    });
   }
+
+  // Within each bucket, sort the faces by their keys; matching faces are now contiguous. Every face in a group of more
+  // than one is interior.
+  std::vector<std::atomic<uint8_t>> cellInteriorFaces(nC); // bitmask of interior faces, value-initialized to 0
+  parallelFor(nBuckets, [&](size_t vStart, size_t vEnd) {
+    std::vector<std::pair<std::array<uint32_t, 4>, uint64_t>> bucket;
+    for (size_t iV = vStart; iV < vEnd; iV++) {
+      bucket.clear();
+      for (uint32_t i = bucketStart[iV]; i < bucketStart[iV + 1]; i++) {
+        uint64_t iC = bucketFaces[i] >> 3;
+        uint64_t iF = bucketFaces[i] & 7;
+        bucket.emplace_back(faceKey(iC, cellFaceVerts(cellType(iC))[iF]), bucketFaces[i]);
+      }
+      std::sort(bucket.begin(), bucket.end());
+
+      size_t gBegin = 0;
+      while (gBegin < bucket.size()) {
+        size_t gEnd = gBegin + 1;
+        while (gEnd < bucket.size() && bucket[gEnd].first == bucket[gBegin].first) gEnd++;
+        if (gEnd - gBegin > 1) {
+          for (size_t i = gBegin; i < gEnd; i++) {
+            uint8_t faceBit = static_cast<uint8_t>(1u << (bucket[i].second & 7));
+            cellInteriorFaces[bucket[i].second >> 3].fetch_or(faceBit, std::memory_order_relaxed);
+          }
+        }
+        gBegin = gEnd;
+      }
+    }
+  });
+
+  // Expand the bitmasks in mesh iteration order
+  faceIsInterior.resize(nFacesCount);
+  parallelFor(
+      nChunks,
+      [&](size_t cStart, size_t cEnd) {
+        for (size_t iChunk = cStart; iChunk < cEnd; iChunk++) {
+          size_t iFace = chunkFaceStart[iChunk];
+          for (size_t iC = iChunk * chunkSize; iC < std::min(nC, (iChunk + 1) * chunkSize); iC++) {
+            uint8_t mask = cellInteriorFaces[iC].load(std::memory_order_relaxed);
+            size_t nCellFaces = cellStencil(cellType(iC)).size();
+            for (size_t iF = 0; iF < nCellFaces; iF++) {
+              faceIsInterior[iFace++] = (mask >> iF) & 1;
+            }
+          }
+        }
+      },
+      1);
 }
 
 
@@ -225,134 +316,183 @@ void VolumeMesh::computeTets() {
   // https://www.researchgate.net/profile/Julien-Dompierre/publication/221561839_How_to_Subdivide_Pyramids_Prisms_and_Hexahedra_into_Tetrahedra/links/0912f509c0b7294059000000/How-to-Subdivide-Pyramids-Prisms-and-Hexahedra-into-Tetrahedra.pdf?origin=publication_detail
   // It's a bit hard to look at but it works
   // Uses vertex numberings to ensure consistent diagonals between faces, and keeps tet counts to 5 or 6 per hex
-  size_t tetCount = 0;
-  // Get number of tets first
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    switch (cellType(iC)) {
-    case VolumeCellType::HEX: {
-      std::array<size_t, 8> sortedNumbering;
-      std::iota(sortedNumbering.begin(), sortedNumbering.end(), 0);
-      std::sort(sortedNumbering.begin(), sortedNumbering.end(),
-                [this, iC](size_t a, size_t b) -> bool { return cells[iC][a] < cells[iC][b]; });
-      std::array<size_t, 8> rotatedNumbering;
-      std::copy(rotationMap[sortedNumbering[0]].begin(), rotationMap[sortedNumbering[0]].end(),
-                rotatedNumbering.begin());
-      size_t diagCount = 0;
-      auto checkDiagonal = [this, rotatedNumbering, iC](size_t a1, size_t a2, size_t b1, size_t b2) {
-        return (cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b2]]) ||
-               (cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b2]]);
-      };
-      if (checkDiagonal(1, 7, 2, 5)) {
-        diagCount++;
-      }
-      if (checkDiagonal(3, 7, 2, 6)) {
-        diagCount++;
-      }
-      if (checkDiagonal(4, 7, 5, 6)) {
-        diagCount++;
-      }
-      if (diagCount == 0) {
-        tetCount += 5;
-      } else {
-        tetCount += 6;
-      }
-      break;
+  //
+  // A first pass decides how each hex is split, and records the decision (the rotated vertex numbering, 3 bits per
+  // corner, and the number of diagonals not incident to V_0 in the top bits). The resulting tet counts give each chunk
+  // of cells its offset in the output, and a second pass emits the tets. Both passes run in parallel.
+
+  auto splitHex = [&](const std::array<uint32_t, 8>& cell) -> uint32_t {
+    std::array<size_t, 8> sortedNumbering;
+    std::iota(sortedNumbering.begin(), sortedNumbering.end(), 0);
+    std::sort(sortedNumbering.begin(), sortedNumbering.end(),
+              [&cell](size_t a, size_t b) -> bool { return cell[a] < cell[b]; });
+    std::array<size_t, 8> rotatedNumbering;
+    std::copy(rotationMap[sortedNumbering[0]].begin(), rotationMap[sortedNumbering[0]].end(),
+              rotatedNumbering.begin());
+    size_t n = 0;
+    uint32_t diagCount = 0;
+    // Diagonal exists on the pair of vertices which contain the minimum vertex number
+    auto checkDiagonal = [&cell, &rotatedNumbering](size_t a1, size_t a2, size_t b1, size_t b2) {
+      return (cell[rotatedNumbering[a1]] < cell[rotatedNumbering[b1]] &&
+              cell[rotatedNumbering[a1]] < cell[rotatedNumbering[b2]]) ||
+             (cell[rotatedNumbering[a2]] < cell[rotatedNumbering[b1]] &&
+              cell[rotatedNumbering[a2]] < cell[rotatedNumbering[b2]]);
+    };
+    // Minimum vertex will always have 3 diagonals, check other three faces
+    if (checkDiagonal(1, 7, 2, 5)) {
+      n += 4;
+      diagCount++;
     }
-    case VolumeCellType::TET:
-      tetCount += 1;
-      break;
+    if (checkDiagonal(3, 7, 2, 6)) {
+      n += 2;
+      diagCount++;
     }
+    if (checkDiagonal(4, 7, 5, 6)) {
+      n += 1;
+      diagCount++;
+    }
+    // Rotate by 120 or 240 degrees depending on diagonal positions
+    if (n == 1 || n == 6) {
+      size_t temp = rotatedNumbering[1];
+      rotatedNumbering[1] = rotatedNumbering[4];
+      rotatedNumbering[4] = rotatedNumbering[3];
+      rotatedNumbering[3] = temp;
+      temp = rotatedNumbering[5];
+      rotatedNumbering[5] = rotatedNumbering[6];
+      rotatedNumbering[6] = rotatedNumbering[2];
+      rotatedNumbering[2] = temp;
+    } else if (n == 2 || n == 5) {
+      size_t temp = rotatedNumbering[1];
+      rotatedNumbering[1] = rotatedNumbering[3];
+      rotatedNumbering[3] = rotatedNumbering[4];
+      rotatedNumbering[4] = temp;
+      temp = rotatedNumbering[5];
+      rotatedNumbering[5] = rotatedNumbering[2];
+      rotatedNumbering[2] = rotatedNumbering[6];
+      rotatedNumbering[6] = temp;
+    }
+
+    uint32_t split = diagCount << 24;
+    for (size_t i = 0; i < 8; i++) {
+      split |= static_cast<uint32_t>(rotatedNumbering[i]) << (3 * i);
+    }
+    return split;
+  };
+  auto splitDiagCount = [](uint32_t split) -> uint32_t { return split >> 24; };
+  auto splitTetCount = [&](uint32_t split) -> size_t { return splitDiagCount(split) == 0 ? 5 : 6; };
+
+  size_t nC = nCells();
+  size_t nChunks = std::max<size_t>(1, std::min<size_t>(4 * numParallelWorkers(), nC / 4096));
+  size_t chunkSize = (nC + nChunks - 1) / nChunks;
+
+  // Get number of tets first
+  std::vector<uint32_t> hexSplits(nC, 0); // only set for hexes
+  std::vector<size_t> chunkTetStart(nChunks + 1, 0);
+  parallelFor(
+      nChunks,
+      [&](size_t cStart, size_t cEnd) {
+        for (size_t iChunk = cStart; iChunk < cEnd; iChunk++) {
+          size_t tetCount = 0;
+          for (size_t iC = iChunk * chunkSize; iC < std::min(nC, (iChunk + 1) * chunkSize); iC++) {
+            switch (cellType(iC)) {
+            case VolumeCellType::HEX:
+              hexSplits[iC] = splitHex(cells[iC]);
+              tetCount += splitTetCount(hexSplits[iC]);
+              break;
+            case VolumeCellType::TET:
+              tetCount += 1;
+              break;
+            }
+          }
+          chunkTetStart[iChunk + 1] = tetCount;
+        }
+      },
+      1);
+  for (size_t iChunk = 0; iChunk < nChunks; iChunk++) {
+    chunkTetStart[iChunk + 1] += chunkTetStart[iChunk];
   }
-  // Mark each edge as real or not (in the original mesh)
-  std::vector<std::array<bool, 6>> realEdges;
-  // Each hex can make up to 6 tets
-  tets.resize(tetCount);
-  realEdges.resize(tetCount);
-  size_t tetIdx = 0;
-  for (size_t iC = 0; iC < nCells(); iC++) {
-    switch (cellType(iC)) {
-    case VolumeCellType::HEX: {
-      std::array<size_t, 8> sortedNumbering;
-      std::iota(sortedNumbering.begin(), sortedNumbering.end(), 0);
-      std::sort(sortedNumbering.begin(), sortedNumbering.end(),
-                [this, iC](size_t a, size_t b) -> bool { return cells[iC][a] < cells[iC][b]; });
-      std::array<size_t, 8> rotatedNumbering;
-      std::copy(rotationMap[sortedNumbering[0]].begin(), rotationMap[sortedNumbering[0]].end(),
-                rotatedNumbering.begin());
-      size_t n = 0;
-      size_t diagCount = 0;
-      // Diagonal exists on the pair of vertices which contain the minimum vertex number
-      auto checkDiagonal = [this, rotatedNumbering, iC](size_t a1, size_t a2, size_t b1, size_t b2) {
-        return (cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a1]] < cells[iC][rotatedNumbering[b2]]) ||
-               (cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b1]] &&
-                cells[iC][rotatedNumbering[a2]] < cells[iC][rotatedNumbering[b2]]);
-      };
-      // Minimum vertex will always have 3 diagonals, check other three faces
-      if (checkDiagonal(1, 7, 2, 5)) {
-        n += 4;
-        diagCount++;
-      }
-      if (checkDiagonal(3, 7, 2, 6)) {
-        n += 2;
-        diagCount++;
-      }
-      if (checkDiagonal(4, 7, 5, 6)) {
-        n += 1;
-        diagCount++;
-      }
-      // Rotate by 120 or 240 degrees depending on diagonal positions
-      if (n == 1 || n == 6) {
-        size_t temp = rotatedNumbering[1];
-        rotatedNumbering[1] = rotatedNumbering[4];
-        rotatedNumbering[4] = rotatedNumbering[3];
-        rotatedNumbering[3] = temp;
-        temp = rotatedNumbering[5];
-        rotatedNumbering[5] = rotatedNumbering[6];
-        rotatedNumbering[6] = rotatedNumbering[2];
-        rotatedNumbering[2] = temp;
-      } else if (n == 2 || n == 5) {
-        size_t temp = rotatedNumbering[1];
-        rotatedNumbering[1] = rotatedNumbering[3];
-        rotatedNumbering[3] = rotatedNumbering[4];
-        rotatedNumbering[4] = temp;
-        temp = rotatedNumbering[5];
-        rotatedNumbering[5] = rotatedNumbering[2];
-        rotatedNumbering[2] = rotatedNumbering[6];
-        rotatedNumbering[6] = temp;
-      }
+  size_t tetCount = chunkTetStart[nChunks];
 
-      // Map final tets according to diagonalMap and the number of diagonals not incident to V_0
-      std::array<std::array<size_t, 4>, 6> tetMap = diagonalMap[diagCount];
-      for (size_t k = 0; k < (diagCount == 0 ? 5 : 6); k++) {
-        for (size_t i = 0; i < 4; i++) {
-          tets[tetIdx][i] = cells[iC][rotatedNumbering[tetMap[k][i]]];
+  // Emit the tets, along with the per-corner index buffers used for slicing
+  tets.resize(tetCount);
+  for (size_t i = 0; i < 4; i++) {
+    tetVertexIndsData[i].resize(tetCount);
+  }
+  parallelFor(
+      nChunks,
+      [&](size_t cStart, size_t cEnd) {
+        for (size_t iChunk = cStart; iChunk < cEnd; iChunk++) {
+          size_t tetIdx = chunkTetStart[iChunk];
+          auto emitTet = [&](const std::array<uint32_t, 4>& tet) {
+            tets[tetIdx] = tet;
+            for (size_t i = 0; i < 4; i++) {
+              tetVertexIndsData[i][tetIdx] = tet[i];
+            }
+            tetIdx++;
+          };
+
+          for (size_t iC = iChunk * chunkSize; iC < std::min(nC, (iChunk + 1) * chunkSize); iC++) {
+            const std::array<uint32_t, 8>& cell = cells[iC];
+            switch (cellType(iC)) {
+            case VolumeCellType::HEX: {
+              uint32_t split = hexSplits[iC];
+              // Map final tets according to diagonalMap and the number of diagonals not incident to V_0
+              const std::array<std::array<size_t, 4>, 6>& tetMap = diagonalMap[splitDiagCount(split)];
+              for (size_t k = 0; k < splitTetCount(split); k++) {
+                std::array<uint32_t, 4> tet;
+                for (size_t i = 0; i < 4; i++) {
+                  tet[i] = cell[(split >> (3 * tetMap[k][i])) & 7];
+                }
+                emitTet(tet);
+              }
+              break;
+            }
+            case VolumeCellType::TET:
+              emitTet({cell[0], cell[1], cell[2], cell[3]});
+              break;
+            }
+          }
         }
-        tetIdx++;
-      }
-      break;
-    }
-    case VolumeCellType::TET:
-      for (size_t i = 0; i < 4; i++) {
-        tets[tetIdx][i] = cells[iC][i];
-      }
-      tetIdx++;
-      break;
-    }
+      },
+      1);
+
+  for (size_t i = 0; i < 4; i++) {
+    tetVertexInds[i].markHostBufferUpdated();
   }
 }
 
 void VolumeMesh::ensureHaveTets() {
-  if (tets.empty()) {
+  if (!tets.empty()) return;
+  if (tetVertexIndsData[0].empty()) {
+    computeTets();
+    return;
+  }
+
+  // The tets were freed with releaseTets(). Gather them back from the per-corner index buffers rather than recomputing
+  // them, which would also mark those buffers as updated and re-upload them.
+  size_t tetCount = tetVertexIndsData[0].size();
+  tets.resize(tetCount);
+  for (size_t iT = 0; iT < tetCount; iT++) {
+    for (size_t i = 0; i < 4; i++) {
+      tets[iT][i] = tetVertexIndsData[i][iT];
+    }
+  }
+}
+
+void VolumeMesh::ensureHaveTetVertexInds() {
+  if (tetVertexIndsData[0].empty()) {
     computeTets();
   }
 }
 
+void VolumeMesh::releaseTets() {
+  ensureHaveTetVertexInds();
+  std::vector<std::array<uint32_t, 4>>().swap(tets);
+}
+
 size_t VolumeMesh::nTets() {
-  ensureHaveTets();
-  return tets.size();
+  ensureHaveTetVertexInds();
+  return tetVertexIndsData[0].size();
 }
 
 void VolumeMesh::addSlicePlaneListener(polyscope::SlicePlane* sp) { volumeSlicePlaneListeners.push_back(sp); }
@@ -368,37 +508,16 @@ void VolumeMesh::removeSlicePlaneListener(polyscope::SlicePlane* sp) {
 
 void VolumeMesh::fillSliceGeometryBuffers(render::ShaderProgram& program) {
 
-  // TODO update this to use new standalone buffers
-
-  ensureHaveTets();
-  vertexPositions.ensureHostBufferPopulated();
+  // The indexed views are cached on the vertex position buffer, so each corner is uploaded once no matter how many
+  // slice planes and quantities draw slices of the mesh, and they are kept up to date when the positions change.
+  ensureHaveTetVertexInds();
 
-  // TODO port this to managed buffers
-
-  std::vector<glm::vec3> point1;
-  std::vector<glm::vec3> point2;
-  std::vector<glm::vec3> point3;
-  std::vector<glm::vec3> point4;
-  size_t tetCount = tets.size();
-  point1.resize(tetCount);
-  point2.resize(tetCount);
-  point3.resize(tetCount);
-  point4.resize(tetCount);
-  for (size_t tetIdx = 0; tetIdx < tets.size(); tetIdx++) {
-    point1[tetIdx] = vertexPositions.data[tets[tetIdx][0]];
-    point2[tetIdx] = vertexPositions.data[tets[tetIdx][1]];
-    point3[tetIdx] = vertexPositions.data[tets[tetIdx][2]];
-    point4[tetIdx] = vertexPositions.data[tets[tetIdx][3]];
+  for (size_t i = 0; i < 4; i++) {
+    std::shared_ptr<render::AttributeBuffer> cornerPositions =
+        vertexPositions.getIndexedRenderAttributeBuffer(tetVertexInds[i]);
+    program.setAttribute("a_point_" + std::to_string(i + 1), cornerPositions);
+    program.setAttribute("a_slice_" + std::to_string(i + 1), cornerPositions);
   }
-
-  program.setAttribute("a_point_1", point1);
-  program.setAttribute("a_point_2", point2);
-  program.setAttribute("a_point_3", point3);
-  program.setAttribute("a_point_4", point4);
-  program.setAttribute("a_slice_1", point1);
-  program.setAttribute("a_slice_2", point2);
-  program.setAttribute("a_slice_3", point3);
-  program.setAttribute("a_slice_4", point4);
 }
 
 
@@ -966,8 +1085,11 @@ void VolumeMesh::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+  objectSpaceBoundsDataVersion = geometryDataVersion();
 }
 
+uint64_t VolumeMesh::geometryDataVersion() { return vertexPositions.dataVersion(); }
+
 std::string VolumeMesh::typeName() { return structureTypeName; }
 
 
@@ -76,34 +76,11 @@ std::shared_ptr<render::ShaderProgram> VolumeMeshVertexColorQuantity::createSlic
 }
 
 void VolumeMeshVertexColorQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
-
-  // TODO update this to use new standalone buffers
-
-  colors.ensureHostBufferPopulated();
-
-  size_t tetCount = parent.nTets();
-  std::vector<glm::vec3> colorval_1;
-  std::vector<glm::vec3> colorval_2;
-  std::vector<glm::vec3> colorval_3;
-  std::vector<glm::vec3> colorval_4;
-
-  colorval_1.resize(tetCount);
-  colorval_2.resize(tetCount);
-  colorval_3.resize(tetCount);
-  colorval_4.resize(tetCount);
-
-  for (size_t iT = 0; iT < parent.tets.size(); iT++) {
-    colorval_1[iT] = colors.data[parent.tets[iT][0]];
-    colorval_2[iT] = colors.data[parent.tets[iT][1]];
-    colorval_3[iT] = colors.data[parent.tets[iT][2]];
-    colorval_4[iT] = colors.data[parent.tets[iT][3]];
-  }
-
-  // Store data in buffers
-  p.setAttribute("a_value_1", colorval_1);
-  p.setAttribute("a_value_2", colorval_2);
-  p.setAttribute("a_value_3", colorval_3);
-  p.setAttribute("a_value_4", colorval_4);
+  parent.ensureHaveTetVertexInds();
+  p.setAttribute("a_value_1", colors.getIndexedRenderAttributeBuffer(parent.tetVertexInds[0]));
+  p.setAttribute("a_value_2", colors.getIndexedRenderAttributeBuffer(parent.tetVertexInds[1]));
+  p.setAttribute("a_value_3", colors.getIndexedRenderAttributeBuffer(parent.tetVertexInds[2]));
+  p.setAttribute("a_value_4", colors.getIndexedRenderAttributeBuffer(parent.tetVertexInds[3]));
 }
 
 void VolumeMeshVertexColorQuantity::createProgram() {
@@ -67,48 +67,36 @@ VolumeMeshVertexScalarQuantity::VolumeMeshVertexScalarQuantity(std::string name,
 {
   parent.refreshVolumeMeshListeners(); // just in case this quantity is being drawn
 }
-void VolumeMeshVertexScalarQuantity::fillLevelSetData(render::ShaderProgram& p) {
 
-  // TODO refactor to use new attribute buffers
-
-  parent.vertexPositions.ensureHostBufferPopulated();
-  values.ensureHostBufferPopulated();
-
-  std::vector<glm::vec3> point1;
-  std::vector<glm::vec3> point2;
-  std::vector<glm::vec3> point3;
-  std::vector<glm::vec3> point4;
-  std::vector<glm::vec3> slice1;
-  std::vector<glm::vec3> slice2;
-  std::vector<glm::vec3> slice3;
-  std::vector<glm::vec3> slice4;
-  size_t tetCount = parent.nTets();
-  slice1.resize(tetCount);
-  slice2.resize(tetCount);
-  slice3.resize(tetCount);
-  slice4.resize(tetCount);
-  point1.resize(tetCount);
-  point2.resize(tetCount);
-  point3.resize(tetCount);
-  point4.resize(tetCount);
-  for (size_t i = 0; i < parent.nTets(); i++) {
-    point1[i] = parent.vertexPositions.data[parent.tets[i][0]];
-    point2[i] = parent.vertexPositions.data[parent.tets[i][1]];
-    point3[i] = parent.vertexPositions.data[parent.tets[i][2]];
-    point4[i] = parent.vertexPositions.data[parent.tets[i][3]];
-    slice1[i] = glm::vec3(values.data[parent.tets[i][0]], 0, 0);
-    slice2[i] = glm::vec3(values.data[parent.tets[i][1]], 0, 0);
-    slice3[i] = glm::vec3(values.data[parent.tets[i][2]], 0, 0);
-    slice4[i] = glm::vec3(values.data[parent.tets[i][3]], 0, 0);
+std::shared_ptr<render::ShaderProgram>
+VolumeMeshVertexScalarQuantity::createLevelSetProgram(VolumeMeshVertexScalarQuantity& colorQuantity) {
+  // clang-format off
+  std::shared_ptr<render::ShaderProgram> p = render::engine->requestShader("SLICE_TETS", 
+      render::engine->addMaterialRules(parent.getMaterial(),
+        parent.addVolumeMeshRules(
+          addScalarRules(
+            {"SLICE_TETS_PROPAGATE_VALUE", "SLICE_TETS_SLICE_BY_LEVEL_SET_VALUE"}), 
+        true, true)
+      )
+    );
+  // clang-format on
+
+  // Fill color buffers
+  parent.fillSliceGeometryBuffers(*p);
+  colorQuantity.fillSliceColorBuffers(*p);
+  render::engine->setMaterial(*p, parent.getMaterial());
+  fillLevelSetData(*p);
+  return p;
+}
+
+void VolumeMeshVertexScalarQuantity::fillLevelSetData(render::ShaderProgram& p) {
+  // The tets are sliced by this quantity's values rather than by position. Like the slice values, these are indexed
+  // views of the values, shared with this quantity's other slice programs.
+  parent.ensureHaveTetVertexInds();
+  for (size_t i = 0; i < 4; i++) {
+    p.setAttribute("a_levelSetValue_" + std::to_string(i + 1),
+                   values.getIndexedRenderAttributeBuffer(parent.tetVertexInds[i]));
   }
-  p.setAttribute("a_point_1", point1);
-  p.setAttribute("a_point_2", point2);
-  p.setAttribute("a_point_3", point3);
-  p.setAttribute("a_point_4", point4);
-  p.setAttribute("a_slice_1", slice1);
-  p.setAttribute("a_slice_2", slice2);
-  p.setAttribute("a_slice_3", slice3);
-  p.setAttribute("a_slice_4", slice4);
 }
 
 void VolumeMeshVertexScalarQuantity::setLevelSetUniforms(render::ShaderProgram& p) {
@@ -122,8 +110,7 @@ void VolumeMeshVertexScalarQuantity::draw() {
   auto programToDraw = program;
   if (isDrawingLevelSet) {
     if (levelSetProgram == nullptr) {
-      levelSetProgram = createSliceProgram();
-      fillLevelSetData(*levelSetProgram);
+      levelSetProgram = createLevelSetProgram(*this);
     }
     setLevelSetUniforms(*levelSetProgram);
     programToDraw = levelSetProgram;
@@ -181,22 +168,7 @@ void VolumeMeshVertexScalarQuantity::setLevelSetVisibleQuantity(std::string name
     return;
   }
 
-  // clang-format off
-  levelSetProgram = render::engine->requestShader("SLICE_TETS", 
-      render::engine->addMaterialRules(parent.getMaterial(),
-        parent.addVolumeMeshRules(
-          addScalarRules(
-            {"SLICE_TETS_PROPAGATE_VALUE"}), 
-        true, true)
-      )
-    );
-  // clang-format on
-
-  // Fill color buffers
-  parent.fillSliceGeometryBuffers(*levelSetProgram);
-  q->fillSliceColorBuffers(*levelSetProgram);
-  render::engine->setMaterial(*levelSetProgram, parent.getMaterial());
-  fillLevelSetData(*levelSetProgram);
+  levelSetProgram = createLevelSetProgram(*q);
   setLevelSetUniforms(*levelSetProgram);
   showQuantity = q;
 }
@@ -281,34 +253,11 @@ std::shared_ptr<render::ShaderProgram> VolumeMeshVertexScalarQuantity::createSli
 }
 
 void VolumeMeshVertexScalarQuantity::fillSliceColorBuffers(render::ShaderProgram& p) {
-
-  // TODO use new attribute buffers
-
-  values.ensureHostBufferPopulated();
-
-  size_t tetCount = parent.nTets();
-  std::vector<float> colorval_1;
-  std::vector<float> colorval_2;
-  std::vector<float> colorval_3;
-  std::vector<float> colorval_4;
-
-  colorval_1.resize(tetCount);
-  colorval_2.resize(tetCount);
-  colorval_3.resize(tetCount);
-  colorval_4.resize(tetCount);
-
-  for (size_t iT = 0; iT < parent.tets.size(); iT++) {
-    colorval_1[iT] = values.data[parent.tets[iT][0]];
-    colorval_2[iT] = values.data[parent.tets[iT][1]];
-    colorval_3[iT] = values.data[parent.tets[iT][2]];
-    colorval_4[iT] = values.data[parent.tets[iT][3]];
-  }
-
-  // Store data in buffers
-  p.setAttribute("a_value_1", colorval_1);
-  p.setAttribute("a_value_2", colorval_2);
-  p.setAttribute("a_value_3", colorval_3);
-  p.setAttribute("a_value_4", colorval_4);
+  parent.ensureHaveTetVertexInds();
+  p.setAttribute("a_value_1", values.getIndexedRenderAttributeBuffer(parent.tetVertexInds[0]));
+  p.setAttribute("a_value_2", values.getIndexedRenderAttributeBuffer(parent.tetVertexInds[1]));
+  p.setAttribute("a_value_3", values.getIndexedRenderAttributeBuffer(parent.tetVertexInds[2]));
+  p.setAttribute("a_value_4", values.getIndexedRenderAttributeBuffer(parent.tetVertexInds[3]));
   p.setTextureFromColormap("t_colormap", cMap.get());
 }
 
@@ -31,6 +31,8 @@ void VolumeMeshVertexVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float VolumeMeshVertexVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void VolumeMeshVertexVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
@@ -71,6 +73,8 @@ void VolumeMeshCellVectorQuantity::refresh() {
   Quantity::refresh();
 }
 
+float VolumeMeshCellVectorQuantity::getRenderPadding() { return getVectorRenderPadding(); }
+
 void VolumeMeshCellVectorQuantity::draw() {
   if (!isEnabled()) return;
   drawVectors();
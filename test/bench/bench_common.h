@@ -0,0 +1,39 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+// Minimal timing helpers for the polyscope-bench executable. Benchmarks are plain functions which print one line per
+// measurement; they are not run as part of the test suite.
+
+// Run func() `nRuns` times (after one untimed warmup run) and return the best wall time in milliseconds
+inline double benchTimeMs(const std::function<void()>& func, size_t nRuns = 5) {
+  func();
+  double best = -1.;
+  for (size_t i = 0; i < nRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (best < 0. || ms < best) best = ms;
+  }
+  return best;
+}
+
+inline void benchReport(const std::string& name, size_t problemSize, double ms) {
+  std::printf("%-48s n = %10zu   %10.3f ms\n", name.c_str(), problemSize, ms);
+}
+
+// Run the large problem sizes too (set by passing --large)
+extern bool benchLarge;
+
+// == Benchmark suites
+void benchSurfaceMesh();
+void benchSurfaceMeshGeometry();
+void benchVolumeMesh();
+void benchTransparency();
+void benchImplicit();
@@ -0,0 +1,72 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "bench_common.h"
+#include "implicit_tracer_baseline.h"
+
+#include "polyscope/implicit_helpers.h"
+#include "polyscope/polyscope.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// A sphere with a smaller sphere carved out of it and a torus around it, as a fixed analytic SDF
+float benchSDF(glm::vec3 p) {
+  float sphere = glm::length(p) - 1.f;
+  float carve = glm::length(p - glm::vec3{0.6f, 0.4f, 0.5f}) - 0.5f;
+  glm::vec2 q{glm::length(glm::vec2{p.x, p.z}) - 1.5f, p.y};
+  float torus = glm::length(q) - 0.2f;
+  return std::min(std::max(sphere, -carve), torus);
+}
+
+void benchSDFBatch(const float* pos, float* out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = benchSDF(glm::vec3{pos[3 * i + 0], pos[3 * i + 1], pos[3 * i + 2]});
+  }
+}
+
+typedef std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>> TracerResult;
+
+} // namespace
+
+void benchImplicit() {
+
+  std::vector<std::array<int32_t, 2>> resolutions = {{320, 240}, {640, 480}, {1280, 720}};
+  if (benchLarge) resolutions.push_back({1920, 1080});
+
+  for (const std::array<int32_t, 2>& res : resolutions) {
+    polyscope::ImplicitRenderOpts opts;
+    opts.dimX = res[0];
+    opts.dimY = res[1];
+    opts.cameraParameters = polyscope::CameraParameters(
+        polyscope::CameraIntrinsics::fromFoVDegVerticalAndAspect(60.f, static_cast<float>(res[0]) / res[1]),
+        polyscope::CameraExtrinsics::fromVectors(glm::vec3{0.5f, 1.f, 4.f}, glm::vec3{-0.1f, -0.25f, -1.f},
+                                                 glm::vec3{0.f, 1.f, 0.f}));
+    polyscope::ImplicitRenderMode mode = polyscope::ImplicitRenderMode::SphereMarch;
+    std::string suffix = " (" + std::to_string(res[0]) + "x" + std::to_string(res[1]);
+    size_t nPix = static_cast<size_t>(res[0]) * res[1];
+
+    // The tracer as it was before tiling, marching every ray of the image in lockstep
+    TracerResult lockstep, tiled, parallel;
+    double lockstepMs =
+        benchTimeMs([&]() { lockstep = renderImplicitSurfaceTracerLockstepBaseline(benchSDFBatch, mode, opts); }, 3);
+
+    double tiledMs =
+        benchTimeMs([&]() { tiled = polyscope::renderImplicitSurfaceTracer(benchSDFBatch, mode, opts); }, 3);
+
+    opts.parallelTiles = true;
+    double parallelMs =
+        benchTimeMs([&]() { parallel = polyscope::renderImplicitSurfaceTracer(benchSDFBatch, mode, opts); }, 3);
+
+    benchReport("implicit sdf trace" + suffix + ", pre-tiling lockstep)", nPix, lockstepMs);
+    benchReport("implicit sdf trace" + suffix + ", tiled)", nPix, tiledMs);
+    benchReport("implicit sdf trace" + suffix + ", parallel tiles)", nPix, parallelMs);
+    std::printf("  tiled output identical: %s, parallel output identical: %s\n",
+                implicitTracerResultsIdentical(lockstep, tiled) ? "yes" : "NO",
+                implicitTracerResultsIdentical(lockstep, parallel) ? "yes" : "NO");
+  }
+}
@@ -0,0 +1,36 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "bench_common.h"
+
+#include "polyscope/parallel.h"
+#include "polyscope/polyscope.h"
+
+#include <cstring>
+#include <string>
+
+bool benchLarge = false;
+
+int main(int argc, char** argv) {
+
+  std::string backend = "openGL_mock";
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--large") == 0) benchLarge = true;
+    if (std::strcmp(argv[i], "--gl") == 0) backend = "openGL3_glfw";
+  }
+
+  // Most structures are only registered to run their CPU-side computations, so the mock backend is enough. Pass --gl
+  // to render with a real backend, which the rendering benchmarks need for meaningful frame times and images.
+  polyscope::options::verbosity = 0;
+  polyscope::options::usePrefsFile = false;
+  polyscope::init(backend);
+
+  std::printf("polyscope benchmarks (%zu worker threads)\n", polyscope::numParallelWorkers());
+
+  benchSurfaceMesh();
+  benchSurfaceMeshGeometry();
+  benchVolumeMesh();
+  benchTransparency();
+  benchImplicit();
+
+  return 0;
+}
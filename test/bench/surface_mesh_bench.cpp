@@ -0,0 +1,188 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "bench_common.h"
+
+#include "polyscope/combining_hash_functions.h"
+#include "polyscope/mesh_edge_table.h"
+#include "polyscope/options.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/surface_mesh.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// A triangulated (n x n)-vertex grid, in the flat face format used by SurfaceMesh
+void buildGridMesh(size_t n, std::vector<uint32_t>& faceIndsStart, std::vector<uint32_t>& faceIndsEntries) {
+  faceIndsStart = {0};
+  faceIndsEntries.clear();
+  auto vInd = [&](size_t i, size_t j) { return static_cast<uint32_t>(i * n + j); };
+  for (size_t i = 0; i + 1 < n; i++) {
+    for (size_t j = 0; j + 1 < n; j++) {
+      for (uint32_t v : {vInd(i, j), vInd(i + 1, j), vInd(i + 1, j + 1)}) faceIndsEntries.push_back(v);
+      faceIndsStart.push_back(faceIndsEntries.size());
+      for (uint32_t v : {vInd(i, j), vInd(i + 1, j + 1), vInd(i, j + 1)}) faceIndsEntries.push_back(v);
+      faceIndsStart.push_back(faceIndsEntries.size());
+    }
+  }
+}
+
+// The hash map based edge numbering and twin search which SurfaceMesh used previously, kept as a reference
+polyscope::MeshEdgeTable buildMeshEdgeTableHashMap(const std::vector<uint32_t>& faceIndsStart,
+                                                   const std::vector<uint32_t>& faceIndsEntries) {
+  polyscope::MeshEdgeTable table;
+  size_t nHalfedges = faceIndsEntries.size();
+  table.halfedgeEdge.resize(nHalfedges);
+  table.twinHalfedge.resize(nHalfedges);
+
+  std::unordered_map<std::pair<size_t, size_t>, std::vector<size_t>,
+                     polyscope::hash_combine::hash<std::pair<size_t, size_t>>>
+      edgeHalfedges;
+
+  size_t psEdgeInd = 0;
+  for (size_t iF = 0; iF + 1 < faceIndsStart.size(); iF++) {
+    size_t start = faceIndsStart[iF];
+    size_t D = faceIndsStart[iF + 1] - start;
+    for (size_t j = 0; j < D; j++) {
+      size_t vA = faceIndsEntries[start + j];
+      size_t vB = faceIndsEntries[start + (j + 1) % D];
+      std::pair<size_t, size_t> key(std::min(vA, vB), std::max(vA, vB));
+      auto it = edgeHalfedges.find(key);
+      if (it == edgeHalfedges.end()) {
+        it = edgeHalfedges.insert(it, {key, std::vector<size_t>()});
+        table.halfedgeEdge[start + j] = psEdgeInd++;
+      } else {
+        table.halfedgeEdge[start + j] = table.halfedgeEdge[it->second.front()];
+      }
+      it->second.push_back(start + j);
+    }
+  }
+  table.nEdges = psEdgeInd;
+
+  for (auto& entry : edgeHalfedges) {
+    std::vector<size_t>& hes = entry.second;
+    for (size_t iHe : hes) {
+      uint32_t myTwin = polyscope::INVALID_IND_32;
+      for (size_t t : hes) {
+        if (t != iHe) {
+          myTwin = t;
+          break;
+        }
+      }
+      table.twinHalfedge[iHe] = myTwin;
+    }
+  }
+
+  return table;
+}
+
+} // namespace
+
+void benchSurfaceMesh() {
+
+  for (size_t n : {100, 300, 1000}) {
+    std::vector<uint32_t> faceIndsStart, faceIndsEntries;
+    buildGridMesh(n, faceIndsStart, faceIndsEntries);
+    size_t nVertices = n * n;
+    size_t nHalfedges = faceIndsEntries.size();
+
+    polyscope::MeshEdgeTable hashTable, sortTable;
+    double hashMs = benchTimeMs([&]() { hashTable = buildMeshEdgeTableHashMap(faceIndsStart, faceIndsEntries); }, 3);
+    double sortMs =
+        benchTimeMs([&]() { sortTable = polyscope::buildMeshEdgeTable(faceIndsStart, faceIndsEntries, nVertices); });
+
+    benchReport("surface mesh edge table (hash map)", nHalfedges, hashMs);
+    benchReport("surface mesh edge table (parallel sort)", nHalfedges, sortMs);
+
+    if (hashTable.nEdges != sortTable.nEdges || hashTable.halfedgeEdge != sortTable.halfedgeEdge ||
+        hashTable.twinHalfedge != sortTable.twinHalfedge) {
+      std::printf("ERROR: edge tables disagree\n");
+      std::exit(1);
+    }
+  }
+}
+
+void benchSurfaceMeshGeometry() {
+
+  std::vector<size_t> targetFaces = {1000000};
+  if (benchLarge) targetFaces.push_back(10000000);
+
+  for (size_t nTargetFaces : targetFaces) {
+    size_t n = static_cast<size_t>(std::sqrt(nTargetFaces / 2.)) + 1;
+    std::vector<uint32_t> faceIndsStart, faceIndsEntries;
+    buildGridMesh(n, faceIndsStart, faceIndsEntries);
+    size_t nFaces = faceIndsStart.size() - 1;
+
+    // a slightly bumpy grid, so the normals are not all identical
+    std::vector<glm::vec3> positions(n * n);
+    for (size_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < n; j++) {
+        float x = static_cast<float>(i);
+        float y = static_cast<float>(j);
+        positions[i * n + j] = glm::vec3{x, y, std::sin(0.1f * x) * std::cos(0.1f * y)};
+      }
+    }
+
+    polyscope::SurfaceMesh* psMesh =
+        new polyscope::SurfaceMesh("bench mesh", positions, faceIndsEntries, faceIndsStart);
+    polyscope::registerStructure(psMesh);
+
+    // time each kernel on its own, with dependencies already populated
+    struct Kernel {
+      std::string name;
+      polyscope::render::ManagedBuffer<glm::vec3>* vecBuffer;
+      polyscope::render::ManagedBuffer<float>* scalarBuffer;
+    };
+    std::vector<Kernel> kernels = {
+        {"face normals", &psMesh->faceNormals, nullptr},
+        {"face centers", &psMesh->faceCenters, nullptr},
+        {"face areas", nullptr, &psMesh->faceAreas},
+        {"vertex normals", &psMesh->vertexNormals, nullptr},
+        {"vertex areas", nullptr, &psMesh->vertexAreas},
+        {"face tangent basis X", &psMesh->defaultFaceTangentBasisX, nullptr},
+        {"face tangent basis Y", &psMesh->defaultFaceTangentBasisY, nullptr},
+    };
+
+    int origMaxThreads = polyscope::options::maxThreads;
+    for (Kernel& k : kernels) {
+      auto recompute = [&]() {
+        if (k.vecBuffer) k.vecBuffer->recomputeIfPopulated();
+        if (k.scalarBuffer) k.scalarBuffer->recomputeIfPopulated();
+      };
+      if (k.vecBuffer) k.vecBuffer->ensureHostBufferPopulated();
+      if (k.scalarBuffer) k.scalarBuffer->ensureHostBufferPopulated();
+
+      polyscope::options::maxThreads = 1;
+      double serialMs = benchTimeMs(recompute);
+      std::vector<glm::vec3> serialVec;
+      std::vector<float> serialScalar;
+      if (k.vecBuffer) serialVec = k.vecBuffer->data;
+      if (k.scalarBuffer) serialScalar = k.scalarBuffer->data;
+
+      polyscope::options::maxThreads = origMaxThreads;
+      double parallelMs = benchTimeMs(recompute);
+
+      benchReport("surface mesh " + k.name + " (1 thread)", nFaces, serialMs);
+      benchReport("surface mesh " + k.name + " (parallel)", nFaces, parallelMs);
+
+      // results must not depend on the thread count
+      bool same = k.vecBuffer ? (std::memcmp(serialVec.data(), k.vecBuffer->data.data(),
+                                             serialVec.size() * sizeof(glm::vec3)) == 0)
+                              : (serialScalar == k.scalarBuffer->data);
+      if (!same) {
+        std::printf("ERROR: %s differ between serial and parallel runs\n", k.name.c_str());
+        std::exit(1);
+      }
+    }
+
+    polyscope::removeAllStructures();
+  }
+}
@@ -0,0 +1,92 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "bench_common.h"
+
+#include "polyscope/options.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/screenshot.h"
+#include "polyscope/surface_mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A stack of `nLayers` wavy, translucent sheets in front of an opaque one, so most pixels are covered by many layers
+void registerLayeredScene(size_t nLayers, size_t res) {
+  for (size_t iL = 0; iL <= nLayers; iL++) {
+    std::vector<glm::vec3> positions;
+    std::vector<std::array<size_t, 3>> faces;
+    for (size_t j = 0; j <= res; j++) {
+      for (size_t i = 0; i <= res; i++) {
+        float x = static_cast<float>(i) / res;
+        float y = static_cast<float>(j) / res;
+        float z = 0.2f * static_cast<float>(iL) + 0.05f * std::sin(10.f * x + static_cast<float>(iL));
+        positions.push_back(glm::vec3{x, y, z});
+      }
+    }
+    for (size_t j = 0; j < res; j++) {
+      for (size_t i = 0; i < res; i++) {
+        size_t v = j * (res + 1) + i;
+        faces.push_back({v, v + 1, v + res + 2});
+        faces.push_back({v, v + res + 2, v + res + 1});
+      }
+    }
+
+    polyscope::SurfaceMesh* psMesh = polyscope::registerSurfaceMesh("layer " + std::to_string(iL), positions, faces);
+    if (iL > 0) psMesh->setTransparency(0.4);
+  }
+}
+
+// Mean and max absolute per-channel difference between two RGBA8 images
+std::array<double, 2> imageDifference(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+  double sum = 0.;
+  double maxDiff = 0.;
+  for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+    double d = std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i]));
+    sum += d;
+    maxDiff = std::max(maxDiff, d);
+  }
+  return {a.empty() ? 0. : sum / a.size(), maxDiff};
+}
+
+} // namespace
+
+void benchTransparency() {
+
+  std::vector<size_t> layerCounts = {4, 8};
+  if (benchLarge) layerCounts.push_back(16);
+
+  polyscope::TransparencyMode origMode = polyscope::options::transparencyMode;
+  int origPasses = polyscope::options::transparencyRenderPasses;
+
+  for (size_t nLayers : layerCounts) {
+    registerLayeredScene(nLayers, 64);
+    std::string suffix = " (" + std::to_string(nLayers) + " layers";
+
+    // Enough depth peeling passes to resolve every layer, so Pretty serves as the reference image
+    polyscope::options::transparencyMode = polyscope::TransparencyMode::Pretty;
+    polyscope::options::transparencyRenderPasses = static_cast<int>(nLayers) + 1;
+    std::vector<unsigned char> prettyImage;
+    double prettyMs = benchTimeMs([&]() { prettyImage = polyscope::screenshotToBuffer(false); }, 5);
+
+    polyscope::options::transparencyMode = polyscope::TransparencyMode::WeightedBlended;
+    std::vector<unsigned char> weightedImage;
+    double weightedMs = benchTimeMs([&]() { weightedImage = polyscope::screenshotToBuffer(false); }, 5);
+
+    benchReport("transparency frame" + suffix + ", pretty)", prettyImage.size() / 4, prettyMs);
+    benchReport("transparency frame" + suffix + ", weighted blended)", weightedImage.size() / 4, weightedMs);
+
+    std::array<double, 2> diff = imageDifference(prettyImage, weightedImage);
+    std::printf("  weighted blended vs pretty: mean abs diff %.3f, max abs diff %.0f (of 255)\n", diff[0], diff[1]);
+
+    polyscope::removeAllStructures();
+  }
+
+  polyscope::options::transparencyMode = origMode;
+  polyscope::options::transparencyRenderPasses = origPasses;
+}
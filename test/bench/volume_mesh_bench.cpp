@@ -0,0 +1,166 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "bench_common.h"
+
+#include "polyscope/combining_hash_functions.h"
+#include "polyscope/options.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/utilities.h"
+#include "polyscope/volume_mesh.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Cells on an (n x n x n)-cube lattice. Cubes in the lower half (along z) are hexes if `lowerHex` is set and those in the
+// upper half if `upperHex` is set; all other cubes are split into 6 tets around their diagonal.
+void buildLatticeMesh(size_t n, bool lowerHex, bool upperHex, std::vector<glm::vec3>& positions,
+                      std::vector<std::array<uint32_t, 8>>& cells) {
+  auto vInd = [&](size_t i, size_t j, size_t k) { return static_cast<uint32_t>((k * (n + 1) + j) * (n + 1) + i); };
+
+  positions.clear();
+  for (size_t k = 0; k <= n; k++) {
+    for (size_t j = 0; j <= n; j++) {
+      for (size_t i = 0; i <= n; i++) {
+        positions.push_back(glm::vec3{static_cast<float>(i), static_cast<float>(j), static_cast<float>(k)});
+      }
+    }
+  }
+
+  const uint32_t X = polyscope::INVALID_IND_32;
+  cells.clear();
+  for (size_t k = 0; k < n; k++) {
+    for (size_t j = 0; j < n; j++) {
+      for (size_t i = 0; i < n; i++) {
+        bool hex = (2 * k < n) ? lowerHex : upperHex;
+        if (hex) {
+          cells.push_back({vInd(i, j, k), vInd(i + 1, j, k), vInd(i + 1, j + 1, k), vInd(i, j + 1, k),
+                           vInd(i, j, k + 1), vInd(i + 1, j, k + 1), vInd(i + 1, j + 1, k + 1),
+                           vInd(i, j + 1, k + 1)});
+        } else {
+          // the 6 paths from the lower to the upper corner, one step along each axis at a time
+          const std::array<std::array<int, 3>, 6> axisOrders{
+              {{{0, 1, 2}}, {{0, 2, 1}}, {{1, 0, 2}}, {{1, 2, 0}}, {{2, 0, 1}}, {{2, 1, 0}}}};
+          for (const std::array<int, 3>& order : axisOrders) {
+            std::array<size_t, 3> c{i, j, k};
+            std::array<uint32_t, 8> tet{vInd(i, j, k), 0, 0, 0, X, X, X, X};
+            for (int s = 0; s < 3; s++) {
+              c[order[s]]++;
+              tet[s + 1] = vInd(c[0], c[1], c[2]);
+            }
+            cells.push_back(tet);
+          }
+        }
+      }
+    }
+  }
+}
+
+// The hash map based face counting which VolumeMesh used previously, kept as a reference
+std::vector<char> computeFaceIsInteriorHashMap(polyscope::VolumeMesh& mesh) {
+  std::unordered_map<std::array<uint32_t, 4>, int, polyscope::hash_combine::hash<std::array<uint32_t, 4>>> faceCounts;
+  std::set<size_t> faceInds;
+  auto generateSortedFace = [&](const std::array<uint32_t, 8>& cell, const std::vector<std::array<size_t, 3>>& face) {
+    faceInds.clear();
+    for (const std::array<size_t, 3>& tri : face) {
+      for (int j = 0; j < 3; j++) {
+        faceInds.insert(cell[tri[j]]);
+      }
+    }
+    std::array<uint32_t, 4> sortedFace{polyscope::INVALID_IND_32, polyscope::INVALID_IND_32,
+                                       polyscope::INVALID_IND_32, polyscope::INVALID_IND_32};
+    int j = 0;
+    for (size_t ind : faceInds) {
+      sortedFace[j] = ind;
+      j++;
+    }
+    return sortedFace;
+  };
+
+  for (size_t iC = 0; iC < mesh.nCells(); iC++) {
+    for (const std::vector<std::array<size_t, 3>>& face : polyscope::VolumeMesh::cellStencil(mesh.cellType(iC))) {
+      faceCounts[generateSortedFace(mesh.cells[iC], face)]++;
+    }
+  }
+
+  std::vector<char> faceIsInterior;
+  for (size_t iC = 0; iC < mesh.nCells(); iC++) {
+    for (const std::vector<std::array<size_t, 3>>& face : polyscope::VolumeMesh::cellStencil(mesh.cellType(iC))) {
+      faceIsInterior.push_back(faceCounts[generateSortedFace(mesh.cells[iC], face)] > 1);
+    }
+  }
+  return faceIsInterior;
+}
+
+} // namespace
+
+void benchVolumeMesh() {
+
+  std::vector<size_t> latticeSizes = {40};
+  if (benchLarge) latticeSizes.push_back(150);
+
+  struct MeshKind {
+    std::string name;
+    bool lowerHex;
+    bool upperHex;
+  };
+  std::vector<MeshKind> kinds = {{"tet", false, false}, {"hex", true, true}, {"mixed", true, false}};
+
+  for (size_t n : latticeSizes) {
+    for (const MeshKind& kind : kinds) {
+      std::vector<glm::vec3> positions;
+      std::vector<std::array<uint32_t, 8>> cells;
+      buildLatticeMesh(n, kind.lowerHex, kind.upperHex, positions, cells);
+
+      double registerMs = benchTimeMs(
+          [&]() {
+            polyscope::registerVolumeMesh("bench mesh", positions, cells);
+            polyscope::removeAllStructures();
+          },
+          3);
+      benchReport("volume mesh register (" + kind.name + ")", cells.size(), registerMs);
+
+      polyscope::VolumeMesh* psMesh = polyscope::registerVolumeMesh("bench mesh", positions, cells);
+
+      std::vector<char> hashFaceIsInterior;
+      double hashMs = benchTimeMs([&]() { hashFaceIsInterior = computeFaceIsInteriorHashMap(*psMesh); }, 1);
+
+      int origMaxThreads = polyscope::options::maxThreads;
+      polyscope::options::maxThreads = 1;
+      double serialMs = benchTimeMs([&]() { psMesh->computeCounts(); }, 3);
+      polyscope::options::maxThreads = origMaxThreads;
+      double parallelMs = benchTimeMs([&]() { psMesh->computeCounts(); }, 3);
+
+      benchReport("volume mesh interior faces (" + kind.name + ", hash map)", cells.size(), hashMs);
+      benchReport("volume mesh interior faces (" + kind.name + ", 1 thread)", cells.size(), serialMs);
+      benchReport("volume mesh interior faces (" + kind.name + ", parallel)", cells.size(), parallelMs);
+
+      if (hashFaceIsInterior != psMesh->faceIsInterior) {
+        std::printf("ERROR: interior faces disagree\n");
+        std::exit(1);
+      }
+
+      polyscope::options::maxThreads = 1;
+      double serialTetMs = benchTimeMs([&]() { psMesh->computeTets(); }, 3);
+      std::vector<std::array<uint32_t, 4>> serialTets = psMesh->tets;
+      polyscope::options::maxThreads = origMaxThreads;
+      double parallelTetMs = benchTimeMs([&]() { psMesh->computeTets(); }, 3);
+
+      benchReport("volume mesh tet decomposition (" + kind.name + ", 1 thread)", cells.size(), serialTetMs);
+      benchReport("volume mesh tet decomposition (" + kind.name + ", parallel)", cells.size(), parallelTetMs);
+
+      if (serialTets != psMesh->tets) {
+        std::printf("ERROR: tets differ between serial and parallel runs\n");
+        std::exit(1);
+      }
+
+      polyscope::removeAllStructures();
+    }
+  }
+}
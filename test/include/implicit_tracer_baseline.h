@@ -0,0 +1,195 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/implicit_helpers.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+// A copy of renderImplicitSurfaceTracer() as it was before the image was split in to tiles: every ray of the image
+// marches in lockstep, and normals are sampled at every pixel. The tests and benchmarks hold the tiled tracer to
+// bit-identical output against it.
+template <class Func>
+std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>>
+renderImplicitSurfaceTracerLockstepBaseline(Func&& func, polyscope::ImplicitRenderMode mode,
+                                            polyscope::ImplicitRenderOpts opts, bool withNormals = true) {
+
+  // Read out option values
+  const float missDist = opts.missDist.asAbsolute();
+  const float hitDist = opts.hitDist.asAbsolute();
+  const float stepFactor = opts.stepFactor;          // used for sphere march only
+  const float stepSize = opts.stepSize.asAbsolute(); // used for fixed step only
+  const size_t nMaxSteps = opts.nMaxSteps;
+  const float normalSampleEps = opts.normalSampleEps;
+
+  polyscope::CameraParameters& params = opts.cameraParameters;
+  glm::vec3 cameraLoc = params.getPosition();
+  glm::mat4x4 viewMat = params.getViewMat();
+  size_t dimX = opts.dimX;
+  size_t dimY = opts.dimY;
+  size_t nPix = dimX * dimY;
+
+  // Generate rays corresponding to each pixel
+  // (this is a working set which will be shrunk as computation proceeds)
+  std::vector<glm::vec3> rayRoots(nPix);
+  std::vector<size_t> rayInds(nPix); // index of the ray
+  for (size_t iY = 0; iY < dimY; iY++) {
+    for (size_t iX = 0; iX < dimX; iX++) {
+      size_t ind = iY * dimX + iX;
+      rayRoots[ind] = cameraLoc;
+      rayInds[ind] = ind;
+    }
+  }
+  std::vector<glm::vec3> rayDirs = params.generateCameraRays(dimX, dimY, polyscope::ImageOrigin::UpperLeft);
+
+  // Sample the first value at each ray (to check for sign changes)
+  std::vector<float> currVals(nPix);
+  func(&rayRoots.front().x, &currVals.front(), rayRoots.size());
+
+  std::vector<bool> initSigns(nPix);
+  for (size_t iP = 0; iP < nPix; iP++) {
+    initSigns[iP] = std::signbit(currVals[iP]);
+  }
+
+  // March along the ray to compute depth
+  std::vector<float> rayDepth(nPix, 0.); // working data, gets shrunk and repacked
+  std::vector<glm::vec3> currPos(nPix);
+  std::vector<float> rayDepthOut(nPix, -1.);                        // output values
+  std::vector<glm::vec3> rayPosOut(nPix, glm::vec3{0.f, 0.f, 0.f}); // output values
+  size_t iFinished = 0;
+  for (size_t iStep = 0; (iStep < nMaxSteps) && (iFinished < nPix); iStep++) {
+
+    // Check for convergence & write/compact
+    size_t iPack = 0;
+    for (size_t iP = 0; iP < rayDepth.size(); iP++) {
+
+      // Check for termination
+      bool missTerminated = rayDepth[iP] > missDist;
+      bool terminated =
+          missTerminated || (std::abs(currVals[iP]) < hitDist) || (std::signbit(currVals[iP]) != initSigns[iP]);
+
+      if (terminated) {
+        // Write to the output buffer
+        size_t outInd = rayInds[iP];
+        glm::vec3 finalPos = rayRoots[iP] + rayDepth[iP] * rayDirs[iP];
+        float outDepth = missTerminated ? -1.f : rayDepth[iP];
+        rayDepthOut[outInd] = outDepth;
+        rayPosOut[outInd] = finalPos;
+
+        iFinished++;
+
+      } else {
+        // Take a step
+        float rayStepSize = -1.;
+        if (mode == polyscope::ImplicitRenderMode::SphereMarch) {
+          rayStepSize = std::abs(currVals[iP]) * stepFactor;
+        } else if (mode == polyscope::ImplicitRenderMode::FixedStep) {
+          rayStepSize = stepSize;
+        }
+
+        float newDepth = rayDepth[iP] + rayStepSize;
+        glm::vec3 newPos = rayRoots[iP] + newDepth * rayDirs[iP];
+
+        // Write to the compacted array
+        rayRoots[iPack] = rayRoots[iP];
+        rayDirs[iPack] = rayDirs[iP];
+        rayInds[iPack] = rayInds[iP];
+        rayDepth[iPack] = newDepth;
+        currPos[iPack] = newPos;
+        iPack++;
+      }
+    }
+
+    // "Trim" the working arrays to size
+    rayRoots.resize(iPack);
+    rayDirs.resize(iPack);
+    rayInds.resize(iPack);
+    rayDepth.resize(iPack);
+    currPos.resize(iPack);
+    currVals.resize(iPack);
+
+    // Evaluate the remaining rays
+    if (iPack > 0) {
+      func(&currPos.front().x, &currVals.front(), currPos.size());
+    }
+  }
+
+  // == Compute normals
+  // Uses finite differences on the vertices of a tetrahedron
+  // (see https://iquilezles.org/articles/normalsSDF/)
+
+  std::vector<glm::vec3> normalOut;
+
+  if (withNormals) {
+
+    normalOut = std::vector<glm::vec3>(nPix, glm::vec3{0.f, 0.f, 0.f});
+
+    std::array<glm::vec3, 4> tetVerts({
+        glm::vec3{1.f, -1.f, -1.f},
+        glm::vec3{-1.f, -1.f, 1.f},
+        glm::vec3{-1.f, 1.f, -1.f},
+        glm::vec3{1.f, 1.f, 1.f},
+    });
+
+    currPos.resize(nPix);
+    currVals.resize(nPix);
+    for (size_t iV = 0; iV < 4; iV++) {
+      glm::vec3 vertVec = tetVerts[iV];
+
+      // Set up the evaluation points for each pixel
+      for (size_t iP = 0; iP < nPix; iP++) {
+        float f = rayDepthOut[iP] * normalSampleEps;
+        currPos[iP] = rayPosOut[iP] + f * vertVec;
+      }
+
+      // Evaluate the function at each sample point
+      func(&currPos.front().x, &currVals.front(), currPos.size());
+
+      // Accumulate the result
+      for (size_t iP = 0; iP < nPix; iP++) {
+        normalOut[iP] += vertVec * currVals[iP];
+      }
+    }
+
+    // Normalize the normal vectors and transform to view space
+    glm::mat3x3 viewMat3(viewMat);
+    for (size_t iP = 0; iP < nPix; iP++) {
+      normalOut[iP] = viewMat3 * glm::normalize(normalOut[iP]);
+    }
+  }
+
+  // Handle not-converged rays
+  for (size_t iP = 0; iP < nPix; iP++) {
+    bool didConverge = rayDepthOut[iP] >= 0.;
+    if (!didConverge) {
+      rayDepthOut[iP] = std::numeric_limits<float>::infinity();
+      if (withNormals) {
+        normalOut[iP] = glm::vec3{0.f, 0.f, 0.f};
+      }
+    }
+  }
+
+  return std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>>{rayDepthOut, rayPosOut,
+                                                                                        normalOut};
+}
+
+// True if the two tracer outputs (depths, positions and normals) are bit-identical
+inline bool implicitTracerResultsIdentical(
+    const std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>>& a,
+    const std::tuple<std::vector<float>, std::vector<glm::vec3>, std::vector<glm::vec3>>& b) {
+  const std::vector<float>& depthA = std::get<0>(a);
+  const std::vector<float>& depthB = std::get<0>(b);
+  const std::vector<glm::vec3>& posA = std::get<1>(a);
+  const std::vector<glm::vec3>& posB = std::get<1>(b);
+  const std::vector<glm::vec3>& normalA = std::get<2>(a);
+  const std::vector<glm::vec3>& normalB = std::get<2>(b);
+  return depthA.size() == depthB.size() && posA.size() == posB.size() && normalA.size() == normalB.size() &&
+         std::memcmp(depthA.data(), depthB.data(), depthA.size() * sizeof(float)) == 0 &&
+         std::memcmp(posA.data(), posB.data(), posA.size() * sizeof(glm::vec3)) == 0 &&
+         std::memcmp(normalA.data(), normalB.data(), normalA.size() * sizeof(glm::vec3)) == 0;
+}
@@ -13,6 +13,7 @@
 #include "polyscope/pick.h"
 #include "polyscope/point_cloud.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/render/mock_opengl/mock_gl_engine.h"
 #include "polyscope/simple_triangle_mesh.h"
 #include "polyscope/surface_mesh.h"
 #include "polyscope/types.h"
@@ -57,6 +58,60 @@ protected:
 
 // == Common helpers
 
+// Measures what the main camera pass draws. The ground plane draws the scene again for its reflection and shadow, from
+// other views, so it is disabled while this is in scope. The primitive counts are only available with the mock backend.
+class MainPassDrawCounter {
+public:
+  MainPassDrawCounter()
+      : mockEngine(dynamic_cast<polyscope::render::backend_openGL_mock::MockGLEngine*>(polyscope::render::engine)),
+        origGroundPlaneMode(polyscope::options::groundPlaneMode) {
+    polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::None;
+  }
+  ~MainPassDrawCounter() { polyscope::options::groundPlaneMode = origGroundPlaneMode; }
+
+  bool hasMockEngine() const { return mockEngine != nullptr; }
+
+  // Primitives submitted to render a screenshot, an interactive frame, or the pick buffer
+  uint64_t countScreenshotPrimitives() {
+    mockEngine->resetSubmittedPrimitiveCount();
+    polyscope::screenshotToBuffer();
+    return mockEngine->getSubmittedPrimitiveCount();
+  }
+  uint64_t countFramePrimitives() {
+    mockEngine->resetSubmittedPrimitiveCount();
+    polyscope::frameTick();
+    return mockEngine->getSubmittedPrimitiveCount();
+  }
+  uint64_t countPickPrimitives() {
+    mockEngine->resetSubmittedPrimitiveCount();
+    polyscope::pick::invalidatePickBuffer();
+    polyscope::pick::evaluatePickQuery(-1, -1); // renders the pick buffer
+    return mockEngine->getSubmittedPrimitiveCount();
+  }
+
+private:
+  polyscope::render::backend_openGL_mock::MockGLEngine* mockEngine;
+  polyscope::GroundPlaneMode origGroundPlaneMode;
+};
+
+// The mock backend does not actually draw anything. This stands in for the pick pass drawing element `localInd` of
+// structure `s` over the rectangle [lower, upper] (inclusive, in buffer coordinates) of the cached pick buffer, so that
+// pick queries have something to find. It lasts until the pick buffer is next rendered. Returns false if the backend
+// is not the mock one.
+inline bool fillMockPickBuffer(polyscope::Structure* s, size_t localInd, glm::ivec2 lower, glm::ivec2 upper) {
+  polyscope::render::backend_openGL_mock::GLFrameBuffer* pickFramebuffer =
+      dynamic_cast<polyscope::render::backend_openGL_mock::GLFrameBuffer*>(
+          polyscope::render::engine->pickFramebuffer.get());
+  if (pickFramebuffer == nullptr) return false;
+
+  polyscope::pick::evaluatePickQuery(-1, -1); // renders the pick buffer, unless it is cached already
+  glm::vec3 color = polyscope::pick::indToVec(polyscope::pick::localIndexToGlobal({s, localInd}));
+  int rowStart = polyscope::view::bufferHeight - 1 - upper.y; // (the framebuffer counts rows from the bottom)
+  pickFramebuffer->fillFloat4Region(lower.x, rowStart, upper.x - lower.x + 1, upper.y - lower.y + 1,
+                                    {color.x, color.y, color.z, 1.f});
+  return true;
+}
+
 inline std::vector<glm::vec3> getPoints() {
   std::vector<glm::vec3> points;
 
@@ -70,6 +70,9 @@ TEST_F(PolyscopeTest, TransparencyTest) {
   polyscope::options::transparencyMode = polyscope::TransparencyMode::Pretty;
   polyscope::show(3);
 
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::WeightedBlended;
+  polyscope::show(3);
+
   polyscope::removeAllStructures();
 }
 
@@ -144,6 +147,123 @@ TEST_F(PolyscopeTest, SlicePlaneTest) {
   polyscope::removeAllStructures();
 }
 
+// Structures which are not visible are skipped when drawing
+TEST_F(PolyscopeTest, StructureCullingTest) {
+
+  auto psMesh = registerTriangleMesh();
+  auto psPoints = registerPointCloud();
+
+  // the culled counts are for the main pass only
+  MainPassDrawCounter counter;
+
+  // everything is in view
+  polyscope::view::resetCameraToHomeView();
+  uint64_t culledCount = polyscope::culledStructureDrawCount();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(polyscope::culledStructureDrawCount(), culledCount);
+
+  // looking away from everything
+  polyscope::view::lookAt(glm::vec3{0., 0., 10.}, glm::vec3{0., 0., 20.});
+  polyscope::screenshotToBuffer();
+  EXPECT_GE(polyscope::culledStructureDrawCount(), culledCount + 2);
+
+  // each render counts a culled structure once, however many passes the transparency mode takes
+  culledCount = polyscope::culledStructureDrawCount();
+  polyscope::screenshotToBuffer();
+  uint64_t culledPerScreenshot = polyscope::culledStructureDrawCount() - culledCount;
+  for (polyscope::TransparencyMode mode :
+       {polyscope::TransparencyMode::Pretty, polyscope::TransparencyMode::WeightedBlended}) {
+    polyscope::options::transparencyMode = mode;
+    culledCount = polyscope::culledStructureDrawCount();
+    polyscope::screenshotToBuffer();
+    EXPECT_EQ(polyscope::culledStructureDrawCount() - culledCount, culledPerScreenshot);
+  }
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
+
+  // unless culling is disabled
+  polyscope::options::cullStructures = false;
+  culledCount = polyscope::culledStructureDrawCount();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(polyscope::culledStructureDrawCount(), culledCount);
+  polyscope::options::cullStructures = true;
+
+  // in view, but entirely behind a slice plane, except for the structure which ignores it
+  polyscope::view::resetCameraToHomeView();
+  polyscope::SlicePlane* p = polyscope::addSceneSlicePlane();
+  p->setPose(glm::vec3{10., 0., 0.}, glm::vec3{1., 0., 0.});
+  psMesh->setIgnoreSlicePlane(p->name, true);
+  EXPECT_FALSE(psMesh->isCulled());
+  EXPECT_TRUE(psPoints->isCulled());
+  culledCount = polyscope::culledStructureDrawCount();
+  polyscope::screenshotToBuffer();
+  EXPECT_GT(polyscope::culledStructureDrawCount(), culledCount);
+
+  polyscope::removeLastSceneSlicePlane();
+  polyscope::removeAllStructures();
+}
+
+// Culling follows the geometry as it moves, and the view of the current pass
+TEST_F(PolyscopeTest, StructureCullingUpdatesTest) {
+
+  auto psPoints = registerPointCloud();
+
+  // the culled counts are for the main pass only
+  MainPassDrawCounter counter;
+
+  // looking away from the points
+  polyscope::view::lookAt(glm::vec3{0., 0., 10.}, glm::vec3{0., 0., 20.});
+  EXPECT_TRUE(psPoints->isCulled());
+
+  // move the points into view, they get drawn
+  std::vector<glm::vec3> movedPoints = getPoints();
+  for (glm::vec3& p : movedPoints) p.z += 15.;
+  psPoints->updatePointPositions(movedPoints);
+  EXPECT_FALSE(psPoints->isCulled());
+  uint64_t culledCount = polyscope::culledStructureDrawCount();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(polyscope::culledStructureDrawCount(), culledCount);
+
+  // and back out of view
+  psPoints->updatePointPositions(getPoints());
+  EXPECT_TRUE(psPoints->isCulled());
+
+  // points behind the camera, but drawn with a radius large enough to reach into view
+  psPoints->setPointRadius(12., false);
+  EXPECT_FALSE(psPoints->isCulled());
+  psPoints->setPointRadius(0.01, false);
+  EXPECT_TRUE(psPoints->isCulled());
+
+  // the same, for a vector quantity which is long enough to reach into view
+  std::vector<glm::vec3> vecs(psPoints->nPoints(), glm::vec3{0., 0., 1.});
+  auto q = psPoints->addVectorQuantity("vecs", vecs, polyscope::VectorType::AMBIENT);
+  q->setEnabled(true);
+  EXPECT_TRUE(psPoints->isCulled());
+  for (glm::vec3& v : vecs) v.z = 20.;
+  q->updateData(vecs);
+  EXPECT_FALSE(psPoints->isCulled());
+  q->setEnabled(false);
+  EXPECT_TRUE(psPoints->isCulled());
+
+  // the ground plane draws the reflection with a mirrored view, which can see the points
+  glm::mat4 origViewMat = polyscope::view::viewMat;
+  glm::mat4 mirrorMat = glm::translate(glm::mat4(1.), glm::vec3{0., 0., 20.}) *
+                        glm::scale(glm::mat4(1.), glm::vec3{1., 1., -1.}); // reflect across z = 10
+  polyscope::view::viewMat = origViewMat * mirrorMat;
+  EXPECT_FALSE(psPoints->isCulled());
+  polyscope::view::viewMat = origViewMat;
+  EXPECT_TRUE(psPoints->isCulled());
+
+  // after writing the positions directly on the device the bounds are unknown, so the points are always drawn
+  polyscope::screenshotToBuffer();
+  psPoints->points.markRenderAttributeBufferUpdated();
+  EXPECT_FALSE(psPoints->isCulled());
+  culledCount = polyscope::culledStructureDrawCount();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(polyscope::culledStructureDrawCount(), culledCount);
+
+  polyscope::removeAllStructures();
+}
+
 // Register a handful of quantities / structures, then call refresh
 TEST_F(PolyscopeTest, OrthoViewTest) {
 
@@ -1,5 +1,6 @@
 // Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
 
+#include "implicit_tracer_baseline.h"
 #include "polyscope_test.h"
 
 #include "polyscope/floating_quantities.h"
@@ -62,6 +63,9 @@ TEST_F(PolyscopeTest, FloatingImageTest) {
   polyscope::options::transparencyMode = polyscope::TransparencyMode::Pretty;
   polyscope::show(3);
 
+  polyscope::options::transparencyMode = polyscope::TransparencyMode::WeightedBlended;
+  polyscope::show(3);
+
   polyscope::options::transparencyMode = polyscope::TransparencyMode::None;
 
   // make sure removing works
@@ -228,3 +232,201 @@ TEST_F(PolyscopeTest, ImplicitSurfaceRenderImageQuantityTest) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, ImplicitSurfaceTiledTracerTest) {
+
+  auto sphereSDF = [](const float* pos, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = glm::length(glm::vec3{pos[3 * i + 0], pos[3 * i + 1], pos[3 * i + 2]}) - 1.f;
+    }
+  };
+
+  polyscope::ImplicitRenderOpts opts;
+  opts.dimX = 67;
+  opts.dimY = 41;
+  opts.cameraParameters = polyscope::CameraParameters(
+      polyscope::CameraIntrinsics::fromFoVDegVerticalAndAspect(60.f, 67.f / 41.f),
+      polyscope::CameraExtrinsics::fromVectors(glm::vec3{0.f, 0.f, 3.f}, glm::vec3{0.f, 0.f, -1.f},
+                                               glm::vec3{0.f, 1.f, 0.f}));
+  polyscope::ImplicitRenderMode mode = polyscope::ImplicitRenderMode::SphereMarch;
+
+  // The output matches the old lockstep tracer bit for bit, no matter how the image is split in to tiles, or
+  // whether they are traced in parallel
+  auto baseline = renderImplicitSurfaceTracerLockstepBaseline(sphereSDF, mode, opts);
+  opts.tileSize = 67;
+  auto whole = polyscope::renderImplicitSurfaceTracer(sphereSDF, mode, opts);
+  opts.tileSize = 16;
+  auto tiled = polyscope::renderImplicitSurfaceTracer(sphereSDF, mode, opts);
+  opts.parallelTiles = true;
+  auto parallel = polyscope::renderImplicitSurfaceTracer(sphereSDF, mode, opts);
+
+  EXPECT_TRUE(implicitTracerResultsIdentical(baseline, whole));
+  EXPECT_TRUE(implicitTracerResultsIdentical(baseline, tiled));
+  EXPECT_TRUE(implicitTracerResultsIdentical(baseline, parallel));
+
+  // the center ray hits the sphere, the corner ray misses it
+  EXPECT_NEAR(std::get<0>(whole)[20 * 67 + 33], 2., 1e-3);
+  EXPECT_EQ(std::get<0>(whole)[0], std::numeric_limits<float>::infinity());
+}
+
+TEST_F(PolyscopeTest, ImplicitSurfaceFunctorTest) {
+
+  // A stateful function which cannot be copied: the non-progressive renders call the caller's own instance
+  struct CountingSphereSDF {
+    CountingSphereSDF() {}
+    CountingSphereSDF(const CountingSphereSDF&) = delete;
+    size_t nCalls = 0;
+    float operator()(glm::vec3 p) {
+      nCalls++;
+      return glm::length(p) - 1.f;
+    }
+  };
+  struct CountingColor {
+    CountingColor() {}
+    CountingColor(const CountingColor&) = delete;
+    size_t nCalls = 0;
+    glm::vec3 operator()(glm::vec3 p) {
+      nCalls++;
+      return glm::vec3{1.f, 0.f, 0.f};
+    }
+  };
+
+  polyscope::ImplicitRenderOpts opts;
+  polyscope::ImplicitRenderMode mode = polyscope::ImplicitRenderMode::SphereMarch;
+  opts.subsampleFactor = 16;
+
+  CountingSphereSDF sdf;
+  CountingColor color;
+  polyscope::renderImplicitSurface("sphere sdf", sdf, mode, opts);
+  EXPECT_GT(sdf.nCalls, 0u);
+  size_t nDepthCalls = sdf.nCalls;
+  polyscope::renderImplicitSurfaceColor("sphere sdf color", sdf, color, mode, opts);
+  EXPECT_GT(sdf.nCalls, nDepthCalls);
+  EXPECT_GT(color.nCalls, 0u);
+
+  // A progressive render outlives the call, so it needs a function it can copy
+  opts.progressive = true;
+  EXPECT_THROW(polyscope::renderImplicitSurface("sphere sdf progressive", sdf, mode, opts), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ImplicitSurfaceProgressiveTest) {
+
+  auto sphereSDF = [](const float* pos, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = glm::length(glm::vec3{pos[3 * i + 0], pos[3 * i + 1], pos[3 * i + 2]}) - 1.f;
+    }
+  };
+  auto colorFunc = [](const float* pos, float* out, size_t n) {
+    for (size_t i = 0; i < 3 * n; i++) out[i] = pos[i] > 0.f ? 1.f : 0.f;
+  };
+
+  polyscope::ImplicitRenderOpts opts;
+  opts.dimX = 67;
+  opts.dimY = 41;
+  opts.cameraParameters = polyscope::CameraParameters(
+      polyscope::CameraIntrinsics::fromFoVDegVerticalAndAspect(60.f, 67.f / 41.f),
+      polyscope::CameraExtrinsics::fromVectors(glm::vec3{0.f, 0.f, 3.f}, glm::vec3{0.f, 0.f, -1.f},
+                                               glm::vec3{0.f, 1.f, 0.f}));
+  polyscope::ImplicitRenderMode mode = polyscope::ImplicitRenderMode::SphereMarch;
+  auto reference = polyscope::renderImplicitSurfaceTracer(sphereSDF, mode, opts);
+  polyscope::ColorRenderImageQuantity* referenceColor =
+      polyscope::renderImplicitSurfaceColorBatch("sphere sdf color reference", sphereSDF, colorFunc, mode, opts);
+  std::map<std::string, std::unique_ptr<polyscope::ProgressiveImplicitRender>>& renders =
+      polyscope::state::globalContext.progressiveImplicitRenders;
+
+  // A coarse preview is available right away, then refined over the following frames to the same image as a
+  // non-progressive render
+  opts.progressive = true;
+  opts.subsampleFactor = 4;
+  opts.progressiveFrameBudgetMs = 1000.;
+  polyscope::DepthRenderImageQuantity* img = polyscope::renderImplicitSurfaceBatch("sphere sdf", sphereSDF, mode, opts);
+  EXPECT_EQ(img->nPix(), 67u * 41u);
+  EXPECT_EQ(renders.size(), 1u);
+  polyscope::show(3);
+  EXPECT_EQ(img->depths.data, std::get<0>(reference));
+  EXPECT_EQ(img->normals.data, std::get<2>(reference));
+
+  polyscope::ColorRenderImageQuantity* imgColor =
+      polyscope::renderImplicitSurfaceColorBatch("sphere sdf color", sphereSDF, colorFunc, mode, opts);
+  polyscope::show(3);
+  EXPECT_EQ(imgColor->depths.data, std::get<0>(reference));
+  EXPECT_EQ(imgColor->normals.data, std::get<2>(reference));
+  EXPECT_EQ(imgColor->colors.data, referenceColor->colors.data);
+
+  // Finished renders with a fixed camera are dropped
+  EXPECT_TRUE(renders.empty());
+
+  // Rendering from the current view refines to the full view resolution, and matches a non-progressive render of it
+  opts.cameraParameters = polyscope::CameraParameters();
+  polyscope::DepthRenderImageQuantity* imgView =
+      polyscope::renderImplicitSurfaceBatch("sphere sdf view", sphereSDF, mode, opts);
+  polyscope::show(3);
+  opts.progressive = false;
+  opts.subsampleFactor = 1;
+  polyscope::DepthRenderImageQuantity* referenceView =
+      polyscope::renderImplicitSurfaceBatch("sphere sdf view reference", sphereSDF, mode, opts);
+  EXPECT_EQ(imgView->nPix(), static_cast<size_t>(polyscope::view::bufferWidth * polyscope::view::bufferHeight));
+  EXPECT_EQ(imgView->depths.data, referenceView->depths.data);
+  EXPECT_EQ(imgView->normals.data, referenceView->normals.data);
+
+  // ...and stays around to follow the view, with its finished image freed
+  ASSERT_EQ(renders.size(), 1u);
+  polyscope::ProgressiveImplicitRender* viewRender = renders.begin()->second.get();
+  EXPECT_FALSE(viewRender->isRefining());
+  EXPECT_TRUE(viewRender->getDepths().empty());
+
+  // Re-rendering without progressive mode stops the refinement
+  opts.subsampleFactor = 16;
+  polyscope::renderImplicitSurfaceBatch("sphere sdf view", sphereSDF, mode, opts);
+  EXPECT_TRUE(renders.empty());
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ImplicitSurfaceProgressiveScreenshotTest) {
+
+  auto sphereSDF = [](const float* pos, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = glm::length(glm::vec3{pos[3 * i + 0], pos[3 * i + 1], pos[3 * i + 2]}) - 1.f;
+    }
+  };
+
+  polyscope::ImplicitRenderOpts opts;
+  opts.dimX = 67;
+  opts.dimY = 41;
+  opts.cameraParameters = polyscope::CameraParameters(
+      polyscope::CameraIntrinsics::fromFoVDegVerticalAndAspect(60.f, 67.f / 41.f),
+      polyscope::CameraExtrinsics::fromVectors(glm::vec3{0.f, 0.f, 3.f}, glm::vec3{0.f, 0.f, -1.f},
+                                               glm::vec3{0.f, 1.f, 0.f}));
+  polyscope::ImplicitRenderMode mode = polyscope::ImplicitRenderMode::SphereMarch;
+  auto reference = polyscope::renderImplicitSurfaceTracer(sphereSDF, mode, opts);
+
+  // Rendering the scene without the UI refines the image too
+  opts.progressive = true;
+  opts.subsampleFactor = 4;
+  opts.progressiveFrameBudgetMs = 1000.;
+  polyscope::DepthRenderImageQuantity* img = polyscope::renderImplicitSurfaceBatch("sphere sdf", sphereSDF, mode, opts);
+  EXPECT_NE(img->depths.data, std::get<0>(reference));
+  for (int i = 0; i < 3; i++) polyscope::screenshotToBuffer();
+  EXPECT_EQ(img->depths.data, std::get<0>(reference));
+  EXPECT_EQ(img->normals.data, std::get<2>(reference));
+  EXPECT_TRUE(polyscope::state::globalContext.progressiveImplicitRenders.empty());
+
+  // A render of the current view starts over when the view changes
+  opts.cameraParameters = polyscope::CameraParameters();
+  polyscope::DepthRenderImageQuantity* imgView =
+      polyscope::renderImplicitSurfaceBatch("sphere sdf view", sphereSDF, mode, opts);
+  for (int i = 0; i < 3; i++) polyscope::screenshotToBuffer();
+  polyscope::view::lookAt(glm::vec3{1.f, 2.f, 4.f}, glm::vec3{0.f, 0.f, 0.f});
+  for (int i = 0; i < 3; i++) polyscope::screenshotToBuffer();
+  opts.progressive = false;
+  opts.subsampleFactor = 1;
+  polyscope::DepthRenderImageQuantity* referenceView =
+      polyscope::renderImplicitSurfaceBatch("sphere sdf view reference", sphereSDF, mode, opts);
+  EXPECT_EQ(imgView->depths.data, referenceView->depths.data);
+
+  polyscope::removeAllStructures();
+}
@@ -2,6 +2,8 @@
 
 #include "polyscope_test.h"
 
+#include <numeric>
+
 
 // ============================================================
 // =============== Managed Buffer Access
@@ -33,3 +35,131 @@ TEST_F(PolyscopeTest, ManagedBufferAccess) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, ManagedBufferPartialUpdate) {
+
+  // register a mesh with a vertex quantity, which gets drawn through an indexed view
+  auto psMesh = registerTriangleMesh();
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  auto q1 = psMesh->addVertexScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  polyscope::show(3);
+
+  // update a few vertex positions
+  polyscope::render::ManagedBuffer<glm::vec3>& bufferPos = psMesh->getManagedBuffer<glm::vec3>("vertexPositions");
+  bufferPos.ensureHostBufferPopulated();
+  bufferPos.data[1] = glm::vec3{0., 2., 0.};
+  bufferPos.data[2] = glm::vec3{0., 0., 2.};
+  bufferPos.markHostBufferUpdated(1, 2);
+  polyscope::show(3);
+  EXPECT_EQ(bufferPos.getValue(1), (glm::vec3{0., 2., 0.}));
+
+  // update a set of scalar ranges, including overlapping and out-of-bounds entries
+  polyscope::render::ManagedBuffer<float>& bufferScalar = q1->getManagedBuffer<float>("values");
+  bufferScalar.ensureHostBufferPopulated();
+  bufferScalar.data[0] = 1.;
+  bufferScalar.data[3] = 2.;
+  bufferScalar.markHostBufferUpdated({{3, 1}, {0, 1}, {0, 2}, {100, 5}});
+  polyscope::show(3);
+  EXPECT_EQ(bufferScalar.getValue(3), 2.);
+  EXPECT_EQ(bufferScalar.getRenderAttributeBuffer()->getDataRange_float(0, 4), (std::vector<float>{1., 7., 7., 2.}));
+
+  // the indexed view of the scalars gets patched in place
+  polyscope::render::ManagedBuffer<uint32_t>& indices = psMesh->triangleVertexInds;
+  std::shared_ptr<polyscope::render::AttributeBuffer> viewBuff =
+      bufferScalar.getIndexedRenderAttributeBuffer(indices);
+  auto expectViewMatches = [&]() {
+    indices.ensureHostBufferPopulated();
+    std::vector<float> expected;
+    for (uint32_t ind : indices.data) expected.push_back(bufferScalar.data[ind]);
+    EXPECT_EQ(viewBuff->getDataRange_float(0, expected.size()), expected);
+  };
+  bufferScalar.data[2] = 3.;
+  bufferScalar.markHostBufferUpdated(2, 1);
+  expectViewMatches();
+
+  // ... also after the contents of the index buffer change
+  indices.ensureHostBufferPopulated();
+  for (size_t iT = 0; iT < indices.data.size(); iT += 3) {
+    std::rotate(indices.data.begin() + iT, indices.data.begin() + iT + 1, indices.data.begin() + iT + 3);
+  }
+  indices.markHostBufferUpdated();
+  bufferScalar.markHostBufferUpdated();
+  expectViewMatches();
+  bufferScalar.data[1] = 4.;
+  bufferScalar.markHostBufferUpdated(1, 1);
+  expectViewMatches();
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ManagedBufferDeviceUpdateIndexedView) {
+
+  // a vertex quantity on a mesh is drawn through an indexed view
+  auto psMesh = registerTriangleMesh();
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  auto q1 = psMesh->addVertexScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  polyscope::show(3);
+
+  // write directly to the device buffer; the indexed view must get regenerated from it
+  polyscope::render::ManagedBuffer<float>& bufferScalar = q1->getManagedBuffer<float>("values");
+  std::shared_ptr<polyscope::render::AttributeBuffer> renderBuff = bufferScalar.getRenderAttributeBuffer();
+  renderBuff->setData(std::vector<float>(psMesh->nVertices(), 3.));
+  bufferScalar.markRenderAttributeBufferUpdated();
+  polyscope::show(3);
+  EXPECT_EQ(bufferScalar.getValue(0), 3.);
+  size_t nCorners = psMesh->triangleVertexInds.size();
+  std::shared_ptr<polyscope::render::AttributeBuffer> viewBuff =
+      bufferScalar.getIndexedRenderAttributeBuffer(psMesh->triangleVertexInds);
+  EXPECT_EQ(viewBuff->getDataRange_float(0, nCorners), std::vector<float>(nCorners, 3.));
+
+  // ... and again, with the indices on the device too
+  psMesh->triangleVertexInds.getRenderAttributeBuffer();
+  std::vector<float> newValues = {1., 2., 3., 4.};
+  renderBuff->setData(newValues);
+  bufferScalar.markRenderAttributeBufferUpdated();
+  polyscope::show(3);
+  psMesh->triangleVertexInds.ensureHostBufferPopulated();
+  std::vector<float> expected;
+  for (uint32_t ind : psMesh->triangleVertexInds.data) expected.push_back(newValues[ind]);
+  EXPECT_EQ(viewBuff->getDataRange_float(0, nCorners), expected);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ScalarStatisticsFollowDeviceUpdates) {
+  auto psPoints = registerPointCloud();
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  vScalar[0] = 0.;
+  auto q1 = psPoints->addScalarQuantity("vScalarLive", vScalar);
+  q1->setEnabled(true);
+  q1->setAutoRefreshStatistics(true);
+  polyscope::show(3);
+
+  // host updates get picked up when the quantity is next drawn
+  vScalar[1] = 10.;
+  q1->updateData(vScalar);
+  polyscope::show(3);
+  EXPECT_EQ(q1->getDataRange(), std::make_pair(0., 10.));
+  std::vector<float> hostValues(vScalar.begin(), vScalar.end());
+  size_t binCount = q1->getHistogramBinCounts().size();
+  EXPECT_EQ(q1->getHistogramBinCounts(), polyscope::computeScalarStatistics(hostValues, binCount, 1e-5).binCounts);
+
+  // device updates are reduced on the device where the backend supports it, otherwise read back
+  polyscope::render::ManagedBuffer<float>& bufferScalar = q1->getManagedBuffer<float>("values");
+  std::shared_ptr<polyscope::render::AttributeBuffer> renderBuff = bufferScalar.getRenderAttributeBuffer();
+  renderBuff->setData(std::vector<float>(psPoints->nPoints(), 3.));
+  bufferScalar.markRenderAttributeBufferUpdated();
+  EXPECT_TRUE(bufferScalar.dataIsOnlyOnDevice());
+  polyscope::show(3);
+  q1->refreshStatistics();
+  EXPECT_EQ(q1->getDataRange(), polyscope::padScalarRange(3., 3., 1e-5));
+  std::vector<float> deviceValues(psPoints->nPoints(), 3.);
+  std::vector<size_t> deviceBins = polyscope::computeScalarStatistics(deviceValues, binCount, 1e-5).binCounts;
+  EXPECT_EQ(std::accumulate(deviceBins.begin(), deviceBins.end(), size_t(0)), psPoints->nPoints());
+  EXPECT_EQ(q1->getHistogramBinCounts(), deviceBins);
+
+  polyscope::removeAllStructures();
+}
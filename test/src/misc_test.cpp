@@ -27,6 +27,54 @@ TEST_F(PolyscopeTest, TestScalarQuantity) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, TestScalarQuantityStatistics) {
+
+  // The statistics kernel skips NaN, and clamps infinite values into the end bins
+  std::vector<float> vals = {0.f, 1.f, 2.f, 3.f, 4.f, std::nanf(""), std::numeric_limits<float>::infinity(), -1e30f};
+  polyscope::ScalarStatistics stats = polyscope::computeScalarStatistics(vals, 4);
+  EXPECT_EQ(stats.range, std::pair<double, double>(polyscope::robustMinMax(vals)));
+  size_t binTotal = 0;
+  for (size_t c : stats.binCounts) binTotal += c;
+  EXPECT_EQ(binTotal, vals.size() - 1);
+  EXPECT_EQ(stats.binCounts.front(), 1u); // -1e30
+  EXPECT_EQ(stats.binCounts.back(), 6u);  // everything else, since -1e30 stretches the range
+
+  // Large inputs are split across blocks and threads
+  std::vector<float> longVals(1000000);
+  for (size_t i = 0; i < longVals.size(); i++) longVals[i] = static_cast<float>(i % 1000);
+  longVals[12345] = std::nanf("");
+  stats = polyscope::computeScalarStatistics(longVals, 10);
+  EXPECT_EQ(stats.range, std::pair<double, double>(polyscope::robustMinMax(longVals)));
+  for (size_t c : stats.binCounts) EXPECT_NEAR(c, longVals.size() / 10, 1);
+
+  // The data range of a scalar quantity is only refreshed on request
+  auto psPoints = registerPointCloud();
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  vScalar[0] = 0.;
+  auto q1 = psPoints->addScalarQuantity("vScalarStatistics", vScalar);
+  q1->setEnabled(true);
+  EXPECT_EQ(q1->getDataRange(), std::make_pair(0., 7.));
+  polyscope::show(3);
+
+  vScalar[1] = 10.;
+  q1->updateData(vScalar);
+  EXPECT_EQ(q1->getDataRange(), std::make_pair(0., 7.));
+  q1->updateData(vScalar, true);
+  EXPECT_EQ(q1->getDataRange(), std::make_pair(0., 10.));
+  EXPECT_EQ(q1->getMapRange(), std::make_pair(0., 10.)); // follows the data, since it was never set
+  polyscope::show(3);
+
+  // ... but a manually set map range is kept
+  q1->setMapRange({2., 3.});
+  vScalar[1] = 20.;
+  q1->updateData(vScalar, true);
+  EXPECT_EQ(q1->getDataRange(), std::make_pair(0., 20.));
+  EXPECT_EQ(q1->getMapRange(), std::make_pair(2., 3.));
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 // ============================================================
 // =============== Materials tests
 // ============================================================
@@ -7,15 +7,23 @@
 #include "polyscope/pick.h"
 #include "polyscope/point_cloud.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/render/mock_opengl/mock_gl_engine.h"
+#include "polyscope/screenshot.h"
+#include "polyscope/streaming_point_cloud.h"
 #include "polyscope/surface_mesh.h"
 #include "polyscope/volume_mesh.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <list>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "polyscope_test.h"
@@ -75,6 +83,76 @@ TEST_F(PolyscopeTest, PointCloudPick) {
 }
 
 
+TEST_F(PolyscopeTest, PointCloudPickRanges) {
+  auto psPoints1 = registerPointCloud("test1");
+  auto psPoints2 = registerPointCloud("test2");
+  polyscope::pick::pickAtBufferCoords(77, 88); // renders the pick buffer, which allocates ranges
+
+  size_t start1 = polyscope::pick::localIndexToGlobal({psPoints1, 0});
+  size_t start2 = polyscope::pick::localIndexToGlobal({psPoints2, 0});
+  size_t n = psPoints1->nPoints();
+  EXPECT_NE(start1, start2);
+
+  // global indices resolve back to the structure and local index
+  std::pair<polyscope::Structure*, size_t> expected{psPoints2, n - 1};
+  EXPECT_EQ(polyscope::pick::globalIndexToLocal(start2 + n - 1), expected);
+  std::vector<std::pair<polyscope::Structure*, size_t>> batch =
+      polyscope::pick::globalIndexToLocal(std::vector<size_t>{0, start1 + 1, start1 + 2, start2});
+  EXPECT_EQ(batch[0].first, nullptr);
+  EXPECT_EQ(batch[1].first, psPoints1);
+  EXPECT_EQ(batch[1].second, 1);
+  EXPECT_EQ(batch[2].second, 2);
+  EXPECT_EQ(batch[3].first, psPoints2);
+  EXPECT_EQ(batch[3].second, 0);
+
+  // removing a structure frees its range for reuse
+  polyscope::removeStructure("test1");
+  EXPECT_EQ(polyscope::pick::globalIndexToLocal(start1).first, nullptr);
+  auto psPoints3 = registerPointCloud("test3");
+  polyscope::pick::pickAtBufferCoords(77, 88);
+  std::set<size_t> oldStarts{start1, start2};
+  std::set<size_t> newStarts{polyscope::pick::localIndexToGlobal({psPoints2, 0}),
+                             polyscope::pick::localIndexToGlobal({psPoints3, 0})};
+  EXPECT_EQ(newStarts, oldStarts);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudPickRegion) {
+  auto psPoints = registerPointCloud();
+  auto psPoints2 = registerPointCloud("test2");
+
+  // point 1 covers a block around (50, 50), point 3 one around (150, 50), and point 0 of the other cloud a single
+  // pixel at (100, 120)
+  if (!fillMockPickBuffer(psPoints, 1, glm::ivec2{45, 45}, glm::ivec2{55, 55})) return;
+  fillMockPickBuffer(psPoints, 3, glm::ivec2{145, 45}, glm::ivec2{155, 55});
+  fillMockPickBuffer(psPoints2, 0, glm::ivec2{100, 120}, glm::ivec2{100, 120});
+  using PickResult = std::unordered_map<polyscope::Structure*, std::vector<size_t>>;
+
+  // Rectangles, including flipped corners and ones hanging off the edge of the buffer
+  EXPECT_EQ(polyscope::pick::pickInBufferRect(glm::ivec2{0, 0}, glm::ivec2{200, 200}),
+            (PickResult{{psPoints, {1, 3}}, {psPoints2, {0}}}));
+  EXPECT_EQ(polyscope::pick::pickInBufferRect(glm::ivec2{100, 60}, glm::ivec2{-10, -20}),
+            (PickResult{{psPoints, {1}}}));
+  EXPECT_EQ(polyscope::pick::pickInBufferRect(glm::ivec2{100, 100}, glm::ivec2{100, 120}),
+            (PickResult{{psPoints2, {0}}}));
+  EXPECT_TRUE(polyscope::pick::pickInBufferRect(glm::ivec2{56, 0}, glm::ivec2{144, 100}).empty());
+  EXPECT_TRUE(polyscope::pick::pickInBufferRect(glm::ivec2{-20, -20}, glm::ivec2{-10, -10}).empty());
+
+  // Lassos: a triangle which reaches point 1 but not point 3, although both are in its bounding box
+  std::vector<glm::vec2> lasso = {{40.f, 40.f}, {40.f, 160.f}, {160.f, 160.f}};
+  EXPECT_EQ(polyscope::pick::pickInBufferLasso(lasso), (PickResult{{psPoints, {1}}, {psPoints2, {0}}}));
+
+  // ... and a self-intersecting bowtie, whose middle is outside by the even-odd rule
+  std::vector<glm::vec2> bowtie = {{40.f, 40.f}, {160.f, 60.f}, {160.f, 40.f}, {40.f, 60.f}};
+  EXPECT_EQ(polyscope::pick::pickInBufferLasso(bowtie), (PickResult{{psPoints, {1, 3}}}));
+  std::vector<glm::vec2> middle = {{60.f, 40.f}, {140.f, 40.f}, {140.f, 60.f}, {60.f, 60.f}};
+  EXPECT_TRUE(polyscope::pick::pickInBufferLasso(middle).empty());
+  EXPECT_TRUE(polyscope::pick::pickInBufferLasso({{10.f, 10.f}, {20.f, 20.f}}).empty());
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, PointCloudColor) {
   auto psPoints = registerPointCloud();
   std::vector<glm::vec3> vColors(psPoints->nPoints(), glm::vec3{.2, .3, .4});
@@ -181,3 +259,150 @@ TEST_F(PolyscopeTest, PointCloudScalarRadius) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, PointCloudSpatialChunking) {
+  // the mock backend counts the primitives which are submitted
+  MainPassDrawCounter counter;
+  if (!counter.hasMockEngine()) return;
+
+  std::vector<glm::vec3> points;
+  for (int j = 0; j < 100; j++) {
+    for (int i = 0; i < 100; i++) {
+      points.push_back(glm::vec3{0.1 * i, 0.1 * j, 0.});
+    }
+  }
+  auto psPoints = polyscope::registerPointCloud("grid", points);
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  psPoints->addScalarQuantity("vScalar", vScalar)->setEnabled(true);
+
+  // up close to a corner, only some of the clusters are drawn
+  polyscope::view::lookAt(glm::vec3{1., 1., 1.5}, glm::vec3{1., 1., 0.});
+  uint64_t fullCount = counter.countScreenshotPrimitives();
+  psPoints->setSpatialChunking(true);
+  EXPECT_TRUE(psPoints->getSpatialChunking());
+  uint64_t chunkedCount = counter.countScreenshotPrimitives();
+  EXPECT_LT(chunkedCount, fullCount);
+
+  // picking skips the same points as drawing (the other passes submit the same amount either way)
+  uint64_t chunkedPickCount = counter.countPickPrimitives();
+  psPoints->setSpatialChunking(false);
+  EXPECT_EQ(counter.countPickPrimitives() - chunkedPickCount, fullCount - chunkedCount);
+  psPoints->setSpatialChunking(true);
+
+  // unless culling is disabled
+  polyscope::options::cullStructures = false;
+  EXPECT_EQ(counter.countScreenshotPrimitives(), fullCount);
+  polyscope::options::cullStructures = true;
+
+  // the clusters follow the points when they move: once they are all in view, they are all drawn
+  for (glm::vec3& p : points) p = glm::vec3{1., 1., 0.} + 0.02f * p;
+  psPoints->updatePointPositions(points);
+  uint64_t movedCount = counter.countScreenshotPrimitives();
+  psPoints->setSpatialChunking(false);
+  EXPECT_EQ(counter.countScreenshotPrimitives(), movedCount);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudLevelOfDetail) {
+  MainPassDrawCounter counter;
+  if (!counter.hasMockEngine()) return;
+
+  std::vector<glm::vec3> points;
+  for (int j = 0; j < 200; j++) {
+    for (int i = 0; i < 200; i++) {
+      points.push_back(glm::vec3{0.01 * i, 0.01 * j, 0.});
+    }
+  }
+  auto psPoints = polyscope::registerPointCloud("grid", points);
+
+  float origPixelSpacing = polyscope::options::pointCloudLODPixelSpacing;
+  polyscope::options::pointCloudLODPixelSpacing = 1000.; // coarse enough that only the root node is drawn
+
+  // screenshots are always drawn at full detail
+  polyscope::view::resetCameraToHomeView();
+  uint64_t fullCount = counter.countScreenshotPrimitives();
+  psPoints->setLevelOfDetail(true);
+  EXPECT_TRUE(psPoints->getLevelOfDetail());
+  EXPECT_EQ(counter.countScreenshotPrimitives(), fullCount);
+
+  // interactive frames are coarse while the camera moves, then full once it stops
+  polyscope::frameTick();
+  polyscope::view::lookAt(glm::vec3{1., 1., 3.}, glm::vec3{1., 1., 0.});
+  uint64_t movingCount = counter.countFramePrimitives();
+  uint64_t restingCount = counter.countFramePrimitives();
+  EXPECT_GT(movingCount, 0u);
+  EXPECT_LT(movingCount, restingCount);
+
+  // point clouds above the threshold get level of detail automatically
+  polyscope::options::pointCloudLODThreshold = points.size();
+  EXPECT_TRUE(polyscope::registerPointCloud("grid2", points)->getLevelOfDetail());
+  polyscope::options::pointCloudLODThreshold = 0;
+
+  psPoints->setLevelOfDetail(false);
+  polyscope::options::pointCloudLODPixelSpacing = origPixelSpacing;
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, StreamingPointCloud) {
+  // interleaved records of a position and a scalar value
+  size_t nPoints = 200000;
+  std::string filename = "test_streaming_points.bin";
+  {
+    std::ofstream out(filename, std::ios::binary);
+    for (size_t i = 0; i < nPoints; i++) {
+      float record[4] = {0.001f * (i % 1000), 0.004f * (i / 1000), 0.f, static_cast<float>(i)};
+      out.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+  }
+
+  auto psStream = polyscope::registerStreamingPointCloud("stream", filename, 0, 16);
+  EXPECT_TRUE(polyscope::hasStreamingPointCloud("stream"));
+  EXPECT_EQ(psStream->nPoints(), nPoints);
+  psStream->addScalarQuantityFromFile("index", filename, 12, 16);
+  psStream->setActiveScalarQuantity("index");
+  EXPECT_EQ(psStream->getMapRange().second, nPoints - 1.);
+
+  // the drawn counts are for the main pass only
+  MainPassDrawCounter counter;
+
+  // everything fits in the default budget, and is drawn once the camera rests
+  polyscope::view::resetCameraToHomeView();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(psStream->getDrawnPointCount(), nPoints);
+  EXPECT_EQ(psStream->getUploadedPointCount(), nPoints);
+  EXPECT_LE(psStream->getGPUPoolBytes(), polyscope::options::streamingPointCloudGPUBudget);
+
+  // later frames of the same view upload nothing more
+  polyscope::screenshotToBuffer();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(psStream->getDrawnPointCount(), nPoints);
+  EXPECT_EQ(psStream->getUploadedPointCount(), nPoints);
+
+  // a small budget is respected, drawing only what fits, and does not thrash the pool from frame to frame
+  size_t origBudget = polyscope::options::streamingPointCloudGPUBudget;
+  polyscope::options::streamingPointCloudGPUBudget = 1 << 20;
+  polyscope::screenshotToBuffer();
+  EXPECT_LE(psStream->getGPUPoolBytes(), polyscope::options::streamingPointCloudGPUBudget);
+  EXPECT_GT(psStream->getDrawnPointCount(), 0u);
+  EXPECT_LT(psStream->getDrawnPointCount(), nPoints);
+  size_t budgetDrawnCount = psStream->getDrawnPointCount();
+  size_t budgetUploadCount = psStream->getUploadedPointCount();
+  polyscope::screenshotToBuffer();
+  polyscope::screenshotToBuffer();
+  EXPECT_EQ(psStream->getDrawnPointCount(), budgetDrawnCount);
+  EXPECT_EQ(psStream->getUploadedPointCount(), budgetUploadCount);
+  polyscope::options::streamingPointCloudGPUBudget = origBudget;
+
+  // up close, only the chunks in view are drawn
+  polyscope::view::lookAt(glm::vec3{0.5, 0.01, 0.05}, glm::vec3{0.5, 0.01, 0.});
+  polyscope::screenshotToBuffer();
+  EXPECT_GT(psStream->getDrawnPointCount(), 0u);
+  EXPECT_LT(psStream->getDrawnPointCount(), nPoints);
+
+  psStream->setPointRenderMode(polyscope::PointRenderMode::Sphere);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+  std::remove(filename.c_str());
+}
@@ -2,6 +2,8 @@
 
 #include "polyscope_test.h"
 
+#include "polyscope/render/mock_opengl/mock_gl_engine.h"
+
 // ============================================================
 // =============== Surface mesh tests
 // ============================================================
@@ -121,6 +123,45 @@ TEST_F(PolyscopeTest, SurfaceMeshPick) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshPickCached) {
+  auto psMesh = registerTriangleMesh();
+  psMesh->markEdgesAsUsed();
+  if (!fillMockPickBuffer(psMesh, 5, glm::ivec2{70, 80}, glm::ivec2{77, 89})) return;
+  std::pair<polyscope::Structure*, size_t> element{psMesh, 5};
+
+  // repeated queries are served from the same cached pick buffer (re-rendering would clear the filled pixels)
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(77, 88), element);
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(77, 88), element);
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(78, 88).first, nullptr);
+
+  // batched queries agree with single queries, and give nothing for out-of-bounds pixels
+  std::vector<glm::ivec2> coords = {{77, 88}, {78, 88}, {70, 89}, {-5, 3}};
+  std::vector<std::pair<polyscope::Structure*, size_t>> results = polyscope::pick::pickAtBufferCoords(coords);
+  ASSERT_EQ(results.size(), coords.size());
+  EXPECT_EQ(results[0], element);
+  EXPECT_EQ(results[1].first, nullptr);
+  EXPECT_EQ(results[2], element);
+  EXPECT_EQ(results[3].first, nullptr);
+
+  // redraw requests alone (e.g. while the mouse is held down) keep the cache, as do frames which change nothing
+  polyscope::requestRedraw();
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(77, 88), element);
+  polyscope::show(3);
+  uint64_t generation = polyscope::sceneGeneration();
+  polyscope::show(3);
+  EXPECT_EQ(polyscope::sceneGeneration(), generation);
+
+  // changes to the scene cause a re-render
+  psMesh->setEdgeWidth(1.0);
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(77, 88).first, nullptr);
+  fillMockPickBuffer(psMesh, 5, glm::ivec2{77, 88}, glm::ivec2{77, 88});
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(77, 88), element);
+  polyscope::pick::invalidatePickBuffer();
+  EXPECT_EQ(polyscope::pick::pickAtBufferCoords(coords)[0].first, nullptr);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshMark) {
   auto psMesh = registerTriangleMesh();
 
@@ -148,6 +189,184 @@ TEST_F(PolyscopeTest, SurfaceMeshMark) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshEdgeConnectivity) {
+  auto psMesh = registerTriangleMesh();
+
+  // the test mesh is a closed tetrahedron
+  EXPECT_EQ(psMesh->nEdges(), 6);
+
+  psMesh->ensureHaveManifoldConnectivity();
+  ASSERT_EQ(psMesh->twinHalfedge.size(), psMesh->nHalfedges());
+  for (size_t iHe = 0; iHe < psMesh->nHalfedges(); iHe++) {
+    size_t iTwin = psMesh->twinHalfedge[iHe];
+    ASSERT_NE(iTwin, polyscope::INVALID_IND);
+    EXPECT_NE(iTwin, iHe);
+    EXPECT_EQ(psMesh->twinHalfedge[iTwin], iHe);
+  }
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshParallelGeometry) {
+  // a grid large enough that geometry is computed on several threads
+  size_t n = 100;
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      points.push_back(glm::vec3(i, j, (i * j) % 5));
+    }
+  }
+  for (size_t i = 0; i + 1 < n; i++) {
+    for (size_t j = 0; j + 1 < n; j++) {
+      faces.push_back({i * n + j, (i + 1) * n + j, (i + 1) * n + j + 1, i * n + j + 1});
+    }
+  }
+
+  int origMaxThreads = polyscope::options::maxThreads;
+  polyscope::options::maxThreads = 1;
+  polyscope::SurfaceMesh* psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+  std::vector<glm::vec3> serialNormals = psMesh->vertexNormals.getPopulatedHostBufferRef();
+  std::vector<float> serialAreas = psMesh->vertexAreas.getPopulatedHostBufferRef();
+
+  // vertex accumulations must give exactly the same result on any number of threads
+  polyscope::options::maxThreads = 4;
+  psMesh->faceNormals.recomputeIfPopulated();
+  psMesh->faceAreas.recomputeIfPopulated();
+  psMesh->vertexNormals.recomputeIfPopulated();
+  psMesh->vertexAreas.recomputeIfPopulated();
+  EXPECT_EQ(psMesh->vertexNormals.data, serialNormals);
+  EXPECT_EQ(psMesh->vertexAreas.data, serialAreas);
+
+  polyscope::options::maxThreads = origMaxThreads;
+  polyscope::show(3);
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshUpdatePositionsPartial) {
+  auto psMeshPartial = registerTriangleMesh("partial");
+  auto psMeshFull = registerTriangleMesh("full");
+  for (polyscope::SurfaceMesh* m : {psMeshPartial, psMeshFull}) {
+    m->vertexNormals.ensureHostBufferPopulated();
+    m->vertexAreas.ensureHostBufferPopulated();
+    m->faceCenters.ensureHostBufferPopulated();
+    m->setSmoothShade(true);
+  }
+  polyscope::show(3);
+
+  // move one vertex, the partial update should match a full update
+  std::vector<glm::vec3> newPositions = getPoints();
+  newPositions[2] = glm::vec3{0.3, 0.2, 1.5};
+  psMeshPartial->updateVertexPositionsPartial(std::vector<size_t>{2}, std::vector<glm::vec3>{newPositions[2]});
+  psMeshFull->updateVertexPositions(newPositions);
+
+  EXPECT_EQ(psMeshPartial->vertexPositions.data, psMeshFull->vertexPositions.data);
+  EXPECT_EQ(psMeshPartial->faceNormals.data, psMeshFull->faceNormals.data);
+  EXPECT_EQ(psMeshPartial->faceAreas.data, psMeshFull->faceAreas.data);
+  EXPECT_EQ(psMeshPartial->faceCenters.data, psMeshFull->faceCenters.data);
+  EXPECT_EQ(psMeshPartial->vertexNormals.data, psMeshFull->vertexNormals.data);
+  EXPECT_EQ(psMeshPartial->vertexAreas.data, psMeshFull->vertexAreas.data);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshSpatialChunking) {
+  // the mock backend counts the primitives which are submitted
+  MainPassDrawCounter counter;
+  if (!counter.hasMockEngine()) return;
+
+  // a grid of quads, with some polygons so the triangulation differs from the faces
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  size_t n = 100;
+  for (size_t j = 0; j <= n; j++) {
+    for (size_t i = 0; i <= n; i++) {
+      points.push_back(glm::vec3{0.1 * i, 0.1 * j, 0.});
+    }
+  }
+  for (size_t j = 0; j < n; j++) {
+    for (size_t i = 0; i < n; i++) {
+      size_t v = j * (n + 1) + i;
+      if ((i + j) % 2 == 0) {
+        faces.push_back({v, v + 1, v + n + 2, v + n + 1});
+      } else {
+        faces.push_back({v, v + 1, v + n + 2});
+        faces.push_back({v, v + n + 2, v + n + 1});
+      }
+    }
+  }
+  auto psMesh = polyscope::registerSurfaceMesh("grid", points, faces);
+  std::vector<double> vScalar(psMesh->nVertices(), 7.);
+  psMesh->addVertexScalarQuantity("vScalar", vScalar)->setEnabled(true);
+
+  // up close to a corner, only some of the clusters are drawn
+  polyscope::view::lookAt(glm::vec3{1., 1., 1.5}, glm::vec3{1., 1., 0.});
+  uint64_t fullCount = counter.countScreenshotPrimitives();
+  psMesh->setSpatialChunking(true);
+  EXPECT_TRUE(psMesh->getSpatialChunking());
+  EXPECT_LT(counter.countScreenshotPrimitives(), fullCount);
+
+  // everything is visible from the home view
+  polyscope::view::resetCameraToHomeView();
+  uint64_t homeCount = counter.countScreenshotPrimitives();
+  psMesh->setSpatialChunking(false);
+  EXPECT_EQ(counter.countScreenshotPrimitives(), homeCount);
+
+  // the visible ranges follow the vertices when they move: once they are all in view, they are all drawn
+  polyscope::view::lookAt(glm::vec3{1., 1., 1.5}, glm::vec3{1., 1., 0.});
+  psMesh->setSpatialChunking(true);
+  EXPECT_LT(counter.countScreenshotPrimitives(), homeCount);
+  for (glm::vec3& p : points) p = glm::vec3{1., 1., 0.} + 0.02f * p;
+  psMesh->updateVertexPositions(points);
+  EXPECT_EQ(counter.countScreenshotPrimitives(), homeCount);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshPolygonEdges) {
+  // edge and halfedge quantities on meshes with polygonal faces
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+
+  // clang-format off
+  points = {
+    {0, 0, 0},
+    {1, 0, 0},
+    {1, 1, 0},
+    {0, 1, 0},
+    {0.5, 2, 0},
+  };
+
+  faces = {
+    {0, 1, 2, 3},
+    {3, 2, 4},
+   };
+  // clang-format on
+
+  polyscope::SurfaceMesh* psMesh = polyscope::registerSurfaceMesh("mesh poly", points, faces);
+  EXPECT_EQ(psMesh->nEdges(), 6);
+
+  // the quad and the triangle share one edge
+  psMesh->ensureHaveManifoldConnectivity();
+  size_t nInterior = 0;
+  for (size_t iHe = 0; iHe < psMesh->nHalfedges(); iHe++) {
+    if (psMesh->twinHalfedge[iHe] != polyscope::INVALID_IND) nInterior++;
+  }
+  EXPECT_EQ(nInterior, 2);
+
+  std::vector<size_t> ePerm = {5, 3, 1, 2, 4, 0};
+  psMesh->setEdgePermutation(ePerm);
+  std::vector<double> eScalar(psMesh->nEdges(), 9.);
+  psMesh->addEdgeScalarQuantity("edge vals", eScalar)->setEnabled(true);
+  std::vector<double> heScalar(psMesh->nHalfedges(), 3.);
+  psMesh->addHalfedgeScalarQuantity("halfedge vals", heScalar)->setEnabled(true);
+  psMesh->markEdgesAsUsed();
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshBackface) {
   auto psMesh = registerTriangleMesh();
 
@@ -357,6 +576,34 @@ TEST_F(PolyscopeTest, SurfaceMeshCornerParam) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshCornerParamIslands) {
+  auto psMesh = registerTriangleMesh();
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getTriangleMesh();
+
+  // coordinates which only depend on the vertex have no seams, so the whole mesh is one island
+  std::vector<glm::vec2> vals;
+  for (const std::vector<size_t>& face : faces) {
+    for (size_t iV : face) vals.push_back({points[iV].x, points[iV].y});
+  }
+  auto q1 = psMesh->addParameterizationQuantity("param islands", vals);
+  q1->setEnabled(true);
+  q1->setAutoIslandLabels(true);
+  q1->setStyle(polyscope::ParamVizStyle::CHECKER_ISLANDS);
+  for (size_t iF = 0; iF < psMesh->nFaces(); iF++) EXPECT_EQ(q1->islandLabels.getValue(iF), 0.);
+  polyscope::show(3);
+
+  // shifting the last face cuts it off along all of its edges
+  for (size_t iC = 9; iC < 12; iC++) vals[iC] += glm::vec2{5., 0.};
+  q1->updateCoords(vals);
+  polyscope::show(3);
+  EXPECT_EQ(q1->islandLabels.getValue(0), 0.);
+  EXPECT_EQ(q1->islandLabels.getValue(3), 1.);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshVertexParam) {
   auto psMesh = registerTriangleMesh();
   std::vector<glm::vec2> vals(psMesh->nVertices(), {1., 2.});
@@ -1,5 +1,6 @@
 // Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
 
+#include "polyscope/marching_cubes.h"
 #include "polyscope/slice_plane.h"
 #include "polyscope_test.h"
 
@@ -180,3 +181,216 @@ TEST_F(PolyscopeTest, VolumeGridScalarIsosurfaceAndOpts) {
   polyscope::removeLastSceneSlicePlane();
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, VolumeGridMarchingCubes) {
+
+  // distance to the origin, sampled on a non-cubic grid
+  glm::uvec3 dim{13, 17, 21};
+  glm::vec3 boundMin{-1.f, -1.f, -1.f};
+  glm::vec3 spacing = 2.f / glm::vec3(dim - 1u);
+  std::vector<float> values;
+  for (uint32_t iZ = 0; iZ < dim.z; iZ++) {
+    for (uint32_t iY = 0; iY < dim.y; iY++) {
+      for (uint32_t iX = 0; iX < dim.x; iX++) {
+        values.push_back(glm::length(boundMin + glm::vec3(iX, iY, iZ) * spacing));
+      }
+    }
+  }
+
+  int origMaxThreads = polyscope::options::maxThreads;
+  polyscope::options::maxThreads = 1;
+  polyscope::IsosurfaceMesh serial = polyscope::marchingCubes(values, dim, 0.6f, boundMin, spacing);
+  polyscope::options::maxThreads = 4;
+  polyscope::IsosurfaceMesh parallel = polyscope::marchingCubes(values, dim, 0.6f, boundMin, spacing);
+  polyscope::options::maxThreads = origMaxThreads;
+
+  // the result does not depend on the number of threads
+  EXPECT_EQ(serial.vertices, parallel.vertices);
+  EXPECT_EQ(serial.indices, parallel.indices);
+
+  // a closed sphere: every vertex is near the surface, and shared by the triangles around it (V - E + F = 2)
+  ASSERT_GT(serial.indices.size(), 0);
+  EXPECT_EQ(serial.indices.size() % 3, 0);
+  for (const glm::vec3& p : serial.vertices) {
+    EXPECT_NEAR(glm::length(p), 0.6f, 0.05f);
+  }
+  for (uint32_t i : serial.indices) {
+    EXPECT_LT(i, serial.vertices.size());
+  }
+  size_t nFaces = serial.indices.size() / 3;
+  EXPECT_EQ(2 * serial.vertices.size(), nFaces + 4);
+
+  // nothing to extract
+  EXPECT_TRUE(polyscope::marchingCubes(values, dim, 10.f, boundMin, spacing).indices.empty());
+}
+
+TEST_F(PolyscopeTest, VolumeGridIsosurfaceDeviceExtraction) {
+  // (the mock backend emulates the device-side extraction, so it can be compared with the host one)
+  polyscope::render::backend_openGL_mock::MockGLEngine* mockEngine =
+      dynamic_cast<polyscope::render::backend_openGL_mock::MockGLEngine*>(polyscope::render::engine);
+  if (mockEngine == nullptr) return;
+
+  glm::uvec3 dim{9, 11, 7};
+  glm::vec3 boundMin{-1.f, -1.f, -1.f};
+  glm::vec3 spacing = 2.f / glm::vec3(dim - 1u);
+  std::vector<float> values;
+  for (uint32_t iZ = 0; iZ < dim.z; iZ++) {
+    for (uint32_t iY = 0; iY < dim.y; iY++) {
+      for (uint32_t iX = 0; iX < dim.x; iX++) {
+        values.push_back(glm::length(boundMin + glm::vec3(iX, iY, iZ) * spacing));
+      }
+    }
+  }
+
+  std::shared_ptr<polyscope::render::TextureBuffer> texture = mockEngine->generateTextureBuffer(
+      polyscope::TextureFormat::R32F, dim.x, dim.y, dim.z, &values.front());
+  std::shared_ptr<polyscope::render::AttributeBuffer> positions =
+      polyscope::render::engine->generateAttributeBuffer(polyscope::RenderDataType::Vector3Float);
+  std::shared_ptr<polyscope::render::AttributeBuffer> indices =
+      polyscope::render::engine->generateAttributeBuffer(polyscope::RenderDataType::UInt);
+  ASSERT_TRUE(
+      polyscope::render::engine->extractIsosurface(*texture, 0.6f, boundMin, spacing, *positions, *indices));
+
+  // the device output does not share vertices, so compare it with the host triangles expanded in the same order
+  polyscope::IsosurfaceMesh hostMesh = polyscope::marchingCubes(values, dim, 0.6f, boundMin, spacing);
+  ASSERT_GT(hostMesh.indices.size(), 0);
+  ASSERT_EQ(positions->getDataSize(), hostMesh.indices.size());
+  ASSERT_EQ(indices->getDataSize(), hostMesh.indices.size());
+  std::vector<glm::vec3> devicePositions = positions->getDataRange_vec3(0, positions->getDataSize());
+  std::vector<uint32_t> deviceIndices = indices->getDataRange_uint32(0, indices->getDataSize());
+  for (size_t i = 0; i < hostMesh.indices.size(); i++) {
+    EXPECT_EQ(deviceIndices[i], i);
+    glm::vec3 expected = hostMesh.vertices[hostMesh.indices[i]];
+    for (int c = 0; c < 3; c++) EXPECT_NEAR(devicePositions[i][c], expected[c], 1e-5);
+  }
+
+  // nothing to extract
+  ASSERT_TRUE(
+      polyscope::render::engine->extractIsosurface(*texture, 10.f, boundMin, spacing, *positions, *indices));
+  EXPECT_EQ(positions->getDataSize(), 0);
+}
+
+TEST_F(PolyscopeTest, VolumeGridIsosurfaceCache) {
+  glm::uvec3 dim{8, 10, 12};
+  polyscope::VolumeGrid* psGrid =
+      polyscope::registerVolumeGrid("test grid", dim, glm::vec3{-1., -1., -1.}, glm::vec3{1., 1., 1.});
+  polyscope::VolumeGridNodeScalarQuantity* q =
+      psGrid->addNodeScalarQuantityFromCallable("dist", [](glm::vec3 p) { return glm::length(p); });
+  q->setIsosurfaceLevel(0.5);
+  q->setIsosurfaceVizEnabled(true);
+  q->setEnabled(true);
+  polyscope::show(3);
+
+  // registering reuses the extracted mesh
+  polyscope::SurfaceMesh* mesh1 = q->registerIsosurfaceAsMesh("iso1");
+  polyscope::SurfaceMesh* mesh2 = q->registerIsosurfaceAsMesh("iso2");
+  EXPECT_EQ(mesh1->nVertices(), mesh2->nVertices());
+  EXPECT_GT(mesh1->nVertices(), 0);
+
+  // new values give a new isosurface
+  std::vector<float> newValues(psGrid->nNodes(), 1.f);
+  q->updateData(newValues);
+  polyscope::SurfaceMesh* mesh3 = q->registerIsosurfaceAsMesh("iso3");
+  EXPECT_EQ(mesh3->nVertices(), 0);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, VolumeGridSparseBricks) {
+
+  // a few scattered values, on a grid which is not a multiple of the brick size
+  glm::uvec3 dim{30, 19, 41};
+  polyscope::SparseBrickGrid grid(dim, 2.f);
+  EXPECT_EQ(grid.getLayout().getBrickDim(), glm::uvec3(4, 3, 5));
+  EXPECT_EQ(grid.getLayout().nStoredBricks(), 0);
+  grid.setValue({8, 8, 8}, -1.f); // on the corner of 8 bricks
+  grid.setValue({29, 18, 40}, -1.f);
+  grid.setValue({3, 4, 5}, 2.f); // background, stores nothing
+  EXPECT_EQ(grid.getLayout().nStoredBricks(), 9);
+  EXPECT_EQ(grid.getValue({8, 8, 8}), -1.f);
+  EXPECT_EQ(grid.getValue({9, 8, 8}), 2.f);
+  EXPECT_EQ(grid.getValue({29, 18, 40}), -1.f);
+
+  // the isosurface matches the one of the dense field
+  std::vector<float> dense = grid.toDense();
+  EXPECT_EQ(dense[(40 * dim.y + 18) * dim.x + 29], -1.f);
+  glm::vec3 boundMin{-1.f, 0.f, 1.f};
+  glm::vec3 spacing{0.1f, 0.2f, 0.3f};
+  polyscope::IsosurfaceMesh denseMesh = polyscope::marchingCubes(dense, dim, 0.f, boundMin, spacing);
+  polyscope::IsosurfaceMesh sparseMesh =
+      polyscope::marchingCubes(grid.getLayout(), grid.getAtlasValues(), 0.f, boundMin, spacing);
+  EXPECT_EQ(sparseMesh.vertices.size(), denseMesh.vertices.size());
+  EXPECT_EQ(sparseMesh.indices.size(), denseMesh.indices.size());
+  std::vector<glm::vec3> denseVerts = denseMesh.vertices;
+  std::vector<glm::vec3> sparseVerts = sparseMesh.vertices;
+  auto lexLess = [](glm::vec3 a, glm::vec3 b) {
+    return std::lexicographical_compare(&a[0], &a[0] + 3, &b[0], &b[0] + 3);
+  };
+  std::sort(denseVerts.begin(), denseVerts.end(), lexLess);
+  std::sort(sparseVerts.begin(), sparseVerts.end(), lexLess);
+  EXPECT_EQ(sparseVerts, denseVerts);
+}
+
+TEST_F(PolyscopeTest, VolumeGridSparseScalar) {
+  glm::uvec3 dim{129, 113, 97};
+  polyscope::VolumeGrid* psGrid =
+      polyscope::registerVolumeGrid("test grid", dim, glm::vec3{-1., -1., -1.}, glm::vec3{1., 1., 1.});
+
+  // a sphere, stored only in the bricks which it overlaps
+  auto dist = [](glm::vec3 p) { return glm::length(p) - 0.3f; };
+  auto overlapsSphere = [](glm::vec3 brickMin, glm::vec3 brickMax) {
+    glm::vec3 closest = glm::clamp(glm::vec3(0.f), brickMin, brickMax);
+    return glm::length(closest) < 0.4f;
+  };
+  polyscope::VolumeGridNodeScalarQuantity* q =
+      psGrid->addNodeScalarQuantityFromCallableSparse("sparse dist", dist, overlapsSphere, 1.f);
+  polyscope::VolumeGridNodeScalarQuantity* qDense = psGrid->addNodeScalarQuantityFromCallable("dist", dist);
+  EXPECT_TRUE(q->isSparse());
+  EXPECT_FALSE(qDense->isSparse());
+  EXPECT_LT(q->getMemoryUsage(), qDense->getMemoryUsage() / 4);
+
+  // values inside the stored bricks, and background elsewhere
+  glm::uvec3 center = dim / 2u;
+  EXPECT_FLOAT_EQ(q->getNodeValue(psGrid->flattenNodeIndex(center)), -0.3f);
+  EXPECT_EQ(q->getNodeValue(psGrid->flattenNodeIndex({0, 0, 0})), 1.f);
+
+  // statistics are over the grid nodes, as if the values were dense
+  std::vector<float> nodeValues(psGrid->nNodes());
+  for (size_t i = 0; i < nodeValues.size(); i++) {
+    nodeValues[i] = q->getNodeValue(i);
+  }
+  size_t binCount = q->getHistogramBinCounts().size();
+  polyscope::ScalarStatistics nodeStats = polyscope::computeScalarStatistics(nodeValues, binCount, 1e-5);
+  EXPECT_EQ(q->getHistogramBinCounts(), nodeStats.binCounts);
+  EXPECT_EQ(q->getDataRange(), nodeStats.range);
+
+  // gridcube and isosurface visualizations
+  q->setEnabled(true);
+  polyscope::show(3);
+  q->setIsosurfaceLevel(0.f);
+  q->setIsosurfaceVizEnabled(true);
+  polyscope::show(3);
+  q->setGridcubeVizEnabled(false);
+  polyscope::show(3);
+
+  qDense->setIsosurfaceLevel(0.f);
+  polyscope::SurfaceMesh* sparseIso = q->registerIsosurfaceAsMesh("sparse iso");
+  polyscope::SurfaceMesh* denseIso = qDense->registerIsosurfaceAsMesh("dense iso");
+  EXPECT_GT(sparseIso->nVertices(), 0);
+  EXPECT_EQ(sparseIso->nVertices(), denseIso->nVertices());
+  EXPECT_EQ(sparseIso->nFaces(), denseIso->nFaces());
+
+  // only the sparse quantity has a page table
+  EXPECT_TRUE(q->hasManagedBuffer<float>(q->uniquePrefix() + "brickSlots"));
+  EXPECT_FALSE(qDense->hasManagedBuffer<float>(qDense->uniquePrefix() + "brickSlots"));
+
+  // the values of a sparse quantity are the brick atlas, they cannot be replaced node by node
+  EXPECT_ANY_THROW(q->updateData(std::vector<float>(psGrid->nNodes(), 1.f)));
+  EXPECT_FLOAT_EQ(q->getNodeValue(psGrid->flattenNodeIndex(center)), -0.3f);
+
+  // the grid must match
+  polyscope::SparseBrickGrid wrongSize(glm::uvec3{3, 3, 3}, 0.f);
+  EXPECT_ANY_THROW(psGrid->addNodeScalarQuantitySparse("wrong", wrongSize));
+
+  polyscope::removeAllStructures();
+}
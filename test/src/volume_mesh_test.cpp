@@ -63,6 +63,34 @@ TEST_F(PolyscopeTest, ShowVolumeMesh) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, VolumeMeshInteriorFaces) {
+  // clang-format off
+  std::vector<glm::vec3> verts = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+    {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1},
+    {0, 0, 2},
+  };
+  std::vector<std::array<int, 8>> cells = {
+      {0, 1, 2, 3, 4, 5, 6, 7},       // hex
+      {4, 5, 6, 8, -1, -1, -1, -1},   // tet on the top of the hex, sharing only a triangle with it
+      {8, 6, 5, 7, -1, -1, -1, -1},   // tet sharing a face with the one above, with a different vertex order
+  };
+  // clang-format on
+  polyscope::VolumeMesh* psVol = polyscope::registerVolumeMesh("vol", verts, cells);
+
+  EXPECT_EQ(psVol->nFaces(), 6u + 4u + 4u);
+  EXPECT_EQ(psVol->nFacesTriangulation(), 12u + 4u + 4u);
+
+  std::vector<char> expected = {
+      false, false, false, false, false, false, // hex
+      false, false, false, true,                // first tet: {4,6,5}, {4,5,8}, {4,8,6}, {5,6,8}
+      true,  false, false, false,               // second tet: {8,5,6}, {8,6,7}, {8,7,5}, {6,5,7}
+  };
+  EXPECT_EQ(psVol->faceIsInterior, expected);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, VolumeMeshUpdatePositions) {
   std::vector<glm::vec3> verts;
   std::vector<std::array<int, 8>> cells;
@@ -228,3 +256,135 @@ TEST_F(PolyscopeTest, VolumeMeshInspect) {
 
   polyscope::removeLastSceneSlicePlane();
 }
+
+TEST_F(PolyscopeTest, VolumeMeshTetDecomposition) {
+  // One hex for each number of split diagonals not incident on the lowest vertex (0 to 3), which is set by the order
+  // of the vertex numbers around the hex, and a tet
+  // clang-format off
+  std::vector<std::array<uint32_t, 8>> hexOrders = {
+    {0, 2, 1, 3, 5, 4, 6, 7},
+    {0, 2, 1, 3, 4, 5, 6, 7},
+    {0, 1, 2, 3, 4, 5, 6, 7},
+    {0, 1, 3, 2, 4, 5, 6, 7},
+  };
+  std::vector<glm::vec3> corners = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1},
+  };
+  // clang-format on
+  std::vector<glm::vec3> verts(8 * hexOrders.size());
+  std::vector<std::array<int, 8>> cells;
+  for (uint32_t iH = 0; iH < hexOrders.size(); iH++) {
+    std::array<int, 8> cell;
+    for (uint32_t k = 0; k < 8; k++) {
+      cell[k] = 8 * iH + hexOrders[iH][k];
+      verts[cell[k]] = corners[k] + glm::vec3{2.f * iH, 0.f, 0.f};
+    }
+    cells.push_back(cell);
+  }
+  cells.push_back({2, 10, 18, 26, -1, -1, -1, -1});
+
+  // As computed by the original serial decomposition
+  // clang-format off
+  std::vector<std::array<uint32_t, 4>> expectedTets = {
+    {0, 2, 1, 4}, {0, 1, 7, 4}, {0, 1, 3, 7}, {0, 4, 7, 5}, {1, 7, 4, 6},
+    {8, 15, 9, 11}, {8, 12, 9, 15}, {12, 14, 9, 15}, {8, 9, 13, 10}, {8, 9, 12, 13}, {12, 9, 14, 13},
+    {16, 17, 18, 22}, {16, 20, 21, 22}, {16, 21, 17, 22}, {16, 19, 23, 18}, {16, 20, 22, 23}, {16, 22, 18, 23},
+    {24, 27, 26, 30}, {24, 26, 31, 30}, {24, 31, 28, 30}, {24, 29, 30, 28}, {25, 29, 30, 24}, {25, 30, 27, 24},
+    {2, 10, 18, 26},
+  };
+  // clang-format on
+
+  polyscope::VolumeMesh* psVol = polyscope::registerVolumeMesh("vol", verts, cells);
+  psVol->computeTets();
+  EXPECT_EQ(psVol->tets, expectedTets);
+  ASSERT_EQ(psVol->nTets(), expectedTets.size());
+  for (size_t i = 0; i < 4; i++) {
+    for (size_t iT = 0; iT < expectedTets.size(); iT++) {
+      EXPECT_EQ(psVol->tetVertexInds[i].data[iT], expectedTets[iT][i]);
+    }
+  }
+
+  // released tets come back the same, without touching the slice buffers
+  uint64_t indsVersion = psVol->tetVertexInds[0].dataVersion();
+  psVol->releaseTets();
+  EXPECT_TRUE(psVol->tets.empty());
+  psVol->ensureHaveTets();
+  EXPECT_EQ(psVol->tets, expectedTets);
+  EXPECT_EQ(psVol->tetVertexInds[0].dataVersion(), indsVersion);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, VolumeMeshInspectMultiplePlanes) {
+  std::vector<glm::vec3> verts;
+  std::vector<std::array<int, 8>> cells;
+  std::tie(verts, cells) = getVolumeMeshData();
+  polyscope::VolumeMesh* psVol = polyscope::registerVolumeMesh("vol", verts, cells);
+
+  polyscope::SlicePlane* p1 = polyscope::addSceneSlicePlane();
+  polyscope::SlicePlane* p2 = polyscope::addSceneSlicePlane();
+  p1->setVolumeMeshToInspect("vol");
+  p2->setVolumeMeshToInspect("vol");
+  polyscope::show(3);
+
+  // with quantities, and a level set
+  std::vector<float> vals;
+  for (const glm::vec3& v : verts) vals.push_back(v.x + 2.f * v.y);
+  auto q1 = psVol->addVertexScalarQuantity("vals", vals);
+  q1->setEnabled(true);
+  std::vector<glm::vec3> vColors(verts.size(), glm::vec3{.2, .3, .4});
+  auto q2 = psVol->addVertexColorQuantity("vcolor", vColors);
+  q2->setEnabled(true);
+  polyscope::show(3);
+
+  q1->setEnabledLevelSet(true);
+  polyscope::show(3);
+
+  // the slice programs all bind the same per-corner buffers, which hold the tet corners
+  std::shared_ptr<polyscope::render::ShaderProgram> scalarSlice = q1->createSliceProgram();
+  std::shared_ptr<polyscope::render::ShaderProgram> colorSlice = q2->createSliceProgram();
+  std::shared_ptr<polyscope::render::ShaderProgram> levelSet = q1->levelSetProgram;
+  ASSERT_NE(levelSet, nullptr);
+  size_t nTets = psVol->nTets();
+  ASSERT_GT(nTets, 0);
+  EXPECT_EQ(psVol->tetVertexInds[0].size(), nTets);
+  for (int i = 0; i < 4; i++) {
+    std::string corner = std::to_string(i + 1);
+    std::shared_ptr<polyscope::render::AttributeBuffer> points = scalarSlice->getAttributeBuffer("a_point_" + corner);
+    ASSERT_NE(points, nullptr);
+    EXPECT_EQ(colorSlice->getAttributeBuffer("a_point_" + corner), points);
+    EXPECT_EQ(levelSet->getAttributeBuffer("a_point_" + corner), points);
+    EXPECT_EQ(scalarSlice->getAttributeBuffer("a_slice_" + corner), points);
+
+    // the level set slices by the same value buffers that the scalar slice program shows
+    std::shared_ptr<polyscope::render::AttributeBuffer> values = scalarSlice->getAttributeBuffer("a_value_" + corner);
+    EXPECT_EQ(levelSet->getAttributeBuffer("a_levelSetValue_" + corner), values);
+
+    ASSERT_EQ(points->getDataSize(), nTets);
+    ASSERT_EQ(values->getDataSize(), nTets);
+    std::vector<glm::vec3> cornerPositions = points->getDataRange_vec3(0, nTets);
+    std::vector<float> cornerValues = values->getDataRange_float(0, nTets);
+    for (size_t iT = 0; iT < nTets; iT++) {
+      uint32_t iV = psVol->tetVertexInds[i].data[iT];
+      EXPECT_EQ(cornerPositions[iT], verts[iV]);
+      EXPECT_EQ(cornerValues[iT], vals[iV]);
+    }
+  }
+
+  // the slices follow the new positions
+  psVol->updateVertexPositions(verts);
+  polyscope::show(3);
+
+  // slicing keeps working without the host tets
+  psVol->releaseTets();
+  EXPECT_TRUE(psVol->tets.empty());
+  EXPECT_EQ(psVol->nTets(), nTets);
+  q1->setEnabledLevelSet(false);
+  polyscope::show(3);
+  psVol->ensureHaveTets();
+  EXPECT_EQ(psVol->tets.size(), nTets);
+
+  polyscope::removeAllStructures();
+  polyscope::removeLastSceneSlicePlane();
+  polyscope::removeLastSceneSlicePlane();
+}